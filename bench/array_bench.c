@@ -0,0 +1,337 @@
+/*
+ Compares the generated Dynamic_Array from examples/array.gs with a
+ vector over void * that copies elements of a runtime size, and
+ measures the inline buffer on many short arrays. Before timing
+ anything it checks the array's behavior and exits with 1 if a
+ check fails.
+ */
+
+#include "bench.h"
+#include "../examples/array.h"
+
+#define ARRAY_COUNT (1 << 24)
+#define SMALL_ARRAYS 1024
+#define SMALL_ROUNDS 1024
+
+typedef struct VoidVector
+{
+    void *data;
+    u64 count;
+    u64 capacity;
+    u64 element_size;
+} VoidVector;
+
+/* kept out of line like a vector library in its own translation unit */
+internal __attribute__((noinline)) b32
+VoidVectorPush(VoidVector *vector, void *element)
+{
+    if (vector->count == vector->capacity)
+    {
+        u64 capacity = vector->capacity ? 2 * vector->capacity : 8;
+        void *data = realloc(vector->data, capacity * vector->element_size);
+        if (!data)
+        {
+            return 0;
+        }
+        
+        vector->data = data;
+        vector->capacity = capacity;
+    }
+    
+    memcpy((u8 *)vector->data + vector->count * vector->element_size,
+           element, vector->element_size);
+    ++vector->count;
+    return 1;
+}
+
+internal __attribute__((noinline)) void *
+VoidVectorGet(VoidVector *vector, u64 index)
+{
+    return (u8 *)vector->data + index * vector->element_size;
+}
+
+global u32 check_failures;
+
+#define ARRAY_CHECK(condition) \
+    ((condition) ? (void)0 : \
+     (printf("  check failed, line %d: %s\n", __LINE__, #condition), \
+      (void)++check_failures))
+
+/* the elements must be 0, 1, 2, ... count - 1 */
+#define ARRAY_CHECK_SEQUENCE(array, expected_count) \
+    do \
+    { \
+        ARRAY_CHECK((array)->count == (expected_count)); \
+        for (u64 i_ = 0; i_ < (array)->count; ++i_) \
+        { \
+            ARRAY_CHECK((array)->items[i_] == i_); \
+        } \
+    } while (0)
+
+/* counts what goes through the alloc and release hooks */
+typedef struct CountingAllocator
+{
+    u32 allocs;
+    u32 releases;
+    u64 live_bytes;
+} CountingAllocator;
+
+internal void *
+CountingAlloc(void *context, u64 size)
+{
+    CountingAllocator *allocator = context;
+    ++allocator->allocs;
+    allocator->live_bytes += size;
+    return malloc(size);
+}
+
+internal void
+CountingRelease(void *context, void *memory, u64 size)
+{
+    CountingAllocator *allocator = context;
+    ++allocator->releases;
+    allocator->live_bytes -= size;
+    free(memory);
+}
+
+internal void
+CheckReserve()
+{
+    Array_U32 array = {0};
+    
+    ARRAY_CHECK(Array_U32_reserve(&array, 1) && array.capacity == 8);
+    ARRAY_CHECK(Array_U32_reserve(&array, 9) && array.capacity == 16);
+    ARRAY_CHECK(Array_U32_reserve(&array, 100) && array.capacity == 100);
+    ARRAY_CHECK(Array_U32_reserve(&array, 50) && array.capacity == 100);
+    ARRAY_CHECK(array.count == 0);
+    
+    for (u32 i = 0; i < 1000; ++i)
+    {
+        Array_U32_push(&array, i);
+    }
+    ARRAY_CHECK(array.capacity >= 1000 && array.capacity < 2000);
+    ARRAY_CHECK_SEQUENCE(&array, 1000);
+    ARRAY_CHECK(Array_U32_pop(&array) == 999 && array.count == 999);
+    
+    Array_U32_free(&array);
+    ARRAY_CHECK(array.items == 0 && array.capacity == 0);
+}
+
+internal void
+CheckInlineToHeap()
+{
+    CountingAllocator allocator = {0};
+    Small_Array_U32 array = {0};
+    array.alloc = CountingAlloc;
+    array.release = CountingRelease;
+    array.context = &allocator;
+    
+    for (u32 i = 0; i < 8; ++i)
+    {
+        Small_Array_U32_push(&array, i);
+    }
+    ARRAY_CHECK(Small_Array_U32_is_inline(&array));
+    ARRAY_CHECK(array.capacity == 8 && allocator.allocs == 0);
+    ARRAY_CHECK_SEQUENCE(&array, 8);
+    
+    Small_Array_U32_push(&array, 8);
+    ARRAY_CHECK(!Small_Array_U32_is_inline(&array));
+    ARRAY_CHECK(array.capacity == 16 && allocator.allocs == 1);
+    ARRAY_CHECK(allocator.releases == 0);
+    ARRAY_CHECK_SEQUENCE(&array, 9);
+    
+    for (u32 i = 9; i < 40; ++i)
+    {
+        Small_Array_U32_push(&array, i);
+    }
+    ARRAY_CHECK(allocator.allocs == 3 && allocator.releases == 2);
+    ARRAY_CHECK(allocator.live_bytes == array.capacity * sizeof(u32));
+    ARRAY_CHECK_SEQUENCE(&array, 40);
+    
+    Small_Array_U32_free(&array);
+    ARRAY_CHECK(allocator.releases == 3 && allocator.live_bytes == 0);
+    
+    /* a freed inline array starts over in its inline buffer */
+    Small_Array_U32_push(&array, 0);
+    ARRAY_CHECK(Small_Array_U32_is_inline(&array) && allocator.allocs == 3);
+    Small_Array_U32_free(&array);
+}
+
+internal void
+CheckInsertRemove()
+{
+    Array_U32 array = {0};
+    u32 values[] = { 2, 3, 4, 5, 6, 7, 8, 9 };
+    u32 ends[] = { 0, 1, 10, 11 };
+    
+    /* middle, front and back */
+    Array_U32_insert(&array, 0, values, 2);
+    Array_U32_insert(&array, 2, values + 6, 2);
+    Array_U32_insert(&array, 2, values + 2, 4);
+    Array_U32_insert(&array, 0, ends, 2);
+    Array_U32_insert(&array, array.count, ends + 2, 2);
+    ARRAY_CHECK_SEQUENCE(&array, 12);
+    
+    Array_U32_remove(&array, 0, 2);
+    Array_U32_remove(&array, 8, 2);
+    Array_U32_remove(&array, 3, 3);
+    u32 expected[] = { 2, 3, 4, 8, 9 };
+    ARRAY_CHECK(array.count == 5);
+    ARRAY_CHECK(memcmp(array.items, expected, sizeof(expected)) == 0);
+    
+    Array_U32_remove(&array, 0, array.count);
+    ARRAY_CHECK(array.count == 0);
+    Array_U32_free(&array);
+}
+
+/* values taken from the array itself while it grows */
+internal void
+CheckAliasing()
+{
+    Array_U32 array = {0};
+    
+    for (u32 i = 0; i < 8; ++i)
+    {
+        Array_U32_push(&array, i);
+    }
+    ARRAY_CHECK(array.count == array.capacity);
+    
+    Array_U32_append(&array, array.items, 8);
+    ARRAY_CHECK(array.count == 16);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        ARRAY_CHECK(array.items[i] == i % 8);
+    }
+    
+    /* the inserted values straddle the insert position */
+    Array_U32_clear(&array);
+    for (u32 i = 0; i < 16; ++i)
+    {
+        Array_U32_push(&array, i);
+    }
+    Array_U32_insert(&array, 4, array.items + 2, 4);
+    u32 expected[] = { 0, 1, 2, 3, 2, 3, 4, 5, 4, 5, 6, 7 };
+    ARRAY_CHECK(array.count == 20);
+    ARRAY_CHECK(memcmp(array.items, expected, sizeof(expected)) == 0);
+    
+    Array_U32_free(&array);
+}
+
+internal void
+BenchVoidVector()
+{
+    VoidVector vector = {0, 0, 0, sizeof(u32)};
+    
+    f64 start = BenchTime();
+    for (u32 i = 0; i < ARRAY_COUNT; ++i)
+    {
+        VoidVectorPush(&vector, &i);
+    }
+    BenchReport("void * vector push", BenchTime() - start, ARRAY_COUNT);
+    
+    start = BenchTime();
+    u64 sum = 0;
+    for (u64 i = 0; i < vector.count; ++i)
+    {
+        sum += *(u32 *)VoidVectorGet(&vector, i);
+    }
+    BenchSink(sum);
+    BenchReport("void * vector iterate", BenchTime() - start, ARRAY_COUNT);
+    
+    free(vector.data);
+}
+
+internal void
+BenchDynamicArray()
+{
+    Array_U32 array = {0};
+    
+    f64 start = BenchTime();
+    for (u32 i = 0; i < ARRAY_COUNT; ++i)
+    {
+        Array_U32_push(&array, i);
+    }
+    BenchReport("Dynamic_Array push", BenchTime() - start, ARRAY_COUNT);
+    
+    start = BenchTime();
+    u64 sum = 0;
+    Array_U32_for_each(value, &array)
+    {
+        sum += *value;
+    }
+    BenchSink(sum);
+    BenchReport("Dynamic_Array iterate", BenchTime() - start, ARRAY_COUNT);
+    
+    Array_U32 copy = {0};
+    start = BenchTime();
+    Array_U32_append(&copy, array.items, array.count);
+    BenchReport("Dynamic_Array append", BenchTime() - start, ARRAY_COUNT);
+    
+    Array_U32_free(&copy);
+    Array_U32_free(&array);
+}
+
+/* fills many arrays of 6 elements each, the size most arrays have in practice */
+internal void
+BenchSmallArrays()
+{
+    Array_U32 *arrays = calloc(SMALL_ARRAYS, sizeof(*arrays));
+    
+    f64 start = BenchTime();
+    for (u32 round = 0; round < SMALL_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < SMALL_ARRAYS; ++i)
+        {
+            for (u32 j = 0; j < 6; ++j)
+            {
+                Array_U32_push(&arrays[i], j);
+            }
+            BenchSink(arrays[i].items[i % 6]);
+            Array_U32_free(&arrays[i]);
+        }
+    }
+    BenchReport("6 elements, heap", BenchTime() - start,
+                SMALL_ARRAYS * SMALL_ROUNDS);
+    free(arrays);
+    
+    Small_Array_U32 *small_arrays = calloc(SMALL_ARRAYS, sizeof(*small_arrays));
+    
+    start = BenchTime();
+    for (u32 round = 0; round < SMALL_ROUNDS; ++round)
+    {
+        for (u32 i = 0; i < SMALL_ARRAYS; ++i)
+        {
+            for (u32 j = 0; j < 6; ++j)
+            {
+                Small_Array_U32_push(&small_arrays[i], j);
+            }
+            BenchSink(small_arrays[i].items[i % 6]);
+            Small_Array_U32_free(&small_arrays[i]);
+        }
+    }
+    BenchReport("6 elements, inline buffer", BenchTime() - start,
+                SMALL_ARRAYS * SMALL_ROUNDS);
+    free(small_arrays);
+}
+
+int
+main()
+{
+    CheckReserve();
+    CheckInlineToHeap();
+    CheckInsertRemove();
+    CheckAliasing();
+    if (check_failures > 0)
+    {
+        return 1;
+    }
+    
+    printf("%d u32 elements\n", ARRAY_COUNT);
+    BenchVoidVector();
+    BenchDynamicArray();
+    
+    printf("%d short arrays x %d rounds\n", SMALL_ARRAYS, SMALL_ROUNDS);
+    BenchSmallArrays();
+    
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef GEN_BENCH_H
+#define GEN_BENCH_H
+
+/*
+ Shared helpers for the microbenchmarks in bench/. Each benchmark
+ includes the header generated from its .gs file next to it, or the
+ example header of the template it measures.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../code/layer.h"
+
+internal f64
+BenchTime()
+{
+    struct timespec time_spec;
+    clock_gettime(CLOCK_MONOTONIC, &time_spec);
+    
+    return time_spec.tv_sec + time_spec.tv_nsec / 1000000000.0;
+}
+
+/* keeps the compiler from dropping a result that is never used */
+global volatile u64 bench_sink;
+
+#define BenchSink(value) (bench_sink += (u64)(value))
+
+/* xorshift, so runs are repeatable and cheap */
+internal inline u64
+BenchRandom(u64 *state)
+{
+    u64 x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    
+    return x;
+}
+
+/* prints one result line: name, total time and time per operation */
+internal inline void
+BenchReport(char *name, f64 seconds, u64 operations)
+{
+    printf("  %-28s %9.3f ms %9.2f ns/op\n", name, seconds * 1000.0,
+           seconds * 1000000000.0 / operations);
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ Compares the generated Bitset from examples/bitset.gs with the
+ hand-rolled kind: a u64 array whose length is only known at run
+ time, combined and counted one word at a time.
+ */
+
+#include "bench.h"
+#include "../examples/bitset.h"
+
+#define BITSET_ROUNDS 4000000
+#define BITSET_SETS 64
+
+internal __attribute__((noinline)) void
+WordsAnd(u64 *out, u64 *a, u64 *b, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        out[i] = a[i] & b[i];
+    }
+}
+
+internal __attribute__((noinline)) u64
+WordsCount(u64 *words, u64 count)
+{
+    u64 total = 0;
+    for (u64 i = 0; i < count; ++i)
+    {
+        for (u64 word = words[i]; word; word &= word - 1)
+        {
+            ++total;
+        }
+    }
+    return total;
+}
+
+internal __attribute__((noinline)) u64
+WordsSumBits(u64 *words, u64 bit_num)
+{
+    u64 sum = 0;
+    for (u64 bit = 0; bit < bit_num; ++bit)
+    {
+        if ((words[bit / 64] >> (bit % 64)) & 1)
+        {
+            sum += bit;
+        }
+    }
+    return sum;
+}
+
+int
+main()
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    Bitset_1000 *sets = malloc(BITSET_SETS * sizeof(Bitset_1000));
+    
+    for (u32 i = 0; i < BITSET_SETS; ++i)
+    {
+        Bitset_1000_clear_all(&sets[i]);
+        for (u32 j = 0; j < 300; ++j)
+        {
+            Bitset_1000_set(&sets[i], (u32)(BenchRandom(&random_state) % 1000));
+        }
+    }
+    
+    u64 word_num = sizeof(sets[0].words) / sizeof(u64);
+    printf("1000-bit sets, %d rounds\n", BITSET_ROUNDS);
+    
+    {
+        Bitset_1000 out;
+        f64 start = BenchTime();
+        for (u32 i = 0; i < BITSET_ROUNDS; ++i)
+        {
+            Bitset_1000 *a = &sets[i % BITSET_SETS];
+            Bitset_1000 *b = &sets[(i * 7 + 1) % BITSET_SETS];
+            WordsAnd(out.words, a->words, b->words, word_num);
+            BenchSink(WordsCount(out.words, word_num));
+        }
+        BenchReport("u64 array, and + count", BenchTime() - start, BITSET_ROUNDS);
+    }
+    
+    {
+        Bitset_1000 out;
+        f64 start = BenchTime();
+        for (u32 i = 0; i < BITSET_ROUNDS; ++i)
+        {
+            Bitset_1000 *a = &sets[i % BITSET_SETS];
+            Bitset_1000 *b = &sets[(i * 7 + 1) % BITSET_SETS];
+            Bitset_1000_and(&out, a, b);
+            BenchSink(Bitset_1000_count(&out));
+        }
+        BenchReport("Bitset, and + count", BenchTime() - start, BITSET_ROUNDS);
+    }
+    
+    {
+        Bitset_1000 out;
+        f64 start = BenchTime();
+        for (u32 i = 0; i < BITSET_ROUNDS; ++i)
+        {
+            Bitset_1000 *a = &sets[i % BITSET_SETS];
+            Bitset_1000 *b = &sets[(i * 7 + 1) % BITSET_SETS];
+            Bitset_1000_andnot(&out, a, b);
+            Bitset_1000_xor(&out, &out, b);
+            BenchSink(out.words[i % word_num]);
+        }
+        BenchReport("Bitset, andnot + xor", BenchTime() - start, BITSET_ROUNDS);
+    }
+    
+    u32 scan_rounds = BITSET_ROUNDS / 100;
+    
+    {
+        f64 start = BenchTime();
+        for (u32 i = 0; i < scan_rounds; ++i)
+        {
+            BenchSink(WordsSumBits(sets[i % BITSET_SETS].words, 1000));
+        }
+        BenchReport("u64 array, test every bit", BenchTime() - start, scan_rounds);
+    }
+    
+    {
+        f64 start = BenchTime();
+        for (u32 i = 0; i < scan_rounds; ++i)
+        {
+            u64 sum = 0;
+            Bitset_1000_for_each(bit, &sets[i % BITSET_SETS])
+            {
+                sum += bit;
+            }
+            BenchSink(sum);
+        }
+        BenchReport("Bitset, for_each", BenchTime() - start, scan_rounds);
+    }
+    
+    free(sets);
+    return 0;
+}
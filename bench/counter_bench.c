@@ -0,0 +1,125 @@
+/*
+ Counts with 1 to 64 threads into the generated Sharded_Counter from
+ examples/counter.gs, into one shared atomic, and into an array of
+ per-thread atomics without padding, where neighbours share a cache
+ line. The time is for the whole run, so with enough cores a counter
+ that scales keeps its ns/op falling as threads are added.
+ */
+
+#include "bench.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../examples/counter.h"
+
+#define COUNTER_INCREMENTS (1 << 24)
+#define COUNTER_MAX_THREADS 64
+
+global _Atomic u64 shared_counter;
+global _Atomic u64 unpadded_counters[COUNTER_MAX_THREADS];
+global Counter_U64 sharded_counter;
+
+global u64 increments_per_thread;
+
+internal void *
+SharedCounterThread(void *unused)
+{
+    (void)unused;
+    for (u64 i = 0; i < increments_per_thread; ++i)
+    {
+        atomic_fetch_add_explicit(&shared_counter, 1, memory_order_relaxed);
+    }
+    return 0;
+}
+
+internal void *
+UnpaddedCounterThread(void *index)
+{
+    _Atomic u64 *counter = &unpadded_counters[(u64)index];
+    for (u64 i = 0; i < increments_per_thread; ++i)
+    {
+        atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+    }
+    return 0;
+}
+
+internal void *
+ShardedCounterThread(void *unused)
+{
+    (void)unused;
+    for (u64 i = 0; i < increments_per_thread; ++i)
+    {
+        Counter_U64_increment(&sharded_counter);
+    }
+    return 0;
+}
+
+internal u64
+UnpaddedTotal()
+{
+    u64 total = 0;
+    for (u32 i = 0; i < COUNTER_MAX_THREADS; ++i)
+    {
+        total += atomic_exchange(&unpadded_counters[i], 0);
+    }
+    return total;
+}
+
+internal void
+RunCounterBench(char *name, u32 thread_num, void *(*thread)(void *), u64 (*total)())
+{
+    pthread_t threads[COUNTER_MAX_THREADS];
+    
+    increments_per_thread = COUNTER_INCREMENTS / thread_num;
+    
+    f64 start = BenchTime();
+    for (u64 i = 0; i < thread_num; ++i)
+    {
+        pthread_create(&threads[i], 0, thread, (void *)i);
+    }
+    for (u32 i = 0; i < thread_num; ++i)
+    {
+        pthread_join(threads[i], 0);
+    }
+    f64 seconds = BenchTime() - start;
+    
+    if (total() != COUNTER_INCREMENTS)
+    {
+        printf("  %s: wrong total\n", name);
+    }
+    
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %u", name, thread_num);
+    BenchReport(label, seconds, COUNTER_INCREMENTS);
+}
+
+internal u64
+SharedTotal()
+{
+    return atomic_exchange(&shared_counter, 0);
+}
+
+internal u64
+ShardedTotal()
+{
+    u64 total = Counter_U64_total(&sharded_counter);
+    Counter_U64_reset(&sharded_counter);
+    return total;
+}
+
+int
+main()
+{
+    printf("%d increments split over 1 to %d threads\n", COUNTER_INCREMENTS,
+           COUNTER_MAX_THREADS);
+    
+    Counter_U64_init(&sharded_counter);
+    
+    for (u32 thread_num = 1; thread_num <= COUNTER_MAX_THREADS; thread_num *= 2)
+    {
+        RunCounterBench("shared atomic", thread_num, SharedCounterThread, SharedTotal);
+        RunCounterBench("unpadded per thread", thread_num, UnpaddedCounterThread, UnpaddedTotal);
+        RunCounterBench("Sharded_Counter", thread_num, ShardedCounterThread, ShardedTotal);
+    }
+    
+    return 0;
+}
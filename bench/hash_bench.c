@@ -0,0 +1,208 @@
+/*
+ Hashes and compares arrays of the keys in examples/hash.gs with the
+ functions generated by @hash and with the usual hand-written kind:
+ a table of field offsets and sizes walked at run time, each field
+ hashed a byte at a time with FNV-1a and compared with its own memcmp.
+ */
+
+#include "bench.h"
+#include "../examples/hash.h"
+
+#define HASH_KEYS (1 << 20)
+#define HASH_ROUNDS 20
+
+typedef struct FieldDescriptor
+{
+    u64 offset;
+    u64 size;
+} FieldDescriptor;
+
+typedef struct TypeDescriptor
+{
+    FieldDescriptor *fields;
+    u32 field_num;
+    u64 size;
+} TypeDescriptor;
+
+global FieldDescriptor vec3f_fields[] =
+{
+    {offsetof(Vec3f, x), 4},
+    {offsetof(Vec3f, y), 4},
+    {offsetof(Vec3f, z), 4},
+};
+
+global FieldDescriptor cell_key_fields[] =
+{
+    {offsetof(Cell_Key_S32, layer), 1},
+    {offsetof(Cell_Key_S32, x), 4},
+    {offsetof(Cell_Key_S32, y), 4},
+    {offsetof(Cell_Key_S32, flags), 2},
+};
+
+#define EDGE_CELL_FIELDS(cell) \
+    {offsetof(Edge_Key_S32, cell) + offsetof(Cell_Key_S32, layer), 1}, \
+    {offsetof(Edge_Key_S32, cell) + offsetof(Cell_Key_S32, x), 4}, \
+    {offsetof(Edge_Key_S32, cell) + offsetof(Cell_Key_S32, y), 4}, \
+    {offsetof(Edge_Key_S32, cell) + offsetof(Cell_Key_S32, flags), 2}
+
+global FieldDescriptor edge_key_fields[] =
+{
+    EDGE_CELL_FIELDS(from),
+    EDGE_CELL_FIELDS(to),
+    {offsetof(Edge_Key_S32, offset) + offsetof(Vec3_s32, x), 4},
+    {offsetof(Edge_Key_S32, offset) + offsetof(Vec3_s32, y), 4},
+    {offsetof(Edge_Key_S32, offset) + offsetof(Vec3_s32, z), 4},
+    {offsetof(Edge_Key_S32, cost), 4},
+};
+
+__attribute__((noinline)) internal u64
+GenericHash(TypeDescriptor *type, void *value)
+{
+    u64 hash = 0xcbf29ce484222325ull;
+    
+    for (u32 i = 0; i < type->field_num; ++i)
+    {
+        u8 *bytes = (u8 *)value + type->fields[i].offset;
+        for (u64 j = 0; j < type->fields[i].size; ++j)
+        {
+            hash = (hash ^ bytes[j]) * 0x100000001b3ull;
+        }
+    }
+    
+    return hash;
+}
+
+__attribute__((noinline)) internal b32
+GenericEqual(TypeDescriptor *type, void *a, void *b)
+{
+    for (u32 i = 0; i < type->field_num; ++i)
+    {
+        FieldDescriptor *field = &type->fields[i];
+        if (memcmp((u8 *)a + field->offset, (u8 *)b + field->offset, field->size) != 0)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/* keys with random fields and garbage in the padding */
+internal void
+FillVec3f(Vec3f *keys, u64 count, u64 *random_state)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        keys[i] = (Vec3f){(f32)(BenchRandom(random_state) % 1000),
+                          (f32)(BenchRandom(random_state) % 1000), (f32)i};
+    }
+}
+
+internal void
+FillCell_Key_S32(Cell_Key_S32 *keys, u64 count, u64 *random_state)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        memset(&keys[i], (u8)BenchRandom(random_state), sizeof(keys[i]));
+        keys[i].layer = (u8)(i % 4);
+        keys[i].x = (s32)(BenchRandom(random_state) % 1000);
+        keys[i].y = (s32)i;
+        keys[i].flags = 1;
+    }
+}
+
+internal void
+FillEdge_Key_S32(Edge_Key_S32 *keys, u64 count, u64 *random_state)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        memset(&keys[i], (u8)BenchRandom(random_state), sizeof(keys[i]));
+        FillCell_Key_S32(&keys[i].from, 1, random_state);
+        FillCell_Key_S32(&keys[i].to, 1, random_state);
+        keys[i].offset = (Vec3_s32){1, 2, (s32)i};
+        keys[i].cost = (u32)BenchRandom(random_state);
+    }
+}
+
+/*
+ Hashes every key, then compares every key with a copy of itself,
+ which is the expensive case for equality since nothing differs
+ */
+#define BENCH_TYPE(Type, descriptor) \
+    do \
+    { \
+        Type *keys = malloc(HASH_KEYS * sizeof(Type)); \
+        Type *copies = malloc(HASH_KEYS * sizeof(Type)); \
+        Fill##Type(keys, HASH_KEYS, &random_state); \
+        memcpy(copies, keys, HASH_KEYS * sizeof(Type)); \
+        \
+        printf("%s: %d keys, %zu bytes\n", #Type, HASH_KEYS, sizeof(Type)); \
+        \
+        f64 start = BenchTime(); \
+        for (u32 round = 0; round < HASH_ROUNDS; ++round) \
+        { \
+            for (u32 i = 0; i < HASH_KEYS; ++i) \
+            { \
+                BenchSink(GenericHash(&descriptor, &keys[i])); \
+            } \
+        } \
+        BenchReport("generic hash", BenchTime() - start, \
+                    (u64)HASH_KEYS * HASH_ROUNDS); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < HASH_ROUNDS; ++round) \
+        { \
+            for (u32 i = 0; i < HASH_KEYS; ++i) \
+            { \
+                BenchSink(Hash_##Type(&keys[i])); \
+            } \
+        } \
+        BenchReport("Hash_" #Type, BenchTime() - start, \
+                    (u64)HASH_KEYS * HASH_ROUNDS); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < HASH_ROUNDS; ++round) \
+        { \
+            for (u32 i = 0; i < HASH_KEYS; ++i) \
+            { \
+                BenchSink(GenericEqual(&descriptor, &keys[i], &copies[i])); \
+            } \
+        } \
+        BenchReport("generic equal", BenchTime() - start, \
+                    (u64)HASH_KEYS * HASH_ROUNDS); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < HASH_ROUNDS; ++round) \
+        { \
+            for (u32 i = 0; i < HASH_KEYS; ++i) \
+            { \
+                BenchSink(Equal_##Type(&keys[i], &copies[i])); \
+            } \
+        } \
+        BenchReport("Equal_" #Type, BenchTime() - start, \
+                    (u64)HASH_KEYS * HASH_ROUNDS); \
+        \
+        free(copies); \
+        free(keys); \
+    } while (0)
+
+int
+main()
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    
+    TypeDescriptor vec3f_type =
+        {vec3f_fields, sizeof(vec3f_fields) / sizeof(vec3f_fields[0]), sizeof(Vec3f)};
+    TypeDescriptor cell_key_type =
+        {cell_key_fields, sizeof(cell_key_fields) / sizeof(cell_key_fields[0]),
+         sizeof(Cell_Key_S32)};
+    TypeDescriptor edge_key_type =
+        {edge_key_fields, sizeof(edge_key_fields) / sizeof(edge_key_fields[0]),
+         sizeof(Edge_Key_S32)};
+    
+    BENCH_TYPE(Vec3f, vec3f_type);
+    BENCH_TYPE(Cell_Key_S32, cell_key_type);
+    BENCH_TYPE(Edge_Key_S32, edge_key_type);
+    
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ Compares the generated Hash_Map from examples/hash_map.gs with a
+ chained map over void * keys and values that calls its hash and
+ compare functions through pointers, as generic C maps do.
+ */
+
+#include "bench.h"
+#include "../examples/hash_map.h"
+
+typedef struct ChainNode ChainNode;
+struct ChainNode
+{
+    ChainNode *next;
+    u64 hash;
+    /* key_size bytes of key followed by value_size bytes of value */
+    u8 data[];
+};
+
+typedef struct ChainMap
+{
+    ChainNode **buckets;
+    u64 bucket_num;
+    u64 count;
+    u64 key_size;
+    u64 value_size;
+    u64 (*hash)(void *key);
+    b32 (*equal)(void *a, void *b);
+} ChainMap;
+
+internal ChainMap
+ChainMapCreate(u64 key_size, u64 value_size,
+               u64 (*hash)(void *key), b32 (*equal)(void *a, void *b))
+{
+    ChainMap map = {0};
+    map.bucket_num = 16;
+    map.buckets = calloc(map.bucket_num, sizeof(*map.buckets));
+    map.key_size = key_size;
+    map.value_size = value_size;
+    map.hash = hash;
+    map.equal = equal;
+    
+    return map;
+}
+
+internal void *
+ChainMapFind(ChainMap *map, void *key)
+{
+    u64 hash = map->hash(key);
+    
+    for (ChainNode *node = map->buckets[hash & (map->bucket_num - 1)];
+         node;
+         node = node->next)
+    {
+        if (node->hash == hash && map->equal(node->data, key))
+        {
+            return node->data + map->key_size;
+        }
+    }
+    
+    return 0;
+}
+
+internal void
+ChainMapInsert(ChainMap *map, void *key, void *value)
+{
+    void *existing = ChainMapFind(map, key);
+    if (existing)
+    {
+        memcpy(existing, value, map->value_size);
+        return;
+    }
+    
+    if (map->count >= map->bucket_num)
+    {
+        u64 bucket_num = map->bucket_num * 2;
+        ChainNode **buckets = calloc(bucket_num, sizeof(*buckets));
+        
+        for (u64 i = 0; i < map->bucket_num; ++i)
+        {
+            for (ChainNode *node = map->buckets[i]; node;)
+            {
+                ChainNode *next = node->next;
+                node->next = buckets[node->hash & (bucket_num - 1)];
+                buckets[node->hash & (bucket_num - 1)] = node;
+                node = next;
+            }
+        }
+        
+        free(map->buckets);
+        map->buckets = buckets;
+        map->bucket_num = bucket_num;
+    }
+    
+    ChainNode *node = malloc(sizeof(*node) + map->key_size + map->value_size);
+    node->hash = map->hash(key);
+    memcpy(node->data, key, map->key_size);
+    memcpy(node->data + map->key_size, value, map->value_size);
+    
+    ChainNode **bucket = &map->buckets[node->hash & (map->bucket_num - 1)];
+    node->next = *bucket;
+    *bucket = node;
+    ++map->count;
+}
+
+internal b32
+ChainMapRemove(ChainMap *map, void *key)
+{
+    u64 hash = map->hash(key);
+    
+    for (ChainNode **at = &map->buckets[hash & (map->bucket_num - 1)];
+         *at;
+         at = &(*at)->next)
+    {
+        if ((*at)->hash == hash && map->equal((*at)->data, key))
+        {
+            ChainNode *node = *at;
+            *at = node->next;
+            free(node);
+            --map->count;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+internal void
+ChainMapFree(ChainMap *map)
+{
+    for (u64 i = 0; i < map->bucket_num; ++i)
+    {
+        for (ChainNode *node = map->buckets[i]; node;)
+        {
+            ChainNode *next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+    free(map->buckets);
+}
+
+internal u64
+HashU64(void *key)
+{
+    return Map_U64_hash(*(u64 *)key);
+}
+
+internal b32
+EqualU64(void *a, void *b)
+{
+    return *(u64 *)a == *(u64 *)b;
+}
+
+/* count random keys, then as many lookups that hit, that miss and removes */
+internal void
+BenchMaps(u64 count)
+{
+    u64 *keys = malloc(sizeof(*keys) * count);
+    u64 random_state = 0x2545F4914F6CDD1Dull;
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        /* odd keys are in the map, even ones miss */
+        keys[i] = BenchRandom(&random_state) | 1;
+    }
+    
+    printf("%llu u64 -> u64 entries\n", (unsigned long long)count);
+    
+    {
+        ChainMap map = ChainMapCreate(sizeof(u64), sizeof(u64), HashU64, EqualU64);
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            ChainMapInsert(&map, &keys[i], &i);
+        }
+        BenchReport("chained void * insert", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(*(u64 *)ChainMapFind(&map, &keys[i]));
+        }
+        BenchReport("chained void * find hit", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 key = keys[i] - 1;
+            BenchSink(ChainMapFind(&map, &key) != 0);
+        }
+        BenchReport("chained void * find miss", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(ChainMapRemove(&map, &keys[i]));
+        }
+        BenchReport("chained void * remove", BenchTime() - start, count);
+        
+        ChainMapFree(&map);
+    }
+    
+    {
+        Map_U64 map = {0};
+        Map_U64_reset_counters();
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            Map_U64_insert(&map, keys[i], i);
+        }
+        BenchReport("Hash_Map insert", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(*Map_U64_find(&map, keys[i]));
+        }
+        BenchReport("Hash_Map find hit", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(Map_U64_find(&map, keys[i] - 1) != 0);
+        }
+        BenchReport("Hash_Map find miss", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(Map_U64_remove(&map, keys[i]));
+        }
+        BenchReport("Hash_Map remove", BenchTime() - start, count);
+        
+        /* probe counts when built with BENCH_FLAGS=-DGEN_INSTRUMENT */
+        Map_U64_dump_counters(stdout);
+        Map_U64_free(&map);
+    }
+    
+    free(keys);
+}
+
+int
+main()
+{
+    BenchMaps(10000);
+    BenchMaps(4000000);
+    
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ Compares the generated Heap from examples/heap.gs, 4-ary and binary,
+ with a binary heap of void * elements ordered through a comparator
+ callback, on an event queue of Event_F64 records.
+ */
+
+#include "bench.h"
+#include "../examples/heap.h"
+
+#define HEAP_OPERATIONS 4000000
+
+typedef struct VoidHeap
+{
+    void **items;
+    u64 count;
+    u64 capacity;
+    int (*compare)(void *a, void *b);
+} VoidHeap;
+
+internal __attribute__((noinline)) void
+VoidHeapPush(VoidHeap *heap, void *item)
+{
+    if (heap->count == heap->capacity)
+    {
+        heap->capacity = heap->capacity ? 2 * heap->capacity : 64;
+        heap->items = realloc(heap->items, heap->capacity * sizeof(void *));
+    }
+    
+    u64 index = heap->count++;
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / 2;
+        if (heap->compare(item, heap->items[parent]) >= 0)
+        {
+            break;
+        }
+        heap->items[index] = heap->items[parent];
+        index = parent;
+    }
+    heap->items[index] = item;
+}
+
+internal __attribute__((noinline)) void *
+VoidHeapPop(VoidHeap *heap)
+{
+    void *top = heap->items[0];
+    void *item = heap->items[--heap->count];
+    u64 index = 0;
+    
+    for (;;)
+    {
+        u64 child = 2 * index + 1;
+        if (child >= heap->count)
+        {
+            break;
+        }
+        if (child + 1 < heap->count &&
+            heap->compare(heap->items[child + 1], heap->items[child]) < 0)
+        {
+            ++child;
+        }
+        if (heap->compare(heap->items[child], item) >= 0)
+        {
+            break;
+        }
+        heap->items[index] = heap->items[child];
+        index = child;
+    }
+    heap->items[index] = item;
+    
+    return top;
+}
+
+internal int
+CompareEvents(void *a, void *b)
+{
+    f64 x = ((Event_F64 *)a)->time;
+    f64 y = ((Event_F64 *)b)->time;
+    return (x > y) - (x < y);
+}
+
+/*
+ The hold model of a discrete event simulation: the heap keeps size
+ events, and each step pops the earliest and schedules it again a
+ random time later.
+ */
+internal void
+BenchHold(u64 size)
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    Event_F64 *events = malloc(size * sizeof(Event_F64));
+    
+    for (u64 i = 0; i < size; ++i)
+    {
+        events[i].time = (f64)(BenchRandom(&random_state) % 1000000);
+        events[i].id = (u32)i;
+    }
+    
+    printf("hold model, %llu events\n", (unsigned long long)size);
+    
+    {
+        VoidHeap heap = {0, 0, 0, CompareEvents};
+        for (u64 i = 0; i < size; ++i)
+        {
+            VoidHeapPush(&heap, &events[i]);
+        }
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < HEAP_OPERATIONS; ++i)
+        {
+            Event_F64 *event = VoidHeapPop(&heap);
+            event->time += (f64)(BenchRandom(&random_state) % 1000000);
+            VoidHeapPush(&heap, event);
+        }
+        BenchReport("void * binary, callback", BenchTime() - start, HEAP_OPERATIONS);
+        free(heap.items);
+    }
+    
+    {
+        Event_Queue_Binary heap = {0};
+        Event_Queue_Binary_heapify(&heap, events, size);
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < HEAP_OPERATIONS; ++i)
+        {
+            Event_F64 event;
+            if (!Event_Queue_Binary_pop(&heap, &event))
+            {
+                break;
+            }
+            event.time += (f64)(BenchRandom(&random_state) % 1000000);
+            Event_Queue_Binary_push(&heap, event);
+        }
+        BenchReport("Heap, 2-ary", BenchTime() - start, HEAP_OPERATIONS);
+        Event_Queue_Binary_free(&heap);
+    }
+    
+    {
+        Event_Queue heap = {0};
+        Event_Queue_heapify(&heap, events, size);
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < HEAP_OPERATIONS; ++i)
+        {
+            Event_F64 event;
+            if (!Event_Queue_pop(&heap, &event))
+            {
+                break;
+            }
+            event.time += (f64)(BenchRandom(&random_state) % 1000000);
+            Event_Queue_push(&heap, event);
+        }
+        BenchReport("Heap, 4-ary", BenchTime() - start, HEAP_OPERATIONS);
+        Event_Queue_free(&heap);
+    }
+    
+    {
+        Event_Queue heap = {0};
+        
+        f64 start = BenchTime();
+        Event_Queue_heapify(&heap, events, size);
+        BenchReport("Heap, 4-ary heapify", BenchTime() - start, size);
+        Event_Queue_free(&heap);
+    }
+    
+    free(events);
+}
+
+/* decrease-key through handles, as in Dijkstra's algorithm */
+internal void
+BenchDecreaseKey(u64 size)
+{
+    u64 random_state = 0x2545F4914F6CDD1Dull;
+    u64 *keys = malloc(size * sizeof(u64));
+    
+    for (u64 i = 0; i < size; ++i)
+    {
+        keys[i] = (BenchRandom(&random_state) % 1000000) + 1000000;
+    }
+    
+    Heap_U64_Handles heap = {0};
+    Heap_U64_Handles_heapify(&heap, keys, size);
+    
+    f64 start = BenchTime();
+    for (u64 i = 0; i < HEAP_OPERATIONS; ++i)
+    {
+        u32 handle = (u32)(BenchRandom(&random_state) % size);
+        u64 key = heap.items[heap.positions[handle]];
+        Heap_U64_Handles_update(&heap, handle, key - key / 16);
+    }
+    BenchReport("Heap, 4-ary decrease-key", BenchTime() - start, HEAP_OPERATIONS);
+    
+    Heap_U64_Handles_free(&heap);
+    free(keys);
+}
+
+int
+main()
+{
+    BenchHold(1000);
+    BenchHold(1000000);
+    
+    printf("decrease-key, 1000000 keys\n");
+    BenchDecreaseKey(1000000);
+    
+    return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/sh
+# Compares the io_uring and stdio file paths on many small .gs files.
+# usage: bench/io_bench.sh [file_count] [rounds]
+
+FILE_COUNT=${1:-5000}
+ROUNDS=${2:-5}
+GEN=build/gen_struct.out
+BENCH_DIR=$(mktemp -d)
+
+i=0
+while [ $i -lt $FILE_COUNT ]; do
+    cp examples/struct.gs "$BENCH_DIR/file_$i.gs"
+    i=$((i + 1))
+done
+
+# warm the page cache and create the outputs so every round overwrites
+$GEN --stdio "$BENCH_DIR"/*.gs > /dev/null
+$GEN "$BENCH_DIR"/*.gs > /dev/null
+
+echo "$FILE_COUNT files, seconds per run"
+echo "stdio      io_uring"
+
+round=0
+while [ $round -lt $ROUNDS ]; do
+    stdio_time=$($GEN --stdio "$BENCH_DIR"/*.gs | tail -n 1 | awk '{ print $5 }')
+    uring_time=$($GEN "$BENCH_DIR"/*.gs | tail -n 1 | awk '{ print $5 }')
+    echo "$stdio_time   $uring_time"
+    round=$((round + 1))
+done
+
+rm -rf "$BENCH_DIR"
@@ -0,0 +1,162 @@
+/*
+ Compares the pooled Linked_List from examples/struct2.gs with
+ the same list built from one malloc per node, once on a fresh heap
+ and once on a heap churned by other allocations in between.
+ */
+
+#include "bench.h"
+#include "../examples/struct2.h"
+
+#define LIST_NODES (1 << 20)
+#define LIST_ROUNDS 8
+
+typedef struct ListTimes
+{
+    f64 push;
+    f64 iterate;
+    f64 pop;
+} ListTimes;
+
+internal void
+ReportListTimes(char *name, ListTimes *times)
+{
+    u64 operations = (u64)LIST_NODES * LIST_ROUNDS;
+    
+    printf("%s\n", name);
+    BenchReport("push", times->push, operations);
+    BenchReport("iterate", times->iterate, operations);
+    BenchReport("pop", times->pop, operations);
+}
+
+/*
+ One malloc per node. With churn every node is followed by a
+ short-lived block of random size, as happens when the list is built
+ by code that allocates other things too. Push
+ then includes the filler allocations.
+ */
+internal void
+BenchMallocList(b32 churn, ListTimes *times)
+{
+    void **fillers = malloc(sizeof(*fillers) * LIST_NODES);
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    
+    for (u32 round = 0; round < LIST_ROUNDS; ++round)
+    {
+        Linked_List_F32 *head = 0;
+        
+        f64 start = BenchTime();
+        for (u32 i = 0; i < LIST_NODES; ++i)
+        {
+            Linked_List_F32 *node = malloc(sizeof(*node));
+            head = Linked_List_F32_push(head, node, (f32)i);
+            
+            if (churn)
+            {
+                fillers[i] = malloc(16 + BenchRandom(&random_state) % 240);
+            }
+        }
+        times->push += BenchTime() - start;
+        
+        if (churn)
+        {
+            for (u32 i = 0; i < LIST_NODES; ++i)
+            {
+                free(fillers[i]);
+            }
+        }
+        
+        start = BenchTime();
+        f32 sum = 0;
+        Linked_List_F32_for_each(node, head)
+        {
+            sum += node->data;
+        }
+        BenchSink(sum);
+        times->iterate += BenchTime() - start;
+        
+        start = BenchTime();
+        while (head)
+        {
+            Linked_List_F32 *next = head->next;
+            BenchSink(head->data);
+            free(head);
+            head = next;
+        }
+        times->pop += BenchTime() - start;
+    }
+    
+    free(fillers);
+}
+
+internal void
+BenchPoolList(b32 prefetch, ListTimes *times)
+{
+    Linked_List_F32_Pool pool = {0};
+    
+    for (u32 round = 0; round < LIST_ROUNDS; ++round)
+    {
+        Linked_List_F32 *head = 0;
+        
+        f64 start = BenchTime();
+        for (u32 i = 0; i < LIST_NODES; ++i)
+        {
+            Linked_List_F32_pool_push(&pool, &head, (f32)i);
+        }
+        times->push += BenchTime() - start;
+        
+        start = BenchTime();
+        f32 sum = 0;
+        if (prefetch)
+        {
+            Linked_List_F32_for_each_prefetch(node, head)
+            {
+                sum += node->data;
+            }
+        }
+        else
+        {
+            Linked_List_F32_for_each(node, head)
+            {
+                sum += node->data;
+            }
+        }
+        BenchSink(sum);
+        times->iterate += BenchTime() - start;
+        
+        start = BenchTime();
+        f32 data;
+        while (Linked_List_F32_pool_pop(&pool, &head, &data))
+        {
+            BenchSink(data);
+        }
+        times->pop += BenchTime() - start;
+        
+        Linked_List_F32_reset(&pool);
+    }
+    
+    Linked_List_F32_pool_free(&pool);
+}
+
+int
+main()
+{
+    printf("Linked_List, %d nodes x %d rounds\n", LIST_NODES, LIST_ROUNDS);
+    
+    ListTimes times = {0};
+    BenchMallocList(FALSE, &times);
+    ReportListTimes("malloc per node", &times);
+    
+    times = (ListTimes){0};
+    BenchMallocList(TRUE, &times);
+    ReportListTimes("malloc per node, churned heap", &times);
+    
+    times = (ListTimes){0};
+    BenchPoolList(FALSE, &times);
+    ReportListTimes("pool", &times);
+    
+    times = (ListTimes){0};
+    BenchPoolList(TRUE, &times);
+    ReportListTimes("pool, prefetch", &times);
+    
+    return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ Compares the generated Lru_Cache from examples/lru.gs with an LRU
+ cache that allocates a node per entry, links nodes by pointer and
+ finds them through a chained hash table, as hand-written caches
+ usually do. Keys follow a skewed distribution, so small keys are
+ requested far more often; each run reports the hit ratio next to
+ the time per get or put.
+ */
+
+#include <math.h>
+
+#include "bench.h"
+#include "../examples/lru.h"
+
+#define LRU_REQUESTS 4000000
+#define LRU_KEY_RANGE 1000000
+
+typedef struct PointerNode PointerNode;
+struct PointerNode
+{
+    PointerNode *newer;
+    PointerNode *older;
+    PointerNode *next_in_bucket;
+    u64 key;
+    u64 value;
+};
+
+typedef struct PointerLru
+{
+    PointerNode **buckets;
+    u64 bucket_mask;
+    PointerNode *newest;
+    PointerNode *oldest;
+    u64 count;
+    u64 capacity;
+} PointerLru;
+
+internal u64
+PointerLruHash(u64 key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return key;
+}
+
+internal void
+PointerLruUnlink(PointerLru *cache, PointerNode *node)
+{
+    if (node->newer) node->newer->older = node->older;
+    else cache->newest = node->older;
+    if (node->older) node->older->newer = node->newer;
+    else cache->oldest = node->newer;
+}
+
+internal void
+PointerLruLinkNewest(PointerLru *cache, PointerNode *node)
+{
+    node->newer = 0;
+    node->older = cache->newest;
+    if (cache->newest) cache->newest->newer = node;
+    else cache->oldest = node;
+    cache->newest = node;
+}
+
+internal __attribute__((noinline)) u64 *
+PointerLruGet(PointerLru *cache, u64 key)
+{
+    PointerNode *node = cache->buckets[PointerLruHash(key) & cache->bucket_mask];
+    while (node && node->key != key)
+    {
+        node = node->next_in_bucket;
+    }
+    if (!node)
+    {
+        return 0;
+    }
+    
+    PointerLruUnlink(cache, node);
+    PointerLruLinkNewest(cache, node);
+    return &node->value;
+}
+
+internal __attribute__((noinline)) void
+PointerLruPut(PointerLru *cache, u64 key, u64 value)
+{
+    if (cache->count == cache->capacity)
+    {
+        PointerNode *old = cache->oldest;
+        PointerNode **link = &cache->buckets[PointerLruHash(old->key) & cache->bucket_mask];
+        while (*link != old)
+        {
+            link = &(*link)->next_in_bucket;
+        }
+        *link = old->next_in_bucket;
+        PointerLruUnlink(cache, old);
+        free(old);
+        --cache->count;
+    }
+    
+    PointerNode *node = malloc(sizeof(PointerNode));
+    node->key = key;
+    node->value = value;
+    PointerNode **bucket = &cache->buckets[PointerLruHash(key) & cache->bucket_mask];
+    node->next_in_bucket = *bucket;
+    *bucket = node;
+    PointerLruLinkNewest(cache, node);
+    ++cache->count;
+}
+
+internal void
+PointerLruFree(PointerLru *cache)
+{
+    for (PointerNode *node = cache->newest; node;)
+    {
+        PointerNode *older = node->older;
+        free(node);
+        node = older;
+    }
+    free(cache->buckets);
+}
+
+/* log-uniform keys: a request for key i is about twice as likely as one for 2i */
+internal void
+MakeRequests(u64 *keys, u64 count)
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    f64 log_range = log((f64)LRU_KEY_RANGE);
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        f64 u = (f64)(BenchRandom(&random_state) >> 11) / (f64)(1ull << 53);
+        keys[i] = (u64)exp(u * log_range) - 1;
+    }
+}
+
+internal void
+BenchCache(u64 *keys, u32 capacity)
+{
+    printf("capacity %u, %u requests\n", capacity, LRU_REQUESTS);
+    
+    {
+        PointerLru cache = {0};
+        u64 bucket_num = 16;
+        while (bucket_num < 2 * (u64)capacity)
+        {
+            bucket_num *= 2;
+        }
+        cache.buckets = calloc(bucket_num, sizeof(PointerNode *));
+        cache.bucket_mask = bucket_num - 1;
+        cache.capacity = capacity;
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < LRU_REQUESTS; ++i)
+        {
+            u64 *value = PointerLruGet(&cache, keys[i]);
+            if (value)
+            {
+                BenchSink(*value);
+            }
+            else
+            {
+                PointerLruPut(&cache, keys[i], i);
+            }
+        }
+        f64 seconds = BenchTime() - start;
+        
+        BenchReport("pointer nodes, malloc", seconds, LRU_REQUESTS);
+        PointerLruFree(&cache);
+    }
+    
+    {
+        Lru_U64 cache;
+        Lru_U64_init(&cache, capacity);
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < LRU_REQUESTS; ++i)
+        {
+            u64 *value = Lru_U64_get(&cache, keys[i]);
+            if (value)
+            {
+                BenchSink(*value);
+            }
+            else
+            {
+                Lru_U64_put(&cache, keys[i], i, 0, 0);
+            }
+        }
+        f64 seconds = BenchTime() - start;
+        
+        BenchReport("Lru_Cache", seconds, LRU_REQUESTS);
+        printf("  hit ratio %.3f\n", (f64)cache.hits / (cache.hits + cache.misses));
+        Lru_U64_free(&cache);
+    }
+}
+
+int
+main()
+{
+    u64 *keys = malloc(LRU_REQUESTS * sizeof(u64));
+    MakeRequests(keys, LRU_REQUESTS);
+    
+    BenchCache(keys, 1000);
+    BenchCache(keys, 100000);
+    BenchCache(keys, 1000000);
+    
+    free(keys);
+    return 0;
+}
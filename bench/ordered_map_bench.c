@@ -0,0 +1,165 @@
+/*
+ Compares the generated Flat_Map and B_Tree from examples/ordered_map.gs
+ with the red-black tree behind tsearch, on random u64 keys.
+ */
+
+#include "bench.h"
+#include <search.h>
+#include "../examples/ordered_map.h"
+
+typedef struct TreeEntry
+{
+    u64 key;
+    u64 value;
+} TreeEntry;
+
+internal int
+CompareTreeEntry(const void *a, const void *b)
+{
+    u64 x = ((TreeEntry *)a)->key;
+    u64 y = ((TreeEntry *)b)->key;
+    return (x > y) - (x < y);
+}
+
+internal int
+CompareU64(const void *a, const void *b)
+{
+    u64 x = *(u64 *)a;
+    u64 y = *(u64 *)b;
+    return (x > y) - (x < y);
+}
+
+/* the entries are freed in one piece */
+internal void
+KeepTreeEntry(void *entry)
+{
+    (void)entry;
+}
+
+internal void
+BenchOrderedMaps(u64 count)
+{
+    u64 *keys = malloc(sizeof(u64) * count);
+    u64 *sorted_keys = malloc(sizeof(u64) * count);
+    u64 *values = malloc(sizeof(u64) * count);
+    u64 random_state = 0x2545F4914F6CDD1Dull;
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        /* random and unique, since i is in the low bits */
+        keys[i] = (BenchRandom(&random_state) << 24) | i;
+        sorted_keys[i] = keys[i];
+        values[i] = i;
+    }
+    
+    qsort(sorted_keys, count, sizeof(u64), CompareU64);
+    
+    printf("%llu u64 -> u64 entries\n", (unsigned long long)count);
+    
+    {
+        TreeEntry *entries = malloc(sizeof(TreeEntry) * count);
+        void *root = 0;
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            entries[i].key = keys[i];
+            entries[i].value = i;
+            tsearch(&entries[i], &root, CompareTreeEntry);
+        }
+        BenchReport("tsearch insert", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            TreeEntry probe = {keys[i], 0};
+            TreeEntry **found = tfind(&probe, &root, CompareTreeEntry);
+            BenchSink((*found)->value);
+        }
+        BenchReport("tsearch find", BenchTime() - start, count);
+        
+        tdestroy(root, KeepTreeEntry);
+        free(entries);
+    }
+    
+    {
+        B_Tree_U64 tree = {0};
+        
+        f64 start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            B_Tree_U64_insert(&tree, keys[i], i);
+        }
+        BenchReport("B_Tree insert", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(*B_Tree_U64_find(&tree, keys[i]));
+        }
+        BenchReport("B_Tree find", BenchTime() - start, count);
+        
+        start = BenchTime();
+        u64 sum = 0;
+        B_Tree_U64_for_range(&tree, cursor, 0, ~(u64)0)
+        {
+            sum += cursor.leaf->values[cursor.index];
+        }
+        BenchSink(sum);
+        BenchReport("B_Tree iterate", BenchTime() - start, count);
+        
+        start = BenchTime();
+        B_Tree_U64_load_sorted(&tree, sorted_keys, values, count);
+        BenchReport("B_Tree load_sorted", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(*B_Tree_U64_find(&tree, keys[i]));
+        }
+        BenchReport("B_Tree find, bulk loaded", BenchTime() - start, count);
+        
+        B_Tree_U64_free(&tree);
+    }
+    
+    {
+        Flat_Map_U64 map = {0};
+        
+        /* every insert moves half the array on average, so only small maps */
+        if (count <= 100000)
+        {
+            f64 start = BenchTime();
+            for (u64 i = 0; i < count; ++i)
+            {
+                Flat_Map_U64_insert(&map, keys[i], i);
+            }
+            BenchReport("Flat_Map insert", BenchTime() - start, count);
+        }
+        
+        f64 start = BenchTime();
+        Flat_Map_U64_load_sorted(&map, sorted_keys, values, count);
+        BenchReport("Flat_Map load_sorted", BenchTime() - start, count);
+        
+        start = BenchTime();
+        for (u64 i = 0; i < count; ++i)
+        {
+            BenchSink(*Flat_Map_U64_find(&map, keys[i]));
+        }
+        BenchReport("Flat_Map find", BenchTime() - start, count);
+        
+        Flat_Map_U64_free(&map);
+    }
+    
+    free(values);
+    free(sorted_keys);
+    free(keys);
+}
+
+int
+main()
+{
+    BenchOrderedMaps(10000);
+    BenchOrderedMaps(1000000);
+    
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ Measures the generated Spsc_Ring and Mpmc_Ring from examples/ring.gs
+ against a ring over void * that copies a runtime element size: a
+ lock-free one without cached indices or padding for one producer and
+ one consumer, and one behind a mutex for several of each.
+ */
+
+#include "bench.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "../examples/ring.h"
+
+#define RING_ITEMS (1 << 22)
+#define RING_SIZE 1024
+
+typedef struct VoidRing
+{
+    u8 *data;
+    u64 element_size;
+    u64 capacity;
+    _Atomic u64 head;
+    _Atomic u64 tail;
+    pthread_mutex_t mutex;
+} VoidRing;
+
+internal void
+VoidRingInit(VoidRing *ring, u64 element_size, u64 capacity)
+{
+    ring->data = malloc(element_size * capacity);
+    ring->element_size = element_size;
+    ring->capacity = capacity;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    pthread_mutex_init(&ring->mutex, 0);
+}
+
+internal __attribute__((noinline)) b32
+VoidRingPush(VoidRing *ring, void *element)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == ring->capacity)
+    {
+        return 0;
+    }
+    
+    memcpy(ring->data + (tail % ring->capacity) * ring->element_size,
+           element, ring->element_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+internal __attribute__((noinline)) b32
+VoidRingPop(VoidRing *ring, void *element)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+    {
+        return 0;
+    }
+    
+    memcpy(element, ring->data + (head % ring->capacity) * ring->element_size,
+           ring->element_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 1;
+}
+
+internal __attribute__((noinline)) b32
+VoidRingLockedPush(VoidRing *ring, void *element)
+{
+    pthread_mutex_lock(&ring->mutex);
+    b32 pushed = VoidRingPush(ring, element);
+    pthread_mutex_unlock(&ring->mutex);
+    return pushed;
+}
+
+internal __attribute__((noinline)) b32
+VoidRingLockedPop(VoidRing *ring, void *element)
+{
+    pthread_mutex_lock(&ring->mutex);
+    b32 popped = VoidRingPop(ring, element);
+    pthread_mutex_unlock(&ring->mutex);
+    return popped;
+}
+
+global VoidRing void_ring;
+global Spsc_Ring_U64 spsc_ring;
+global Mpmc_Ring_U64 mpmc_ring;
+
+/* shared by the threads of one run */
+global u64 items_per_producer;
+global _Atomic u64 items_consumed;
+global _Atomic u64 consumed_sum;
+
+/*
+ Producer and consumer threads for one ring. Producers push the
+ numbers 1 to items_per_producer; consumers pop until every item is
+ gone and add them up so the result can be checked.
+ */
+#define RING_BENCH_THREADS(name, push, pop)                             \
+    internal void *                                                     \
+    name##Producer(void *unused)                                        \
+    {                                                                   \
+        (void)unused;                                                   \
+        for (u64 value = 1; value <= items_per_producer; ++value)       \
+        {                                                               \
+            while (!(push))                                             \
+            {                                                           \
+                sched_yield();                                          \
+            }                                                           \
+        }                                                               \
+        return 0;                                                       \
+    }                                                                   \
+                                                                        \
+    internal void *                                                     \
+    name##Consumer(void *unused)                                        \
+    {                                                                   \
+        (void)unused;                                                   \
+        u64 sum = 0;                                                    \
+        u64 value;                                                      \
+        while (atomic_load(&items_consumed) < RING_ITEMS)               \
+        {                                                               \
+            if (pop)                                                    \
+            {                                                           \
+                sum += value;                                           \
+                atomic_fetch_add(&items_consumed, 1);                   \
+            }                                                           \
+            else                                                        \
+            {                                                           \
+                sched_yield();                                          \
+            }                                                           \
+        }                                                               \
+        atomic_fetch_add(&consumed_sum, sum);                           \
+        return 0;                                                       \
+    }
+
+RING_BENCH_THREADS(VoidSpsc, VoidRingPush(&void_ring, &value),
+                   VoidRingPop(&void_ring, &value))
+RING_BENCH_THREADS(VoidLocked, VoidRingLockedPush(&void_ring, &value),
+                   VoidRingLockedPop(&void_ring, &value))
+RING_BENCH_THREADS(Spsc, Spsc_Ring_U64_push(&spsc_ring, value),
+                   Spsc_Ring_U64_pop(&spsc_ring, &value))
+RING_BENCH_THREADS(Mpmc, Mpmc_Ring_U64_push(&mpmc_ring, value),
+                   Mpmc_Ring_U64_pop(&mpmc_ring, &value))
+
+internal void
+RunRingBench(char *name, u32 thread_num,
+             void *(*producer)(void *), void *(*consumer)(void *))
+{
+    pthread_t threads[32];
+    
+    items_per_producer = RING_ITEMS / thread_num;
+    atomic_store(&items_consumed, 0);
+    atomic_store(&consumed_sum, 0);
+    
+    f64 start = BenchTime();
+    for (u32 i = 0; i < thread_num; ++i)
+    {
+        pthread_create(&threads[2 * i], 0, producer, 0);
+        pthread_create(&threads[2 * i + 1], 0, consumer, 0);
+    }
+    for (u32 i = 0; i < 2 * thread_num; ++i)
+    {
+        pthread_join(threads[i], 0);
+    }
+    f64 seconds = BenchTime() - start;
+    
+    u64 expected = thread_num * (items_per_producer * (items_per_producer + 1) / 2);
+    if (atomic_load(&consumed_sum) != expected)
+    {
+        printf("  %s: wrong sum\n", name);
+    }
+    
+    char label[64];
+    snprintf(label, sizeof(label), "%s, %ux%u", name, thread_num, thread_num);
+    BenchReport(label, seconds, RING_ITEMS);
+}
+
+int
+main()
+{
+    printf("%d u64 items through a ring of %d\n", RING_ITEMS, RING_SIZE);
+    
+    VoidRingInit(&void_ring, sizeof(u64), RING_SIZE);
+    
+    RunRingBench("void * lock-free", 1, VoidSpscProducer, VoidSpscConsumer);
+    Spsc_Ring_U64_init(&spsc_ring);
+    RunRingBench("Spsc_Ring", 1, SpscProducer, SpscConsumer);
+    
+    for (u32 thread_num = 1; thread_num <= 4; thread_num *= 2)
+    {
+        atomic_store(&void_ring.head, 0);
+        atomic_store(&void_ring.tail, 0);
+        RunRingBench("void * mutex", thread_num,
+                     VoidLockedProducer, VoidLockedConsumer);
+        
+        Mpmc_Ring_U64_init(&mpmc_ring);
+        RunRingBench("Mpmc_Ring", thread_num, MpmcProducer, MpmcConsumer);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ Serializes and deserializes arrays of the structs in
+ examples/serialize.gs with the generated functions and with a
+ generic serializer that walks a table of field descriptors at run
+ time and writes each number a byte at a time, the way a reflection
+ based serializer does.
+ */
+
+#include "bench.h"
+#include "../examples/serialize.h"
+
+#define SERIALIZE_BYTES (64 * 1024 * 1024)
+#define SERIALIZE_ROUNDS 5
+
+/* one run of numbers in a struct, nested structs flattened */
+typedef struct FieldDescriptor
+{
+    u64 offset;
+    u64 size;
+    u64 count;
+} FieldDescriptor;
+
+typedef struct TypeDescriptor
+{
+    FieldDescriptor *fields;
+    u32 field_num;
+    u64 size;
+    u64 wire_size;
+} TypeDescriptor;
+
+global FieldDescriptor vec3f_fields[] =
+{
+    {offsetof(Vec3f, x), 4, 1},
+    {offsetof(Vec3f, y), 4, 1},
+    {offsetof(Vec3f, z), 4, 1},
+};
+
+global FieldDescriptor vec4c_fields[] =
+{
+    {offsetof(Vec4c, x), 1, 1},
+    {offsetof(Vec4c, y), 1, 1},
+    {offsetof(Vec4c, z), 1, 1},
+    {offsetof(Vec4c, w), 1, 1},
+};
+
+global FieldDescriptor particle_fields[] =
+{
+    {offsetof(Particle_F32, position) + offsetof(Vec3f, x), 4, 1},
+    {offsetof(Particle_F32, position) + offsetof(Vec3f, y), 4, 1},
+    {offsetof(Particle_F32, position) + offsetof(Vec3f, z), 4, 1},
+    {offsetof(Particle_F32, velocity) + offsetof(Vec3f, x), 4, 1},
+    {offsetof(Particle_F32, velocity) + offsetof(Vec3f, y), 4, 1},
+    {offsetof(Particle_F32, velocity) + offsetof(Vec3f, z), 4, 1},
+    {offsetof(Particle_F32, kind), 1, 1},
+    {offsetof(Particle_F32, id), 4, 1},
+    {offsetof(Particle_F32, flags), 2, 2},
+};
+
+__attribute__((noinline)) internal void
+GenericSerialize(TypeDescriptor *type, void *values, u64 count, u8 *buffer)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        u8 *memory = (u8 *)values + i * type->size;
+        for (u32 j = 0; j < type->field_num; ++j)
+        {
+            FieldDescriptor *field = &type->fields[j];
+            for (u64 k = 0; k < field->count; ++k)
+            {
+                u64 bits = 0;
+                memcpy(&bits, memory + field->offset + k * field->size, field->size);
+                for (u64 byte = 0; byte < field->size; ++byte)
+                {
+                    *buffer++ = (u8)(bits >> (8 * byte));
+                }
+            }
+        }
+    }
+}
+
+__attribute__((noinline)) internal void
+GenericDeserialize(TypeDescriptor *type, void *values, u64 count, u8 *buffer)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        u8 *memory = (u8 *)values + i * type->size;
+        for (u32 j = 0; j < type->field_num; ++j)
+        {
+            FieldDescriptor *field = &type->fields[j];
+            for (u64 k = 0; k < field->count; ++k)
+            {
+                u64 bits = 0;
+                for (u64 byte = 0; byte < field->size; ++byte)
+                {
+                    bits |= (u64)*buffer++ << (8 * byte);
+                }
+                memcpy(memory + field->offset + k * field->size, &bits, field->size);
+            }
+        }
+    }
+}
+
+/* like BenchReport, with the throughput in serialized bytes */
+internal void
+SerializeReport(char *name, f64 seconds, u64 count, u64 wire_size)
+{
+    printf("  %-32s %9.3f ms %7.2f ns/value %8.1f MB/s\n", name,
+           seconds * 1000.0, seconds * 1000000000.0 / count,
+           (f64)count * wire_size / seconds / 1000000.0);
+}
+
+internal void
+FillVec3f(Vec3f *values, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        values[i] = (Vec3f){(f32)i, (f32)(i * 2), (f32)(i * 3)};
+    }
+}
+
+internal void
+FillVec4c(Vec4c *values, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        values[i] = (Vec4c){(u8)i, (u8)(i >> 8), (u8)(i >> 16), 255};
+    }
+}
+
+internal void
+FillParticle_F32(Particle_F32 *values, u64 count)
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        values[i].position = (Vec3f){(f32)i, 0, 0};
+        values[i].velocity = (Vec3f){0, (f32)i, 1};
+        values[i].kind = (u8)BenchRandom(&random_state);
+        values[i].id = (u32)i;
+        values[i].flags[0] = (u16)i;
+        values[i].flags[1] = 1;
+    }
+}
+
+#define BENCH_TYPE(Type, descriptor) \
+    do \
+    { \
+        u64 count = SERIALIZE_BYTES / sizeof(Type); \
+        Type *values = malloc(count * sizeof(Type)); \
+        Type *copies = malloc(count * sizeof(Type)); \
+        u8 *buffer = malloc(count * Type##_WIRE_SIZE); \
+        memset(values, 0, count * sizeof(Type)); \
+        Fill##Type(values, count); \
+        \
+        printf("%s: %llu values, size %zu, wire size %d\n", #Type, \
+               (unsigned long long)count, sizeof(Type), Type##_WIRE_SIZE); \
+        \
+        f64 start = BenchTime(); \
+        for (u32 round = 0; round < SERIALIZE_ROUNDS; ++round) \
+        { \
+            GenericSerialize(&descriptor, values, count, buffer); \
+            BenchSink(buffer[round]); \
+        } \
+        SerializeReport("generic serialize", BenchTime() - start, \
+                        count * SERIALIZE_ROUNDS, Type##_WIRE_SIZE); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < SERIALIZE_ROUNDS; ++round) \
+        { \
+            GenericDeserialize(&descriptor, copies, count, buffer); \
+            BenchSink(((u8 *)copies)[round]); \
+        } \
+        SerializeReport("generic deserialize", BenchTime() - start, \
+                        count * SERIALIZE_ROUNDS, Type##_WIRE_SIZE); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < SERIALIZE_ROUNDS; ++round) \
+        { \
+            Type##_serialize_array(values, count, buffer); \
+            BenchSink(buffer[round]); \
+        } \
+        SerializeReport(#Type "_serialize_array", BenchTime() - start, \
+                        count * SERIALIZE_ROUNDS, Type##_WIRE_SIZE); \
+        \
+        start = BenchTime(); \
+        for (u32 round = 0; round < SERIALIZE_ROUNDS; ++round) \
+        { \
+            Type##_deserialize_array(copies, count, buffer); \
+            BenchSink(((u8 *)copies)[round]); \
+        } \
+        SerializeReport(#Type "_deserialize_array", BenchTime() - start, \
+                        count * SERIALIZE_ROUNDS, Type##_WIRE_SIZE); \
+        \
+        free(buffer); \
+        free(copies); \
+        free(values); \
+    } while (0)
+
+int
+main()
+{
+    TypeDescriptor vec3f_type =
+        {vec3f_fields, sizeof(vec3f_fields) / sizeof(vec3f_fields[0]), sizeof(Vec3f), Vec3f_WIRE_SIZE};
+    TypeDescriptor vec4c_type =
+        {vec4c_fields, sizeof(vec4c_fields) / sizeof(vec4c_fields[0]), sizeof(Vec4c), Vec4c_WIRE_SIZE};
+    TypeDescriptor particle_type =
+        {particle_fields, sizeof(particle_fields) / sizeof(particle_fields[0]), sizeof(Particle_F32),
+         Particle_F32_WIRE_SIZE};
+    
+    BENCH_TYPE(Vec3f, vec3f_type);
+    BENCH_TYPE(Vec4c, vec4c_type);
+    BENCH_TYPE(Particle_F32, particle_type);
+    
+    return 0;
+}
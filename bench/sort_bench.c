@@ -0,0 +1,162 @@
+/*
+ Compares the generated Sort kernels from examples/sort.gs with qsort
+ on random u32 arrays and on Vec3f arrays ordered by x. Sizes run from
+ 1e3 to 1e7 elements; pass 8 to go up to 1e8.
+ */
+
+#include "bench.h"
+#include "../examples/sort.h"
+
+internal int
+CompareU32(const void *a, const void *b)
+{
+    u32 x = *(u32 *)a;
+    u32 y = *(u32 *)b;
+    return (x > y) - (x < y);
+}
+
+internal int
+CompareVec3fX(const void *a, const void *b)
+{
+    f32 x = ((Vec3f *)a)->x;
+    f32 y = ((Vec3f *)b)->x;
+    return (x > y) - (x < y);
+}
+
+/* repeats small sizes so every measurement sorts at least 1e6 elements */
+internal u64
+GetSortRounds(u64 count)
+{
+    return (count < 1000000) ? 1000000 / count : 1;
+}
+
+internal void
+BenchSortU32(u64 count, u64 *random_state)
+{
+    u32 *source = malloc(sizeof(u32) * count);
+    u32 *array = malloc(sizeof(u32) * count);
+    u32 *scratch = malloc(sizeof(u32) * count);
+    u64 rounds = GetSortRounds(count);
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        source[i] = (u32)BenchRandom(random_state);
+    }
+    
+    f64 seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(u32) * count);
+        f64 start = BenchTime();
+        qsort(array, count, sizeof(u32), CompareU32);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("u32 qsort", seconds, count * rounds);
+    
+    seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(u32) * count);
+        f64 start = BenchTime();
+        Sort_U32_sort(array, count);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("u32 introsort", seconds, count * rounds);
+    
+    seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(u32) * count);
+        f64 start = BenchTime();
+        Sort_U32_radix_sort(array, scratch, count);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("u32 radix sort", seconds, count * rounds);
+    
+    /* lookups of keys in the array, in random order */
+    u64 lookups = 1000000;
+    f64 start = BenchTime();
+    for (u64 i = 0; i < lookups; ++i)
+    {
+        BenchSink(Sort_U32_lower_bound(array, count, source[i % count]));
+    }
+    BenchReport("u32 lower_bound", BenchTime() - start, lookups);
+    
+    start = BenchTime();
+    for (u64 i = 0; i < lookups; ++i)
+    {
+        BenchSink(bsearch(&source[i % count], array, count, sizeof(u32), CompareU32) != 0);
+    }
+    BenchReport("u32 bsearch", BenchTime() - start, lookups);
+    
+    free(scratch);
+    free(array);
+    free(source);
+}
+
+internal void
+BenchSortVec3f(u64 count, u64 *random_state)
+{
+    Vec3f *source = malloc(sizeof(Vec3f) * count);
+    Vec3f *array = malloc(sizeof(Vec3f) * count);
+    Vec3f *scratch = malloc(sizeof(Vec3f) * count);
+    u64 rounds = GetSortRounds(count);
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        source[i].x = (f32)(BenchRandom(random_state) % 2000001) - 1000000.0f;
+        source[i].y = (f32)i;
+        source[i].z = 0;
+    }
+    
+    f64 seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(Vec3f) * count);
+        f64 start = BenchTime();
+        qsort(array, count, sizeof(Vec3f), CompareVec3fX);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("Vec3f.x qsort", seconds, count * rounds);
+    
+    seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(Vec3f) * count);
+        f64 start = BenchTime();
+        Sort_Vec3f_X_sort(array, count);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("Vec3f.x introsort", seconds, count * rounds);
+    
+    seconds = 0;
+    for (u64 round = 0; round < rounds; ++round)
+    {
+        memcpy(array, source, sizeof(Vec3f) * count);
+        f64 start = BenchTime();
+        Sort_Vec3f_X_radix_sort(array, scratch, count);
+        seconds += BenchTime() - start;
+    }
+    BenchReport("Vec3f.x radix sort", seconds, count * rounds);
+    
+    free(scratch);
+    free(array);
+    free(source);
+}
+
+int
+main(int argc, char **argv)
+{
+    u32 max_exponent = (argc > 1) ? (u32)atoi(argv[1]) : 7;
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    
+    u64 count = 1000;
+    for (u32 exponent = 3; exponent <= max_exponent; ++exponent, count *= 10)
+    {
+        printf("%llu elements\n", (unsigned long long)count);
+        BenchSortU32(count, &random_state);
+        BenchSortVec3f(count, &random_state);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ Sums the areas of a mixed array of shapes stored as the Shape variant
+ from examples/variant.gs, dispatched by Shape_visit, and as separately
+ allocated objects that start with a pointer to a table of functions,
+ the usual way to model kinds of records in C.
+ */
+
+#include "bench.h"
+#include "../examples/variant.h"
+
+#define VARIANT_SHAPES 1000000
+#define VARIANT_ROUNDS 20
+
+typedef struct ShapeVtable
+{
+    f32 (*area)(void *shape);
+} ShapeVtable;
+
+typedef struct VtableCircle
+{
+    ShapeVtable *vtable;
+    Circle_F32 circle;
+} VtableCircle;
+
+typedef struct VtableRect
+{
+    ShapeVtable *vtable;
+    Rect_F32 rect;
+} VtableRect;
+
+typedef struct VtablePoint
+{
+    ShapeVtable *vtable;
+    Vec2_f32 point;
+} VtablePoint;
+
+internal f32
+VtableCircleArea(void *shape)
+{
+    Circle_F32 *circle = &((VtableCircle *)shape)->circle;
+    return 3.14159265f * circle->radius * circle->radius;
+}
+
+internal f32
+VtableRectArea(void *shape)
+{
+    Rect_F32 *rect = &((VtableRect *)shape)->rect;
+    return (rect->max.x - rect->min.x) * (rect->max.y - rect->min.y);
+}
+
+internal f32
+VtablePointArea(void *shape)
+{
+    (void)shape;
+    return 0.0f;
+}
+
+global ShapeVtable circle_vtable = {VtableCircleArea};
+global ShapeVtable rect_vtable = {VtableRectArea};
+global ShapeVtable point_vtable = {VtablePointArea};
+
+/* visitors for Shape_visit, the context is the running sum */
+internal void
+Area_circle_f32(Circle_F32 *circle, f32 *sum)
+{
+    *sum += 3.14159265f * circle->radius * circle->radius;
+}
+
+internal void
+Area_rect_f32(Rect_F32 *rect, f32 *sum)
+{
+    *sum += (rect->max.x - rect->min.x) * (rect->max.y - rect->min.y);
+}
+
+internal void
+Area_vec2_f32(Vec2_f32 *point, f32 *sum)
+{
+    (void)point;
+    (void)sum;
+}
+
+int
+main()
+{
+    u64 random_state = 0x9E3779B97F4A7C15ull;
+    Shape *shapes = malloc(VARIANT_SHAPES * sizeof(Shape));
+    void **objects = malloc(VARIANT_SHAPES * sizeof(void *));
+    u64 object_bytes = 0;
+    
+    for (u32 i = 0; i < VARIANT_SHAPES; ++i)
+    {
+        f32 a = (f32)(BenchRandom(&random_state) % 100);
+        f32 b = (f32)(BenchRandom(&random_state) % 100);
+        
+        switch (BenchRandom(&random_state) % 3)
+        {
+            case 0:
+            {
+                Circle_F32 circle = {{a, b}, a / 10.0f};
+                shapes[i] = Shape_from_circle_f32(circle);
+                
+                VtableCircle *object = malloc(sizeof(VtableCircle));
+                *object = (VtableCircle){&circle_vtable, circle};
+                objects[i] = object;
+                object_bytes += sizeof(VtableCircle);
+            } break;
+            case 1:
+            {
+                Rect_F32 rect = {{0, 0}, {a, b}};
+                shapes[i] = Shape_from_rect_f32(rect);
+                
+                VtableRect *object = malloc(sizeof(VtableRect));
+                *object = (VtableRect){&rect_vtable, rect};
+                objects[i] = object;
+                object_bytes += sizeof(VtableRect);
+            } break;
+            default:
+            {
+                Vec2_f32 point = {a, b};
+                shapes[i] = Shape_from_vec2_f32(point);
+                
+                VtablePoint *object = malloc(sizeof(VtablePoint));
+                *object = (VtablePoint){&point_vtable, point};
+                objects[i] = object;
+                object_bytes += sizeof(VtablePoint);
+            } break;
+        }
+    }
+    
+    printf("%d shapes, %d rounds\n", VARIANT_SHAPES, VARIANT_ROUNDS);
+    printf("  vtable objects %.1f bytes each plus a pointer and malloc overhead, "
+           "Shape %zu bytes\n",
+           (f64)object_bytes / VARIANT_SHAPES, sizeof(Shape));
+    
+    {
+        f64 start = BenchTime();
+        for (u32 round = 0; round < VARIANT_ROUNDS; ++round)
+        {
+            f32 sum = 0;
+            for (u32 i = 0; i < VARIANT_SHAPES; ++i)
+            {
+                sum += (*(ShapeVtable **)objects[i])->area(objects[i]);
+            }
+            BenchSink(sum);
+        }
+        BenchReport("vtable, pointer per shape", BenchTime() - start,
+                    (u64)VARIANT_SHAPES * VARIANT_ROUNDS);
+    }
+    
+    {
+        f64 start = BenchTime();
+        for (u32 round = 0; round < VARIANT_ROUNDS; ++round)
+        {
+            f32 sum = 0;
+            for (u32 i = 0; i < VARIANT_SHAPES; ++i)
+            {
+                Shape_visit(&shapes[i], Area, &sum);
+            }
+            BenchSink(sum);
+        }
+        BenchReport("Shape_visit", BenchTime() - start,
+                    (u64)VARIANT_SHAPES * VARIANT_ROUNDS);
+    }
+    
+    for (u32 i = 0; i < VARIANT_SHAPES; ++i)
+    {
+        free(objects[i]);
+    }
+    free(objects);
+    free(shapes);
+    return 0;
+}
@@ -0,0 +1,28 @@
+~output_ext .h
+
+@template_start Vec4 <- T
+@vec_math
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T x;
+	T y;
+	T z;
+	T w;
+};
+@template_end
+
+@template_start Vec3 <- T
+@vec_math
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T x;
+	T y;
+	T z;
+};
+@template_end
+
+@template Vec4 -> f32 -> Vec4f
+@template Vec3 -> f32 -> Vec3f
+@template Vec4 -> s32 -> Vec4i
@@ -0,0 +1,154 @@
+/*
+ Compares the @vec_math kernels with the scalar loops
+ they replace, over arrays that fit in L2 and over ones that don't.
+ */
+
+#include "bench.h"
+#include "vec_math.h"
+
+#define VEC_ROUNDS 64
+
+/* the hand-written loops the generated kernels replace */
+internal __attribute__((noinline)) void
+ScalarAddVec4f(Vec4f *out, Vec4f *a, Vec4f *b, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        out[i].x = a[i].x + b[i].x;
+        out[i].y = a[i].y + b[i].y;
+        out[i].z = a[i].z + b[i].z;
+        out[i].w = a[i].w + b[i].w;
+    }
+}
+
+internal __attribute__((noinline)) void
+ScalarDotVec4f(f32 *out, Vec4f *a, Vec4f *b, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        out[i] = a[i].x * b[i].x + a[i].y * b[i].y +
+            a[i].z * b[i].z + a[i].w * b[i].w;
+    }
+}
+
+internal __attribute__((noinline)) void
+ScalarScaleVec3f(Vec3f *out, Vec3f *a, f32 s, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        out[i].x = a[i].x * s;
+        out[i].y = a[i].y * s;
+        out[i].z = a[i].z * s;
+    }
+}
+
+internal __attribute__((noinline)) void
+ScalarAddVec4i(Vec4i *out, Vec4i *a, Vec4i *b, u64 count)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        out[i].x = a[i].x + b[i].x;
+        out[i].y = a[i].y + b[i].y;
+        out[i].z = a[i].z + b[i].z;
+        out[i].w = a[i].w + b[i].w;
+    }
+}
+
+internal __attribute__((noinline)) void
+GeneratedAddVec4f(Vec4f *out, Vec4f *a, Vec4f *b, u64 count)
+{
+    Vec4f_add_array(out, a, b, count);
+}
+
+internal __attribute__((noinline)) void
+GeneratedDotVec4f(f32 *out, Vec4f *a, Vec4f *b, u64 count)
+{
+    Vec4f_dot_array(out, a, b, count);
+}
+
+internal __attribute__((noinline)) void
+GeneratedScaleVec3f(Vec3f *out, Vec3f *a, f32 s, u64 count)
+{
+    Vec3f_scale_array(out, a, s, count);
+}
+
+internal __attribute__((noinline)) void
+GeneratedAddVec4i(Vec4i *out, Vec4i *a, Vec4i *b, u64 count)
+{
+    Vec4i_add_array(out, a, b, count);
+}
+
+internal void
+RunVecBench(u64 count)
+{
+    Vec4f *a = aligned_alloc(64, count * sizeof(Vec4f));
+    Vec4f *b = aligned_alloc(64, count * sizeof(Vec4f));
+    Vec4f *out = aligned_alloc(64, count * sizeof(Vec4f));
+    Vec3f *a3 = aligned_alloc(64, count * sizeof(Vec4f));
+    Vec3f *out3 = aligned_alloc(64, count * sizeof(Vec4f));
+    Vec4i *ai = aligned_alloc(64, count * sizeof(Vec4i));
+    Vec4i *bi = aligned_alloc(64, count * sizeof(Vec4i));
+    Vec4i *outi = aligned_alloc(64, count * sizeof(Vec4i));
+    f32 *dots = aligned_alloc(64, count * sizeof(f32));
+    
+    u64 state = 0x9e3779b97f4a7c15;
+    for (u64 i = 0; i < count; ++i)
+    {
+        a[i] = (Vec4f){BenchRandom(&state) % 100, 1, 2, 3};
+        b[i] = (Vec4f){BenchRandom(&state) % 100, 4, 5, 6};
+        a3[i] = (Vec3f){BenchRandom(&state) % 100, 7, 8};
+        ai[i] = (Vec4i){BenchRandom(&state) % 100, 1, 2, 3};
+        bi[i] = (Vec4i){BenchRandom(&state) % 100, 4, 5, 6};
+    }
+    
+    printf("%llu vectors, %d rounds\n", (unsigned long long)count, VEC_ROUNDS);
+    u64 operations = count * VEC_ROUNDS;
+    
+#define VEC_BENCH(name, call, result) \
+    { \
+        f64 start = BenchTime(); \
+        for (u32 round = 0; round < VEC_ROUNDS; ++round) \
+        { \
+            call; \
+        } \
+        BenchReport(name, BenchTime() - start, operations); \
+        BenchSink(result); \
+    }
+    
+    VEC_BENCH("Vec4f add, scalar loop", ScalarAddVec4f(out, a, b, count),
+              out[count - 1].x);
+    VEC_BENCH("Vec4f add, @vec_math", GeneratedAddVec4f(out, a, b, count),
+              out[count - 1].x);
+    VEC_BENCH("Vec4f dot, scalar loop", ScalarDotVec4f(dots, a, b, count),
+              dots[count - 1]);
+    VEC_BENCH("Vec4f dot, @vec_math", GeneratedDotVec4f(dots, a, b, count),
+              dots[count - 1]);
+    VEC_BENCH("Vec3f scale, scalar loop",
+              ScalarScaleVec3f(out3, a3, 1.5f, count), out3[count - 1].x);
+    VEC_BENCH("Vec3f scale, @vec_math",
+              GeneratedScaleVec3f(out3, a3, 1.5f, count), out3[count - 1].x);
+    VEC_BENCH("Vec4i add, scalar loop", ScalarAddVec4i(outi, ai, bi, count),
+              outi[count - 1].x);
+    VEC_BENCH("Vec4i add, @vec_math", GeneratedAddVec4i(outi, ai, bi, count),
+              outi[count - 1].x);
+#undef VEC_BENCH
+    
+    free(a);
+    free(b);
+    free(out);
+    free(a3);
+    free(out3);
+    free(ai);
+    free(bi);
+    free(outi);
+    free(dots);
+}
+
+int
+main()
+{
+    RunVecBench(4096);
+    RunVecBench(1024 * 1024);
+    
+    return 0;
+}
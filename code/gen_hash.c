@@ -0,0 +1,273 @@
+/*
+ Hash and equality generation for @hash.
+
+ Every instantiation of a template with a @hash line gets
+ Hash_<name> and Equal_<name>. A struct without padding, also in the
+ structs nested in it, is hashed as one run of 8-byte words and
+ compared with one memcmp of constant size, which the compiler
+ inlines as wide loads. Other structs are hashed and compared run by
+ run, where a run is a stretch of fields without padding between them,
+ so padding bytes never reach the hash. Nested structs with padding
+ must have @hash themselves and are hashed with their own function.
+ Floats are compared by their bits, so 0 and -0 differ and a NaN
+ equals itself.
+ */
+
+internal void
+WriteHashPrelude(StreamBuffer *buffer)
+{
+    AppendString(buffer,
+                 "#ifndef GEN_HASH_PRELUDE\n"
+                 "#define GEN_HASH_PRELUDE\n"
+                 "#include <stddef.h>\n"
+                 "#include <string.h>\n"
+                 "\n"
+                 "#ifndef GEN_HASH_SEED\n"
+                 "#define GEN_HASH_SEED 0x9e3779b97f4a7c15ull\n"
+                 "#endif\n"
+                 "\n"
+                 "/* Hash_<type> and Equal_<type> of a type parameter */\n"
+                 "#define GEN_HASH(type) Hash_##type\n"
+                 "#define GEN_EQUAL(type) Equal_##type\n"
+                 "\n"
+                 "/* one multiply per word, the finish step does the rest */\n"
+                 "static inline u64\n"
+                 "GenHashMix(u64 hash, u64 word)\n"
+                 "{\n"
+                 "    hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;\n"
+                 "    return hash ^ (hash >> 31);\n"
+                 "}\n"
+                 "\n"
+                 "/* size is a constant in every call, so the loop unrolls */\n"
+                 "static inline u64\n"
+                 "GenHashBytes(u8 *data, u64 size, u64 hash)\n"
+                 "{\n"
+                 "    for (; size >= 8; size -= 8, data += 8)\n"
+                 "    {\n"
+                 "        u64 word;\n"
+                 "        memcpy(&word, data, 8);\n"
+                 "        hash = GenHashMix(hash, word);\n"
+                 "    }\n"
+                 "    if (size > 0)\n"
+                 "    {\n"
+                 "        u64 word = 0;\n"
+                 "        memcpy(&word, data, size);\n"
+                 "        hash = GenHashMix(hash, word);\n"
+                 "    }\n"
+                 "    return hash;\n"
+                 "}\n"
+                 "\n"
+                 "static inline u64\n"
+                 "GenHashFinish(u64 hash)\n"
+                 "{\n"
+                 "    hash ^= hash >> 33;\n"
+                 "    hash *= 0xff51afd7ed558ccdull;\n"
+                 "    hash ^= hash >> 33;\n"
+                 "    hash *= 0xc4ceb9fe1a85ec53ull;\n"
+                 "    hash ^= hash >> 33;\n"
+                 "    return hash;\n"
+                 "}\n"
+                 "#endif\n\n");
+}
+
+/*
+ A field that is hashed by calling the function of its type, because
+ the type has padding. 0 if the bytes of the field can be hashed.
+ */
+internal TypeInfo *
+GetHashCallType(StructField *field, TypeTable *type_table)
+{
+    TypeInfo *type_info = field->is_pointer ?
+        0 : GetTypeInfo(type_table, field->type_name);
+
+    if (type_info && type_info->type_kind == TypeKind_Struct &&
+        !type_info->is_dense)
+    {
+        return type_info;
+    }
+
+    return 0;
+}
+
+/*
+ One statement per run of fields without padding between them, and
+ per nested struct that has its own functions. Hashes if equal is
+ FALSE, compares otherwise.
+ */
+internal void
+AppendHashRuns(StreamBuffer *buffer, char *struct_name, StructLayout *layout,
+               TypeTable *type_table, b8 equal)
+{
+    for (u32 i = 0; i < layout->field_num;)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *call_type = GetHashCallType(field, type_table);
+
+        if (call_type && field->count == 1)
+        {
+            if (equal)
+            {
+                AppendFormat(buffer,
+                             "    if (Equal_%s(&a->%s, &b->%s) == 0)\n"
+                             "    {\n"
+                             "        return 0;\n"
+                             "    }\n",
+                             call_type->type_name, field->field_name,
+                             field->field_name);
+            }
+            else
+            {
+                AppendFormat(buffer,
+                             "    hash = GenHashMix(hash, Hash_%s(&value->%s));\n",
+                             call_type->type_name, field->field_name);
+            }
+        }
+        else if (call_type && equal)
+        {
+            /* continuation lines line up with the first argument */
+            int indent = 8 + (int)strlen("if (Equal_(") +
+                (int)strlen(call_type->type_name);
+
+            AppendFormat(buffer,
+                         "    for (u64 i = 0; i < %llu; ++i)\n"
+                         "    {\n"
+                         "        if (Equal_%s((%s *)(memory_a + offsetof(%s, %s)) + i,\n"
+                         "%*s(%s *)(memory_b + offsetof(%s, %s)) + i) == 0)\n"
+                         "        {\n"
+                         "            return 0;\n"
+                         "        }\n"
+                         "    }\n",
+                         (unsigned long long)field->count,
+                         call_type->type_name, call_type->type_name,
+                         struct_name, field->field_name, indent, "",
+                         call_type->type_name, struct_name, field->field_name);
+        }
+        else if (call_type)
+        {
+            AppendFormat(buffer,
+                         "    for (u64 i = 0; i < %llu; ++i)\n"
+                         "    {\n"
+                         "        hash = GenHashMix(hash, Hash_%s((%s *)\n"
+                         "            (memory + offsetof(%s, %s)) + i));\n"
+                         "    }\n",
+                         (unsigned long long)field->count,
+                         call_type->type_name, call_type->type_name,
+                         struct_name, field->field_name);
+        }
+
+        if (call_type)
+        {
+            ++i;
+            continue;
+        }
+
+        u64 run_end = field->offset + field->size;
+        u32 next = i + 1;
+
+        while (next < layout->field_num &&
+               layout->fields[next].offset == run_end &&
+               GetHashCallType(&layout->fields[next], type_table) == 0)
+        {
+            run_end += layout->fields[next].size;
+            ++next;
+        }
+
+        u64 run_size = run_end - field->offset;
+        if (equal)
+        {
+            AppendFormat(buffer,
+                         "    if (memcmp(memory_a + offsetof(%s, %s),\n"
+                         "               memory_b + offsetof(%s, %s), %llu) != 0)\n"
+                         "    {\n"
+                         "        return 0;\n"
+                         "    }\n",
+                         struct_name, field->field_name,
+                         struct_name, field->field_name,
+                         (unsigned long long)run_size);
+        }
+        else
+        {
+            AppendFormat(buffer,
+                         "    hash = GenHashBytes(memory + offsetof(%s, %s), "
+                         "%llu, hash);\n",
+                         struct_name, field->field_name,
+                         (unsigned long long)run_size);
+        }
+
+        i = next;
+    }
+}
+
+/*
+ Writes Hash_<name> and Equal_<name>. Returns FALSE and writes
+ nothing if a field is a struct with padding and without @hash.
+ */
+internal b32
+WriteHash(StreamBuffer *buffer, char *struct_name, StructLayout *layout,
+          TypeTable *type_table)
+{
+    /* only runs and arrays of nested structs address the struct as bytes */
+    b32 uses_memory = FALSE;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *call_type = GetHashCallType(field, type_table);
+
+        if (call_type && !call_type->has_hash)
+        {
+            fprintf(stderr, "@hash: field %s of %s is a struct with padding "
+                    "and without @hash\n", field->field_name, struct_name);
+            return FALSE;
+        }
+
+        if (!call_type || field->count != 1)
+        {
+            uses_memory = TRUE;
+        }
+    }
+
+    if (IsDenseLayout(layout, type_table))
+    {
+        AppendFormat(buffer,
+                     "/* %s has no padding, so it is hashed and compared as memory */\n"
+                     "static inline u64\n"
+                     "Hash_%s(%s *value)\n{\n"
+                     "    return GenHashFinish(GenHashBytes((u8 *)value, "
+                     "sizeof(*value), GEN_HASH_SEED));\n}\n\n"
+                     "static inline b32\n"
+                     "Equal_%s(%s *a, %s *b)\n{\n"
+                     "    return memcmp(a, b, sizeof(*a)) == 0;\n}\n\n",
+                     struct_name, struct_name, struct_name,
+                     struct_name, struct_name, struct_name);
+        return TRUE;
+    }
+
+    AppendFormat(buffer,
+                 "/* %s has padding, which is skipped */\n"
+                 "static inline u64\n"
+                 "Hash_%s(%s *value)\n{\n",
+                 struct_name, struct_name, struct_name);
+    if (uses_memory)
+    {
+        AppendString(buffer, "    u8 *memory = (u8 *)value;\n");
+    }
+    AppendString(buffer, "    u64 hash = GEN_HASH_SEED;\n");
+    AppendHashRuns(buffer, struct_name, layout, type_table, FALSE);
+    AppendString(buffer, "    return GenHashFinish(hash);\n}\n\n");
+
+    AppendFormat(buffer,
+                 "static inline b32\n"
+                 "Equal_%s(%s *a, %s *b)\n{\n",
+                 struct_name, struct_name, struct_name);
+    if (uses_memory)
+    {
+        AppendString(buffer,
+                     "    u8 *memory_a = (u8 *)a;\n"
+                     "    u8 *memory_b = (u8 *)b;\n");
+    }
+    AppendHashRuns(buffer, struct_name, layout, type_table, TRUE);
+    AppendString(buffer, "    return 1;\n}\n\n");
+
+    return TRUE;
+}
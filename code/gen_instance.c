@@ -0,0 +1,386 @@
+/*
+ Instantiation cache and nested template arguments.
+
+ Every expansion is recorded under its full (template, arguments) key,
+ for example Pair<u32,Vec3f>, so that a concrete type is expanded
+ exactly once per run no matter how often it is referenced. Arguments
+ and template bodies may name other instantiations as Name<args>,
+ which are expanded first and replaced by their struct name.
+ Like the type table this lives in the persistent arena.
+ */
+
+internal Instantiation *
+LookupInstantiation(InstantiationTable *table, char *key)
+{
+    u32 bucket = GetHash(key) % table->num;
+
+    for (Instantiation *instantiation = table->buckets[bucket];
+         instantiation;
+         instantiation = instantiation->next)
+    {
+        if (strcmp(instantiation->key, key) == 0)
+        {
+            return instantiation;
+        }
+    }
+
+    return 0;
+}
+
+internal void
+GrowInstantiationTable(InstantiationTable *table)
+{
+    u32 new_num = table->num * 2;
+    Instantiation **new_buckets =
+        PushSize(&persistent_arena, sizeof(*new_buckets) * new_num);
+
+    for (u32 i = 0; i < table->num; ++i)
+    {
+        Instantiation *instantiation = table->buckets[i];
+
+        while (instantiation)
+        {
+            Instantiation *next = instantiation->next;
+            u32 bucket = GetHash(instantiation->key) % new_num;
+
+            instantiation->next = new_buckets[bucket];
+            new_buckets[bucket] = instantiation;
+
+            instantiation = next;
+        }
+    }
+
+    table->buckets = new_buckets;
+    table->num = new_num;
+}
+
+/*
+ Records a new instantiation. The key and name are copied
+ since requests are thrown away in streaming mode.
+ */
+internal Instantiation *
+AddInstantiation(InstantiationTable *table, char *key, char *struct_name)
+{
+    if (table->instantiation_num >= 2 * table->num)
+    {
+        GrowInstantiationTable(table);
+    }
+
+    u32 bucket = GetHash(key) % table->num;
+    ++table->instantiation_num;
+
+    Instantiation *instantiation =
+        PushSize(&persistent_arena, sizeof(*instantiation));
+
+    instantiation->key = PushSize(&persistent_arena, strlen(key));
+    strcpy(instantiation->key, key);
+    instantiation->struct_name = PushSize(&persistent_arena,
+                                          strlen(struct_name));
+    strcpy(instantiation->struct_name, struct_name);
+
+    instantiation->next = table->buckets[bucket];
+    table->buckets[bucket] = instantiation;
+
+    return instantiation;
+}
+
+/*
+ Unlinks an instantiation whose expansion failed, so that later
+ requests for it expand again instead of naming a missing type
+ */
+internal void
+RemoveInstantiation(InstantiationTable *table, Instantiation *instantiation)
+{
+    u32 bucket = GetHash(instantiation->key) % table->num;
+
+    for (Instantiation **at = &table->buckets[bucket]; *at; at = &(*at)->next)
+    {
+        if (*at == instantiation)
+        {
+            *at = instantiation->next;
+            --table->instantiation_num;
+            return;
+        }
+    }
+}
+
+internal InstantiationTable
+GetInstantiationTable()
+{
+    InstantiationTable table = {0};
+    table.num = INSTANTIATION_TABLE_BUCKETS;
+    table.buckets =
+        PushSize(&persistent_arena, sizeof(*table.buckets) * table.num);
+
+    return table;
+}
+
+/*
+ Builds the cache key Name<A,B> of a request whose
+ arguments are already resolved and complete
+ */
+internal char *
+GetInstantiationKey(TypeRequest *type_request)
+{
+    u64 length = strlen(type_request->template_name) + 2;
+
+    for (u32 i = 0; i < type_request->type_num; ++i)
+    {
+        length += strlen(type_request->type_names[i]) + 1;
+    }
+
+    char *key = ArenaAlloc(length);
+    strcpy(key, type_request->template_name);
+    strcat(key, "<");
+
+    for (u32 i = 0; i < type_request->type_num; ++i)
+    {
+        if (i > 0)
+        {
+            strcat(key, ",");
+        }
+        strcat(key, type_request->type_names[i]);
+    }
+    strcat(key, ">");
+
+    return key;
+}
+
+/*
+ Name for an instantiation that was not named by a request:
+ Vec3<f32> becomes Vec3_f32 and Pair<char *, u32> Pair_char_Ptr_u32
+ */
+internal char *
+GetMangledName(TypeRequest *type_request)
+{
+    u64 length = strlen(type_request->template_name) + 1;
+
+    for (u32 i = 0; i < type_request->type_num; ++i)
+    {
+        /* every character expands to at most _Ptr */
+        length += 4 * strlen(type_request->type_names[i]) + 1;
+    }
+
+    char *name = ArenaAlloc(length);
+    strcpy(name, type_request->template_name);
+    u64 at = strlen(name);
+
+    for (u32 i = 0; i < type_request->type_num; ++i)
+    {
+        name[at++] = '_';
+
+        for (char *c = type_request->type_names[i]; *c; ++c)
+        {
+            if (IsIdentifierChar(*c))
+            {
+                name[at++] = *c;
+                continue;
+            }
+
+            if (name[at - 1] != '_')
+            {
+                name[at++] = '_';
+            }
+
+            if (*c == '*')
+            {
+                strcpy(name + at, "Ptr");
+                at += 3;
+            }
+        }
+
+        while (name[at - 1] == '_')
+        {
+            --at;
+        }
+    }
+    name[at] = '\0';
+
+    return name;
+}
+
+/*
+ Balance of angle brackets in a string, used to glue
+ Pair<u32, f32> back together after the lexer split it at the comma
+ */
+internal s32
+GetAngleDepth(char *text)
+{
+    s32 depth = 0;
+
+    for (; *text; ++text)
+    {
+        if (*text == '<')
+        {
+            ++depth;
+        }
+        else if (*text == '>')
+        {
+            --depth;
+        }
+    }
+
+    return depth;
+}
+
+/*
+ Appends a body token that may contain a nested type such as Vec3<T>,
+ substituting the template parameters inside of it.
+ Names after . or -> are members and are left alone.
+ */
+internal void
+AppendNestedToken(StreamBuffer *buffer, char *token,
+                  Template *templates, TypeRequest *type_request)
+{
+    char *at = token;
+
+    while (*at)
+    {
+        if (!IsIdentifierChar(*at))
+        {
+            AppendStreamBuffer(buffer, at, 1);
+            ++at;
+            continue;
+        }
+
+        char *word_start = at;
+        while (IsIdentifierChar(*at))
+        {
+            ++at;
+        }
+        u64 word_length = at - word_start;
+
+        b32 is_member =
+            ((word_start - token >= 1 && word_start[-1] == '.') ||
+             (word_start - token >= 2 && word_start[-2] == '-' &&
+              word_start[-1] == '>'));
+        char *replacement = 0;
+
+        for (u32 i = 0; !is_member && i < templates->param_num; ++i)
+        {
+            char *param_name = templates->param_names[i];
+
+            if (strlen(param_name) == word_length &&
+                strncmp(param_name, word_start, word_length) == 0)
+            {
+                replacement = type_request->type_names[i];
+                break;
+            }
+        }
+
+        if (replacement)
+        {
+            AppendString(buffer, replacement);
+        }
+        else
+        {
+            AppendStreamBuffer(buffer, word_start, word_length);
+        }
+    }
+}
+
+/*
+ Finds the > that closes the < at text[0]. Returns 0 if the
+ brackets do not close before the end of the statement, which
+ means the < was a comparison.
+ */
+internal char *
+FindClosingAngle(char *text)
+{
+    s32 depth = 0;
+
+    for (char *at = text; *at; ++at)
+    {
+        switch (*at)
+        {
+            case '<':
+            {
+                ++depth;
+            } break;
+            case '>':
+            {
+                if (--depth == 0)
+                {
+                    return at;
+                }
+            } break;
+            case ';':
+            case '{':
+            case '}':
+            case '(':
+            case ')':
+            case '\n':
+            {
+                return 0;
+            } break;
+        }
+    }
+
+    return 0;
+}
+
+internal char *
+CopyTrimmed(char *start, char *end)
+{
+    while (start < end && (*start == ' ' || *start == '\t'))
+    {
+        ++start;
+    }
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        --end;
+    }
+
+    char *result = ArenaAlloc(end - start);
+    memcpy(result, start, end - start);
+    result[end - start] = '\0';
+
+    return result;
+}
+
+/*
+ Splits Name<A, B<C>> into a request for Name with arguments
+ A and B<C>. The request has no struct name, so it gets a mangled one.
+ */
+internal b8
+ParseNestedType(char *text, u64 length, TypeRequest *type_request)
+{
+    char *end = text + length;
+    char *open = memchr(text, '<', length);
+
+    if (open == 0 || end[-1] != '>')
+    {
+        return FALSE;
+    }
+
+    *type_request = (TypeRequest){0};
+    type_request->template_name = CopyTrimmed(text, open);
+
+    char *arg_start = open + 1;
+    s32 depth = 0;
+
+    for (char *at = arg_start; at < end; ++at)
+    {
+        if (*at == '<')
+        {
+            ++depth;
+        }
+        else if (*at == '>' && depth > 0)
+        {
+            --depth;
+        }
+        else if ((*at == ',' && depth == 0) || at == end - 1)
+        {
+            if (type_request->type_num == MAX_TEMPLATE_PARAMS)
+            {
+                return FALSE;
+            }
+
+            type_request->type_names[type_request->type_num++] =
+                CopyTrimmed(arg_start, at);
+            arg_start = at + 1;
+        }
+    }
+
+    return (type_request->template_name[0] != '\0');
+}
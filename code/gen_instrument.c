@@ -0,0 +1,70 @@
+/*
+ Event counters for @instrument.
+
+ "@instrument probes, resizes" in a template body becomes, for every
+ instantiation, a struct of u64 counters in a _Thread_local variable,
+ the macros Name_COUNT(counter, n) and Name_COUNT_MAX(counter, value)
+ that the template calls where the events happen, and
+ Name_dump_counters(file) and Name_reset_counters(). All of it is
+ behind GEN_INSTRUMENT; without it the macros expand to ((void)0), so
+ the counting code and its arguments compile to nothing.
+ */
+
+/* maximum number of counters on one @instrument line */
+#define MAX_INSTRUMENT_COUNTERS 32
+
+internal void
+WriteInstrument(StreamBuffer *buffer, char *struct_name,
+                char **counters, u32 counter_num)
+{
+    AppendFormat(buffer,
+                 "#ifdef GEN_INSTRUMENT\n"
+                 "#include <stdio.h>\n"
+                 "\n"
+                 "/* events of %s in the calling thread */\n"
+                 "typedef struct %s_Counters\n{\n",
+                 struct_name, struct_name);
+    for (u32 i = 0; i < counter_num; ++i)
+    {
+        AppendFormat(buffer, "    u64 %s;\n", counters[i]);
+    }
+    AppendFormat(buffer,
+                 "} %s_Counters;\n"
+                 "\n"
+                 "static _Thread_local %s_Counters %s_counters;\n"
+                 "\n"
+                 "#define %s_COUNT(counter, n) (%s_counters.counter += (u64)(n))\n"
+                 "/* value is evaluated twice */\n"
+                 "#define %s_COUNT_MAX(counter, value) \\\n"
+                 "    (%s_counters.counter = ((u64)(value) > %s_counters.counter) ? \\\n"
+                 "        (u64)(value) : %s_counters.counter)\n"
+                 "\n"
+                 "static inline void\n"
+                 "%s_dump_counters(FILE *file)\n{\n"
+                 "    fprintf(file, \"%s:\");\n",
+                 struct_name, struct_name, struct_name,
+                 struct_name, struct_name,
+                 struct_name, struct_name, struct_name, struct_name,
+                 struct_name, struct_name);
+    for (u32 i = 0; i < counter_num; ++i)
+    {
+        AppendFormat(buffer,
+                     "    fprintf(file, \" %s %%llu\", "
+                     "(unsigned long long)%s_counters.%s);\n",
+                     counters[i], struct_name, counters[i]);
+    }
+    AppendFormat(buffer,
+                 "    fprintf(file, \"\\n\");\n}\n"
+                 "\n"
+                 "static inline void\n"
+                 "%s_reset_counters(void)\n{\n"
+                 "    %s_counters = (%s_Counters){0};\n}\n"
+                 "#else\n"
+                 "#define %s_COUNT(counter, n) ((void)0)\n"
+                 "#define %s_COUNT_MAX(counter, value) ((void)0)\n"
+                 "#define %s_dump_counters(file) ((void)0)\n"
+                 "#define %s_reset_counters() ((void)0)\n"
+                 "#endif",
+                 struct_name, struct_name, struct_name,
+                 struct_name, struct_name, struct_name, struct_name);
+}
@@ -0,0 +1,846 @@
+/*
+ Type table and struct layout computation.
+
+ The type table knows the size and alignment of the layer.h primitives
+ and of every struct instantiated so far in the current run, so that
+ templates can make decisions based on the types they are given.
+ It lives in the persistent arena because streaming mode throws away
+ everything else a request allocates.
+ */
+
+/* rounds value up to the next multiple of align (align is a power of 2) */
+#define AlignUp(value, align) (((value) + (align) - 1) & ~((u64)(align) - 1))
+
+internal TypeInfo *
+LookupTypeInfo(TypeTable *type_table, char *type_name)
+{
+    u32 bucket = GetHash(type_name) % type_table->num;
+
+    for (TypeInfo *type_info = type_table->buckets[bucket];
+         type_info;
+         type_info = type_info->next)
+    {
+        if (strcmp(type_info->type_name, type_name) == 0)
+        {
+            return type_info;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ Doubles the number of buckets once the chains get long.
+ Every run instantiates an unbounded number of structs in streaming mode.
+ */
+internal void
+GrowTypeTable(TypeTable *type_table)
+{
+    u32 new_num = type_table->num * 2;
+    TypeInfo **new_buckets =
+        PushSize(&persistent_arena, sizeof(*new_buckets) * new_num);
+
+    for (u32 i = 0; i < type_table->num; ++i)
+    {
+        TypeInfo *type_info = type_table->buckets[i];
+
+        while (type_info)
+        {
+            TypeInfo *next = type_info->next;
+            u32 bucket = GetHash(type_info->type_name) % new_num;
+
+            type_info->next = new_buckets[bucket];
+            new_buckets[bucket] = type_info;
+
+            type_info = next;
+        }
+    }
+
+    type_table->buckets = new_buckets;
+    type_table->num = new_num;
+}
+
+/*
+ Adds a type to the table or updates it if it is already there
+ */
+internal TypeInfo *
+AddTypeInfo(TypeTable *type_table, char *type_name, TypeKind type_kind,
+            b32 is_signed, u64 size, u64 align)
+{
+    TypeInfo *type_info = LookupTypeInfo(type_table, type_name);
+
+    if (type_info == 0)
+    {
+        if (type_table->type_num >= 2 * type_table->num)
+        {
+            GrowTypeTable(type_table);
+        }
+
+        u32 bucket = GetHash(type_name) % type_table->num;
+        ++type_table->type_num;
+
+        type_info = PushSize(&persistent_arena, sizeof(*type_info));
+        type_info->type_name = PushSize(&persistent_arena, strlen(type_name));
+        strcpy(type_info->type_name, type_name);
+
+        type_info->next = type_table->buckets[bucket];
+        type_table->buckets[bucket] = type_info;
+    }
+
+    type_info->type_kind = type_kind;
+    type_info->is_signed = is_signed;
+    type_info->size = size;
+    type_info->align = align;
+    type_info->wire_size = (type_kind == TypeKind_Struct) ? 0 : size;
+    type_info->is_dense = (type_kind != TypeKind_Struct);
+    type_info->has_hash = FALSE;
+
+    return type_info;
+}
+
+/*
+ Creates a type table with the layer.h primitives and
+ the plain C types they are built from
+ */
+internal TypeTable
+GetPrimitiveTypeTable()
+{
+    TypeTable type_table = {0};
+    type_table.num = TYPE_TABLE_BUCKETS;
+    type_table.buckets =
+        PushSize(&persistent_arena, sizeof(*type_table.buckets) * type_table.num);
+
+#define ADD_INTEGER(name, type, is_signed) \
+AddTypeInfo(&type_table, name, TypeKind_Integer, is_signed, \
+sizeof(type), _Alignof(type))
+#define ADD_FLOAT(name, type) \
+AddTypeInfo(&type_table, name, TypeKind_Float, TRUE, \
+sizeof(type), _Alignof(type))
+
+    ADD_INTEGER("s8", s8, TRUE);
+    ADD_INTEGER("s16", s16, TRUE);
+    ADD_INTEGER("s32", s32, TRUE);
+    ADD_INTEGER("s64", s64, TRUE);
+    ADD_INTEGER("u8", u8, FALSE);
+    ADD_INTEGER("u16", u16, FALSE);
+    ADD_INTEGER("u32", u32, FALSE);
+    ADD_INTEGER("u64", u64, FALSE);
+    ADD_INTEGER("b8", b8, FALSE);
+    ADD_INTEGER("b16", b16, FALSE);
+    ADD_INTEGER("b32", b32, FALSE);
+    ADD_INTEGER("b64", b64, FALSE);
+    ADD_FLOAT("f32", f32);
+    ADD_FLOAT("f64", f64);
+
+    ADD_INTEGER("char", char, TRUE);
+    ADD_INTEGER("signed char", signed char, TRUE);
+    ADD_INTEGER("unsigned char", unsigned char, FALSE);
+    ADD_INTEGER("short", short, TRUE);
+    ADD_INTEGER("unsigned short", unsigned short, FALSE);
+    ADD_INTEGER("int", int, TRUE);
+    ADD_INTEGER("unsigned", unsigned, FALSE);
+    ADD_INTEGER("unsigned int", unsigned int, FALSE);
+    ADD_INTEGER("long", long, TRUE);
+    ADD_INTEGER("unsigned long", unsigned long, FALSE);
+    ADD_INTEGER("long long", long long, TRUE);
+    ADD_INTEGER("unsigned long long", unsigned long long, FALSE);
+    ADD_INTEGER("size_t", size_t, FALSE);
+    ADD_INTEGER("int8_t", int8_t, TRUE);
+    ADD_INTEGER("int16_t", int16_t, TRUE);
+    ADD_INTEGER("int32_t", int32_t, TRUE);
+    ADD_INTEGER("int64_t", int64_t, TRUE);
+    ADD_INTEGER("uint8_t", uint8_t, FALSE);
+    ADD_INTEGER("uint16_t", uint16_t, FALSE);
+    ADD_INTEGER("uint32_t", uint32_t, FALSE);
+    ADD_INTEGER("uint64_t", uint64_t, FALSE);
+    ADD_INTEGER("uintptr_t", uintptr_t, FALSE);
+    ADD_INTEGER("intptr_t", intptr_t, TRUE);
+    ADD_FLOAT("float", float);
+    ADD_FLOAT("double", double);
+#undef ADD_INTEGER
+#undef ADD_FLOAT
+
+    return type_table;
+}
+
+/*
+ Gets the type info for a template argument. Arguments ending in *
+ are pointers, everything else has to be in the table.
+ Returns 0 if the type is unknown.
+ */
+internal TypeInfo *
+GetTypeInfo(TypeTable *type_table, char *type_name)
+{
+    local_persist TypeInfo pointer_info = {
+        .type_name = "pointer",
+        .type_kind = TypeKind_Pointer,
+        .is_signed = FALSE,
+        .size = sizeof(void *),
+        .align = _Alignof(void *),
+    };
+
+    u32 type_name_length = strlen(type_name);
+
+    if (type_name_length > 0 && type_name[type_name_length - 1] == '*')
+    {
+        return &pointer_info;
+    }
+
+    return LookupTypeInfo(type_table, type_name);
+}
+
+internal b8
+IsIdentifierChar(char c)
+{
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9') || c == '_');
+}
+
+internal char *
+SkipSpaces(char *at, char *end)
+{
+    while (at < end && (*at == ' ' || *at == '\t' ||
+                        *at == '\n' || *at == '\r'))
+    {
+        ++at;
+    }
+
+    return at;
+}
+
+/*
+ Makes a copy of text with // and block comments replaced by spaces
+ so that the layout parser does not have to know about them
+ */
+internal char *
+CopyWithoutComments(char *text)
+{
+    u64 text_length = strlen(text);
+    char *copy = ArenaAlloc(text_length);
+
+    for (u64 i = 0; i < text_length; ++i)
+    {
+        if (text[i] == '/' && text[i + 1] == '/')
+        {
+            while (i < text_length && text[i] != '\n')
+            {
+                copy[i++] = ' ';
+            }
+            if (i < text_length)
+            {
+                copy[i] = text[i];
+            }
+        }
+        else if (text[i] == '/' && text[i + 1] == '*')
+        {
+            while (i < text_length && !(text[i] == '*' && text[i + 1] == '/'))
+            {
+                copy[i++] = ' ';
+            }
+            if (i < text_length)
+            {
+                copy[i++] = ' ';
+                copy[i] = ' ';
+            }
+        }
+        else
+        {
+            copy[i] = text[i];
+        }
+    }
+
+    return copy;
+}
+
+/*
+ Finds the body of the first struct definition in text.
+ Returns a pointer to the character after the opening brace, or 0.
+ */
+internal char *
+FindStructBody(char *text)
+{
+    char *at = text;
+
+    while ((at = strstr(at, "struct")) != 0)
+    {
+        b8 is_word = ((at == text || !IsIdentifierChar(at[-1])) &&
+                      !IsIdentifierChar(at[6]));
+        at += 6;
+
+        if (!is_word)
+        {
+            continue;
+        }
+
+        char *end = at + strlen(at);
+        at = SkipSpaces(at, end);
+        while (at < end && IsIdentifierChar(*at))
+        {
+            ++at;
+        }
+        at = SkipSpaces(at, end);
+
+        if (*at == '{')
+        {
+            return at + 1;
+        }
+    }
+
+    return 0;
+}
+
+/* checks if a word of a declaration is a qualifier rather than a type */
+internal b8
+IsTypeQualifier(char *word)
+{
+    return (strcmp(word, "const") == 0 ||
+            strcmp(word, "volatile") == 0 ||
+            strcmp(word, "struct") == 0 ||
+            strcmp(word, "union") == 0 ||
+            strcmp(word, "enum") == 0 ||
+            strcmp(word, "restrict") == 0 ||
+            strcmp(word, "_Atomic") == 0);
+}
+
+/*
+ Adds one declarator of a field declaration to the layout.
+ Returns FALSE if the type of the field is unknown.
+ */
+internal b8
+AddStructField(StructLayout *layout, TypeTable *type_table,
+               char *type_name, char *field_name,
+               b32 is_pointer, u64 count, u64 field_align)
+{
+    StructField *field = &layout->fields[layout->field_num++];
+    field->field_name = field_name;
+    field->type_name = type_name;
+    field->is_pointer = is_pointer;
+    field->count = count;
+
+    TypeInfo *type_info = is_pointer ?
+        GetTypeInfo(type_table, "void *") :
+        GetTypeInfo(type_table, type_name);
+
+    if (type_info == 0)
+    {
+        return FALSE;
+    }
+
+    field->size = type_info->size * count;
+    field->align = type_info->align;
+
+    if (field_align > field->align)
+    {
+        field->align = field_align;
+    }
+
+    return TRUE;
+}
+
+/*
+ Parses one field declaration (without the semicolon) such as
+ "T x, y", "Node *next", "f32 e[4][4]" or "alignas(16) f32 x"
+ */
+internal b8
+ParseFieldDeclaration(StructLayout *layout, TypeTable *type_table,
+                      char *start, char *end)
+{
+    char type_name[128] = {0};
+    u64 field_align = 0;
+    b32 has_type = FALSE;
+
+    char *at = start;
+
+    for (;;)
+    {
+        char *words[16];
+        u32 word_num = 0;
+        b32 is_pointer = FALSE;
+        u64 count = 1;
+
+        /* one declarator: words, stars and array bounds up to , or end */
+        while (at < end && *at != ',')
+        {
+            at = SkipSpaces(at, end);
+
+            if (at >= end || *at == ',')
+            {
+                break;
+            }
+
+            if (IsIdentifierChar(*at))
+            {
+                char *word_start = at;
+                while (at < end && IsIdentifierChar(*at))
+                {
+                    ++at;
+                }
+
+                char *word = ArenaAlloc(at - word_start);
+                CopyStringRange(word_start, word, 0, at - word_start);
+
+                char *after = SkipSpaces(at, end);
+                if ((strcmp(word, "alignas") == 0 ||
+                     strcmp(word, "_Alignas") == 0) && *after == '(')
+                {
+                    field_align = strtoull(after + 1, &at, 0);
+                    at = strchr(at, ')');
+                    if (at == 0 || at >= end || field_align == 0)
+                    {
+                        return FALSE;
+                    }
+                    ++at;
+                    continue;
+                }
+
+                if (!IsTypeQualifier(word) && word_num < 16)
+                {
+                    words[word_num++] = word;
+                }
+            }
+            else if (*at == '*')
+            {
+                is_pointer = TRUE;
+                ++at;
+            }
+            else if (*at == '[')
+            {
+                char *number_end = 0;
+                u64 dimension = strtoull(at + 1, &number_end, 0);
+                number_end = SkipSpaces(number_end, end);
+
+                if (*number_end != ']' || dimension == 0)
+                {
+                    return FALSE;
+                }
+
+                count *= dimension;
+                at = number_end + 1;
+            }
+            else if (*at == '(')
+            {
+                /* function pointer: (*name)(args) */
+                char *name_start = at + 1;
+                while (name_start < end && !IsIdentifierChar(*name_start))
+                {
+                    ++name_start;
+                }
+                char *name_end = name_start;
+                while (name_end < end && IsIdentifierChar(*name_end))
+                {
+                    ++name_end;
+                }
+
+                char *word = ArenaAlloc(name_end - name_start);
+                CopyStringRange(name_start, word, 0, name_end - name_start);
+                if (word_num < 16)
+                {
+                    words[word_num++] = word;
+                }
+                is_pointer = TRUE;
+
+                s32 depth = 0;
+                for (; at < end; ++at)
+                {
+                    if (*at == '(')
+                    {
+                        ++depth;
+                    }
+                    else if (*at == ')' && --depth == 0 &&
+                             *SkipSpaces(at + 1, end) != '(')
+                    {
+                        ++at;
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                /* bit fields and anything else are not supported */
+                return FALSE;
+            }
+        }
+
+        if (word_num == 0)
+        {
+            return FALSE;
+        }
+
+        if (!has_type)
+        {
+            /* everything but the last word is the (possibly multi-word) type */
+            if (word_num < 2)
+            {
+                return FALSE;
+            }
+
+            for (u32 i = 0; i < word_num - 1; ++i)
+            {
+                if (i > 0)
+                {
+                    strcat(type_name, " ");
+                }
+                strncat(type_name, words[i],
+                        sizeof(type_name) - strlen(type_name) - 2);
+            }
+            has_type = TRUE;
+        }
+
+        char *field_type_name = ArenaAlloc(strlen(type_name));
+        strcpy(field_type_name, type_name);
+
+        if (!AddStructField(layout, type_table, field_type_name,
+                            words[word_num - 1], is_pointer, count,
+                            field_align))
+        {
+            return FALSE;
+        }
+
+        if (at >= end)
+        {
+            break;
+        }
+        ++at;
+    }
+
+    return TRUE;
+}
+
+/*
+ Computes offsets, size and alignment from the fields in layout
+ in their current order
+ */
+internal void
+ComputeStructLayout(StructLayout *layout)
+{
+    u64 offset = 0;
+    u64 struct_align = 1;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+
+        offset = AlignUp(offset, field->align);
+        field->offset = offset;
+        offset += field->size;
+
+        if (field->align > struct_align)
+        {
+            struct_align = field->align;
+        }
+    }
+
+    layout->align = struct_align;
+    layout->size = AlignUp(offset, struct_align);
+}
+
+/*
+ Parses the first struct definition in text and computes its layout.
+ Returns FALSE if there is no struct or a field type is unknown.
+ */
+internal b8
+GetStructLayout(char *text, TypeTable *type_table, StructLayout *layout)
+{
+    *layout = (StructLayout){0};
+
+    char *code = CopyWithoutComments(text);
+    char *at = FindStructBody(code);
+
+    if (at == 0)
+    {
+        return FALSE;
+    }
+
+    char *end = at + strlen(at);
+
+    u32 max_fields = 1;
+    for (char *c = at; c < end && *c != '}'; ++c)
+    {
+        if (*c == ';' || *c == ',')
+        {
+            ++max_fields;
+        }
+    }
+    layout->fields = AllocArray(sizeof(*layout->fields), max_fields);
+    layout->declarations =
+        AllocArray(sizeof(*layout->declarations), max_fields);
+
+    for (;;)
+    {
+        char *declaration_start = at;
+        at = SkipSpaces(at, end);
+
+        if (at >= end)
+        {
+            return FALSE;
+        }
+
+        if (*at == '}')
+        {
+            break;
+        }
+
+        char *declaration_end = at;
+        while (declaration_end < end && *declaration_end != ';')
+        {
+            if (*declaration_end == '{' || *declaration_end == '}')
+            {
+                /* nested struct or union definitions are not supported */
+                return FALSE;
+            }
+            ++declaration_end;
+        }
+
+        StructDeclaration *declaration =
+            &layout->declarations[layout->declaration_num++];
+        declaration->start = declaration_start - code;
+        declaration->end = declaration_end + 1 - code;
+        declaration->first_field = layout->field_num;
+
+        if (declaration_end >= end ||
+            !ParseFieldDeclaration(layout, type_table, at, declaration_end))
+        {
+            return FALSE;
+        }
+
+        declaration->field_num = layout->field_num - declaration->first_field;
+        for (u32 i = declaration->first_field; i < layout->field_num; ++i)
+        {
+            if (layout->fields[i].align > declaration->align)
+            {
+                declaration->align = layout->fields[i].align;
+            }
+        }
+
+        /* a comment after the semicolon stays with its declaration */
+        at = declaration_end + 1;
+        while (at < end && (*at == ' ' || *at == '\t' || *at == '\r'))
+        {
+            ++at;
+        }
+        if (*at != '\n')
+        {
+            at = declaration_end + 1;
+        }
+        declaration->end = at - code;
+    }
+
+    if (layout->field_num == 0)
+    {
+        return FALSE;
+    }
+
+    ComputeStructLayout(layout);
+
+    return TRUE;
+}
+
+/*
+ Checks that the fields fill the whole struct, so there is no padding
+ in it or in the structs nested in it
+ */
+internal b32
+IsDenseLayout(StructLayout *layout, TypeTable *type_table)
+{
+    u64 size = 0;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *type_info = field->is_pointer ?
+            0 : GetTypeInfo(type_table, field->type_name);
+
+        if (type_info && type_info->type_kind == TypeKind_Struct &&
+            !type_info->is_dense)
+        {
+            return FALSE;
+        }
+
+        size += field->size;
+    }
+
+    return (size == layout->size);
+}
+
+/*
+ Orders the declarations of a struct by descending alignment, keeping
+ the written order among equal alignments. Whole declarations move so
+ that "T x, y, z;" stays one line.
+ */
+internal void
+GetPackedOrder(StructLayout *layout, u32 *order)
+{
+    for (u32 i = 0; i < layout->declaration_num; ++i)
+    {
+        u32 j = i;
+        for (; j > 0 &&
+             layout->declarations[order[j - 1]].align <
+             layout->declarations[i].align;
+             --j)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+}
+
+/*
+ Rearranges fields and declarations into the given order and
+ recomputes the offsets. The old arrays are left untouched so a
+ copy of a layout can be reordered without affecting the original.
+ */
+internal void
+ReorderStructLayout(StructLayout *layout, u32 *order)
+{
+    StructField *fields = AllocArray(sizeof(*fields), layout->field_num);
+    StructDeclaration *declarations =
+        AllocArray(sizeof(*declarations), layout->declaration_num);
+    u32 field_num = 0;
+
+    for (u32 i = 0; i < layout->declaration_num; ++i)
+    {
+        StructDeclaration declaration = layout->declarations[order[i]];
+
+        memcpy(fields + field_num, layout->fields + declaration.first_field,
+               sizeof(*fields) * declaration.field_num);
+
+        declaration.first_field = field_num;
+        declarations[i] = declaration;
+        field_num += declaration.field_num;
+    }
+
+    layout->fields = fields;
+    layout->declarations = declarations;
+    ComputeStructLayout(layout);
+}
+
+/*
+ Implements @packed_order: moves the field declarations of the struct
+ at the start of buffer into descending alignment order and appends a
+ _Static_assert on the resulting size, so the compiler checks that it
+ agrees with the generator.
+ */
+internal void
+PackStructFields(StreamBuffer *buffer, StructLayout *layout,
+                 char *struct_name)
+{
+    u32 *order = AllocArray(sizeof(*order), layout->declaration_num);
+    GetPackedOrder(layout, order);
+
+    u64 body_start = layout->declarations[0].start;
+    u64 body_end = layout->declarations[layout->declaration_num - 1].end;
+    char *body = ArenaAlloc(body_end - body_start);
+    memcpy(body, buffer->data + body_start, body_end - body_start);
+
+    /* the declarations only change places, so this is done in place */
+    u64 write_at = body_start;
+    for (u32 i = 0; i < layout->declaration_num; ++i)
+    {
+        StructDeclaration *declaration = &layout->declarations[order[i]];
+        u64 length = declaration->end - declaration->start;
+
+        memcpy(buffer->data + write_at,
+               body + declaration->start - body_start, length);
+        write_at += length;
+    }
+
+    ReorderStructLayout(layout, order);
+
+    while (buffer->size > 0 && buffer->data[buffer->size - 1] == '\n')
+    {
+        --buffer->size;
+    }
+
+    char assertion[256];
+    s32 length = snprintf(assertion, sizeof(assertion),
+                          "\n_Static_assert(sizeof(%s) == %llu, "
+                          "\"unexpected size of %s\");\n\n",
+                          struct_name, (unsigned long long)layout->size,
+                          struct_name);
+    AppendStreamBuffer(buffer, assertion, length);
+}
+
+/* checks if bytes [offset, offset + size) touch more than one cache line */
+internal b8
+StraddlesCacheLine(u64 offset, u64 size)
+{
+    return (size > 0 &&
+            offset / CACHE_LINE_SIZE != (offset + size - 1) / CACHE_LINE_SIZE);
+}
+
+/*
+ Writes size, alignment, padding and cache line use of one
+ instantiation for --layout-report
+ */
+internal void
+WriteLayoutReport(FILE *file, char *struct_name, StructLayout *layout)
+{
+    u64 padding = layout->size;
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        padding -= layout->fields[i].size;
+    }
+
+    fprintf(file, "%s: size %llu, align %llu, padding %llu (%.1f%%)\n",
+            struct_name, (unsigned long long)layout->size,
+            (unsigned long long)layout->align, (unsigned long long)padding,
+            100.0 * padding / layout->size);
+    fprintf(file, "    %8s %8s %6s %6s  %s\n",
+            "offset", "size", "align", "pad", "field");
+
+    u64 end = 0;
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+
+        fprintf(file, "    %8llu %8llu %6llu %6llu  %s %s%s",
+                (unsigned long long)field->offset,
+                (unsigned long long)field->size,
+                (unsigned long long)field->align,
+                (unsigned long long)(field->offset - end),
+                field->type_name, field->is_pointer ? "*" : "",
+                field->field_name);
+
+        if (field->count > 1)
+        {
+            fprintf(file, "[%llu]", (unsigned long long)field->count);
+        }
+        if (field->size <= CACHE_LINE_SIZE &&
+            StraddlesCacheLine(field->offset, field->size))
+        {
+            fprintf(file, "  <- straddles a cache line");
+        }
+        fprintf(file, "\n");
+
+        end = field->offset + field->size;
+    }
+
+    if (layout->size > end)
+    {
+        fprintf(file, "    %8llu %8s %6s %6llu  (tail padding)\n",
+                (unsigned long long)end, "", "",
+                (unsigned long long)(layout->size - end));
+    }
+
+    if (layout->size < CACHE_LINE_SIZE && CACHE_LINE_SIZE % layout->size != 0)
+    {
+        fprintf(file, "    array elements straddle cache lines\n");
+    }
+
+    if (layout->declaration_num > 1)
+    {
+        StructLayout packed = *layout;
+        u32 *order = AllocArray(sizeof(*order), packed.declaration_num);
+
+        GetPackedOrder(&packed, order);
+        ReorderStructLayout(&packed, order);
+
+        if (packed.size < layout->size)
+        {
+            fprintf(file, "    @packed_order would save %llu bytes\n",
+                    (unsigned long long)(layout->size - packed.size));
+        }
+    }
+
+    fprintf(file, "\n");
+}
@@ -0,0 +1,308 @@
+/*
+ Binary serialization for @serialize.
+
+ Every instantiation of a template with a @serialize line gets a table
+ of its fields and functions that write it to and read it from bytes.
+ The serialized form is the fields in declaration order, without
+ padding, numbers little-endian. A struct without padding whose fields
+ are numbers or such structs already has that form in memory on a
+ little-endian machine, so it is copied with one memcpy there; every
+ other struct is written field by field. The prelude decides which at
+ compile time.
+ */
+
+internal void
+WriteSerializePrelude(StreamBuffer *buffer)
+{
+    AppendString(buffer,
+                 "#ifndef GEN_SERIALIZE_PRELUDE\n"
+                 "#define GEN_SERIALIZE_PRELUDE\n"
+                 "#include <stddef.h>\n"
+                 "#include <string.h>\n"
+                 "\n"
+                 "#if defined(__BYTE_ORDER__) && "
+                 "__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__\n"
+                 "#define GEN_LITTLE_ENDIAN 1\n"
+                 "#elif defined(_WIN32)\n"
+                 "#define GEN_LITTLE_ENDIAN 1\n"
+                 "#else\n"
+                 "#define GEN_LITTLE_ENDIAN 0\n"
+                 "#endif\n"
+                 "\n"
+                 "/* one field of a serializable struct */\n"
+                 "typedef struct GenFieldInfo\n"
+                 "{\n"
+                 "    char *name;\n"
+                 "    char *type_name;\n"
+                 "    /* where the field starts in the struct and in the bytes */\n"
+                 "    u64 offset;\n"
+                 "    u64 wire_offset;\n"
+                 "    /* size of one element and number of elements */\n"
+                 "    u64 size;\n"
+                 "    u64 count;\n"
+                 "} GenFieldInfo;\n"
+                 "\n"
+                 "/*\n"
+                 " Copies count numbers of size bytes between memory and their\n"
+                 " little-endian form. The byte loops compile to plain loads and\n"
+                 " stores on little-endian machines and to byte swaps elsewhere.\n"
+                 " */\n"
+                 "static inline void\n"
+                 "GenStoreLittleEndian(u8 *to, u8 *from, u64 size, u64 count)\n"
+                 "{\n"
+                 "    for (u64 i = 0; i < count; ++i, to += size, from += size)\n"
+                 "    {\n"
+                 "        u64 bits = 0;\n"
+                 "        switch (size)\n"
+                 "        {\n"
+                 "            case 1: { u8 x; memcpy(&x, from, 1); bits = x; } break;\n"
+                 "            case 2: { u16 x; memcpy(&x, from, 2); bits = x; } break;\n"
+                 "            case 4: { u32 x; memcpy(&x, from, 4); bits = x; } break;\n"
+                 "            default: { memcpy(&bits, from, 8); } break;\n"
+                 "        }\n"
+                 "        for (u64 byte = 0; byte < size; ++byte)\n"
+                 "        {\n"
+                 "            to[byte] = (u8)(bits >> (8 * byte));\n"
+                 "        }\n"
+                 "    }\n"
+                 "}\n"
+                 "\n"
+                 "static inline void\n"
+                 "GenLoadLittleEndian(u8 *to, u8 *from, u64 size, u64 count)\n"
+                 "{\n"
+                 "    for (u64 i = 0; i < count; ++i, to += size, from += size)\n"
+                 "    {\n"
+                 "        u64 bits = 0;\n"
+                 "        for (u64 byte = 0; byte < size; ++byte)\n"
+                 "        {\n"
+                 "            bits |= (u64)from[byte] << (8 * byte);\n"
+                 "        }\n"
+                 "        switch (size)\n"
+                 "        {\n"
+                 "            case 1: { u8 x = (u8)bits; memcpy(to, &x, 1); } break;\n"
+                 "            case 2: { u16 x = (u16)bits; memcpy(to, &x, 2); } break;\n"
+                 "            case 4: { u32 x = (u32)bits; memcpy(to, &x, 4); } break;\n"
+                 "            default: { memcpy(to, &bits, 8); } break;\n"
+                 "        }\n"
+                 "    }\n"
+                 "}\n"
+                 "#endif\n\n");
+}
+
+/*
+ Checks that every field can be serialized and computes the
+ serialized size. Returns 0 and reports the field that can't.
+ */
+internal u64
+GetWireSize(char *struct_name, StructLayout *layout, TypeTable *type_table)
+{
+    u64 wire_size = 0;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *type_info = field->is_pointer ?
+            0 : GetTypeInfo(type_table, field->type_name);
+
+        if (type_info == 0 || type_info->wire_size == 0)
+        {
+            fprintf(stderr, "@serialize: field %s of %s is a pointer or "
+                    "a struct without @serialize\n",
+                    field->field_name, struct_name);
+            return 0;
+        }
+
+        wire_size += type_info->wire_size * field->count;
+    }
+
+    return wire_size;
+}
+
+/* one statement per field that converts between value and buffer */
+internal void
+AppendFieldCopies(StreamBuffer *buffer, char *struct_name,
+                  StructLayout *layout, TypeTable *type_table, b8 store)
+{
+    u64 wire_offset = 0;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *type_info = GetTypeInfo(type_table, field->type_name);
+        u64 element_size = field->size / field->count;
+
+        if (type_info->type_kind == TypeKind_Struct && field->count == 1)
+        {
+            AppendFormat(buffer,
+                         "    %s_%s((%s *)(memory + offsetof(%s, %s)), buffer + %llu);\n",
+                         field->type_name, store ? "serialize" : "deserialize",
+                         field->type_name, struct_name, field->field_name,
+                         (unsigned long long)wire_offset);
+        }
+        else if (type_info->type_kind == TypeKind_Struct)
+        {
+            AppendFormat(buffer,
+                         "    for (u64 i = 0; i < %llu; ++i)\n"
+                         "    {\n"
+                         "        %s_%s((%s *)(memory + offsetof(%s, %s)) + i,\n"
+                         "            buffer + %llu + i * %llu);\n"
+                         "    }\n",
+                         (unsigned long long)field->count,
+                         field->type_name, store ? "serialize" : "deserialize",
+                         field->type_name, struct_name, field->field_name,
+                         (unsigned long long)wire_offset,
+                         (unsigned long long)type_info->wire_size);
+        }
+        else if (store)
+        {
+            AppendFormat(buffer,
+                         "    GenStoreLittleEndian(buffer + %llu, "
+                         "memory + offsetof(%s, %s), %llu, %llu);\n",
+                         (unsigned long long)wire_offset, struct_name,
+                         field->field_name, (unsigned long long)element_size,
+                         (unsigned long long)field->count);
+        }
+        else
+        {
+            AppendFormat(buffer,
+                         "    GenLoadLittleEndian(memory + offsetof(%s, %s), "
+                         "buffer + %llu, %llu, %llu);\n",
+                         struct_name, field->field_name,
+                         (unsigned long long)wire_offset,
+                         (unsigned long long)element_size,
+                         (unsigned long long)field->count);
+        }
+
+        wire_offset += type_info->wire_size * field->count;
+    }
+}
+
+/*
+ Writes the field table and the serialize functions of an
+ instantiation. Returns the serialized size, 0 if a field can't be
+ serialized, in which case nothing is written.
+ */
+internal u64
+WriteSerialize(StreamBuffer *buffer, char *struct_name,
+               StructLayout *layout, TypeTable *type_table)
+{
+    u64 wire_size = GetWireSize(struct_name, layout, type_table);
+    if (wire_size == 0)
+    {
+        return 0;
+    }
+
+    /* no padding anywhere, so memory already is the serialized form */
+    b8 is_plain = (wire_size == layout->size);
+
+    AppendFormat(buffer, "#define %s_WIRE_SIZE %llu\n\n",
+                 struct_name, (unsigned long long)wire_size);
+
+    AppendFormat(buffer,
+                 "static inline GenFieldInfo *\n"
+                 "%s_fields(u32 *field_num)\n{\n"
+                 "    static GenFieldInfo fields[] =\n"
+                 "    {\n",
+                 struct_name);
+
+    u64 wire_offset = 0;
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *type_info = GetTypeInfo(type_table, field->type_name);
+
+        AppendFormat(buffer,
+                     "        {\"%s\", \"%s\", offsetof(%s, %s), %llu, %llu, %llu},\n",
+                     field->field_name, field->type_name, struct_name,
+                     field->field_name, (unsigned long long)wire_offset,
+                     (unsigned long long)(field->size / field->count),
+                     (unsigned long long)field->count);
+
+        wire_offset += type_info->wire_size * field->count;
+    }
+
+    AppendFormat(buffer,
+                 "    };\n"
+                 "    *field_num = %u;\n"
+                 "    return fields;\n}\n\n",
+                 layout->field_num);
+
+    /* serialize */
+    AppendFormat(buffer,
+                 "/* writes %s_WIRE_SIZE bytes */\n"
+                 "static inline void\n"
+                 "%s_serialize(%s *value, u8 *buffer)\n{\n",
+                 struct_name, struct_name, struct_name);
+    if (is_plain)
+    {
+        AppendString(buffer,
+                     "#if GEN_LITTLE_ENDIAN\n"
+                     "    memcpy(buffer, value, sizeof(*value));\n"
+                     "#else\n");
+    }
+    AppendString(buffer, "    u8 *memory = (u8 *)value;\n");
+    AppendFieldCopies(buffer, struct_name, layout, type_table, TRUE);
+    if (is_plain)
+    {
+        AppendString(buffer, "#endif\n");
+    }
+    AppendString(buffer, "}\n\n");
+
+    /* deserialize */
+    AppendFormat(buffer,
+                 "static inline void\n"
+                 "%s_deserialize(%s *value, u8 *buffer)\n{\n",
+                 struct_name, struct_name);
+    if (is_plain)
+    {
+        AppendString(buffer,
+                     "#if GEN_LITTLE_ENDIAN\n"
+                     "    memcpy(value, buffer, sizeof(*value));\n"
+                     "#else\n");
+    }
+    AppendString(buffer, "    u8 *memory = (u8 *)value;\n");
+    AppendFieldCopies(buffer, struct_name, layout, type_table, FALSE);
+    if (is_plain)
+    {
+        AppendString(buffer, "#endif\n");
+    }
+    AppendString(buffer, "}\n\n");
+
+    /* arrays, one memcpy for the whole run when there is no padding */
+    char *directions[2][3] = {
+        {"serialize", "memcpy(buffer, values, count * sizeof(*values));",
+         "%s_serialize(&values[i], buffer + i * %llu);"},
+        {"deserialize", "memcpy(values, buffer, count * sizeof(*values));",
+         "%s_deserialize(&values[i], buffer + i * %llu);"},
+    };
+
+    for (u32 direction = 0; direction < 2; ++direction)
+    {
+        AppendFormat(buffer,
+                     "static inline void\n"
+                     "%s_%s_array(%s *values, u64 count, u8 *buffer)\n{\n",
+                     struct_name, directions[direction][0], struct_name);
+        if (is_plain)
+        {
+            AppendFormat(buffer,
+                         "#if GEN_LITTLE_ENDIAN\n"
+                         "    %s\n"
+                         "#else\n",
+                         directions[direction][1]);
+        }
+        AppendString(buffer,
+                     "    for (u64 i = 0; i < count; ++i)\n"
+                     "    {\n"
+                     "        ");
+        AppendFormat(buffer, directions[direction][2],
+                     struct_name, (unsigned long long)wire_size);
+        AppendString(buffer, "\n    }\n");
+        if (is_plain)
+        {
+            AppendString(buffer, "#endif\n");
+        }
+        AppendString(buffer, "}\n\n");
+    }
+
+    return wire_size;
+}
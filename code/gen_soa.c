@@ -0,0 +1,177 @@
+/*
+ Struct-of-arrays generation for @template_soa.
+
+ The fields come from the layout of the ordinary instantiation, so the
+ SoA type always matches the template body. Every field becomes its own
+ cache-line aligned array sharing one count and capacity, and the
+ generated functions convert between the two forms.
+ */
+
+/* alignment of every generated array, one cache line */
+#define SOA_ALIGNMENT 64
+
+/*
+ Writes the declaration of a field as an array: "f32 x" becomes
+ "f32 *x" and "f32 m[4]" becomes "f32 (*m)[4]"
+ */
+internal void
+AppendSoAField(StreamBuffer *buffer, StructField *field)
+{
+    char *pointer = field->is_pointer ? "*" : "";
+
+    if (field->count > 1)
+    {
+        AppendFormat(buffer, "    %s %s(*%s)[%llu];\n",
+                     field->type_name, pointer, field->field_name,
+                     (unsigned long long)field->count);
+    }
+    else
+    {
+        AppendFormat(buffer, "    %s %s*%s;\n",
+                     field->type_name, pointer, field->field_name);
+    }
+}
+
+/*
+ Writes one statement per field. Every %s in the statement is the
+ field name. Array fields can't be assigned and use copy instead.
+ */
+internal void
+AppendSoAFieldLoop(StreamBuffer *buffer, StructLayout *layout,
+                   char *assign, char *copy)
+{
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+
+        char *name = field->field_name;
+        AppendFormat(buffer, (field->count > 1) ? copy : assign,
+                     name, name, name, name);
+    }
+}
+
+internal void
+WriteSoAToBuffer(StreamBuffer *buffer, char *soa_name, char *aos_name,
+                 StructLayout *layout)
+{
+    AppendFormat(buffer, "typedef struct %s %s;\n", soa_name, soa_name);
+    AppendFormat(buffer, "struct %s\n{\n", soa_name);
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        AppendSoAField(buffer, &layout->fields[i]);
+    }
+    AppendString(buffer, "    u64 count;\n    u64 capacity;\n};\n\n");
+
+    /* free */
+    AppendFormat(buffer, "static inline void\n%s_free(%s *soa)\n{\n",
+                 soa_name, soa_name);
+    AppendSoAFieldLoop(buffer, layout,
+                       "    free(soa->%s);\n", "    free(soa->%s);\n");
+    AppendFormat(buffer, "    *soa = (%s){0};\n}\n\n", soa_name);
+
+    /* reserve: every array is reallocated with the same capacity */
+    AppendFormat(buffer,
+                 "/* capacity is rounded up to whole cache lines per array */\n"
+                 "static inline b32\n"
+                 "%s_reserve(%s *soa, u64 capacity)\n{\n"
+                 "    if (capacity <= soa->capacity)\n"
+                 "    {\n"
+                 "        return 1;\n"
+                 "    }\n"
+                 "    capacity = (capacity + %d) & ~(u64)%d;\n\n"
+                 "    %s grown = {0};\n"
+                 "    grown.count = soa->count;\n"
+                 "    grown.capacity = capacity;\n",
+                 soa_name, soa_name,
+                 SOA_ALIGNMENT - 1, SOA_ALIGNMENT - 1, soa_name);
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        char *name = layout->fields[i].field_name;
+        AppendFormat(buffer,
+                     "    grown.%s = aligned_alloc(%d, capacity * sizeof(*grown.%s));\n",
+                     name, SOA_ALIGNMENT, name);
+    }
+    AppendString(buffer, "\n    if (");
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        AppendFormat(buffer, "%s!grown.%s", (i > 0) ? " || " : "",
+                     layout->fields[i].field_name);
+    }
+    AppendFormat(buffer, ")\n    {\n        %s_free(&grown);\n"
+                 "        return 0;\n    }\n\n", soa_name);
+    AppendString(buffer, "    if (soa->count > 0)\n    {\n");
+    AppendSoAFieldLoop(buffer, layout,
+                       "        memcpy(grown.%s, soa->%s, "
+                       "soa->count * sizeof(*soa->%s));\n",
+                       "        memcpy(grown.%s, soa->%s, "
+                       "soa->count * sizeof(*soa->%s));\n");
+    AppendFormat(buffer, "    }\n    %s_free(soa);\n    *soa = grown;\n"
+                 "    return 1;\n}\n\n", soa_name);
+
+    /* push */
+    AppendFormat(buffer,
+                 "static inline b32\n"
+                 "%s_push(%s *soa, %s value)\n{\n"
+                 "    if (soa->count == soa->capacity &&\n"
+                 "        !%s_reserve(soa, 2 * soa->capacity + 1))\n"
+                 "    {\n"
+                 "        return 0;\n"
+                 "    }\n\n",
+                 soa_name, soa_name, aos_name, soa_name);
+    AppendSoAFieldLoop(buffer, layout,
+                       "    soa->%s[soa->count] = value.%s;\n",
+                       "    memcpy(soa->%s[soa->count], value.%s, "
+                       "sizeof(value.%s));\n");
+    AppendString(buffer, "    ++soa->count;\n    return 1;\n}\n\n");
+
+    /* get */
+    AppendFormat(buffer,
+                 "static inline %s\n"
+                 "%s_get(%s *soa, u64 index)\n{\n"
+                 "    %s value;\n",
+                 aos_name, soa_name, soa_name, aos_name);
+    AppendSoAFieldLoop(buffer, layout,
+                       "    value.%s = soa->%s[index];\n",
+                       "    memcpy(value.%s, soa->%s[index], "
+                       "sizeof(value.%s));\n");
+    AppendString(buffer, "    return value;\n}\n\n");
+
+    /* AoS -> SoA, one field at a time so each loop streams one array */
+    AppendFormat(buffer,
+                 "static inline b32\n"
+                 "%s_from_aos(%s *soa, %s *aos, u64 count)\n{\n"
+                 "    if (!%s_reserve(soa, count))\n"
+                 "    {\n"
+                 "        return 0;\n"
+                 "    }\n\n",
+                 soa_name, soa_name, aos_name, soa_name);
+    AppendSoAFieldLoop(buffer, layout,
+                       "    for (u64 i = 0; i < count; ++i)\n"
+                       "    {\n"
+                       "        soa->%s[i] = aos[i].%s;\n"
+                       "    }\n",
+                       "    for (u64 i = 0; i < count; ++i)\n"
+                       "    {\n"
+                       "        memcpy(soa->%s[i], aos[i].%s, "
+                       "sizeof(aos[i].%s));\n"
+                       "    }\n");
+    AppendString(buffer, "    soa->count = count;\n    return 1;\n}\n\n");
+
+    /* SoA -> AoS, aos has room for soa->count elements */
+    AppendFormat(buffer,
+                 "static inline void\n"
+                 "%s_to_aos(%s *soa, %s *aos)\n{\n",
+                 soa_name, soa_name, aos_name);
+    AppendSoAFieldLoop(buffer, layout,
+                       "    for (u64 i = 0; i < soa->count; ++i)\n"
+                       "    {\n"
+                       "        aos[i].%s = soa->%s[i];\n"
+                       "    }\n",
+                       "    for (u64 i = 0; i < soa->count; ++i)\n"
+                       "    {\n"
+                       "        memcpy(aos[i].%s, soa->%s[i], "
+                       "sizeof(aos[i].%s));\n"
+                       "    }\n");
+    AppendString(buffer, "}\n\n");
+}
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdarg.h>
 
 #include "layer.h"
 #include "gen_struct.h"
@@ -14,17 +15,50 @@
 #include "win32/win32_platform.c"
 #elif __linux__
 #include "linux/linux_platform.c"
+#include "linux/linux_io_uring.c"
+#define GEN_IO_URING
 #endif
 
 /* utility macro for getting the range between two indices */
 #define GetRange(start, end) (end - start)
 
+/* size of each read when streaming input */
+#define STREAM_CHUNK_SIZE kilobytes(64)
+
+/* number of hash buckets when the template count is not known up front */
+#define STREAM_TEMPLATE_BUCKETS 256
+
 /* utility macro for allocating array */
 #define AllocArray(size, array_num) \
 ArenaAlloc(size * array_num)
 
 global MemoryArena arena = {0};
+/*
+ holds tables that have to outlive a single request in streaming mode,
+ where everything else a request allocates is thrown away
+ */
+global MemoryArena persistent_arena = {0};
 global char file_ext[16];
+global TypeTable type_table = {0};
+global InstantiationTable instantiation_table = {0};
+/*
+ every template is expanded here before it is written out,
+ one buffer per level of nested instantiation
+ */
+global StreamBuffer expand_buffers[MAX_INSTANTIATION_DEPTH] = {0};
+global u32 expand_depth = 0;
+/* templates that failed to expand, the run then exits with an error */
+global u32 expand_error_num = 0;
+/* @template_soa output needs stdlib.h and string.h once per output */
+global b32 soa_includes_written = FALSE;
+/* the @vec_math prelude with the intrinsics headers, once per output */
+global b32 vec_math_prelude_written = FALSE;
+/* the @serialize prelude with the byte order helpers, once per output */
+global b32 serialize_prelude_written = FALSE;
+/* the @hash prelude with the mixing functions, once per output */
+global b32 hash_prelude_written = FALSE;
+/* where --layout-report writes, 0 if it was not requested */
+global FILE *layout_report_file = 0;
 
 /* djb2 hash function for string hashing */
 internal u64
@@ -40,56 +74,157 @@ GetHash(char *str)
 	return hash;
 }
 
-/* initializes global arena for program use */
 internal void
-InitArena(u32 size)
+InitMemoryArena(MemoryArena *memory_arena, u64 size)
 {
     void *memory = RequestMem(size);
     VOID_CHECK(memory);
     
-	arena.memory = memory;
-	arena.size = size;
-	arena.size_left = size;
+	memory_arena->memory = memory;
+	memory_arena->size = size;
+	memory_arena->size_left = size;
+	memory_arena->offset = 0;
 }
 
 internal void
-FreeArena()
+FreeMemoryArena(MemoryArena *memory_arena)
 {
-    FreeMem(arena.memory, arena.size);
+    FreeMem(memory_arena->memory, memory_arena->size);
     
-    arena.memory = 0;
-	arena.size = 0;
-	arena.size_left = 0;
+    memory_arena->memory = 0;
+	memory_arena->size = 0;
+	memory_arena->size_left = 0;
+	memory_arena->offset = 0;
+}
+
+/* initializes global arenas for program use */
+internal void
+InitArena(u64 size)
+{
+    InitMemoryArena(&arena, size);
+    InitMemoryArena(&persistent_arena, size);
+}
+
+internal void
+FreeArena()
+{
+    FreeMemoryArena(&arena);
+    FreeMemoryArena(&persistent_arena);
 }
 
 /*
-allocates specified amount of memory and
+allocates specified amount of memory from a given arena and
 returns a pointer to the start of the memory
 */
 internal void *
-ArenaAlloc(u32 size)
+PushSize(MemoryArena *memory_arena, u64 size)
 {
 	++size;
     
 	void *result = 0;
     
-	assert(arena.size_left >= size);
+	assert(memory_arena->size_left >= size);
     
-	result = &((cast(arena.memory, char *))[arena.offset]);
+	result = &((cast(memory_arena->memory, char *))[memory_arena->offset]);
     
-	arena.offset += size;
-	arena.size_left -= size;
+	memory_arena->offset += size;
+	memory_arena->size_left -= size;
 	memset(result, 0, size);
     
 	return result;
 }
 
-/* resets arena offset but does not zero memory */
+/*
+allocates specified amount of memory and
+returns a pointer to the start of the memory
+*/
+internal void *
+ArenaAlloc(u64 size)
+{
+    return PushSize(&arena, size);
+}
+
+/* resets arena offsets but does not zero memory */
 internal void
 ClearArena()
 {
     arena.size_left = arena.size;
     arena.offset = 0;
+    
+    persistent_arena.size_left = persistent_arena.size;
+    persistent_arena.offset = 0;
+}
+
+/*
+ saves the arena offset so that everything allocated after this
+ can be thrown away with EndTemporaryMemory
+ */
+internal TemporaryMemory
+BeginTemporaryMemory(MemoryArena *memory_arena)
+{
+    TemporaryMemory temp_memory = {0};
+    temp_memory.arena = memory_arena;
+    temp_memory.offset = memory_arena->offset;
+    
+    return temp_memory;
+}
+
+/* restores the arena offset saved by BeginTemporaryMemory */
+internal void
+EndTemporaryMemory(TemporaryMemory temp_memory)
+{
+    MemoryArena *memory_arena = temp_memory.arena;
+    
+    assert(memory_arena->offset >= temp_memory.offset);
+    
+    memory_arena->size_left += memory_arena->offset - temp_memory.offset;
+    memory_arena->offset = temp_memory.offset;
+}
+
+/*
+ Appends a range of bytes to a stream buffer, doubling
+ the capacity when needed. Always keeps the data null-terminated.
+ */
+internal void
+AppendStreamBuffer(StreamBuffer *buffer, char *data, u64 size)
+{
+    if (buffer->size + size + 1 > buffer->capacity)
+    {
+        u64 new_capacity = (buffer->capacity == 0) ?
+            STREAM_CHUNK_SIZE : buffer->capacity;
+        
+        while (buffer->size + size + 1 > new_capacity)
+        {
+            new_capacity *= 2;
+        }
+        
+        char *new_data = RequestMem(new_capacity);
+        VOID_CHECK(new_data);
+        
+        if (buffer->data)
+        {
+            memcpy(new_data, buffer->data, buffer->size);
+            FreeMem(buffer->data, buffer->capacity);
+        }
+        
+        buffer->data = new_data;
+        buffer->capacity = new_capacity;
+    }
+    
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    buffer->data[buffer->size] = '\0';
+}
+
+internal void
+FreeStreamBuffer(StreamBuffer *buffer)
+{
+    if (buffer->data)
+    {
+        FreeMem(buffer->data, buffer->capacity);
+    }
+    
+    *buffer = (StreamBuffer){0};
 }
 
 /* copies a specific range of input_string */
@@ -107,6 +242,8 @@ CopyStringRange(char *input_string, char *output_string,
 	output_string[string_length] = '\0';
 }
 
+#include "gen_layout.c"
+
 /*
  debug printing for tokenizer
  prints token type to specified FILE pointer.
@@ -125,6 +262,15 @@ fprintf(file, "%s: ", #token_const);                      \
         
         TOKEN_PRINT_CASE(Token_Template);
         TOKEN_PRINT_CASE(Token_TemplateStart);
+        TOKEN_PRINT_CASE(Token_TemplateSpecialize);
+        TOKEN_PRINT_CASE(Token_TemplateFunction);
+        TOKEN_PRINT_CASE(Token_PackedOrder);
+        TOKEN_PRINT_CASE(Token_TemplateSoA);
+        TOKEN_PRINT_CASE(Token_VecMath);
+        TOKEN_PRINT_CASE(Token_Variant);
+        TOKEN_PRINT_CASE(Token_Serialize);
+        TOKEN_PRINT_CASE(Token_Hash);
+        TOKEN_PRINT_CASE(Token_Instrument);
         TOKEN_PRINT_CASE(Token_TemplateEnd);
         TOKEN_PRINT_CASE(Token_TemplateTypeName);
         TOKEN_PRINT_CASE(Token_TemplateType);
@@ -141,6 +287,12 @@ fprintf(file, "%s: ", #token_const);                      \
         TOKEN_PRINT_CASE(Token_Semicolon);
         TOKEN_PRINT_CASE(Token_EndOfFile);
         TOKEN_PRINT_CASE(Token_FeedSymbol);
+        TOKEN_PRINT_CASE(Token_Comma);
+        TOKEN_PRINT_CASE(Token_SquareOpen);
+        TOKEN_PRINT_CASE(Token_SquareClose);
+        TOKEN_PRINT_CASE(Token_If);
+        TOKEN_PRINT_CASE(Token_Else);
+        TOKEN_PRINT_CASE(Token_EndIf);
 #undef TOKEN_PRINT_CASE
         default:
         {
@@ -258,822 +410,2471 @@ GetTokenizerAt(Tokenizer *tokenizer)
 }
 
 
-/*
- Writes contents of a template to specified file
- */
 internal void
-WriteTemplateToFile(Template *templates, FILE *file)
+AppendString(StreamBuffer *buffer, char *string)
+{
+    AppendStreamBuffer(buffer, string, strlen(string));
+}
+
+/* formats into arena memory of exactly the needed size */
+internal char *
+ArenaFormatV(char *format, va_list args)
 {
-    ResetTokenizer(&templates->tokenizer);
+    va_list size_args;
+    va_copy(size_args, args);
+    s32 length = vsnprintf(0, 0, format, size_args);
+    va_end(size_args);
     
-    do
+    if (length < 0)
     {
-        if (GetTokenizerAt(&templates->tokenizer)->token_type == Token_TemplateStart)
-        {
-            IncrementTokenizerNoWhitespace(&templates->tokenizer);
-            IncrementTokenizerNoWhitespace(&templates->tokenizer);
-            IncrementTokenizerNoWhitespace(&templates->tokenizer);
-            IncrementTokenizerNoWhitespace(&templates->tokenizer);
-        }
-        else if (GetTokenizerAt(&templates->tokenizer)->token_type == Token_TemplateEnd)
-        {
-            break;
-        }
-        
-        fprintf(file, "%s", GetTokenizerAt(&templates->tokenizer)->token_data);
-    } while (IncrementTokenizerAll(&templates->tokenizer));
-    ResetTokenizer(&templates->tokenizer);
+        length = 0;
+    }
+    
+    /* PushSize adds the byte for the terminator */
+    char *text = ArenaAlloc(length);
+    vsnprintf(text, length + 1, format, args);
+    return text;
 }
 
-/*
- Gets the number of templates in a file
- Takes in a tokenized file
- Returns a u32 with the number of templates in file
- */
-internal u32
-GetNumberOfTemplates(Tokenizer *tokenizer)
+internal char *
+ArenaFormat(char *format, ...)
 {
-    u32 count = 0;
+    va_list args;
+    va_start(args, format);
+    char *text = ArenaFormatV(format, args);
+    va_end(args);
     
-    ResetTokenizer(tokenizer);
+    return text;
+}
+
+internal void
+AppendFormat(StreamBuffer *buffer, char *format, ...)
+{
+    char text[1024];
     
-    do
-    {
-        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateEnd)
-        {
-            ++count;
-        }
-    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    va_list args;
+    va_start(args, format);
+    va_list long_args;
+    va_copy(long_args, args);
+    s32 length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
     
-    ResetTokenizer(tokenizer);
-    return count;
+    if (length >= (s32)sizeof(text))
+    {
+        /* rare, the long text goes to the arena instead of being cut */
+        AppendStreamBuffer(buffer, ArenaFormatV(format, long_args), length);
+    }
+    else if (length > 0)
+    {
+        AppendStreamBuffer(buffer, text, length);
+    }
+    va_end(long_args);
 }
 
+#include "gen_instance.c"
+#include "gen_soa.c"
+#include "gen_vec_math.c"
+#include "gen_variant.c"
+#include "gen_serialize.c"
+#include "gen_hash.c"
+#include "gen_instrument.c"
+
 /*
- Gets the template name
- Takes in a tokenizer where the tokens pointer points to the first
- Token in the template
+ Checks if a string is a whole integer literal (decimal, hex or octal)
  */
-internal char *
-GetTemplateName(Tokenizer *tokenizer)
+internal b8
+IsIntegerLiteral(char *string)
 {
-    char *template_name;
+    char *end = 0;
     
-    ResetTokenizer(tokenizer);
+    if (string[0] == '\0')
+    {
+        return FALSE;
+    }
     
-    do
+    strtoll(string, &end, 0);
+    return (*end == '\0');
+}
+
+internal char *
+PeekConditionWord(ConditionExpression *expression)
+{
+    if (expression->at >= expression->word_num)
     {
-        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateName)
-        {
-            template_name = GetTokenizerAt(tokenizer)->token_data;
-            break;
-        }
-    } while (IncrementTokenizerNoWhitespace(tokenizer));
+        return 0;
+    }
     
-    ResetTokenizer(tokenizer);
-    return template_name;
+    return expression->words[expression->at];
 }
 
-/*
- Takes in a template tokenizer and
- Returns the name of template
- */
 internal char *
-GetTemplateTypeName(Tokenizer *tokenizer)
+NextConditionWord(ConditionExpression *expression)
 {
-    char *type_name = 0;
-    ResetTokenizer(tokenizer);
+    char *word = PeekConditionWord(expression);
     
-    do
+    if (word == 0)
     {
-        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateTypeName)
-        {
-            type_name = GetTokenizerAt(tokenizer)->token_data;
-            break;
-        }
-    } while(IncrementTokenizerNoWhitespace(tokenizer));
+        expression->failed = TRUE;
+        return "";
+    }
     
-    ResetTokenizer(tokenizer);
+    ++expression->at;
+    return word;
+}
+
+internal b8
+MatchConditionWord(ConditionExpression *expression, char *word)
+{
+    char *next_word = PeekConditionWord(expression);
+    
+    if (next_word && strcmp(next_word, word) == 0)
+    {
+        ++expression->at;
+        return TRUE;
+    }
     
-    return type_name;
+    return FALSE;
 }
 
-/*
-  Gets struct Template from tokenizer where tokenizer starts at the
- start of the template
+internal s64 EvaluateCondition(ConditionExpression *expression);
 
-TODO (winston): complete this function and maybe implement a more
- versatile usage where the parameter does not have to point to the first
- token in the template.
+/*
+ Evaluates a type query such as size(T) against the type table.
+ Unknown types make the whole condition fail.
  */
-internal Template
-GetTemplateFromTokens(Tokenizer *tokenizer)
+internal s64
+EvaluateTypeQuery(ConditionExpression *expression, char *query)
 {
-    Template template = {0};
+    if (!MatchConditionWord(expression, "("))
+    {
+        expression->failed = TRUE;
+        return 0;
+    }
     
-    template.template_name = GetTemplateName(tokenizer);
-    template.template_type_name = GetTemplateTypeName(tokenizer);
+    char *type_name = NextConditionWord(expression);
     
-    Tokenizer template_tokenizer = {0};
-    template_tokenizer.tokens = tokenizer->at;
+    if (!MatchConditionWord(expression, ")"))
+    {
+        expression->failed = TRUE;
+        return 0;
+    }
     
-    u32 range_start = 0;;
-    u32 range_end = 0;
+    TypeInfo *type_info = GetTypeInfo(&type_table, type_name);
     
-    ResetTokenizer(tokenizer);
-    do
+    if (strcmp(query, "is_known") == 0)
     {
-        if (GetTokenizerAt(tokenizer)->token_type ==
-            Token_TemplateEnd)
+        return (type_info != 0);
+    }
+    
+    if (type_info == 0)
+    {
+        fprintf(stderr, "Unknown type in @if: %s\n", type_name);
+        expression->failed = TRUE;
+        return 0;
+    }
+    
+    if (strcmp(query, "size") == 0)
+    {
+        return type_info->size;
+    }
+    else if (strcmp(query, "align") == 0)
+    {
+        return type_info->align;
+    }
+    else if (strcmp(query, "is_integer") == 0)
+    {
+        return (type_info->type_kind == TypeKind_Integer);
+    }
+    else if (strcmp(query, "is_float") == 0)
+    {
+        return (type_info->type_kind == TypeKind_Float);
+    }
+    else if (strcmp(query, "is_signed") == 0)
+    {
+        return ((type_info->type_kind == TypeKind_Integer ||
+                 type_info->type_kind == TypeKind_Float) &&
+                type_info->is_signed);
+    }
+    else if (strcmp(query, "is_pointer") == 0)
+    {
+        return (type_info->type_kind == TypeKind_Pointer);
+    }
+    else if (strcmp(query, "is_struct") == 0)
+    {
+        return (type_info->type_kind == TypeKind_Struct);
+    }
+    else if (strcmp(query, "has_hash") == 0)
+    {
+        return type_info->has_hash;
+    }
+    
+    fprintf(stderr, "Unknown function in @if: %s\n", query);
+    expression->failed = TRUE;
+    return 0;
+}
+
+internal s64
+EvaluateConditionPrimary(ConditionExpression *expression)
+{
+    char *word = NextConditionWord(expression);
+    
+    if (strcmp(word, "(") == 0)
+    {
+        s64 value = EvaluateCondition(expression);
+        
+        if (!MatchConditionWord(expression, ")"))
         {
-            range_end = tokenizer->at - tokenizer->tokens;
-            break;
+            expression->failed = TRUE;
         }
-    } while (IncrementTokenizerNoWhitespace(tokenizer));
-    
-    template_tokenizer.token_num = GetRange(range_start, range_end);
-    template.tokenizer = template_tokenizer;
+        return value;
+    }
+    else if (strcmp(word, "!") == 0)
+    {
+        return !EvaluateConditionPrimary(expression);
+    }
+    else if (strcmp(word, "-") == 0)
+    {
+        return -EvaluateConditionPrimary(expression);
+    }
+    else if (IsIntegerLiteral(word))
+    {
+        return strtoll(word, 0, 0);
+    }
     
-    ResetTokenizer(tokenizer);
-    return template;
+    return EvaluateTypeQuery(expression, word);
 }
 
-/*
- Constructs a hash table from a file tokenizer
- */
-internal TemplateHashTable
-GetTemplateHashTable(Tokenizer *tokenizer)
+internal s64
+EvaluateConditionProduct(ConditionExpression *expression)
 {
-    TemplateHashTable hash_table = {0};
-    hash_table.num = GetNumberOfTemplates(tokenizer);
-    hash_table.templates =
-        AllocArray(sizeof(*hash_table.templates), hash_table.num);
+    s64 value = EvaluateConditionPrimary(expression);
     
-    do
+    for (;;)
     {
-        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateStart)
+        if (MatchConditionWord(expression, "*"))
         {
-            Tokenizer template_tokenizer = {0};
-            template_tokenizer.token_num =
-                tokenizer->tokens + tokenizer->token_num - tokenizer->at;
-            template_tokenizer.tokens = tokenizer->at;
-            template_tokenizer.at = tokenizer->at;
-            
-            Template template =
-                GetTemplateFromTokens(&template_tokenizer);
-            
-            u32 bucket = GetHash(template.template_name) % hash_table.num;
-            
-            if (hash_table.templates[bucket].template_name == 0)
-            {
-                hash_table.templates[bucket] = template;
-                continue;
-            }
+            value *= EvaluateConditionPrimary(expression);
+        }
+        else if (MatchConditionWord(expression, "/") ||
+                 MatchConditionWord(expression, "%"))
+        {
+            b8 is_modulo = (expression->words[expression->at - 1][0] == '%');
+            s64 divisor = EvaluateConditionPrimary(expression);
             
-            Template template_at =
-                hash_table.templates[bucket];
-            for (;;)
+            if (divisor == 0)
             {
-                if (template_at.next != 0) {
-                    template_at = *(template_at.next);
-                    continue;
-                }
-                
-                template_at.next =
-                    ArenaAlloc(sizeof(*(template_at.next)));
-                *(template_at.next) = template;
-                break;
+                expression->failed = TRUE;
+                return 0;
             }
+            value = is_modulo ? (value % divisor) : (value / divisor);
         }
-    } while (IncrementTokenizerNoWhitespace(tokenizer));
-    return hash_table;
+        else
+        {
+            return value;
+        }
+    }
 }
 
-/*
-Pretty intuitive.
-This looks up the definition of the template in the template hash table.
-*/
-
-internal Template
-LookupHashTable(char *template_name, TemplateHashTable *hash_table)
+internal s64
+EvaluateConditionSum(ConditionExpression *expression)
 {
-    Template template = {0};
-    u32 bucket = GetHash(template_name) % hash_table->num;
-    
-    template = hash_table->templates[bucket];
+    s64 value = EvaluateConditionProduct(expression);
     
-    while (strcmp(template_name, template.template_name) != 0)
+    for (;;)
     {
-        if (template.next == 0)
+        if (MatchConditionWord(expression, "+"))
         {
-            break;
+            value += EvaluateConditionProduct(expression);
+        }
+        else if (MatchConditionWord(expression, "-"))
+        {
+            value -= EvaluateConditionProduct(expression);
+        }
+        else
+        {
+            return value;
         }
-        
-        template = *(template.next);
     }
-    
-    return template;
 }
 
-/*
- Gets number of template "type requests" in file
- TODO (winston): maybe integrate this into the lexing process
- To speed up things
- */
-internal u32
-GetNumberOfTemplateTypeRequests(Tokenizer *tokenizer)
+internal s64
+EvaluateConditionComparison(ConditionExpression *expression)
 {
-    u32 increment_thing = 0;
+    s64 value = EvaluateConditionSum(expression);
     
-    ResetTokenizer(tokenizer);
-    do
+    if (MatchConditionWord(expression, "<="))
     {
-        if (GetTokenizerAt(tokenizer)->token_type == Token_Template)
-        {
-            ++increment_thing;
-        }
-    } while (IncrementTokenizerNoWhitespace(tokenizer));
-    ResetTokenizer(tokenizer);
+        return value <= EvaluateConditionSum(expression);
+    }
+    else if (MatchConditionWord(expression, ">="))
+    {
+        return value >= EvaluateConditionSum(expression);
+    }
+    else if (MatchConditionWord(expression, "<"))
+    {
+        return value < EvaluateConditionSum(expression);
+    }
+    else if (MatchConditionWord(expression, ">"))
+    {
+        return value > EvaluateConditionSum(expression);
+    }
+    else if (MatchConditionWord(expression, "=="))
+    {
+        return value == EvaluateConditionSum(expression);
+    }
+    else if (MatchConditionWord(expression, "!="))
+    {
+        return value != EvaluateConditionSum(expression);
+    }
     
-    return increment_thing;
+    return value;
 }
 
-/*
- Gets the type of template requested
- */
-internal TemplateTypeRequest
-GetTemplateTypeRequests(Tokenizer *file_tokens)
+internal s64
+EvaluateConditionAnd(ConditionExpression *expression)
 {
-    TemplateTypeRequest type_request = {0};
+    s64 value = EvaluateConditionComparison(expression);
     
-    type_request.request_num =
-        GetNumberOfTemplateTypeRequests(file_tokens);
-    type_request.type_requests =
-        AllocArray(sizeof(*type_request.type_requests),
-                   type_request.request_num);
-    
-    ResetTokenizer(file_tokens);
-    u32 index = 0;
-    do
+    while (MatchConditionWord(expression, "&&"))
     {
-        if (GetTokenizerAt(file_tokens)->token_type == Token_Template)
-        {
-            TypeRequest type_request_at = {0};
-            
-            do
-            {
-                IncrementTokenizerNoWhitespace(file_tokens);
-                
-                switch (GetTokenizerAt(file_tokens)->token_type)
-                {
-                    case Token_TemplateName:
-                    {
-                        type_request_at.template_name =
-                            GetTokenizerAt(file_tokens)->token_data;
-                    } break;
-                    case Token_TemplateType:
-                    {
-                        type_request_at.type_name =
-                            GetTokenizerAt(file_tokens)->token_data;
-                    } break;
-                    case Token_GenStructName:
-                    {
-                        type_request_at.struct_name =
-                            GetTokenizerAt(file_tokens)->token_data;
-                    } break;
-                }
-            } while (GetTokenizerAt(file_tokens)->token_type !=
-                     Token_GenStructName);
-            type_request.type_requests[index] = type_request_at;
-            
-            ++index;
-        }
-    } while (IncrementTokenizerNoWhitespace(file_tokens));
-    ResetTokenizer(file_tokens);
+        s64 right = EvaluateConditionComparison(expression);
+        value = (value && right);
+    }
     
-    return type_request;
+    return value;
 }
 
 /*
- Replace the type name in a template
+ Evaluates an @if expression:
+ || and && over comparisons (< <= > >= == !=) of integer arithmetic
+ (+ - * / %) on literals, value parameters and the type queries
+ size, align, is_integer, is_float, is_signed, is_pointer, is_struct,
+ has_hash and is_known. Words have to be separated by spaces.
  */
-internal void
-ReplaceTypeName(Template *templates, char *type_name, char *struct_name)
+internal s64
+EvaluateCondition(ConditionExpression *expression)
 {
-    ResetTokenizer(&templates->tokenizer);
-    char *type_name_real = ArenaAlloc(strlen(type_name));
-    strcpy(type_name_real, type_name);
+    s64 value = EvaluateConditionAnd(expression);
     
-    char *struct_name_real = ArenaAlloc(strlen(struct_name));
-    strcpy(struct_name_real, struct_name);
-    
-    do
+    while (MatchConditionWord(expression, "||"))
     {
-        if (GetTokenizerAt(&templates->tokenizer)->token_type ==
-            Token_TemplateTypeName)
-        {
-            GetTokenizerAt(&templates->tokenizer)->token_data =
-                type_name_real;
-        }
-        else if (GetTokenizerAt(&templates->tokenizer)->token_type ==
-                 Token_TemplateNameStatement)
-        {
-            GetTokenizerAt(&templates->tokenizer)->token_data = struct_name_real;
-        }
-    } while (IncrementTokenizerNoWhitespace(&templates->tokenizer));
-    ResetTokenizer(&templates->tokenizer);
+        s64 right = EvaluateConditionAnd(expression);
+        value = (value || right);
+    }
+    
+    return value;
+}
+
+/* checks if a token ends the current line */
+internal b8
+IsLineEnd(Token *token)
+{
+    return (token->token_type == Token_Whitespace &&
+            token->token_data[0] == '\n');
 }
 
 /*
- Gets the pointer of the string to the next whitespace
- or to the next semicolon or parenthesis
+ Evaluates the @if expression that follows token index *index
+ into *condition and moves *index to the end of the line.
+ Returns FALSE if the expression is invalid.
  */
-internal char *
-GetStringToNextWhitespace(Token *tokens,
-                          char *file_data,
-                          u32 *start_index)
+internal b32
+EvaluateConditionLine(Template *templates, TypeRequest *type_request,
+                      u32 *index, b32 *condition)
 {
-    u32 range_start = *start_index;
-    u32 range_end = *start_index;
+    Token *tokens = templates->tokenizer.tokens;
+    u32 token_num = templates->tokenizer.token_num;
     
-    do
+    u32 line_end = *index + 1;
+    while (line_end < token_num && !IsLineEnd(&tokens[line_end]))
     {
-        if (tokens[range_end].token_type == Token_EndOfFile)
-        {
-            break;
-        }
-        ++range_end;
-    } while (tokens[range_end].token_type != Token_Whitespace &&
-             tokens[range_end].token_type != Token_Semicolon &&
-             tokens[range_end].token_type != Token_ParentheticalOpen &&
-             tokens[range_end].token_type != Token_ParentheticalClose);
+        ++line_end;
+    }
     
-    char *token_string =
-        ArenaAlloc(GetRange(range_start, range_end));
+    ConditionExpression expression = {0};
+    expression.words =
+        AllocArray(sizeof(*expression.words), 2 * (line_end - *index));
     
-    for (u32 j = 0; j < GetRange(range_start, range_end); ++j)
+    for (u32 i = *index + 1; i < line_end; ++i)
     {
-        token_string[j] = file_data[range_start + j];
+        if (tokens[i].token_type == Token_Whitespace ||
+            tokens[i].token_type == Token_Comment)
+        {
+            continue;
+        }
+        
+        char *word = (tokens[i].token_type == Token_TemplateTypeName) ?
+            type_request->type_names[tokens[i].param_index] :
+            tokens[i].token_data;
+        
+        /* !is_float is read as ! is_float */
+        while (word[0] == '!' && word[1] != '\0' && word[1] != '=')
+        {
+            expression.words[expression.word_num++] = "!";
+            ++word;
+        }
+        
+        expression.words[expression.word_num++] = word;
     }
     
-    token_string[GetRange(range_start, range_end)] = '\0';
+    *index = line_end;
     
-    *start_index = range_end - 1;
+    s64 value = EvaluateCondition(&expression);
     
-    return token_string;
+    if (expression.failed || expression.at != expression.word_num)
+    {
+        fprintf(stderr, "Invalid @if in template %s for %s\n",
+                templates->template_name, type_request->struct_name);
+        return FALSE;
+    }
+    
+    *condition = (value != 0);
+    return TRUE;
 }
 
 /*
- Does the opposite of the previous function
- Allocates string and points it to the from the start
- and null-terminates at the next whitespace
+ Drops the indentation written before a directive
+ so that directive lines leave no trace in the output
  */
-internal char *
-GetStringToNextNonWhitespace(Token *tokens,
-                             char *file_data,
-                             u32 *start_index)
+internal void
+TrimLineIndentation(StreamBuffer *buffer)
 {
-    u32 range_start = *start_index;
-    u32 range_end = *start_index;
+    u64 size = buffer->size;
     
-    do
+    while (size > 0 &&
+           (buffer->data[size - 1] == ' ' || buffer->data[size - 1] == '\t'))
     {
-        if (tokens[range_end].token_type == Token_EndOfFile)
-        {
-            break;
-        }
-        ++range_end;
-    } while (tokens[range_end].token_type == Token_Whitespace &&
-             tokens[range_end].token_type == Token_Semicolon &&
-             tokens[range_end].token_type != Token_ParentheticalOpen &&
-             tokens[range_end].token_type != Token_ParentheticalClose);
-    
-    char *token_string =
-        ArenaAlloc(GetRange(range_start, range_end));
+        --size;
+    }
     
-    for (u32 j = 0; j < GetRange(range_start, range_end); ++j)
+    if (size == 0 || buffer->data[size - 1] == '\n')
     {
-        token_string[j] = file_data[range_start + j];
+        buffer->size = size;
+        if (buffer->data)
+        {
+            buffer->data[size] = '\0';
+        }
     }
-    
-    token_string[GetRange(range_start, range_end)] = '\0';
-    
-    *start_index = range_end - 1;
-    
-    return token_string;
 }
 
 /*
- Lexes the file and tokenizes all data
-
-TODO (winston): split this into multiple functions
- to shorten main function
+ Writes contents of a template to the given buffer.
+ Parameters and @template_name are substituted and @if blocks are
+ resolved in the same pass, so the template tokens are never modified.
+ Returns FALSE if the template can't be written; the buffer then holds
+ a partial expansion that must be thrown away.
  */
-internal Tokenizer
-TokenizeFileData(char *file_data)
+internal b32
+WriteTemplateToBuffer(Template *templates, TypeRequest *type_request,
+                      StreamBuffer *buffer)
 {
-    if(file_data == 0)
-    {
-        return (Tokenizer){0};
-    }
-    
-    u32 file_data_length = strlen(file_data) + 1;
-    
-    Tokenizer tokenizer = {0};
+    Token *tokens = templates->tokenizer.tokens;
+    u32 token_num = templates->tokenizer.token_num;
     
-    Token *tokens =
-        AllocArray(sizeof(*tokens), file_data_length);
+    ConditionalBlock blocks[MAX_CONDITIONAL_DEPTH];
+    u32 block_num = 0;
+    b32 active = TRUE;
     
-    for (u32 i = 0; i < file_data_length; ++i)
+    for (u32 i = templates->body_start; i < token_num; ++i)
     {
-        Token token = {0};
-        
-        switch (file_data[i])
+        switch (tokens[i].token_type)
         {
-            case '\n':
-            case ' ':
-            case '\t':
+            case Token_If:
             {
-                token.token_type = Token_Whitespace;
-            } break;
-            case '~':
+                TrimLineIndentation(buffer);
+                
+                /* inside a skipped block the expression may name unknown types */
+                b32 condition = FALSE;
+                if (!active)
+                {
+                    while (i < token_num && !IsLineEnd(&tokens[i]))
+                    {
+                        ++i;
+                    }
+                }
+                else if (!EvaluateConditionLine(templates, type_request, &i,
+                                                &condition))
+                {
+                    return FALSE;
+                }
+                
+                /* without its block the matching @endif would close the outer one */
+                if (block_num == MAX_CONDITIONAL_DEPTH)
+                {
+                    fprintf(stderr, "@if nested more than %d deep in %s\n",
+                            MAX_CONDITIONAL_DEPTH, templates->template_name);
+                    return FALSE;
+                }
+                
+                ConditionalBlock *block = &blocks[block_num++];
+                block->parent_active = active;
+                block->condition = condition;
+                block->in_else = FALSE;
+                
+                active = (active && condition);
+                continue;
+            }
+            case Token_PackedOrder:
+            case Token_VecMath:
+            case Token_Serialize:
+            case Token_Hash:
+            {
+                TrimLineIndentation(buffer);
+                
+                while (i < token_num && !IsLineEnd(&tokens[i]))
+                {
+                    ++i;
+                }
+                continue;
+            }
+            case Token_Else:
+            case Token_EndIf:
+            {
+                TrimLineIndentation(buffer);
+                
+                if (block_num == 0)
+                {
+                    fprintf(stderr, "%s without @if in %s\n",
+                            tokens[i].token_data, templates->template_name);
+                    return FALSE;
+                }
+                else if (tokens[i].token_type == Token_Else)
+                {
+                    ConditionalBlock *block = &blocks[block_num - 1];
+                    
+                    if (block->in_else)
+                    {
+                        fprintf(stderr, "Second @else in %s\n",
+                                templates->template_name);
+                        return FALSE;
+                    }
+                    block->in_else = TRUE;
+                    active = (block->parent_active && !block->condition);
+                }
+                else
+                {
+                    active = blocks[--block_num].parent_active;
+                }
+                
+                while (i < token_num && !IsLineEnd(&tokens[i]))
+                {
+                    ++i;
+                }
+                continue;
+            }
+            default:
             {
-                token.token_type = Token_SpecialProcess;
             } break;
-            case '@':
+        }
+        
+        if (!active)
+        {
+            continue;
+        }
+        
+        switch (tokens[i].token_type)
+        {
+            case Token_Instrument:
             {
-                token.token_type = Token_Template;
+                /* the counter names up to the end of the line */
+                char *counters[MAX_INSTRUMENT_COUNTERS];
+                u32 counter_num = 0;
+                
+                while (i + 1 < token_num && !IsLineEnd(&tokens[i + 1]))
+                {
+                    ++i;
+                    if (tokens[i].token_type != Token_Identifier)
+                    {
+                        continue;
+                    }
+                    
+                    if (counter_num == MAX_INSTRUMENT_COUNTERS)
+                    {
+                        fprintf(stderr, "@instrument: more than %d counters in %s\n",
+                                MAX_INSTRUMENT_COUNTERS, templates->template_name);
+                        continue;
+                    }
+                    counters[counter_num++] = tokens[i].token_data;
+                }
+                
+                TrimLineIndentation(buffer);
+                WriteInstrument(buffer, type_request->struct_name,
+                                counters, counter_num);
             } break;
-            case '\0':
+            case Token_TemplateTypeName:
             {
-                token.token_type = Token_EndOfFile;
+                AppendString(buffer,
+                             type_request->type_names[tokens[i].param_index]);
             } break;
-            case '{':
+            case Token_TemplateNameStatement:
             {
-                token.token_type = Token_BracketOpen;
-            } break;
-            case '}':
-            {
-                token.token_type = Token_BracketClose;
-            } break;
-            case '(':
-            {
-                token.token_type = Token_ParentheticalOpen;
-            } break;
-            case ')':
-            {
-                token.token_type = Token_ParentheticalClose;
+                /* @template_name_push becomes <struct_name>_push */
+                AppendString(buffer, type_request->struct_name);
+                AppendString(buffer, tokens[i].token_data +
+                             strlen("@template_name"));
             } break;
-            case ';':
+            case Token_Identifier:
             {
-                token.token_type = Token_Semicolon;
+                /* Vec3<T> and friends carry parameters inside the token */
+                if (templates->param_num > 0 &&
+                    (strchr(tokens[i].token_data, '<') ||
+                     strchr(tokens[i].token_data, '>')))
+                {
+                    AppendNestedToken(buffer, tokens[i].token_data,
+                                      templates, type_request);
+                }
+                else
+                {
+                    AppendString(buffer, tokens[i].token_data);
+                }
             } break;
             default:
             {
-                token.token_type = Token_Identifier;
+                AppendString(buffer, tokens[i].token_data);
             } break;
         }
-        
-        tokens[i] = token;
     }
     
-    u32 counter = 0;
-    for (u32 i = 0; i < file_data_length; ++i)
+    if (block_num != 0)
     {
-        char *token_string = 0;
-        
-        switch (tokens[i].token_type)
+        fprintf(stderr, "Missing @endif in template %s\n",
+                templates->template_name);
+        return FALSE;
+    }
+    
+    return TRUE;
+}
+
+/*
+ Gets the number of templates in a file
+ Takes in a tokenized file
+ Returns a u32 with the number of templates in file
+ */
+internal u32
+GetNumberOfTemplates(Tokenizer *tokenizer)
+{
+    u32 count = 0;
+    
+    ResetTokenizer(tokenizer);
+    
+    do
+    {
+        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateEnd)
         {
-            case Token_Template:
-            case Token_Semicolon:
-            case Token_Identifier:
-            case Token_SpecialProcess:
+            ++count;
+        }
+    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    
+    ResetTokenizer(tokenizer);
+    return count;
+}
+
+/*
+ Gets the template name
+ Takes in a tokenizer where the tokens pointer points to the first
+ Token in the template
+ */
+internal char *
+GetTemplateName(Tokenizer *tokenizer)
+{
+    char *template_name;
+    
+    ResetTokenizer(tokenizer);
+    
+    do
+    {
+        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateName)
+        {
+            template_name = GetTokenizerAt(tokenizer)->token_data;
+            break;
+        }
+    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    
+    ResetTokenizer(tokenizer);
+    return template_name;
+}
+
+/*
+ Takes in a template tokenizer and fills in the parameter
+ names declared after <- (or the arguments after -> for a
+ specialization) and the index where the body starts
+ */
+internal void
+GetTemplateParams(Tokenizer *tokenizer, Template *template)
+{
+    Token *tokens = tokenizer->tokens;
+    u32 i = 0;
+    
+    template->is_specialization =
+        (tokens[0].token_type == Token_TemplateSpecialize);
+    template->is_function =
+        (tokens[0].token_type == Token_TemplateFunction);
+    
+    for (; i < tokenizer->token_num; ++i)
+    {
+        if (tokens[i].token_type == Token_TemplateType)
+        {
+            if (template->type_num < MAX_TEMPLATE_PARAMS)
             {
-                tokens[counter].token_type = tokens[i].token_type;
-                
-                token_string = GetStringToNextWhitespace(tokens,
-                                                         file_data,
-                                                         &i);
-            } break;
-            case Token_BracketOpen:
-            case Token_BracketClose:
-            case Token_ParentheticalOpen:
-            case Token_ParentheticalClose:
+                template->type_names[template->type_num++] =
+                    tokens[i].token_data;
+            }
+        }
+        else if (tokens[i].token_type == Token_TemplateTypeName)
+        {
+            if (template->param_num < MAX_TEMPLATE_PARAMS)
             {
-                tokens[counter].token_type = tokens[i].token_type;
+                /* value parameters are written as NAME:DEFAULT */
+                char *param = tokens[i].token_data;
+                char *colon = strchr(param, ':');
                 
-                token_string = ArenaAlloc(2);
+                if (colon)
+                {
+                    char *param_name = ArenaAlloc(colon - param);
+                    CopyStringRange(param, param_name, 0, colon - param);
+                    
+                    template->param_names[template->param_num] = param_name;
+                    template->param_defaults[template->param_num] = colon + 1;
+                }
+                else
+                {
+                    template->param_names[template->param_num] = param;
+                }
                 
-                token_string[0] = file_data[i];
-                token_string[1] = '\0';
-            } break;
-            case Token_Whitespace:
-            {
-                tokens[counter].token_type = tokens[i].token_type;
-                token_string =
-                    GetStringToNextNonWhitespace(tokens,
-                                                 file_data,
-                                                 &i);
-            } break;
-            default:
-            {
-                tokens[counter].token_type = tokens[i].token_type;
-            } break;
+                ++template->param_num;
+            }
+        }
+        else if (tokens[i].token_type == Token_Whitespace &&
+                 tokens[i].token_data[0] == '\n')
+        {
+            break;
         }
-        tokens[counter].token_data = token_string;
-        
-        ++counter;
     }
     
-    u32 tokens_actual_length = 0;
-    for (u32 i = 0; i < file_data_length; ++i)
+    while (i < tokenizer->token_num &&
+           tokens[i].token_type == Token_Whitespace)
     {
-        if (tokens[i].token_type == Token_EndOfFile)
+        ++i;
+    }
+    
+    template->body_start = i;
+    
+    for (; i < tokenizer->token_num; ++i)
+    {
+        if (tokens[i].token_type == Token_PackedOrder)
         {
-            tokens_actual_length = i + 1;
+            template->packed_order = TRUE;
+        }
+        else if (tokens[i].token_type == Token_VecMath)
+        {
+            template->vec_math = TRUE;
+        }
+        else if (tokens[i].token_type == Token_Serialize)
+        {
+            template->serialize = TRUE;
+        }
+        else if (tokens[i].token_type == Token_Hash)
+        {
+            template->hash = TRUE;
+        }
+    }
+}
+
+/*
+  Gets struct Template from tokenizer where tokenizer starts at the
+ start of the template
+
+TODO (winston): complete this function and maybe implement a more
+ versatile usage where the parameter does not have to point to the first
+ token in the template.
+ */
+internal Template
+GetTemplateFromTokens(Tokenizer *tokenizer)
+{
+    Template template = {0};
+    
+    template.template_name = GetTemplateName(tokenizer);
+    
+    Tokenizer template_tokenizer = {0};
+    template_tokenizer.tokens = tokenizer->at;
+    
+    u32 range_start = 0;;
+    u32 range_end = 0;
+    
+    ResetTokenizer(tokenizer);
+    do
+    {
+        if (GetTokenizerAt(tokenizer)->token_type ==
+            Token_TemplateEnd)
+        {
+            range_end = tokenizer->at - tokenizer->tokens;
             break;
         }
-        if (tokens[i].token_data[0] == '/' &&
-            tokens[i].token_data[1] == '/')
+    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    
+    template_tokenizer.token_num = GetRange(range_start, range_end);
+    template.tokenizer = template_tokenizer;
+    
+    GetTemplateParams(&template.tokenizer, &template);
+    
+    ResetTokenizer(tokenizer);
+    return template;
+}
+
+/*
+ Allocates an empty hash table with the given number of buckets
+ */
+internal TemplateHashTable
+AllocTemplateHashTable(u32 bucket_num)
+{
+    TemplateHashTable hash_table = {0};
+    hash_table.num = (bucket_num == 0) ? 1 : bucket_num;
+    hash_table.templates =
+        AllocArray(sizeof(*hash_table.templates), hash_table.num);
+    
+    return hash_table;
+}
+
+/*
+ Hash of a (template, arguments) key. Generic templates are keyed on
+ the name alone, specializations on the name and their arguments,
+ so both are found with a single probe.
+ */
+internal u64
+GetTemplateKeyHash(char *template_name, char **type_names, u32 type_num)
+{
+    u64 hash = GetHash(template_name);
+    
+    for (u32 i = 0; i < type_num; ++i)
+    {
+        hash = (hash * 31) ^ GetHash(type_names[i]);
+    }
+    
+    return hash;
+}
+
+/*
+ Inserts a template into the hash table, chaining on collisions
+ */
+internal void
+InsertTemplate(TemplateHashTable *hash_table, Template template)
+{
+    u32 bucket = GetTemplateKeyHash(template.template_name,
+                                    template.type_names,
+                                    template.type_num) % hash_table->num;
+    
+    if (template.is_specialization)
+    {
+        ++hash_table->specialization_num;
+    }
+    if (template.is_function)
+    {
+        ++hash_table->function_num;
+    }
+    
+    if (hash_table->templates[bucket].template_name == 0)
+    {
+        hash_table->templates[bucket] = template;
+        return;
+    }
+    
+    Template *template_at = &hash_table->templates[bucket];
+    while (template_at->next != 0)
+    {
+        template_at = template_at->next;
+    }
+    
+    template_at->next = ArenaAlloc(sizeof(*(template_at->next)));
+    *(template_at->next) = template;
+}
+
+/*
+ Builds a Template from a tokenizer whose at pointer
+ is on a Token_TemplateStart, Token_TemplateSpecialize
+ or Token_TemplateFunction
+ */
+internal Template
+GetTemplateAt(Tokenizer *tokenizer)
+{
+    Tokenizer template_tokenizer = {0};
+    template_tokenizer.token_num =
+        tokenizer->tokens + tokenizer->token_num - tokenizer->at;
+    template_tokenizer.tokens = tokenizer->at;
+    template_tokenizer.at = tokenizer->at;
+    
+    return GetTemplateFromTokens(&template_tokenizer);
+}
+
+/*
+ Constructs a hash table from a file tokenizer
+ */
+internal TemplateHashTable
+GetTemplateHashTable(Tokenizer *tokenizer)
+{
+    TemplateHashTable hash_table =
+        AllocTemplateHashTable(GetNumberOfTemplates(tokenizer));
+    
+    do
+    {
+        if (GetTokenizerAt(tokenizer)->token_type == Token_TemplateStart ||
+            GetTokenizerAt(tokenizer)->token_type == Token_TemplateSpecialize ||
+            GetTokenizerAt(tokenizer)->token_type == Token_TemplateFunction)
+        {
+            InsertTemplate(&hash_table, GetTemplateAt(tokenizer));
+        }
+    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    return hash_table;
+}
+
+/*
+ Checks if a template is the one for a (name, arguments) key.
+ A key without arguments only matches the generic template.
+ Struct and function templates of the same name are told apart
+ by is_function.
+ */
+internal b8
+TemplateMatchesKey(Template *template, char *template_name,
+                   char **type_names, u32 type_num, b32 is_function)
+{
+    if (template->template_name == 0 ||
+        template->is_function != is_function ||
+        strcmp(template->template_name, template_name) != 0 ||
+        template->type_num != type_num ||
+        template->is_specialization != (type_num != 0))
+    {
+        return FALSE;
+    }
+    
+    for (u32 i = 0; i < type_num; ++i)
+    {
+        if (strcmp(template->type_names[i], type_names[i]) != 0)
+        {
+            return FALSE;
+        }
+    }
+    
+    return TRUE;
+}
+
+/*
+ Looks up a template by name and, for specializations, arguments.
+ Returns an empty template if there is none.
+ */
+internal Template
+LookupTemplate(char *template_name, char **type_names, u32 type_num,
+               b32 is_function, TemplateHashTable *hash_table)
+{
+    u32 bucket = GetTemplateKeyHash(template_name, type_names, type_num) %
+        hash_table->num;
+    
+    for (Template *template = &hash_table->templates[bucket];
+         template && template->template_name;
+         template = template->next)
+    {
+        if (TemplateMatchesKey(template, template_name,
+                               type_names, type_num, is_function))
+        {
+            return *template;
+        }
+    }
+    
+    return (Template){0};
+}
+
+/*
+Pretty intuitive.
+This looks up the definition of the template in the template hash table.
+*/
+
+internal Template
+LookupHashTable(char *template_name, TemplateHashTable *hash_table)
+{
+    return LookupTemplate(template_name, 0, 0, FALSE, hash_table);
+}
+
+/*
+ Looks up the @template_fn block of a template.
+ Returns an empty template if there is none.
+ */
+internal Template
+LookupFunctionTemplate(char *template_name, TemplateHashTable *hash_table)
+{
+    if (hash_table->function_num == 0)
+    {
+        return (Template){0};
+    }
+    
+    return LookupTemplate(template_name, 0, 0, TRUE, hash_table);
+}
+
+/*
+ Gets number of template "type requests" in file
+ TODO (winston): maybe integrate this into the lexing process
+ To speed up things
+ */
+internal u32
+GetNumberOfTemplateTypeRequests(Tokenizer *tokenizer)
+{
+    u32 increment_thing = 0;
+    
+    ResetTokenizer(tokenizer);
+    do
+    {
+        if (GetTokenizerAt(tokenizer)->token_type == Token_Template ||
+            GetTokenizerAt(tokenizer)->token_type == Token_TemplateSoA ||
+            GetTokenizerAt(tokenizer)->token_type == Token_Variant)
+        {
+            ++increment_thing;
+        }
+    } while (IncrementTokenizerNoWhitespace(tokenizer));
+    ResetTokenizer(tokenizer);
+    
+    return increment_thing;
+}
+
+/*
+ Gets the type of template requested
+ */
+internal TemplateTypeRequest
+GetTemplateTypeRequests(Tokenizer *file_tokens)
+{
+    TemplateTypeRequest type_request = {0};
+    
+    type_request.request_num =
+        GetNumberOfTemplateTypeRequests(file_tokens);
+    type_request.type_requests =
+        AllocArray(sizeof(*type_request.type_requests),
+                   type_request.request_num);
+    
+    ResetTokenizer(file_tokens);
+    u32 index = 0;
+    do
+    {
+        if (GetTokenizerAt(file_tokens)->token_type == Token_Template ||
+            GetTokenizerAt(file_tokens)->token_type == Token_TemplateSoA ||
+            GetTokenizerAt(file_tokens)->token_type == Token_Variant)
+        {
+            TypeRequest type_request_at = {0};
+            type_request_at.is_soa =
+                (GetTokenizerAt(file_tokens)->token_type == Token_TemplateSoA);
+            type_request_at.is_variant =
+                (GetTokenizerAt(file_tokens)->token_type == Token_Variant);
+            
+            do
+            {
+                IncrementTokenizerNoWhitespace(file_tokens);
+                
+                switch (GetTokenizerAt(file_tokens)->token_type)
+                {
+                    case Token_TemplateName:
+                    {
+                        type_request_at.template_name =
+                            GetTokenizerAt(file_tokens)->token_data;
+                    } break;
+                    case Token_TemplateType:
+                    {
+                        u32 last = type_request_at.type_num - 1;
+                        
+                        /* Pair<u32, f32> was split at the comma */
+                        if (type_request_at.type_num > 0 &&
+                            GetAngleDepth(type_request_at.type_names[last]) > 0)
+                        {
+                            char *type_name =
+                                GetTokenizerAt(file_tokens)->token_data;
+                            char *joined =
+                                ArenaAlloc(strlen(type_request_at.type_names[last]) +
+                                           strlen(type_name) + 2);
+                            
+                            strcpy(joined, type_request_at.type_names[last]);
+                            strcat(joined, ", ");
+                            strcat(joined, type_name);
+                            type_request_at.type_names[last] = joined;
+                        }
+                        else if (type_request_at.type_num < MAX_TEMPLATE_PARAMS)
+                        {
+                            type_request_at.type_names[type_request_at.type_num++] =
+                                GetTokenizerAt(file_tokens)->token_data;
+                        }
+                    } break;
+                    case Token_GenStructName:
+                    {
+                        type_request_at.struct_name =
+                            GetTokenizerAt(file_tokens)->token_data;
+                    } break;
+                }
+            } while (GetTokenizerAt(file_tokens)->token_type !=
+                     Token_GenStructName);
+            type_request.type_requests[index] = type_request_at;
+            
+            ++index;
+        }
+    } while (IncrementTokenizerNoWhitespace(file_tokens));
+    ResetTokenizer(file_tokens);
+    
+    return type_request;
+}
+
+/*
+ Gets the pointer of the string to the next whitespace
+ or to the next semicolon or parenthesis
+ */
+internal char *
+GetStringToNextWhitespace(Token *tokens,
+                          char *file_data,
+                          u32 *start_index)
+{
+    u32 range_start = *start_index;
+    u32 range_end = *start_index;
+    
+    do
+    {
+        if (tokens[range_end].token_type == Token_EndOfFile)
+        {
+            break;
+        }
+        ++range_end;
+    } while (tokens[range_end].token_type != Token_Whitespace &&
+             tokens[range_end].token_type != Token_Semicolon &&
+             tokens[range_end].token_type != Token_ParentheticalOpen &&
+             tokens[range_end].token_type != Token_ParentheticalClose &&
+             tokens[range_end].token_type != Token_Comma &&
+             tokens[range_end].token_type != Token_SquareOpen &&
+             tokens[range_end].token_type != Token_SquareClose);
+    
+    char *token_string =
+        ArenaAlloc(GetRange(range_start, range_end));
+    
+    for (u32 j = 0; j < GetRange(range_start, range_end); ++j)
+    {
+        token_string[j] = file_data[range_start + j];
+    }
+    
+    token_string[GetRange(range_start, range_end)] = '\0';
+    
+    *start_index = range_end - 1;
+    
+    return token_string;
+}
+
+/*
+ Does the opposite of the previous function
+ Allocates string and points it to the from the start
+ and null-terminates at the next whitespace
+ */
+internal char *
+GetStringToNextNonWhitespace(Token *tokens,
+                             char *file_data,
+                             u32 *start_index)
+{
+    u32 range_start = *start_index;
+    u32 range_end = *start_index;
+    
+    do
+    {
+        if (tokens[range_end].token_type == Token_EndOfFile)
+        {
+            break;
+        }
+        ++range_end;
+    } while (tokens[range_end].token_type == Token_Whitespace &&
+             tokens[range_end].token_type == Token_Semicolon &&
+             tokens[range_end].token_type != Token_ParentheticalOpen &&
+             tokens[range_end].token_type != Token_ParentheticalClose);
+    
+    char *token_string =
+        ArenaAlloc(GetRange(range_start, range_end));
+    
+    for (u32 j = 0; j < GetRange(range_start, range_end); ++j)
+    {
+        token_string[j] = file_data[range_start + j];
+    }
+    
+    token_string[GetRange(range_start, range_end)] = '\0';
+    
+    *start_index = range_end - 1;
+    
+    return token_string;
+}
+
+/*
+ Lexes the file and tokenizes all data
+
+TODO (winston): split this into multiple functions
+ to shorten main function
+ */
+internal Tokenizer
+TokenizeFileData(char *file_data)
+{
+    if(file_data == 0)
+    {
+        return (Tokenizer){0};
+    }
+    
+    u32 file_data_length = strlen(file_data) + 1;
+    
+    Tokenizer tokenizer = {0};
+    
+    Token *tokens =
+        AllocArray(sizeof(*tokens), file_data_length);
+    
+    for (u32 i = 0; i < file_data_length; ++i)
+    {
+        Token token = {0};
+        
+        switch (file_data[i])
+        {
+            case '\n':
+            case ' ':
+            case '\t':
+            {
+                token.token_type = Token_Whitespace;
+            } break;
+            case '~':
+            {
+                token.token_type = Token_SpecialProcess;
+            } break;
+            case '@':
+            {
+                token.token_type = Token_Template;
+            } break;
+            case '\0':
+            {
+                token.token_type = Token_EndOfFile;
+            } break;
+            case '{':
+            {
+                token.token_type = Token_BracketOpen;
+            } break;
+            case '}':
+            {
+                token.token_type = Token_BracketClose;
+            } break;
+            case '(':
+            {
+                token.token_type = Token_ParentheticalOpen;
+            } break;
+            case ')':
+            {
+                token.token_type = Token_ParentheticalClose;
+            } break;
+            case ';':
+            {
+                token.token_type = Token_Semicolon;
+            } break;
+            case ',':
+            {
+                token.token_type = Token_Comma;
+            } break;
+            case '[':
+            {
+                token.token_type = Token_SquareOpen;
+            } break;
+            case ']':
+            {
+                token.token_type = Token_SquareClose;
+            } break;
+            default:
+            {
+                token.token_type = Token_Identifier;
+            } break;
+        }
+        
+        tokens[i] = token;
+    }
+    
+    u32 counter = 0;
+    for (u32 i = 0; i < file_data_length; ++i)
+    {
+        char *token_string = 0;
+        
+        switch (tokens[i].token_type)
+        {
+            case Token_Template:
+            case Token_Semicolon:
+            case Token_Identifier:
+            case Token_SpecialProcess:
+            {
+                tokens[counter].token_type = tokens[i].token_type;
+                
+                token_string = GetStringToNextWhitespace(tokens,
+                                                         file_data,
+                                                         &i);
+            } break;
+            case Token_BracketOpen:
+            case Token_BracketClose:
+            case Token_ParentheticalOpen:
+            case Token_ParentheticalClose:
+            case Token_Comma:
+            case Token_SquareOpen:
+            case Token_SquareClose:
+            {
+                tokens[counter].token_type = tokens[i].token_type;
+                
+                token_string = ArenaAlloc(2);
+                
+                token_string[0] = file_data[i];
+                token_string[1] = '\0';
+            } break;
+            case Token_Whitespace:
+            {
+                tokens[counter].token_type = tokens[i].token_type;
+                token_string =
+                    GetStringToNextNonWhitespace(tokens,
+                                                 file_data,
+                                                 &i);
+            } break;
+            default:
+            {
+                tokens[counter].token_type = tokens[i].token_type;
+            } break;
+        }
+        tokens[counter].token_data = token_string;
+        
+        ++counter;
+    }
+    
+    u32 tokens_actual_length = 0;
+    for (u32 i = 0; i < file_data_length; ++i)
+    {
+        if (tokens[i].token_type == Token_EndOfFile)
+        {
+            tokens_actual_length = i + 1;
+            break;
+        }
+        if (tokens[i].token_data[0] == '/' &&
+            tokens[i].token_data[1] == '/')
+        {
+            do
+            {
+                TokenTypes type_before = tokens[i].token_type;
+                tokens[i].token_type = Token_Comment;
+                
+                if (type_before == Token_Whitespace)
+                {
+                    b32 is_end_of_line = FALSE;
+                    for (u32 j = 0; tokens[i].token_data[j] != '\0'; ++j) {
+                        if (tokens[i].token_data[j] == '\n')
+                        {
+                            is_end_of_line = TRUE;
+                            break;
+                        }
+                    }
+                    
+                    if (is_end_of_line == TRUE)
+                    {
+                        break;
+                    }
+                }
+            } while (++i);
+        }
+        if (tokens[i].token_data[0] == '/' &&
+            tokens[i].token_data[1] == '*')
+        {
+            do
+            {
+                TokenTypes type_before = tokens[i].token_type;
+                tokens[i].token_type = Token_Comment;
+                
+                b32 is_end_of_comment = FALSE;
+                for (u32 j = 0; tokens[i].token_data[j] != '\0';++j) {
+                    if (tokens[i].token_data[j] == '*' &&
+                        tokens[i].token_data[j + 1] == '/')
+                    {
+                        is_end_of_comment = TRUE;
+                        break;
+                    }
+                }
+                
+                if (is_end_of_comment == TRUE)
+                {
+                    break;
+                }
+            } while (++i);
+        }
+        if (tokens[i].token_data[0] == '@')
+        {
+            if (strcmp(tokens[i].token_data, "@template_start") == 0)
+            {
+                tokens[i].token_type = Token_TemplateStart;
+            }
+            else if (strcmp(tokens[i].token_data, "@template_specialize") == 0)
+            {
+                tokens[i].token_type = Token_TemplateSpecialize;
+            }
+            else if (strcmp(tokens[i].token_data, "@template_fn") == 0)
+            {
+                tokens[i].token_type = Token_TemplateFunction;
+            }
+            else if (strcmp(tokens[i].token_data, "@template_end") == 0)
+            {
+                tokens[i].token_type = Token_TemplateEnd;
+            }
+            else if (strcmp(tokens[i].token_data, "@template_name") == 0 ||
+                     strncmp(tokens[i].token_data, "@template_name_",
+                             strlen("@template_name_")) == 0)
+            {
+                tokens[i].token_type = Token_TemplateNameStatement;
+            }
+            else if (strcmp(tokens[i].token_data, "@if") == 0)
+            {
+                tokens[i].token_type = Token_If;
+            }
+            else if (strcmp(tokens[i].token_data, "@else") == 0)
+            {
+                tokens[i].token_type = Token_Else;
+            }
+            else if (strcmp(tokens[i].token_data, "@endif") == 0)
+            {
+                tokens[i].token_type = Token_EndIf;
+            }
+            else if (strcmp(tokens[i].token_data, "@packed_order") == 0)
+            {
+                tokens[i].token_type = Token_PackedOrder;
+            }
+            else if (strcmp(tokens[i].token_data, "@vec_math") == 0)
+            {
+                tokens[i].token_type = Token_VecMath;
+            }
+            else if (strcmp(tokens[i].token_data, "@template_soa") == 0)
+            {
+                tokens[i].token_type = Token_TemplateSoA;
+            }
+            else if (strcmp(tokens[i].token_data, "@variant") == 0)
+            {
+                tokens[i].token_type = Token_Variant;
+            }
+            else if (strcmp(tokens[i].token_data, "@serialize") == 0)
+            {
+                tokens[i].token_type = Token_Serialize;
+            }
+            else if (strcmp(tokens[i].token_data, "@hash") == 0)
+            {
+                tokens[i].token_type = Token_Hash;
+            }
+            else if (strcmp(tokens[i].token_data, "@instrument") == 0)
+            {
+                tokens[i].token_type = Token_Instrument;
+            }
+            else if (strcmp(tokens[i].token_data, "@template") == 0)
+            {
+            }
+            else
+            {
+                fprintf(stderr, "Unrecognized keyword: %s\n",
+                        tokens[i].token_data);
+                return tokenizer;
+            }
+            
+            continue;
+        }
+        
+        if (strcmp(tokens[i].token_data, "<-") == 0)
+        {
+            tokens[i].token_type = Token_FeedSymbol;
+        }
+        else if (strcmp(tokens[i].token_data, "->") == 0)
+        {
+            tokens[i].token_type = Token_TemplateTypeIndicator;
+        }
+        
+        if (tokens[i].token_type == Token_SpecialProcess)
+        {
+            if (strcmp(tokens[i].token_data, "~output_ext") == 0)
+            {
+                while (tokens[++i].token_type == Token_Whitespace);
+                strcpy(file_ext, tokens[i].token_data);
+            }
+        }
+    }
+    
+    char *param_names[MAX_TEMPLATE_PARAMS];
+    u32 param_num = 0;
+    /* the template whose header or request is being read, for errors */
+    char *template_name = 0;
+    u32 template_name_index = 0;
+    for (u32 i = 0; i < tokens_actual_length - 1; ++i)
+    {
+        if (tokens[i].token_type == Token_TemplateStart ||
+            tokens[i].token_type == Token_TemplateSpecialize ||
+            tokens[i].token_type == Token_TemplateFunction ||
+            tokens[i].token_type == Token_TemplateSoA ||
+            tokens[i].token_type == Token_Template)
+        {
+            while (tokens[++i].token_type == Token_Whitespace);
+            tokens[i].token_type = Token_TemplateName;
+            template_name = tokens[i].token_data;
+            template_name_index = i;
+        }
+        if (tokens[i].token_type == Token_TemplateEnd)
+        {
+            param_num = 0;
+            continue;
+        }
+        if (tokens[i].token_type == Token_TemplateTypeIndicator ||
+            tokens[i].token_type == Token_Variant)
+        {
+            /* only argument lists right after a template name or @variant are counted */
+            u32 previous = i;
+            while (previous > 0 &&
+                   tokens[--previous].token_type == Token_Whitespace);
+            b32 is_variant = (tokens[i].token_type == Token_Variant);
+            b32 is_request = (is_variant ||
+                              (previous == template_name_index &&
+                               template_name != 0));
+            u32 arg_num = 0;
+            s32 angle_depth = 0;
+            
+            /* -> A, B, C -> Name, or @variant A, B, C -> Name */
+            for (;;)
+            {
+                while (tokens[++i].token_type == Token_Whitespace);
+                tokens[i].token_type = Token_TemplateType;
+                
+                /* Pair<u32, f32> is split at its comma but is one argument */
+                if (angle_depth == 0)
+                {
+                    ++arg_num;
+                }
+                angle_depth += GetAngleDepth(tokens[i].token_data);
+                
+                if (is_request && arg_num > MAX_TEMPLATE_PARAMS)
+                {
+                    if (is_variant)
+                    {
+                        fprintf(stderr, "@variant: more than %d members\n",
+                                MAX_TEMPLATE_PARAMS);
+                    }
+                    else
+                    {
+                        fprintf(stderr, "Template %s: more than %d arguments\n",
+                                template_name, MAX_TEMPLATE_PARAMS);
+                    }
+                    return tokenizer;
+                }
+                
+                u32 next = i;
+                while (tokens[++next].token_type == Token_Whitespace);
+                
+                if (tokens[next].token_type != Token_Comma)
+                {
+                    break;
+                }
+                i = next;
+            }
+            
+            while (tokens[++i].token_type == Token_Whitespace);
+            if(tokens[i].token_type == Token_TemplateTypeIndicator)
+            {
+                while (tokens[++i].token_type == Token_Whitespace);
+                tokens[i].token_type = Token_GenStructName;
+            }
+        }
+        if (tokens[i].token_type == Token_FeedSymbol)
+        {
+            /* <- A, B, C */
+            param_num = 0;
+            for (;;)
+            {
+                while (tokens[++i].token_type == Token_Whitespace);
+                
+                tokens[i].token_type = Token_TemplateTypeName;
+                tokens[i].param_index = param_num;
+                
+                if (param_num == MAX_TEMPLATE_PARAMS)
+                {
+                    fprintf(stderr, "Template %s: more than %d parameters\n",
+                            template_name, MAX_TEMPLATE_PARAMS);
+                    return tokenizer;
+                }
+                
+                /* N:4 is matched in the body as N */
+                char *param_name = tokens[i].token_data;
+                char *colon = strchr(param_name, ':');
+                
+                if (colon)
+                {
+                    param_name = ArenaAlloc(colon - tokens[i].token_data);
+                    CopyStringRange(tokens[i].token_data, param_name,
+                                    0, colon - tokens[i].token_data);
+                }
+                
+                param_names[param_num++] = param_name;
+                
+                u32 next = i;
+                while (tokens[++next].token_type == Token_Whitespace);
+                
+                if (tokens[next].token_type != Token_Comma)
+                {
+                    break;
+                }
+                i = next;
+            }
+            continue;
+        }
+        for (u32 param_index = 0; param_index < param_num; ++param_index)
+        {
+            if (strcmp(tokens[i].token_data, param_names[param_index]) == 0)
+            {
+                tokens[i].token_type = Token_TemplateTypeName;
+                tokens[i].param_index = param_index;
+                break;
+            }
+        }
+    }
+    
+    tokenizer.token_num = tokens_actual_length;
+    tokenizer.tokens = tokens;
+    tokenizer.at = tokenizer.tokens;
+    
+    return tokenizer;
+}
+
+/*
+   Gets the file name from the path without the extension
+  */
+internal char *
+GetFilenameNoExt(char *file_path)
+{
+    if(file_path == 0)
+    {
+        return 0;
+    }
+    
+    u32 file_path_length = strlen(file_path);
+    u32 filename_start = 0;
+    u32 filename_end = file_path_length;
+    
+    for (u32 i = 0; i < file_path_length; ++i)
+    {
+        if (file_path[i] == '\\' || file_path[i] == '/')
+        {
+            filename_start = i + 1;
+        }
+    }
+    
+    for (u32 i = filename_start; i < file_path_length; ++i)
+    {
+        if (file_path[i] == '.')
+        {
+            filename_end = i;
+            break;
+        }
+    }
+    
+    u32 filename_length = GetRange(filename_start, filename_end);
+    char *filename = ArenaAlloc(filename_length + 1);
+    
+    CopyStringRange(file_path, filename,
+                    filename_start, filename_end);
+    
+    return filename;
+}
+
+/*
+ Gets the extension of the file from the file path
+ */
+internal char *
+GetFileExt(char *file_path)
+{
+    if(file_path == 0)
+    {
+        return 0;
+    }
+    
+    u32 file_path_length = strlen(file_path);
+    
+    u32 file_ext_start = 0;
+    u32 file_ext_end = file_path_length;
+    
+    for (u32 i = 0; i < file_path_length; ++i)
+    {
+        if (file_path[i] == '.')
+        {
+            file_ext_start = i + 1;
+            break;
+        }
+    }
+    
+    u32 file_ext_length = GetRange(file_ext_start, file_ext_end);
+    char *file_ext = ArenaAlloc(file_ext_length + 1);
+    
+    CopyStringRange(file_path, file_ext,
+                    file_ext_start, file_ext_end);
+    
+    return file_ext;
+}
+
+/*
+ Gets the directory from the file path
+ */
+internal char *
+GetFileWorkingDir(char *file_path)
+{
+    if(file_path == 0)
+    {
+        return 0;
+    }
+    
+    u32 file_path_length = strlen(file_path);
+    
+    u32 working_dir_start = 0;
+    u32 working_dir_end = 0;
+    
+    for (u32 i = 0; i < file_path_length; ++i)
+    {
+        if (file_path[i] == '\\' || file_path[i] == '/')
+        {
+            working_dir_end = i + 1;
+        }
+    }
+    
+    u32 working_dir_length = GetRange(working_dir_start, working_dir_end);
+    char *working_dir = ArenaAlloc(working_dir_length + 1);
+    
+    CopyStringRange(file_path, working_dir,
+                    working_dir_start, working_dir_end);
+    
+    return working_dir;
+}
+
+internal char *
+ReadFileData(char *file_path)
+{
+    FILE *file = fopen(file_path, "r");
+    
+    if (!file)
+    {
+        return 0;
+    }
+    
+    u64 file_length = GetFileLength(file);
+    
+    if (file_length == 0 || file_length >= arena.size_left)
+    {
+        fprintf(stderr, "%s is empty, not seekable or too large; "
+                "use --stream for pipes and huge inputs.\n", file_path);
+        fclose(file);
+        return 0;
+    }
+    
+    char *file_contents = ArenaAlloc(file_length);
+    
+    fread(file_contents, 1, file_length, file);
+    
+    fclose(file);
+    
+    return file_contents;
+}
+
+/*
+ Fills omitted trailing value parameters with their defaults and
+ checks that every value parameter got an integer.
+ Returns FALSE and reports the problem if the request does not fit.
+ */
+internal b8
+FillTemplateArguments(Template *template, TypeRequest *type_request)
+{
+    if (type_request->type_num > template->param_num)
+    {
+        fprintf(stderr, "Template %s takes %u parameters, got %u for %s\n",
+                template->template_name, template->param_num,
+                type_request->type_num, type_request->struct_name);
+        return FALSE;
+    }
+    
+    for (u32 i = type_request->type_num; i < template->param_num; ++i)
+    {
+        if (template->param_defaults[i] == 0)
+        {
+            fprintf(stderr, "Template %s: missing parameter %s for %s\n",
+                    template->template_name, template->param_names[i],
+                    type_request->struct_name);
+            return FALSE;
+        }
+        
+        type_request->type_names[i] = template->param_defaults[i];
+    }
+    type_request->type_num = template->param_num;
+    
+    for (u32 i = 0; i < template->param_num; ++i)
+    {
+        if (template->param_defaults[i] != 0 &&
+            !IsIntegerLiteral(type_request->type_names[i]))
+        {
+            fprintf(stderr, "Template %s: %s must be an integer, got %s for %s\n",
+                    template->template_name, template->param_names[i],
+                    type_request->type_names[i], type_request->struct_name);
+            return FALSE;
+        }
+    }
+    
+    return TRUE;
+}
+
+/*
+ Looks up the requested struct template, including a specialization
+ for the exact arguments, and fills in default arguments.
+ Returns an empty template if the name has no struct template.
+ */
+internal Template
+LookupStructTemplate(TypeRequest *type_request, TypeRequest *full_request,
+                     TemplateHashTable *hash_table)
+{
+    Template template_at = {0};
+    
+    /* a specialization for the exact arguments wins over the generic body */
+    if (hash_table->specialization_num > 0)
+    {
+        template_at = LookupTemplate(type_request->template_name,
+                                     type_request->type_names,
+                                     type_request->type_num,
+                                     FALSE, hash_table);
+        
+        if (template_at.template_name != 0)
+        {
+            return template_at;
+        }
+    }
+    
+    template_at = LookupHashTable(type_request->template_name, hash_table);
+    
+    if (template_at.template_name == 0 ||
+        !FillTemplateArguments(&template_at, full_request))
+    {
+        return (Template){0};
+    }
+    
+    /* the request may only match a specialization once defaults are in */
+    if (hash_table->specialization_num > 0 &&
+        full_request->type_num != type_request->type_num)
+    {
+        Template specialization =
+            LookupTemplate(full_request->template_name,
+                           full_request->type_names,
+                           full_request->type_num, FALSE, hash_table);
+        
+        if (specialization.template_name != 0)
+        {
+            template_at = specialization;
+        }
+    }
+    
+    return template_at;
+}
+
+internal char *
+ExpandTemplateRequest(TypeRequest *type_request,
+                      TemplateHashTable *hash_table, FILE *output_file);
+
+/*
+ Instantiates a nested type written as Name<args>
+ and returns the name of the generated struct
+ */
+internal char *
+ExpandNestedType(char *text, u64 length, TemplateHashTable *hash_table,
+                 FILE *output_file)
+{
+    TypeRequest nested_request;
+    
+    if (!ParseNestedType(text, length, &nested_request))
+    {
+        fprintf(stderr, "Invalid nested type: %.*s\n", (s32)length, text);
+        return 0;
+    }
+    
+    return ExpandTemplateRequest(&nested_request, hash_table, output_file);
+}
+
+/*
+ Replaces every Name<args> of a known template in buffer,
+ starting at offset from, by the name of its instantiation.
+ The nested instantiations are written out before returning, so
+ they end up ahead of the type that uses them.
+ */
+internal void
+ResolveNestedTypes(StreamBuffer *buffer, u64 from,
+                   TemplateHashTable *hash_table, FILE *output_file)
+{
+    if (buffer->size == from || !memchr(buffer->data + from, '<',
+                                        buffer->size - from))
+    {
+        return;
+    }
+    
+    u64 text_length = buffer->size - from;
+    char *text = ArenaAlloc(text_length);
+    memcpy(text, buffer->data + from, text_length);
+    text[text_length] = '\0';
+    
+    buffer->size = from;
+    
+    char *at = text;
+    char *copied = text;
+    
+    while (*at)
+    {
+        if (!IsIdentifierChar(*at) || (at > text && IsIdentifierChar(at[-1])))
         {
-            do
-            {
-                TokenTypes type_before = tokens[i].token_type;
-                tokens[i].token_type = Token_Comment;
-                
-                if (type_before == Token_Whitespace)
-                {
-                    b32 is_end_of_line = FALSE;
-                    for (u32 j = 0; tokens[i].token_data[j] != '\0'; ++j) {
-                        if (tokens[i].token_data[j] == '\n')
-                        {
-                            is_end_of_line = TRUE;
-                            break;
-                        }
-                    }
-                    
-                    if (is_end_of_line == TRUE)
-                    {
-                        break;
-                    }
-                }
-            } while (++i);
+            ++at;
+            continue;
         }
-        if (tokens[i].token_data[0] == '/' &&
-            tokens[i].token_data[1] == '*')
+        
+        char *word_start = at;
+        while (IsIdentifierChar(*at))
         {
-            do
-            {
-                TokenTypes type_before = tokens[i].token_type;
-                tokens[i].token_type = Token_Comment;
-                
-                b32 is_end_of_comment = FALSE;
-                for (u32 j = 0; tokens[i].token_data[j] != '\0';++j) {
-                    if (tokens[i].token_data[j] == '*' &&
-                        tokens[i].token_data[j + 1] == '/')
-                    {
-                        is_end_of_comment = TRUE;
-                        break;
-                    }
-                }
-                
-                if (is_end_of_comment == TRUE)
-                {
-                    break;
-                }
-            } while (++i);
+            ++at;
         }
-        if (tokens[i].token_data[0] == '@')
+        
+        if (*at != '<')
         {
-            if (strcmp(tokens[i].token_data, "@template_start") == 0)
-            {
-                tokens[i].token_type = Token_TemplateStart;
-            }
-            else if (strcmp(tokens[i].token_data, "@template_end") == 0)
-            {
-                tokens[i].token_type = Token_TemplateEnd;
-            }
-            else if (strcmp(tokens[i].token_data, "@template_name") == 0)
-            {
-                tokens[i].token_type = Token_TemplateNameStatement;
-            }
-            else if (strcmp(tokens[i].token_data, "@template") == 0)
-            {
-            }
-            else
-            {
-                fprintf(stderr, "Unrecognized keyword: %s\n",
-                        tokens[i].token_data);
-                return tokenizer;
-            }
-            
             continue;
         }
         
-        if (strcmp(tokens[i].token_data, "<-") == 0)
+        char *close = FindClosingAngle(at);
+        if (close == 0)
         {
-            tokens[i].token_type = Token_FeedSymbol;
+            continue;
         }
-        else if (strcmp(tokens[i].token_data, "->") == 0)
+        
+        char saved = *at;
+        *at = '\0';
+        b32 is_template =
+            (LookupHashTable(word_start, hash_table).template_name != 0 ||
+             LookupFunctionTemplate(word_start, hash_table).template_name != 0);
+        *at = saved;
+        
+        if (!is_template)
         {
-            tokens[i].token_type = Token_TemplateTypeIndicator;
+            continue;
         }
         
-        if (tokens[i].token_type == Token_SpecialProcess)
+        char *struct_name = ExpandNestedType(word_start,
+                                             close + 1 - word_start,
+                                             hash_table, output_file);
+        
+        if (struct_name)
         {
-            if (strcmp(tokens[i].token_data, "~output_ext") == 0)
-            {
-                while (tokens[++i].token_type == Token_Whitespace);
-                strcpy(file_ext, tokens[i].token_data);
-            }
+            AppendStreamBuffer(buffer, copied, word_start - copied);
+            AppendString(buffer, struct_name);
+            copied = close + 1;
         }
+        at = close + 1;
     }
     
-    char *template_typename = 0;
-    for (u32 i = 0; i < tokens_actual_length - 1; ++i)
+    AppendString(buffer, copied);
+}
+
+/*
+ Instantiates the nested arguments of a request, looks up the struct
+ and function templates it expands and fills in their defaults.
+ Returns FALSE if there is nothing to expand.
+ */
+internal b8
+ResolveTemplateRequest(TypeRequest *type_request,
+                       TemplateHashTable *hash_table, FILE *output_file,
+                       ResolvedRequest *resolved)
+{
+    TypeRequest resolved_request = *type_request;
+    
+    for (u32 i = 0; i < resolved_request.type_num; ++i)
     {
-        if (tokens[i].token_type == Token_TemplateStart ||
-            tokens[i].token_type == Token_Template)
-        {
-            while (tokens[++i].token_type == Token_Whitespace);
-            tokens[i].token_type = Token_TemplateName;
-        }
-        if (tokens[i].token_type == Token_TemplateTypeIndicator)
+        char *type_name = resolved_request.type_names[i];
+        
+        if (strchr(type_name, '<'))
         {
-            while (tokens[++i].token_type == Token_Whitespace);
-            tokens[i].token_type = Token_TemplateType;
+            resolved_request.type_names[i] =
+                ExpandNestedType(type_name, strlen(type_name),
+                                 hash_table, output_file);
             
-            while (tokens[++i].token_type == Token_Whitespace);
-            if(tokens[i].token_type == Token_TemplateTypeIndicator)
+            if (resolved_request.type_names[i] == 0)
             {
-                while (tokens[++i].token_type == Token_Whitespace);
-                tokens[i].token_type = Token_GenStructName;
+                return FALSE;
             }
         }
-        if (tokens[i].token_type == Token_FeedSymbol)
-        {
-            while (tokens[++i].token_type == Token_Whitespace);
-            
-            tokens[i].token_type = Token_TemplateTypeName;
-            template_typename = tokens[i].token_data;
-            continue;
-        }
-        if (template_typename)
+    }
+    
+    resolved->full_request = resolved_request;
+    resolved->function_request = resolved_request;
+    
+    resolved->template_at =
+        LookupStructTemplate(&resolved_request, &resolved->full_request,
+                             hash_table);
+    resolved->function_at =
+        LookupFunctionTemplate(type_request->template_name, hash_table);
+    
+    if (resolved->function_at.template_name != 0 &&
+        !FillTemplateArguments(&resolved->function_at,
+                               &resolved->function_request))
+    {
+        resolved->function_at = (Template){0};
+    }
+    
+    if (resolved->template_at.template_name == 0 &&
+        resolved->function_at.template_name == 0)
+    {
+        if (LookupHashTable(type_request->template_name,
+                            hash_table).template_name == 0)
         {
-            if (strcmp(tokens[i].token_data, template_typename) == 0)
-            {
-                tokens[i].token_type = Token_TemplateTypeName;
-            }
+            fprintf(stderr, "Unknown template: %s\n",
+                    type_request->template_name);
         }
+        return FALSE;
     }
     
-    tokenizer.token_num = tokens_actual_length;
-    tokenizer.tokens = tokens;
-    tokenizer.at = tokenizer.tokens;
+    return TRUE;
+}
+
+/*
+ Returns the name of an instantiation that was expanded before, or 0.
+ A request naming it differently gets a typedef to the first name.
+ */
+internal char *
+GetCachedInstantiation(char *key, TypeRequest *type_request,
+                       FILE *output_file)
+{
+    Instantiation *instantiation =
+        LookupInstantiation(&instantiation_table, key);
     
-    return tokenizer;
+    if (instantiation == 0)
+    {
+        return 0;
+    }
+    
+    /* a template may point to itself, anything else can't be ordered */
+    if (instantiation->in_progress &&
+        instantiation->depth + 1 != expand_depth)
+    {
+        fprintf(stderr, "Circular instantiation of %s\n", key);
+    }
+    
+    if (type_request->struct_name &&
+        strcmp(type_request->struct_name, instantiation->struct_name) != 0)
+    {
+        fprintf(output_file, "typedef %s %s;\n\n",
+                instantiation->struct_name, type_request->struct_name);
+    }
+    
+    return instantiation->struct_name;
 }
 
+internal char *
+ExpandSoARequest(TypeRequest *type_request,
+                 TemplateHashTable *hash_table, FILE *output_file);
+
+internal char *
+ExpandVariantRequest(TypeRequest *type_request,
+                     TemplateHashTable *hash_table, FILE *output_file);
+
 /*
-   Gets the file name from the path without the extension
-  */
+ Looks up the requested template and writes it out
+ with the request's types substituted, followed by its
+ @template_fn block if it has one.
+
+ Nested arguments are instantiated first and every (template, arguments)
+ pair is expanded once per run; a repeated request only gets a typedef
+ to the first name. Returns the name of the instantiation, 0 on error.
+ */
 internal char *
-GetFilenameNoExt(char *file_path)
+ExpandTemplateRequest(TypeRequest *type_request,
+                      TemplateHashTable *hash_table, FILE *output_file)
 {
-    if(file_path == 0)
+    if (expand_depth == MAX_INSTANTIATION_DEPTH)
     {
+        fprintf(stderr, "Template %s nested too deeply\n",
+                type_request->template_name);
         return 0;
     }
     
-    u32 file_path_length = strlen(file_path);
-    u32 filename_start = 0;
-    u32 filename_end = 0;
+    if (type_request->is_soa)
+    {
+        return ExpandSoARequest(type_request, hash_table, output_file);
+    }
     
-    for (u32 i = 0; i < file_path_length; ++i)
+    if (type_request->is_variant)
     {
-        if (file_path[i] == '\\' || file_path[i] == '/')
+        return ExpandVariantRequest(type_request, hash_table, output_file);
+    }
+    
+    ResolvedRequest resolved;
+    if (!ResolveTemplateRequest(type_request, hash_table, output_file,
+                                &resolved))
+    {
+        return 0;
+    }
+    
+    Template template_at = resolved.template_at;
+    TypeRequest full_request = resolved.full_request;
+    Template function_at = resolved.function_at;
+    TypeRequest function_request = resolved.function_request;
+    
+    TypeRequest *key_request = (template_at.template_name != 0) ?
+        &full_request : &function_request;
+    char *key = GetInstantiationKey(key_request);
+    
+    char *cached_name =
+        GetCachedInstantiation(key, type_request, output_file);
+    
+    if (cached_name)
+    {
+        return cached_name;
+    }
+    
+    char *struct_name = type_request->struct_name ?
+        type_request->struct_name : GetMangledName(key_request);
+    
+    Instantiation *instantiation =
+        AddInstantiation(&instantiation_table, key, struct_name);
+    instantiation->in_progress = TRUE;
+    instantiation->depth = expand_depth;
+    
+    full_request.struct_name = instantiation->struct_name;
+    function_request.struct_name = instantiation->struct_name;
+    
+    StreamBuffer *buffer = &expand_buffers[expand_depth++];
+    buffer->size = 0;
+    
+    if (template_at.template_name != 0)
+    {
+        if (!WriteTemplateToBuffer(&template_at, &full_request, buffer))
         {
-            filename_start = i + 1;
+            ++expand_error_num;
+            --expand_depth;
+            RemoveInstantiation(&instantiation_table, instantiation);
+            return 0;
         }
-        else if ((file_path[i] == '.') && (file_path[i + 1] != '/'))
+        AppendString(buffer, "\n");
+        ResolveNestedTypes(buffer, 0, hash_table, output_file);
+        
+        /* later @if blocks can ask for the size of this instantiation */
+        StructLayout layout;
+        if (GetStructLayout(buffer->data, &type_table, &layout))
         {
-            filename_end = i;
-            break;
+            if (template_at.packed_order)
+            {
+                PackStructFields(buffer, &layout, full_request.struct_name);
+            }
+            
+            if (template_at.vec_math)
+            {
+                AlignVecStruct(buffer, &layout);
+            }
+            
+            TypeInfo *type_info =
+                AddTypeInfo(&type_table, full_request.struct_name,
+                            TypeKind_Struct, FALSE, layout.size, layout.align);
+            type_info->is_dense = IsDenseLayout(&layout, &type_table);
+            
+            if (layout_report_file)
+            {
+                WriteLayoutReport(layout_report_file,
+                                  full_request.struct_name, &layout);
+            }
+            
+            if (template_at.vec_math)
+            {
+                if (!vec_math_prelude_written)
+                {
+                    WriteVecMathPrelude(buffer);
+                    vec_math_prelude_written = TRUE;
+                }
+                
+                if (!WriteVecMath(buffer, full_request.struct_name,
+                                  &layout, &type_table))
+                {
+                    fprintf(stderr, "@vec_math: %s is not 2 to 4 numbers "
+                            "of one type\n", full_request.struct_name);
+                }
+            }
+            
+            if (template_at.serialize)
+            {
+                if (!serialize_prelude_written)
+                {
+                    WriteSerializePrelude(buffer);
+                    serialize_prelude_written = TRUE;
+                }
+                
+                /* nested serializable structs can call this one */
+                type_info->wire_size = WriteSerialize(buffer,
+                                                      full_request.struct_name,
+                                                      &layout, &type_table);
+            }
+            
+            if (template_at.hash)
+            {
+                if (!hash_prelude_written)
+                {
+                    WriteHashPrelude(buffer);
+                    hash_prelude_written = TRUE;
+                }
+                
+                /* templates can ask for it with has_hash */
+                type_info->has_hash = WriteHash(buffer, full_request.struct_name,
+                                                &layout, &type_table);
+            }
+        }
+        else if (template_at.packed_order || template_at.vec_math ||
+                 template_at.serialize || template_at.hash)
+        {
+            fprintf(stderr, "Can't compute the layout of %s\n",
+                    full_request.struct_name);
         }
     }
     
-    u32 filename_length = GetRange(filename_start, filename_end);
-    char *filename = ArenaAlloc(filename_length + 1);
+    if (function_at.template_name != 0)
+    {
+        u64 function_start = buffer->size;
+        
+        if (!WriteTemplateToBuffer(&function_at, &function_request, buffer))
+        {
+            ++expand_error_num;
+            --expand_depth;
+            RemoveInstantiation(&instantiation_table, instantiation);
+            return 0;
+        }
+        AppendString(buffer, "\n");
+        ResolveNestedTypes(buffer, function_start, hash_table, output_file);
+    }
     
-    CopyStringRange(file_path, filename,
-                    filename_start, filename_end);
+    fwrite(buffer->data, 1, buffer->size, output_file);
     
-    return filename;
+    --expand_depth;
+    instantiation->in_progress = FALSE;
+    
+    return instantiation->struct_name;
 }
 
 /*
- Gets the extension of the file from the file path
+ Expands a @template_soa request. The ordinary (AoS) instantiation is
+ expanded or reused first, its layout gives the fields of the
+ struct-of-arrays type, which is cached under its own key.
  */
 internal char *
-GetFileExt(char *file_path)
+ExpandSoARequest(TypeRequest *type_request,
+                 TemplateHashTable *hash_table, FILE *output_file)
 {
-    if(file_path == 0)
+    TypeRequest aos_request = *type_request;
+    aos_request.is_soa = FALSE;
+    aos_request.struct_name = 0;
+    
+    char *aos_name =
+        ExpandTemplateRequest(&aos_request, hash_table, output_file);
+    
+    ResolvedRequest resolved;
+    if (aos_name == 0 ||
+        !ResolveTemplateRequest(&aos_request, hash_table, output_file,
+                                &resolved))
     {
         return 0;
     }
     
-    u32 file_path_length = strlen(file_path);
+    if (resolved.template_at.template_name == 0)
+    {
+        fprintf(stderr, "@template_soa: %s is not a struct template\n",
+                type_request->template_name);
+        return 0;
+    }
     
-    u32 file_ext_start = 0;
-    u32 file_ext_end = file_path_length;
+    char *aos_key = GetInstantiationKey(&resolved.full_request);
+    char *key = ArenaAlloc(strlen(aos_key) + 4);
+    strcpy(key, "soa ");
+    strcat(key, aos_key);
     
-    for (u32 i = 0; i < file_path_length; ++i)
+    char *cached_name =
+        GetCachedInstantiation(key, type_request, output_file);
+    
+    if (cached_name)
     {
-        if (file_path[i] == '.')
-        {
-            file_ext_start = i + 1;
-            break;
-        }
+        return cached_name;
+    }
+    
+    StreamBuffer *buffer = &expand_buffers[expand_depth++];
+    buffer->size = 0;
+    
+    /* the nested types are cached by now, so this writes nothing else */
+    resolved.full_request.struct_name = aos_name;
+    if (!WriteTemplateToBuffer(&resolved.template_at, &resolved.full_request,
+                               buffer))
+    {
+        ++expand_error_num;
+        --expand_depth;
+        return 0;
+    }
+    ResolveNestedTypes(buffer, 0, hash_table, output_file);
+    
+    StructLayout layout;
+    if (!GetStructLayout(buffer->data, &type_table, &layout))
+    {
+        fprintf(stderr, "@template_soa: can't compute the layout of %s\n",
+                aos_name);
+        --expand_depth;
+        return 0;
+    }
+    
+    Instantiation *instantiation =
+        AddInstantiation(&instantiation_table, key, type_request->struct_name);
+    
+    buffer->size = 0;
+    
+    if (!soa_includes_written)
+    {
+        AppendString(buffer, "#include <stdlib.h>\n#include <string.h>\n\n");
+        soa_includes_written = TRUE;
     }
     
-    u32 file_ext_length = GetRange(file_ext_start, file_ext_end);
-    char *file_ext = ArenaAlloc(file_ext_length + 1);
+    WriteSoAToBuffer(buffer, instantiation->struct_name, aos_name, &layout);
     
-    CopyStringRange(file_path, file_ext,
-                    file_ext_start, file_ext_end);
+    fwrite(buffer->data, 1, buffer->size, output_file);
     
-    return file_ext;
+    --expand_depth;
+    
+    return instantiation->struct_name;
 }
 
 /*
- Gets the directory from the file path
+ Expands a @variant request. Member types written as Name<args> are
+ instantiated first; every member has to be a primitive, a pointer or
+ a struct instantiated earlier so that its size is known. The variant
+ is cached under its member list like any other instantiation.
  */
 internal char *
-GetFileWorkingDir(char *file_path)
+ExpandVariantRequest(TypeRequest *type_request,
+                     TemplateHashTable *hash_table, FILE *output_file)
 {
-    if(file_path == 0)
+    if (type_request->struct_name == 0 || type_request->type_num == 0)
     {
+        fprintf(stderr, "@variant needs member types and a name\n");
         return 0;
     }
     
-    u32 file_path_length = strlen(file_path);
+    char *type_names[MAX_TEMPLATE_PARAMS];
+    u64 key_length = strlen("variant<>") + 1;
     
-    u32 working_dir_start = 0;
-    u32 working_dir_end = 0;
+    for (u32 i = 0; i < type_request->type_num; ++i)
+    {
+        type_names[i] = type_request->type_names[i];
+        
+        if (strchr(type_names[i], '<'))
+        {
+            type_names[i] = ExpandNestedType(type_names[i],
+                                             strlen(type_names[i]),
+                                             hash_table, output_file);
+            if (type_names[i] == 0)
+            {
+                return 0;
+            }
+        }
+        key_length += strlen(type_names[i]) + 1;
+    }
     
-    for (u32 i = 0; i < file_path_length; ++i)
+    char *key = ArenaAlloc(key_length);
+    strcpy(key, "variant<");
+    for (u32 i = 0; i < type_request->type_num; ++i)
     {
-        if (file_path[i] == '\\' || file_path[i] == '/')
+        if (i > 0)
         {
-            working_dir_end = i + 1;
+            strcat(key, ",");
         }
+        strcat(key, type_names[i]);
     }
+    strcat(key, ">");
     
-    u32 working_dir_length = GetRange(working_dir_start, working_dir_end);
-    char *working_dir = ArenaAlloc(working_dir_length + 1);
+    char *cached_name =
+        GetCachedInstantiation(key, type_request, output_file);
     
-    CopyStringRange(file_path, working_dir,
-                    working_dir_start, working_dir_end);
+    if (cached_name)
+    {
+        return cached_name;
+    }
     
-    return working_dir;
+    VariantLayout layout;
+    if (!GetVariantLayout(type_names, type_request->type_num, &type_table,
+                          &layout))
+    {
+        return 0;
+    }
+    
+    Instantiation *instantiation =
+        AddInstantiation(&instantiation_table, key, type_request->struct_name);
+    AddTypeInfo(&type_table, instantiation->struct_name, TypeKind_Struct,
+                FALSE, layout.size, layout.align);
+    
+    if (layout_report_file)
+    {
+        WriteVariantReport(layout_report_file, instantiation->struct_name,
+                           &layout);
+    }
+    
+    StreamBuffer *buffer = &expand_buffers[expand_depth++];
+    buffer->size = 0;
+    
+    WriteVariantToBuffer(buffer, instantiation->struct_name, &layout);
+    
+    fwrite(buffer->data, 1, buffer->size, output_file);
+    
+    --expand_depth;
+    
+    return instantiation->struct_name;
 }
 
+/*
+ Builds the output path from the input path and the
+ extension set by ~output_ext (.h by default)
+ */
 internal char *
-ReadFileData(char *file_path)
+GetOutputFilePath(char *file_path)
 {
-    FILE *file = fopen(file_path, "r");
+    char *filename_no_ext = GetFilenameNoExt(file_path);
+    char *file_working_dir = GetFileWorkingDir(file_path);
+    char *output_file_path = (char *)ArenaAlloc(128);
     
-    if (!file)
+    strcpy(output_file_path, file_working_dir);
+    strcat(output_file_path, filename_no_ext);
+    
+    if (file_ext[0] == '\0')
     {
-        return 0;
+        strcat(output_file_path, ".h");
+    }
+    else
+    {
+        strcat(output_file_path, file_ext);
     }
     
-    fseek(file, 0, SEEK_END);
-    u32 file_length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    char *file_contents = ArenaAlloc(file_length);
+    return output_file_path;
+}
+
+/*
+ Expands every template request of a tokenized file into output_file
+ */
+internal void
+WriteTemplateRequests(Tokenizer *tokenizer, FILE *output_file)
+{
+    type_table = GetPrimitiveTypeTable();
+    instantiation_table = GetInstantiationTable();
+    soa_includes_written = FALSE;
+    vec_math_prelude_written = FALSE;
+    serialize_prelude_written = FALSE;
+    hash_prelude_written = FALSE;
     
-    fread(file_contents, 1, file_length, file);
+    TemplateHashTable hash_table =
+        GetTemplateHashTable(tokenizer);
     
-    fclose(file);
+    TemplateTypeRequest type_request =
+        GetTemplateTypeRequests(tokenizer);
     
-    return file_contents;
+    for (u32 i = 0; i < type_request.request_num; ++i)
+    {
+        ExpandTemplateRequest(&type_request.type_requests[i],
+                              &hash_table, output_file);
+    }
 }
 
 internal void
 GenCode(u32 arg_count, char **args)
 {
-    for (u32 i = 1; i < arg_count; ++i)
+    for (u32 i = 0; i < arg_count; ++i)
     {
         char *file_path = args[i];
-        char *filename_no_ext = GetFilenameNoExt(file_path);
-        char *file_working_dir = GetFileWorkingDir(file_path);
-        char *output_file_path = (char *)ArenaAlloc(128);
-        
-        strcpy(output_file_path, file_working_dir);
-        strcat(output_file_path, filename_no_ext);
-        
         char *file_contents = ReadFileData(file_path);
         
         if (file_contents == 0)
@@ -1092,67 +2893,393 @@ GenCode(u32 arg_count, char **args)
             continue;
         }
         
-        if (file_ext[0] == '\0')
+        char *output_file_path = GetOutputFilePath(file_path);
+        FILE *output_file = fopen(output_file_path, "w");
+        
+        if (!output_file)
         {
-            strcat(output_file_path, ".h");
+            fprintf(stderr, "Failed to open output file %s.\n",
+                    output_file_path);
+            file_ext[0] = '\0';
+            ClearArena();
+            continue;
         }
-        else
+        
+        WriteTemplateRequests(&tokenizer, output_file);
+        
+        fclose(output_file);
+        
+        printf("%s -> %s\n", file_path, output_file_path);
+        
+        file_ext[0] = '\0';
+        ClearArena();
+    }
+}
+
+#ifdef GEN_IO_URING
+/*
+ Same as GenCode but all file I/O goes through one io_uring:
+ the next IO_READ_AHEAD inputs are read while the current one is lexed,
+ and every output is expanded into memory and written asynchronously.
+ Returns FALSE without touching any file if io_uring is unavailable.
+ */
+internal b32
+GenCodeBatched(u32 arg_count, char **args)
+{
+    FileBatch batch;
+    
+    if (!InitFileBatch(&batch, arg_count))
+    {
+        return FALSE;
+    }
+    
+    u32 read_ahead = (arg_count < IO_READ_AHEAD) ? arg_count : IO_READ_AHEAD;
+    for (u32 i = 0; i < read_ahead; ++i)
+    {
+        QueueFileRead(&batch, i, args[i]);
+    }
+    
+    for (u32 i = 0; i < arg_count; ++i)
+    {
+        char *file_path = args[i];
+        char *file_contents = WaitFileRead(&batch, i);
+        
+        if (i + IO_READ_AHEAD < arg_count)
+        {
+            QueueFileRead(&batch, i + IO_READ_AHEAD, args[i + IO_READ_AHEAD]);
+        }
+        
+        if (file_contents == 0)
+        {
+            fprintf(stderr, "Failed to read file %s.\n", file_path);
+            continue;
+        }
+        
+        Tokenizer tokenizer = TokenizeFileData(file_contents);
+        
+        if (tokenizer.tokens == 0)
         {
-            strcat(output_file_path, file_ext);
+            fprintf(stderr, "Failed to compile file.\n");
+            free(file_contents);
+            ClearArena();
+            continue;
         }
         
-        TemplateHashTable hash_table =
-            GetTemplateHashTable(&tokenizer);
+        char *output_data = 0;
+        size_t output_size = 0;
+        FILE *output_file = open_memstream(&output_data, &output_size);
+        
+        WriteTemplateRequests(&tokenizer, output_file);
+        
+        fclose(output_file);
+        
+        char *output_file_path = GetOutputFilePath(file_path);
+        QueueFileWrite(&batch, output_file_path, output_data, output_size);
+        
+        printf("%s -> %s\n", file_path, output_file_path);
         
+        free(file_contents);
+        file_ext[0] = '\0';
+        ClearArena();
+    }
+    
+    FinishFileBatch(&batch);
+    
+    return TRUE;
+}
+#endif
+
+internal void
+FreeExpandBuffers()
+{
+    for (u32 i = 0; i < MAX_INSTANTIATION_DEPTH; ++i)
+    {
+        FreeStreamBuffer(&expand_buffers[i]);
+    }
+}
+
+/*
+ Checks if the first word of a line is the given keyword
+ */
+internal b8
+LineStartsWith(char *line, char *keyword)
+{
+    while (*line == ' ' || *line == '\t')
+    {
+        ++line;
+    }
+    
+    u32 keyword_length = strlen(keyword);
+    
+    if (strncmp(line, keyword, keyword_length) != 0)
+    {
+        return FALSE;
+    }
+    
+    char after = line[keyword_length];
+    return (after == ' ' || after == '\t' || after == '\n' ||
+            after == '\r' || after == '\0');
+}
+
+/*
+ Tokenizes a complete @template_start ... @template_end block
+ and adds it to the hash table. The tokens live in the arena for the
+ rest of the run, the text buffer can be reused afterwards.
+ */
+internal void
+DefineStreamTemplate(char *template_text, TemplateHashTable *hash_table)
+{
+    Tokenizer tokenizer = TokenizeFileData(template_text);
+    
+    if (tokenizer.tokens == 0)
+    {
+        return;
+    }
+    
+    do
+    {
+        if (GetTokenizerAt(&tokenizer)->token_type == Token_TemplateStart ||
+            GetTokenizerAt(&tokenizer)->token_type == Token_TemplateSpecialize ||
+            GetTokenizerAt(&tokenizer)->token_type == Token_TemplateFunction)
+        {
+            InsertTemplate(hash_table, GetTemplateAt(&tokenizer));
+            break;
+        }
+    } while (IncrementTokenizerNoWhitespace(&tokenizer));
+}
+
+/*
+ Expands every @template request on a line straight to the output.
+ Everything allocated while doing so is released before returning.
+ */
+internal void
+ExpandStreamRequest(char *line, TemplateHashTable *hash_table,
+                    FILE *output_file)
+{
+    TemporaryMemory temp_memory = BeginTemporaryMemory(&arena);
+    
+    Tokenizer tokenizer = TokenizeFileData(line);
+    
+    if (tokenizer.tokens != 0)
+    {
         TemplateTypeRequest type_request =
             GetTemplateTypeRequests(&tokenizer);
         
-        FILE *output_file = fopen(output_file_path, "w");
-        
         for (u32 i = 0; i < type_request.request_num; ++i)
         {
-            Template template_at =
-                LookupHashTable(type_request.type_requests[i].template_name,
-                                &hash_table);
-            
-            ReplaceTypeName(&template_at,
-                            type_request.type_requests[i].type_name,
-                            type_request.type_requests[i].struct_name);
+            ExpandTemplateRequest(&type_request.type_requests[i],
+                                  hash_table, output_file);
+        }
+    }
+    
+    EndTemporaryMemory(temp_memory);
+}
+
+/*
+ Handles one complete line of streamed input.
+ Template definitions are buffered until @template_end, requests are
+ expanded right away and every other line is dropped.
+ */
+internal void
+ProcessStreamLine(char *line, StreamBuffer *template_buffer,
+                  TemplateHashTable *hash_table, FILE *output_file)
+{
+    if (template_buffer->size != 0)
+    {
+        AppendStreamBuffer(template_buffer, line, strlen(line));
+        
+        if (LineStartsWith(line, "@template_end"))
+        {
+            DefineStreamTemplate(template_buffer->data, hash_table);
+            template_buffer->size = 0;
+        }
+    }
+    else if (LineStartsWith(line, "@template_start") ||
+             LineStartsWith(line, "@template_specialize") ||
+             LineStartsWith(line, "@template_fn"))
+    {
+        AppendStreamBuffer(template_buffer, line, strlen(line));
+    }
+    else if (LineStartsWith(line, "@template") ||
+             LineStartsWith(line, "@template_soa") ||
+             LineStartsWith(line, "@variant"))
+    {
+        ExpandStreamRequest(line, hash_table, output_file);
+    }
+}
+
+/*
+ Streaming mode: reads the input in fixed-size chunks and writes
+ each expansion as soon as its request line is complete. Memory use is
+ bounded by the template definitions and the longest line, not by the
+ size of the input, so this also works for pipes and multi-GB inputs.
+ */
+internal void
+GenCodeStream(FILE *input_file, FILE *output_file)
+{
+    TemplateHashTable hash_table =
+        AllocTemplateHashTable(STREAM_TEMPLATE_BUCKETS);
+    type_table = GetPrimitiveTypeTable();
+    instantiation_table = GetInstantiationTable();
+    soa_includes_written = FALSE;
+    vec_math_prelude_written = FALSE;
+    serialize_prelude_written = FALSE;
+    hash_prelude_written = FALSE;
+    
+    StreamBuffer line_buffer = {0};
+    StreamBuffer template_buffer = {0};
+    
+    char *chunk = RequestMem(STREAM_CHUNK_SIZE);
+    VOID_CHECK(chunk);
+    
+    u64 bytes_read = 0;
+    while ((bytes_read = fread(chunk, 1, STREAM_CHUNK_SIZE, input_file)) > 0)
+    {
+        char *at = chunk;
+        char *end = chunk + bytes_read;
+        
+        while (at < end)
+        {
+            char *line_end = memchr(at, '\n', end - at);
             
-            if (template_at.template_name != 0)
+            if (line_end == 0)
             {
-                WriteTemplateToFile(&template_at, output_file);
+                AppendStreamBuffer(&line_buffer, at, end - at);
+                break;
             }
             
-            fprintf(output_file, "\n");
+            AppendStreamBuffer(&line_buffer, at, line_end - at + 1);
+            ProcessStreamLine(line_buffer.data, &template_buffer,
+                              &hash_table, output_file);
+            line_buffer.size = 0;
+            
+            at = line_end + 1;
         }
-        
-        fclose(output_file);
-        
-        file_ext[0] = '\0';
-        ClearArena();
-        
-        printf("%s -> %s\n", file_path, output_file_path);
     }
+    
+    if (line_buffer.size != 0)
+    {
+        ProcessStreamLine(line_buffer.data, &template_buffer,
+                          &hash_table, output_file);
+    }
+    
+    if (template_buffer.size != 0)
+    {
+        fprintf(stderr, "Missing @template_end at end of input.\n");
+    }
+    
+    fflush(output_file);
+    
+    FreeMem(chunk, STREAM_CHUNK_SIZE);
+    FreeStreamBuffer(&line_buffer);
+    FreeStreamBuffer(&template_buffer);
 }
 
 s32
 main(s32 arg_count, char **args)
 {
-    if (arg_count < 2)
+    b32 use_stdio = FALSE;
+    b32 layout_report = FALSE;
+    u32 first_file = 1;
+    
+    for (; first_file < cast(arg_count, u32) &&
+         strncmp(args[first_file], "--", 2) == 0 &&
+         strcmp(args[first_file], "--stream") != 0;
+         ++first_file)
+    {
+        if (strcmp(args[first_file], "--stdio") == 0)
+        {
+            use_stdio = TRUE;
+        }
+        else if (strcmp(args[first_file], "--layout-report") == 0)
+        {
+            layout_report = TRUE;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", args[first_file]);
+            return -1;
+        }
+    }
+    
+    if (first_file >= cast(arg_count, u32))
     {
         fprintf(stderr, "Specify file name as first argument");
         return -1;
     }
     
+    if (strcmp(args[first_file], "--stream") == 0)
+    {
+        FILE *input_file = stdin;
+        char *input_path = (first_file + 1 < cast(arg_count, u32)) ?
+            args[first_file + 1] : "-";
+        
+        if (strcmp(input_path, "-") != 0)
+        {
+            input_file = fopen(input_path, "r");
+            
+            if (!input_file)
+            {
+                fprintf(stderr, "Failed to read file %s.\n", input_path);
+                return -1;
+            }
+        }
+        
+        /* stdout carries the generated code */
+        if (layout_report)
+        {
+            layout_report_file = stderr;
+        }
+        
+        InitArena(gigabytes((u64)2));
+        GenCodeStream(input_file, stdout);
+        FreeArena();
+        FreeExpandBuffers();
+        
+        if (input_file != stdin)
+        {
+            fclose(input_file);
+        }
+        
+        return (expand_error_num > 0) ? 1 : 0;
+    }
+    
+    if (layout_report)
+    {
+        layout_report_file = stdout;
+    }
+    
+    u32 file_num = cast(arg_count, u32) - first_file;
+    char **file_paths = args + first_file;
+    
     f64 time_start = GetTime();
     {
-        InitArena(gigabytes((u32)2));
-        GenCode(cast(arg_count, u32), args);
+        InitArena(gigabytes((u64)2));
+        
+        b32 batched = FALSE;
+#ifdef GEN_IO_URING
+        if (!use_stdio)
+        {
+            batched = GenCodeBatched(file_num, file_paths);
+        }
+#endif
+        if (!batched)
+        {
+            GenCode(file_num, file_paths);
+        }
+        
         FreeArena();
+        FreeExpandBuffers();
     }
     f64 time_end = GetTime();
     
+    if (expand_error_num > 0)
+    {
+        fprintf(stderr, "Code generation failed, %u template expansions "
+                "had errors.\n", expand_error_num);
+        return 1;
+    }
+    
     printf("Code generation succeeded in %f seconds.\n",
            time_end - time_start);
     
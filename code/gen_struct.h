@@ -0,0 +1,284 @@
+#ifndef GEN_STRUCT_H
+#define GEN_STRUCT_H
+
+/* maximum number of parameters in a template declaration or request */
+#define MAX_TEMPLATE_PARAMS 16
+
+typedef enum TokenTypes
+{
+    Token_Template,
+    Token_TemplateStart,
+    Token_TemplateEnd,
+    Token_TemplateTypeName,
+    Token_TemplateType,
+    Token_TemplateName,
+    Token_TemplateNameStatement,
+    Token_TemplateTypeIndicator,
+    Token_GenStructName,
+    Token_Identifier,
+    Token_Whitespace,
+    Token_BracketOpen,
+    Token_BracketClose,
+    Token_ParentheticalOpen,
+    Token_ParentheticalClose,
+    Token_Semicolon,
+    Token_EndOfFile,
+    Token_FeedSymbol,
+    Token_SpecialProcess,
+    Token_Comment,
+    Token_Comma,
+    Token_SquareOpen,
+    Token_SquareClose,
+    Token_If,
+    Token_Else,
+    Token_EndIf,
+    Token_TemplateSpecialize,
+    Token_TemplateFunction,
+    Token_PackedOrder,
+    Token_TemplateSoA,
+    Token_VecMath,
+    Token_Variant,
+    Token_Serialize,
+    Token_Hash,
+    Token_Instrument,
+} TokenTypes;
+
+typedef struct Token
+{
+    TokenTypes token_type;
+    /* position in the parameter list for Token_TemplateTypeName */
+    u32 param_index;
+    char *token_data;
+} Token;
+
+typedef struct Tokenizer
+{
+    Token *tokens;
+    Token *at;
+    u32 token_num;
+} Tokenizer;
+
+typedef struct Template Template;
+struct Template
+{
+    char *template_name;
+    char *param_names[MAX_TEMPLATE_PARAMS];
+    /* default for integer value parameters (N:4), 0 for type parameters */
+    char *param_defaults[MAX_TEMPLATE_PARAMS];
+    u32 param_num;
+
+    /* arguments a @template_specialize block is written for */
+    b32 is_specialization;
+    char *type_names[MAX_TEMPLATE_PARAMS];
+    u32 type_num;
+
+    /* @template_fn block, emitted after the struct of the same name */
+    b32 is_function;
+    /* @packed_order: fields are sorted by alignment when expanded */
+    b32 packed_order;
+    /* @vec_math: vector math kernels are generated for the struct */
+    b32 vec_math;
+    /* @serialize: a field table and serialize functions are generated */
+    b32 serialize;
+    /* @hash: Hash_<name> and Equal_<name> are generated */
+    b32 hash;
+
+    Tokenizer tokenizer;
+    /* index of the first token after the @template_start line */
+    u32 body_start;
+
+    Template *next;
+};
+
+typedef struct TemplateHashTable
+{
+    Template *templates;
+    u32 num;
+    u32 specialization_num;
+    u32 function_num;
+} TemplateHashTable;
+
+typedef struct TypeRequest
+{
+    char *template_name;
+    char *type_names[MAX_TEMPLATE_PARAMS];
+    u32 type_num;
+    char *struct_name;
+    /* @template_soa: generate the struct-of-arrays form */
+    b32 is_soa;
+    /* @variant: type_names are the members of a tagged union */
+    b32 is_variant;
+} TypeRequest;
+
+/*
+ a request with its nested arguments instantiated, the templates it
+ expands and the arguments for each of them with defaults filled in
+ */
+typedef struct ResolvedRequest
+{
+    Template template_at;
+    TypeRequest full_request;
+    Template function_at;
+    TypeRequest function_request;
+} ResolvedRequest;
+
+typedef struct TemplateTypeRequest
+{
+    TypeRequest *type_requests;
+    u32 request_num;
+} TemplateTypeRequest;
+
+typedef struct MemoryArena
+{
+    void *memory;
+    u64 size;
+    u64 size_left;
+    u64 offset;
+} MemoryArena;
+
+typedef struct TemporaryMemory
+{
+    MemoryArena *arena;
+    u64 offset;
+} TemporaryMemory;
+
+/*
+ growable byte buffer backed by platform memory instead of the arena,
+ so that it can be reused for every line of a streamed input
+ */
+typedef struct StreamBuffer
+{
+    char *data;
+    u64 size;
+    u64 capacity;
+} StreamBuffer;
+
+/* maximum nesting of @if blocks inside one template */
+#define MAX_CONDITIONAL_DEPTH 32
+
+/* cache line size assumed by --layout-report */
+#define CACHE_LINE_SIZE 64
+
+/* number of hash buckets in the type table */
+#define TYPE_TABLE_BUCKETS 256
+
+typedef enum TypeKind
+{
+    TypeKind_Integer,
+    TypeKind_Float,
+    TypeKind_Pointer,
+    TypeKind_Struct,
+} TypeKind;
+
+/*
+ size and alignment of a type known to the generator, either a
+ primitive from layer.h or a struct instantiated earlier in the run
+ */
+typedef struct TypeInfo TypeInfo;
+struct TypeInfo
+{
+    char *type_name;
+    TypeKind type_kind;
+    b32 is_signed;
+    u64 size;
+    u64 align;
+    /* bytes written by @serialize, 0 if the type can't be serialized */
+    u64 wire_size;
+    /* no padding anywhere, so the bytes can be hashed and compared */
+    b32 is_dense;
+    /* Hash_<name> and Equal_<name> were generated by @hash */
+    b32 has_hash;
+
+    TypeInfo *next;
+};
+
+typedef struct TypeTable
+{
+    TypeInfo **buckets;
+    u32 num;
+    u32 type_num;
+} TypeTable;
+
+typedef struct StructField
+{
+    char *field_name;
+    char *type_name;
+    b32 is_pointer;
+    /* number of elements, 1 unless the field is an array */
+    u64 count;
+
+    u64 size;
+    u64 align;
+    u64 offset;
+} StructField;
+
+/*
+ one field declaration such as "T x, y;" together with the whitespace
+ before it, as offsets into the text the layout was parsed from
+ */
+typedef struct StructDeclaration
+{
+    u64 start;
+    u64 end;
+    u32 first_field;
+    u32 field_num;
+    u64 align;
+} StructDeclaration;
+
+typedef struct StructLayout
+{
+    StructField *fields;
+    u32 field_num;
+    StructDeclaration *declarations;
+    u32 declaration_num;
+
+    u64 size;
+    u64 align;
+} StructLayout;
+
+/* number of hash buckets in the instantiation cache */
+#define INSTANTIATION_TABLE_BUCKETS 256
+
+/* how deep Name<Name<...>> instantiations may nest */
+#define MAX_INSTANTIATION_DEPTH 32
+
+/* a concrete type expanded in the current run */
+typedef struct Instantiation Instantiation;
+struct Instantiation
+{
+    /* Name<A,B> with resolved and defaulted arguments */
+    char *key;
+    char *struct_name;
+    /* still being expanded, set while its nested types are instantiated */
+    b32 in_progress;
+    u32 depth;
+
+    Instantiation *next;
+};
+
+typedef struct InstantiationTable
+{
+    Instantiation **buckets;
+    u32 num;
+    u32 instantiation_num;
+} InstantiationTable;
+
+/* one open @if block while expanding a template */
+typedef struct ConditionalBlock
+{
+    b32 parent_active;
+    b32 condition;
+    b32 in_else;
+} ConditionalBlock;
+
+/* word list of an @if expression with a read position */
+typedef struct ConditionExpression
+{
+    char **words;
+    u32 word_num;
+    u32 at;
+
+    b32 failed;
+} ConditionExpression;
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ Tagged union generation for @variant.
+
+ "@variant A, B, C -> Name" wraps the member types in an anonymous
+ union followed by the smallest unsigned tag that can number them.
+ The union starts at offset 0, so a pointer to the variant is also a
+ pointer to the member in use, and the tag goes right after it. The
+ generator emits constructors, checked accessors and a switch-based
+ visit macro; the tags are dense from 0, so the switch compiles to a
+ jump table.
+ */
+
+/* maximum number of member types of one @variant */
+#define MAX_VARIANT_MEMBERS MAX_TEMPLATE_PARAMS
+
+typedef struct VariantMember
+{
+    char *type_name;
+    /* union field and function suffix: Vec3_f32 becomes vec3_f32 */
+    char *field_name;
+    /* tag constant suffix: the type name with * as Ptr */
+    char *tag_name;
+    u64 size;
+    u64 align;
+} VariantMember;
+
+typedef struct VariantLayout
+{
+    VariantMember members[MAX_VARIANT_MEMBERS];
+    u32 member_num;
+    char *tag_type;
+    u64 tag_size;
+    u64 tag_offset;
+    /* index of the largest member */
+    u32 largest;
+
+    u64 size;
+    u64 align;
+} VariantLayout;
+
+/*
+ Turns a type name into an identifier: every run of other characters
+ becomes one underscore, * becomes Ptr, and letters are lowered if
+ lower is set
+ */
+internal char *
+GetVariantIdentifier(char *type_name, b8 lower)
+{
+    char *name = ArenaAlloc(4 * strlen(type_name) + 1);
+    u64 at = 0;
+
+    for (char *c = type_name; *c; ++c)
+    {
+        if (IsIdentifierChar(*c))
+        {
+            name[at++] = (lower && *c >= 'A' && *c <= 'Z') ? *c - 'A' + 'a' : *c;
+            continue;
+        }
+
+        if (at > 0 && name[at - 1] != '_')
+        {
+            name[at++] = '_';
+        }
+
+        if (*c == '*')
+        {
+            strcpy(name + at, lower ? "ptr" : "Ptr");
+            at += 3;
+        }
+    }
+
+    while (at > 0 && name[at - 1] == '_')
+    {
+        --at;
+    }
+    name[at] = '\0';
+
+    return name;
+}
+
+/*
+ Fills in the members of layout from the resolved member type names
+ and computes the size of the variant. Returns FALSE if a type is
+ unknown to the generator or named twice.
+ */
+internal b8
+GetVariantLayout(char **type_names, u32 type_num, TypeTable *type_table,
+                 VariantLayout *layout)
+{
+    *layout = (VariantLayout){0};
+
+    u64 union_size = 0;
+    layout->align = 1;
+
+    for (u32 i = 0; i < type_num; ++i)
+    {
+        TypeInfo *type_info = GetTypeInfo(type_table, type_names[i]);
+        if (type_info == 0)
+        {
+            fprintf(stderr, "@variant: unknown member type %s\n",
+                    type_names[i]);
+            return FALSE;
+        }
+
+        VariantMember *member = &layout->members[layout->member_num++];
+        member->type_name = type_names[i];
+        member->field_name = GetVariantIdentifier(type_names[i], TRUE);
+        member->tag_name = GetVariantIdentifier(type_names[i], FALSE);
+        member->size = type_info->size;
+        member->align = type_info->align;
+
+        for (u32 j = 0; j < i; ++j)
+        {
+            if (strcmp(layout->members[j].field_name, member->field_name) == 0)
+            {
+                fprintf(stderr, "@variant: member type %s named twice\n",
+                        type_names[i]);
+                return FALSE;
+            }
+        }
+
+        if (member->size > union_size)
+        {
+            union_size = member->size;
+            layout->largest = i;
+        }
+        if (member->align > layout->align)
+        {
+            layout->align = member->align;
+        }
+    }
+
+    union_size = AlignUp(union_size, layout->align);
+
+    if (type_num <= 256)
+    {
+        layout->tag_type = "u8";
+        layout->tag_size = 1;
+    }
+    else
+    {
+        layout->tag_type = "u16";
+        layout->tag_size = 2;
+    }
+
+    if (layout->tag_size > layout->align)
+    {
+        layout->align = layout->tag_size;
+    }
+
+    layout->tag_offset = AlignUp(union_size, layout->tag_size);
+    layout->size = AlignUp(layout->tag_offset + layout->tag_size,
+                           layout->align);
+
+    return TRUE;
+}
+
+/* size report of a variant for --layout-report */
+internal void
+WriteVariantReport(FILE *file, char *variant_name, VariantLayout *layout)
+{
+    u64 largest = layout->members[layout->largest].size;
+
+    fprintf(file, "%s: variant of %u, size %llu, align %llu, "
+            "%s tag at %llu, padding %llu\n",
+            variant_name, layout->member_num,
+            (unsigned long long)layout->size,
+            (unsigned long long)layout->align, layout->tag_type,
+            (unsigned long long)layout->tag_offset,
+            (unsigned long long)(layout->size - largest - layout->tag_size));
+    fprintf(file, "    %8s %6s  %s\n", "size", "align", "member");
+
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        VariantMember *member = &layout->members[i];
+
+        fprintf(file, "    %8llu %6llu  %s\n",
+                (unsigned long long)member->size,
+                (unsigned long long)member->align, member->type_name);
+    }
+    fprintf(file, "\n");
+}
+
+internal void
+WriteVariantToBuffer(StreamBuffer *buffer, char *variant_name,
+                     VariantLayout *layout)
+{
+    AppendFormat(buffer,
+                 "/*\n %s: size %llu, align %llu, %s tag at offset %llu\n",
+                 variant_name, (unsigned long long)layout->size,
+                 (unsigned long long)layout->align, layout->tag_type,
+                 (unsigned long long)layout->tag_offset);
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        VariantMember *member = &layout->members[i];
+        AppendFormat(buffer, " %s: size %llu, align %llu\n",
+                     member->type_name, (unsigned long long)member->size,
+                     (unsigned long long)member->align);
+    }
+    AppendString(buffer, " */\n");
+
+    AppendFormat(buffer, "typedef enum %s_Tag\n{\n", variant_name);
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        AppendFormat(buffer, "    %s_Tag_%s,\n",
+                     variant_name, layout->members[i].tag_name);
+    }
+    AppendFormat(buffer, "    %s_Tag_Count\n} %s_Tag;\n\n",
+                 variant_name, variant_name);
+
+    AppendFormat(buffer, "typedef struct %s %s;\n", variant_name, variant_name);
+    AppendFormat(buffer, "struct %s\n{\n    union\n    {\n", variant_name);
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        AppendFormat(buffer, "        %s %s;\n",
+                     layout->members[i].type_name,
+                     layout->members[i].field_name);
+    }
+    AppendFormat(buffer, "    };\n    %s tag;\n};\n\n", layout->tag_type);
+
+    AppendFormat(buffer,
+                 "_Static_assert(sizeof(%s) == %llu, "
+                 "\"unexpected size of %s\");\n\n",
+                 variant_name, (unsigned long long)layout->size,
+                 variant_name);
+
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        VariantMember *member = &layout->members[i];
+
+        AppendFormat(buffer,
+                     "static inline %s\n"
+                     "%s_from_%s(%s value)\n{\n"
+                     "    %s variant;\n"
+                     "    variant.%s = value;\n"
+                     "    variant.tag = %s_Tag_%s;\n"
+                     "    return variant;\n}\n\n",
+                     variant_name, variant_name, member->field_name,
+                     member->type_name, variant_name, member->field_name,
+                     variant_name, member->tag_name);
+
+        AppendFormat(buffer,
+                     "/* the member if it is the one in use, or 0 */\n"
+                     "static inline %s *\n"
+                     "%s_as_%s(%s *variant)\n{\n"
+                     "    return (variant->tag == %s_Tag_%s) ? "
+                     "&variant->%s : 0;\n}\n\n",
+                     member->type_name, variant_name, member->field_name,
+                     variant_name, variant_name, member->tag_name,
+                     member->field_name);
+    }
+
+    AppendFormat(buffer,
+                 "static inline char *\n"
+                 "%s_tag_name(u32 tag)\n{\n"
+                 "    switch (tag)\n    {\n",
+                 variant_name);
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        AppendFormat(buffer,
+                     "        case %s_Tag_%s: return \"%s\";\n",
+                     variant_name, layout->members[i].tag_name,
+                     layout->members[i].type_name);
+    }
+    AppendString(buffer, "        default: return \"\";\n    }\n}\n\n");
+
+    /* visit, one case per member so the compiler sees every call */
+    AppendFormat(buffer,
+                 "/*\n"
+                 " calls prefix_member(&variant->member, context) for the"
+                 " member in use,\n"
+                 " for example prefix_%s; variant is evaluated more than once\n"
+                 " */\n"
+                 "#define %s_visit(variant, prefix, context) \\\n"
+                 "    do \\\n    { \\\n"
+                 "        switch ((variant)->tag) \\\n        { \\\n",
+                 layout->members[0].field_name, variant_name);
+    for (u32 i = 0; i < layout->member_num; ++i)
+    {
+        VariantMember *member = &layout->members[i];
+        AppendFormat(buffer,
+                     "            case %s_Tag_%s: "
+                     "prefix##_%s(&(variant)->%s, context); break; \\\n",
+                     variant_name, member->tag_name,
+                     member->field_name, member->field_name);
+    }
+    AppendString(buffer,
+                 "            default: break; \\\n"
+                 "        } \\\n    } while (0)\n\n");
+}
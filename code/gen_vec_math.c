@@ -0,0 +1,428 @@
+/*
+ Vector math generation for @vec_math.
+
+ A struct whose fields are 2 to 4 numbers of one type gets add, sub,
+ mul and scale kernels (plus dot, length and normalize for floats) and
+ batch variants over arrays. If the struct is a power of two between 8
+ and 32 bytes it is aligned to its size, so Vec4f fills one 16-byte
+ register and single-vector kernels use SSE2/AVX. Batch kernels treat
+ the arrays as flat runs of numbers and use the widest instructions the
+ compiler enables. Everything falls back to scalar code otherwise.
+ */
+
+/* intrinsics for one vector width of one element type */
+typedef struct VecSimdOps
+{
+    /* macro set by the prelude when these intrinsics are available */
+    char *guard;
+    char *vector_type;
+    char *load;
+    char *loadu;
+    char *store;
+    char *storeu;
+    char *add;
+    char *sub;
+    /* 0 if there is no lane-wise multiply for the type */
+    char *mul;
+    char *set1;
+    u32 lanes;
+} VecSimdOps;
+
+global VecSimdOps vec_f32_ops[] =
+{
+    {"GEN_VEC_AVX", "__m256", "_mm256_load_ps(%s)", "_mm256_loadu_ps(%s)",
+     "_mm256_store_ps(%s, %s)", "_mm256_storeu_ps(%s, %s)",
+     "_mm256_add_ps", "_mm256_sub_ps", "_mm256_mul_ps", "_mm256_set1_ps", 8},
+    {"GEN_VEC_SSE2", "__m128", "_mm_load_ps(%s)", "_mm_loadu_ps(%s)",
+     "_mm_store_ps(%s, %s)", "_mm_storeu_ps(%s, %s)",
+     "_mm_add_ps", "_mm_sub_ps", "_mm_mul_ps", "_mm_set1_ps", 4},
+};
+
+global VecSimdOps vec_f64_ops[] =
+{
+    {"GEN_VEC_AVX", "__m256d", "_mm256_load_pd(%s)", "_mm256_loadu_pd(%s)",
+     "_mm256_store_pd(%s, %s)", "_mm256_storeu_pd(%s, %s)",
+     "_mm256_add_pd", "_mm256_sub_pd", "_mm256_mul_pd", "_mm256_set1_pd", 4},
+    {"GEN_VEC_SSE2", "__m128d", "_mm_load_pd(%s)", "_mm_loadu_pd(%s)",
+     "_mm_store_pd(%s, %s)", "_mm_storeu_pd(%s, %s)",
+     "_mm_add_pd", "_mm_sub_pd", "_mm_mul_pd", "_mm_set1_pd", 2},
+};
+
+global VecSimdOps vec_i32_ops[] =
+{
+    {"GEN_VEC_AVX2", "__m256i", "_mm256_load_si256((__m256i *)(%s))",
+     "_mm256_loadu_si256((__m256i *)(%s))",
+     "_mm256_store_si256((__m256i *)(%s), %s)",
+     "_mm256_storeu_si256((__m256i *)(%s), %s)",
+     "_mm256_add_epi32", "_mm256_sub_epi32", "_mm256_mullo_epi32",
+     "_mm256_set1_epi32", 8},
+    {"GEN_VEC_SSE2", "__m128i", "_mm_load_si128((__m128i *)(%s))",
+     "_mm_loadu_si128((__m128i *)(%s))",
+     "_mm_store_si128((__m128i *)(%s), %s)",
+     "_mm_storeu_si128((__m128i *)(%s), %s)",
+     "_mm_add_epi32", "_mm_sub_epi32", 0, "_mm_set1_epi32", 4},
+};
+
+/* the intrinsic table for an element type, widest first */
+internal VecSimdOps *
+GetVecSimdOps(TypeInfo *type_info, u32 *ops_num)
+{
+    *ops_num = 2;
+
+    if (type_info->type_kind == TypeKind_Float && type_info->size == 4)
+    {
+        return vec_f32_ops;
+    }
+    if (type_info->type_kind == TypeKind_Float && type_info->size == 8)
+    {
+        return vec_f64_ops;
+    }
+    if (type_info->type_kind == TypeKind_Integer && type_info->size == 4)
+    {
+        return vec_i32_ops;
+    }
+
+    *ops_num = 0;
+    return 0;
+}
+
+internal void
+WriteVecMathPrelude(StreamBuffer *buffer)
+{
+    AppendString(buffer,
+                 "#ifndef GEN_VEC_MATH_PRELUDE\n"
+                 "#define GEN_VEC_MATH_PRELUDE\n"
+                 "#include <math.h>\n"
+                 "#if defined(__SSE2__) || defined(_M_X64)\n"
+                 "#include <emmintrin.h>\n"
+                 "#define GEN_VEC_SSE2\n"
+                 "#endif\n"
+                 "#if defined(__AVX__)\n"
+                 "#include <immintrin.h>\n"
+                 "#define GEN_VEC_AVX\n"
+                 "#endif\n"
+                 "#if defined(__AVX2__)\n"
+                 "#define GEN_VEC_AVX2\n"
+                 "#endif\n"
+                 "#endif\n\n");
+}
+
+/*
+ Checks that a struct is 2 to 4 fields of one arithmetic type and
+ returns that type, or 0
+ */
+internal TypeInfo *
+GetVecElementType(StructLayout *layout, TypeTable *type_table)
+{
+    if (layout->field_num < 2 || layout->field_num > 4)
+    {
+        return 0;
+    }
+
+    TypeInfo *element = 0;
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        StructField *field = &layout->fields[i];
+        TypeInfo *type_info = GetTypeInfo(type_table, field->type_name);
+
+        if (field->is_pointer || field->count != 1 || type_info == 0 ||
+            (type_info->type_kind != TypeKind_Integer &&
+             type_info->type_kind != TypeKind_Float) ||
+            (element && element != type_info))
+        {
+            return 0;
+        }
+
+        element = type_info;
+    }
+
+    return element;
+}
+
+/*
+ Adds _Alignas(size) in front of the first field when the struct is a
+ power of two between 8 and 32 bytes, so it fits one SIMD register
+ */
+internal void
+AlignVecStruct(StreamBuffer *buffer, StructLayout *layout)
+{
+    u64 size = layout->size;
+
+    if (size < 8 || size > 32 || (size & (size - 1)) != 0 ||
+        layout->align >= size)
+    {
+        return;
+    }
+
+    u64 insert_at = layout->declarations[0].start;
+    while (buffer->data[insert_at] == ' ' || buffer->data[insert_at] == '\t' ||
+           buffer->data[insert_at] == '\n' || buffer->data[insert_at] == '\r')
+    {
+        ++insert_at;
+    }
+
+    char alignment[32];
+    s32 length = snprintf(alignment, sizeof(alignment), "_Alignas(%llu) ",
+                          (unsigned long long)size);
+
+    u64 tail_size = buffer->size - insert_at;
+    char *tail = ArenaAlloc(tail_size);
+    memcpy(tail, buffer->data + insert_at, tail_size);
+
+    buffer->size = insert_at;
+    AppendStreamBuffer(buffer, alignment, length);
+    AppendStreamBuffer(buffer, tail, tail_size);
+
+    layout->align = size;
+}
+
+/*
+ Writes a component-wise kernel. op is the C operator; with scalar
+ set the right hand side is a single number instead of a vector.
+ */
+internal void
+WriteVecLaneKernel(StreamBuffer *buffer, char *name, char *element_name,
+                   StructLayout *layout, VecSimdOps *ops, char *suffix,
+                   char *op, char *simd_op, b32 scalar)
+{
+    AppendFormat(buffer, "static inline %s\n%s_%s(%s a, %s b)\n{\n"
+                 "    %s result;\n",
+                 name, name, suffix, name,
+                 scalar ? element_name : name, name);
+
+    char *first = layout->fields[0].field_name;
+
+    /* field names have any length, so the pieces are sized to fit */
+    if (ops && simd_op)
+    {
+        char *target = ArenaFormat("&result.%s", first);
+        char *source_a = ArenaFormat("&a.%s", first);
+        char *source_b = ArenaFormat("&b.%s", first);
+
+        char *loaded_a = ArenaFormat(ops->load, source_a);
+        char *loaded_b = scalar ?
+            ArenaFormat("%s(b)", ops->set1) : ArenaFormat(ops->load, source_b);
+        char *value = ArenaFormat("%s(%s, %s)", simd_op, loaded_a, loaded_b);
+        char *stored = ArenaFormat(ops->store, target, value);
+
+        AppendFormat(buffer, "#ifdef %s\n    %s;\n#else\n",
+                     ops->guard, stored);
+    }
+
+    for (u32 i = 0; i < layout->field_num; ++i)
+    {
+        char *field = layout->fields[i].field_name;
+
+        if (scalar)
+        {
+            AppendFormat(buffer, "    result.%s = a.%s %s b;\n",
+                         field, field, op);
+        }
+        else
+        {
+            AppendFormat(buffer, "    result.%s = a.%s %s b.%s;\n",
+                         field, field, op, field);
+        }
+    }
+
+    if (ops && simd_op)
+    {
+        AppendString(buffer, "#endif\n");
+    }
+
+    AppendString(buffer, "    return result;\n}\n\n");
+}
+
+/*
+ Writes a batch kernel over arrays. When the struct has no padding the
+ arrays are one flat run of numbers, processed a register at a time
+ with the widest available instructions and a scalar tail.
+ */
+internal void
+WriteVecBatchKernel(StreamBuffer *buffer, char *name, char *element_name,
+                    StructLayout *layout, VecSimdOps *ops, u32 ops_num,
+                    b32 is_flat, char *suffix, char *op, b32 scalar)
+{
+    AppendFormat(buffer, "static inline void\n"
+                 "%s_%s_array(%s *out, %s *a, %s %sb, u64 count)\n{\n",
+                 name, suffix, name, name,
+                 scalar ? element_name : name, scalar ? "" : "*");
+
+    if (!is_flat)
+    {
+        AppendFormat(buffer, "    for (u64 i = 0; i < count; ++i)\n"
+                     "    {\n"
+                     "        out[i] = %s_%s(a[i], %s);\n"
+                     "    }\n}\n\n",
+                     name, suffix, scalar ? "b" : "b[i]");
+        return;
+    }
+
+    char *first = layout->fields[0].field_name;
+
+    AppendFormat(buffer, "    %s *o = &out->%s;\n    %s *x = &a->%s;\n",
+                 element_name, first, element_name, first);
+    if (!scalar)
+    {
+        AppendFormat(buffer, "    %s *y = &b->%s;\n", element_name, first);
+    }
+    AppendFormat(buffer, "    u64 n = count * %u;\n    u64 i = 0;\n",
+                 layout->field_num);
+
+    b32 opened = FALSE;
+
+    for (u32 i = 0; i < ops_num; ++i)
+    {
+        char *simd_op = (op[0] == '+') ? ops[i].add :
+            (op[0] == '-') ? ops[i].sub : ops[i].mul;
+
+        if (simd_op == 0)
+        {
+            continue;
+        }
+
+        AppendFormat(buffer, "#%s defined(%s)\n",
+                     opened ? "elif" : "if", ops[i].guard);
+        opened = TRUE;
+
+        char *loaded_a = ArenaFormat(ops[i].loadu, "x + i");
+        char *loaded_b = scalar ?
+            ArenaFormat("%s(b)", ops[i].set1) : ArenaFormat(ops[i].loadu, "y + i");
+        char *value = ArenaFormat("%s(%s, %s)", simd_op, loaded_a, loaded_b);
+        char *stored = ArenaFormat(ops[i].storeu, "o + i", value);
+
+        AppendFormat(buffer, "    for (; i + %u <= n; i += %u)\n"
+                     "    {\n"
+                     "        %s;\n"
+                     "    }\n",
+                     ops[i].lanes, ops[i].lanes, stored);
+    }
+
+    if (opened)
+    {
+        AppendString(buffer, "#endif\n");
+    }
+
+    AppendFormat(buffer, "    for (; i < n; ++i)\n"
+                 "    {\n"
+                 "        o[i] = x[i] %s %s;\n"
+                 "    }\n}\n\n",
+                 op, scalar ? "b" : "y[i]");
+}
+
+/*
+ Writes the vector math functions for the struct in buffer.
+ Returns FALSE if the struct is not a small vector of numbers.
+ */
+internal b8
+WriteVecMath(StreamBuffer *buffer, char *name, StructLayout *layout,
+             TypeTable *type_table)
+{
+    TypeInfo *element = GetVecElementType(layout, type_table);
+
+    if (element == 0)
+    {
+        return FALSE;
+    }
+
+    char *element_name = layout->fields[0].type_name;
+    b32 is_float = (element->type_kind == TypeKind_Float);
+    b32 is_flat = (layout->size == layout->field_num * element->size);
+
+    u32 ops_num = 0;
+    VecSimdOps *ops = GetVecSimdOps(element, &ops_num);
+
+    /* single vectors only use SIMD when they are exactly one register */
+    VecSimdOps *vector_ops = 0;
+    for (u32 i = 0; i < ops_num; ++i)
+    {
+        if (ops[i].lanes * element->size == layout->size &&
+            layout->align >= layout->size)
+        {
+            vector_ops = &ops[i];
+        }
+    }
+
+    WriteVecLaneKernel(buffer, name, element_name, layout, vector_ops,
+                       "add", "+", vector_ops ? vector_ops->add : 0, FALSE);
+    WriteVecLaneKernel(buffer, name, element_name, layout, vector_ops,
+                       "sub", "-", vector_ops ? vector_ops->sub : 0, FALSE);
+    WriteVecLaneKernel(buffer, name, element_name, layout, vector_ops,
+                       "mul", "*", vector_ops ? vector_ops->mul : 0, FALSE);
+    WriteVecLaneKernel(buffer, name, element_name, layout, vector_ops,
+                       "scale", "*", vector_ops ? vector_ops->mul : 0, TRUE);
+
+    if (is_float)
+    {
+        char *sqrt_name = (element->size == 4) ? "sqrtf" : "sqrt";
+
+        AppendFormat(buffer, "static inline %s\n%s_dot(%s a, %s b)\n{\n",
+                     element_name, name, name, name);
+
+        /* horizontal sum of a Vec4f in two shuffles */
+        if (vector_ops && element->size == 4 && layout->field_num == 4 &&
+            strcmp(vector_ops->vector_type, "__m128") == 0)
+        {
+            char *first = layout->fields[0].field_name;
+            AppendFormat(buffer,
+                         "#ifdef GEN_VEC_SSE2\n"
+                         "    __m128 m = _mm_mul_ps(_mm_load_ps(&a.%s), "
+                         "_mm_load_ps(&b.%s));\n"
+                         "    __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, "
+                         "_MM_SHUFFLE(2, 3, 0, 1)));\n"
+                         "    s = _mm_add_ss(s, _mm_movehl_ps(s, s));\n"
+                         "    return _mm_cvtss_f32(s);\n"
+                         "#else\n",
+                         first, first);
+        }
+
+        AppendString(buffer, "    return ");
+        for (u32 i = 0; i < layout->field_num; ++i)
+        {
+            char *field = layout->fields[i].field_name;
+            AppendFormat(buffer, "%sa.%s * b.%s", (i > 0) ? " + " : "",
+                         field, field);
+        }
+        AppendString(buffer, ";\n");
+
+        if (vector_ops && element->size == 4 && layout->field_num == 4 &&
+            strcmp(vector_ops->vector_type, "__m128") == 0)
+        {
+            AppendString(buffer, "#endif\n");
+        }
+        AppendString(buffer, "}\n\n");
+
+        AppendFormat(buffer, "static inline %s\n%s_length(%s a)\n{\n"
+                     "    return %s(%s_dot(a, a));\n}\n\n",
+                     element_name, name, name, sqrt_name, name);
+
+        AppendFormat(buffer, "static inline %s\n%s_normalize(%s a)\n{\n"
+                     "    %s length = %s_length(a);\n"
+                     "    return (length > 0) ? %s_scale(a, 1 / length) : a;\n"
+                     "}\n\n",
+                     name, name, name, element_name, name, name);
+    }
+
+    WriteVecBatchKernel(buffer, name, element_name, layout, ops, ops_num,
+                        is_flat, "add", "+", FALSE);
+    WriteVecBatchKernel(buffer, name, element_name, layout, ops, ops_num,
+                        is_flat, "sub", "-", FALSE);
+    WriteVecBatchKernel(buffer, name, element_name, layout, ops, ops_num,
+                        is_flat, "mul", "*", FALSE);
+    WriteVecBatchKernel(buffer, name, element_name, layout, ops, ops_num,
+                        is_flat, "scale", "*", TRUE);
+
+    if (is_float)
+    {
+        AppendFormat(buffer, "static inline void\n"
+                     "%s_dot_array(%s *out, %s *a, %s *b, u64 count)\n{\n"
+                     "    for (u64 i = 0; i < count; ++i)\n"
+                     "    {\n"
+                     "        out[i] = %s_dot(a[i], b[i]);\n"
+                     "    }\n}\n\n",
+                     name, element_name, name, name, name);
+    }
+
+    return TRUE;
+}
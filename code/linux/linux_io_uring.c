@@ -0,0 +1,458 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "../layer.h"
+#include "linux_io_uring.h"
+
+/*
+ io_uring batched file I/O. Talks to the kernel through the raw
+ syscalls so no liburing is needed. If io_uring_setup fails
+ (old kernel, seccomp, ...) or the ring lacks one of the opcodes used
+ here, InitFileBatch returns FALSE and the caller falls back to stdio. If io_uring_enter fails later the ring
+ is marked broken and every request still queued on it fails.
+ */
+
+/*
+ Kernels 5.1 to 5.5 create rings without OPENAT, READ and WRITE and
+ fail every such request with -EINVAL. Those kernels also lack
+ IORING_REGISTER_PROBE, so a failed probe means no support either.
+ */
+internal b32
+IoRingSupportsFileOps(s32 ring_fd)
+{
+    u8 probe_memory[sizeof(struct io_uring_probe) +
+                    256 * sizeof(struct io_uring_probe_op)] = {0};
+    struct io_uring_probe *probe = (struct io_uring_probe *)probe_memory;
+
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE,
+                probe, 256) < 0)
+    {
+        return FALSE;
+    }
+
+    u8 ops[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE };
+    for (u32 i = 0; i < sizeof(ops) / sizeof(ops[0]); ++i)
+    {
+        if (ops[i] > probe->last_op ||
+            !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+internal b32
+IoRingInit(IoRing *ring, u32 entries)
+{
+    struct io_uring_params params = {0};
+
+    s32 ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring_fd < 0)
+    {
+        return FALSE;
+    }
+
+    if (!IoRingSupportsFileOps(ring_fd))
+    {
+        close(ring_fd);
+        return FALSE;
+    }
+
+    ring->ring_fd = ring_fd;
+    ring->sq_ring_size =
+        params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring->cq_ring_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_ring_size > ring->sq_ring_size)
+        {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(0, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd,
+                         IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED)
+    {
+        close(ring_fd);
+        return FALSE;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cq_ring = ring->sq_ring;
+    }
+    else
+    {
+        ring->cq_ring = mmap(0, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd,
+                             IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED)
+        {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring_fd);
+            return FALSE;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        if (ring->cq_ring != ring->sq_ring)
+        {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring_fd);
+        return FALSE;
+    }
+
+    char *sq_ring = ring->sq_ring;
+    ring->sq_head = (u32 *)(sq_ring + params.sq_off.head);
+    ring->sq_tail = (u32 *)(sq_ring + params.sq_off.tail);
+    ring->sq_mask = (u32 *)(sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (u32 *)(sq_ring + params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+
+    char *cq_ring = ring->cq_ring;
+    ring->cq_head = (u32 *)(cq_ring + params.cq_off.head);
+    ring->cq_tail = (u32 *)(cq_ring + params.cq_off.tail);
+    ring->cq_mask = (u32 *)(cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+    return TRUE;
+}
+
+internal void
+IoRingClose(IoRing *ring)
+{
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring)
+    {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->ring_fd);
+}
+
+/*
+ Hands all pending entries to the kernel and
+ waits for at least min_complete completions.
+ An interrupted call returns TRUE so the caller's loop retries it;
+ any other error breaks the ring and returns FALSE.
+ */
+internal b32
+IoRingEnter(IoRing *ring, u32 min_complete)
+{
+    if (ring->broken)
+    {
+        return FALSE;
+    }
+
+    u32 flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    s32 submitted = syscall(__NR_io_uring_enter, ring->ring_fd,
+                            ring->pending, min_complete, flags, 0, 0);
+    if (submitted >= 0)
+    {
+        ring->pending -= submitted;
+        ring->in_flight += submitted;
+        return TRUE;
+    }
+
+    if (errno == EINTR || errno == EAGAIN)
+    {
+        return TRUE;
+    }
+
+    fprintf(stderr, "io_uring_enter failed: %s\n", strerror(errno));
+    ring->broken = TRUE;
+    return FALSE;
+}
+
+/*
+ Ends a read or write. Finished writes release their buffer,
+ finished reads are left for WaitFileRead.
+ */
+internal void
+IoRingFinishRequest(IoRequest *request, b32 failed)
+{
+    request->failed = failed;
+    request->done = TRUE;
+    close(request->fd);
+
+    if (request->request_type == IoRequest_Write)
+    {
+        if (request->failed)
+        {
+            fprintf(stderr, "Failed to write output file %s.\n",
+                    request->file_path);
+        }
+
+        free(request->file_path);
+        free(request->data);
+        free(request);
+    }
+}
+
+/*
+ Handles one completion. Short transfers get queued again
+ from where they stopped, finished writes release their buffer.
+ Returns FALSE if the completion queue is empty.
+ */
+internal b32 IoRingQueueRequest(IoRing *ring, IoRequest *request);
+
+internal b32
+IoRingReap(IoRing *ring)
+{
+    u32 head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        return FALSE;
+    }
+
+    struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+    IoRequest *request = (IoRequest *)cqe->user_data;
+    s32 result = cqe->res;
+
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    --ring->in_flight;
+
+    if (request->request_type == IoRequest_Open)
+    {
+        if (result < 0)
+        {
+            fprintf(stderr, "Failed to open output file %s.\n",
+                    request->file_path);
+            free(request->file_path);
+            free(request->data);
+            free(request);
+            return TRUE;
+        }
+
+        request->fd = result;
+        request->request_type = IoRequest_Write;
+        if (!IoRingQueueRequest(ring, request))
+        {
+            IoRingFinishRequest(request, TRUE);
+        }
+        return TRUE;
+    }
+
+    if (result > 0)
+    {
+        request->offset += result;
+    }
+
+    if (result > 0 && request->offset < request->size)
+    {
+        if (!IoRingQueueRequest(ring, request))
+        {
+            IoRingFinishRequest(request, TRUE);
+        }
+        return TRUE;
+    }
+
+    IoRingFinishRequest(request,
+                        result < 0 || request->offset < request->size);
+    return TRUE;
+}
+
+/*
+ Gets a free submission entry, making room by submitting
+ and reaping when the ring is full. Returns 0 if the ring is broken.
+ */
+internal struct io_uring_sqe *
+IoRingGetSqe(IoRing *ring)
+{
+    while (ring->pending + ring->in_flight >= ring->sq_entries)
+    {
+        if (!IoRingEnter(ring, 1))
+        {
+            return 0;
+        }
+        while (IoRingReap(ring));
+    }
+
+    if (ring->broken)
+    {
+        return 0;
+    }
+
+    u32 tail = *ring->sq_tail;
+    u32 index = tail & *ring->sq_mask;
+
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++ring->pending;
+
+    return sqe;
+}
+
+internal b32
+IoRingQueueRequest(IoRing *ring, IoRequest *request)
+{
+    struct io_uring_sqe *sqe = IoRingGetSqe(ring);
+    if (sqe == 0)
+    {
+        return FALSE;
+    }
+
+    sqe->user_data = (u64)request;
+
+    if (request->request_type == IoRequest_Open)
+    {
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (u64)request->file_path;
+        sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+        sqe->len = 0644;
+        return TRUE;
+    }
+
+    sqe->opcode = (request->request_type == IoRequest_Read) ?
+        IORING_OP_READ : IORING_OP_WRITE;
+    /* len is 32 bits, larger files go in chunks like short transfers */
+    u64 remaining = request->size - request->offset;
+    sqe->fd = request->fd;
+    sqe->addr = (u64)(request->data + request->offset);
+    sqe->len = (remaining < IO_MAX_TRANSFER) ? remaining : IO_MAX_TRANSFER;
+    sqe->off = request->offset;
+
+    return TRUE;
+}
+
+internal b32
+InitFileBatch(FileBatch *batch, u32 file_num)
+{
+    *batch = (FileBatch){0};
+
+    if (!IoRingInit(&batch->ring, IO_RING_ENTRIES))
+    {
+        return FALSE;
+    }
+
+    batch->reads = calloc(file_num, sizeof(*batch->reads));
+    batch->read_num = file_num;
+
+    return TRUE;
+}
+
+/*
+ Opens an input file and queues a read of the whole file.
+ The buffer is null-terminated so it can go straight to the lexer.
+ */
+internal void
+QueueFileRead(FileBatch *batch, u32 index, char *file_path)
+{
+    IoRequest *request = &batch->reads[index];
+    request->request_type = IoRequest_Read;
+
+    struct stat file_stat = {0};
+    s32 fd = open(file_path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        request->failed = TRUE;
+        request->done = TRUE;
+        return;
+    }
+
+    request->fd = fd;
+    request->size = file_stat.st_size;
+    request->data = malloc(request->size + 1);
+    request->data[request->size] = '\0';
+
+    if (!IoRingQueueRequest(&batch->ring, request))
+    {
+        IoRingFinishRequest(request, TRUE);
+    }
+}
+
+/*
+ Submits whatever is queued and waits until the given read is done.
+ Returns the file contents or 0 on failure; the caller frees them.
+ */
+internal char *
+WaitFileRead(FileBatch *batch, u32 index)
+{
+    IoRequest *request = &batch->reads[index];
+
+    while (!request->done)
+    {
+        if (!IoRingEnter(&batch->ring, 1))
+        {
+            /* the kernel may still own the buffer, so it is not freed */
+            return 0;
+        }
+        while (IoRingReap(&batch->ring));
+    }
+
+    if (request->failed)
+    {
+        free(request->data);
+        return 0;
+    }
+
+    return request->data;
+}
+
+/*
+ Queues creating the output file followed by a write of data.
+ Takes ownership of data, which must come from malloc.
+ */
+internal void
+QueueFileWrite(FileBatch *batch, char *file_path, char *data, u64 size)
+{
+    IoRequest *request = calloc(1, sizeof(*request));
+    request->request_type = IoRequest_Open;
+    request->file_path = strdup(file_path);
+    request->data = data;
+    request->size = size;
+
+    if (!IoRingQueueRequest(&batch->ring, request))
+    {
+        fprintf(stderr, "Failed to write output file %s.\n", file_path);
+        free(request->file_path);
+        free(request->data);
+        free(request);
+    }
+}
+
+/* waits for all outstanding writes and tears down the ring */
+internal void
+FinishFileBatch(FileBatch *batch)
+{
+    while (batch->ring.pending + batch->ring.in_flight > 0)
+    {
+        if (!IoRingEnter(&batch->ring, 1))
+        {
+            fprintf(stderr, "Failed to finish writing %u output files.\n",
+                    batch->ring.pending + batch->ring.in_flight);
+            break;
+        }
+        while (IoRingReap(&batch->ring));
+    }
+
+    IoRingClose(&batch->ring);
+    free(batch->reads);
+}
@@ -0,0 +1,99 @@
+#ifndef GEN_LINUX_IO_URING_H
+#define GEN_LINUX_IO_URING_H
+
+#include <linux/io_uring.h>
+
+/* number of submission queue entries requested from the kernel */
+#define IO_RING_ENTRIES 256
+
+/*
+ largest read or write in one submission entry; sqe->len is 32 bits
+ and the kernel caps a single transfer just below 2 GB anyway
+ */
+#define IO_MAX_TRANSFER ((u32)1 << 30)
+
+/* how many input files are read ahead of the one being lexed */
+#define IO_READ_AHEAD 32
+
+typedef enum IoRequestTypes
+{
+    IoRequest_Read,
+    IoRequest_Open,
+    IoRequest_Write,
+} IoRequestTypes;
+
+/*
+ one in-flight read or write, passed to the kernel as user_data.
+ Outputs start as IoRequest_Open and become IoRequest_Write once the
+ kernel hands back the fd. Short reads and writes are resubmitted
+ from offset.
+ */
+typedef struct IoRequest
+{
+    IoRequestTypes request_type;
+    s32 fd;
+    char *file_path;
+
+    char *data;
+    u64 size;
+    u64 offset;
+
+    b32 done;
+    b32 failed;
+} IoRequest;
+
+typedef struct IoRing
+{
+    s32 ring_fd;
+
+    void *sq_ring;
+    u64 sq_ring_size;
+    void *cq_ring;
+    u64 cq_ring_size;
+    struct io_uring_sqe *sqes;
+    u64 sqes_size;
+
+    u32 *sq_head;
+    u32 *sq_tail;
+    u32 *sq_mask;
+    u32 *sq_array;
+    u32 sq_entries;
+
+    u32 *cq_head;
+    u32 *cq_tail;
+    u32 *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    /* queued but not yet handed to the kernel */
+    u32 pending;
+    /* handed to the kernel but not yet completed */
+    u32 in_flight;
+
+    /* io_uring_enter failed, nothing more is submitted or completed */
+    b32 broken;
+} IoRing;
+
+/*
+ reads upcoming inputs and writes finished outputs through one ring,
+ so that I/O overlaps with lexing and expansion
+ */
+typedef struct FileBatch
+{
+    IoRing ring;
+
+    IoRequest *reads;
+    u32 read_num;
+} FileBatch;
+
+internal b32 InitFileBatch(FileBatch *batch, u32 file_num);
+
+internal void QueueFileRead(FileBatch *batch, u32 index, char *file_path);
+
+internal char *WaitFileRead(FileBatch *batch, u32 index);
+
+internal void QueueFileWrite(FileBatch *batch, char *file_path,
+                             char *data, u64 size);
+
+internal void FinishFileBatch(FileBatch *batch);
+
+#endif
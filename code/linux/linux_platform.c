@@ -4,24 +4,45 @@
 #include "../layer.h"
 #include "linux_platform.h"
 
-internal f32
+internal f64
 GetTime()
 {
 	struct timespec time_spec_thing = {0};
-	clock_gettime(CLOCK_REALTIME, &time_spec_thing);
-	float seconds_elapsed =
-		((float)time_spec_thing.tv_nsec / (float)1e9);
+	clock_gettime(CLOCK_MONOTONIC, &time_spec_thing);
+	f64 seconds_elapsed = (f64)time_spec_thing.tv_sec +
+		((f64)time_spec_thing.tv_nsec / 1e9);
 	return seconds_elapsed;
 }
 
 internal void *
-RequestMem(u32 size)
+RequestMem(u64 size)
 {
-	return mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
+	void *memory =
+        mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
+    
+    return (memory == MAP_FAILED) ? 0 : memory;
 }
 
 internal
-void FreeMem(void *mem, u32 size)
+void FreeMem(void *mem, u64 size)
 {
     munmap(mem, size);
 }
+
+/*
+ Gets the length of a seekable file using 64-bit offsets.
+ Returns 0 if the file cannot be seeked (pipes, process substitution).
+ */
+internal u64
+GetFileLength(FILE *file)
+{
+    if (fseeko(file, 0, SEEK_END) != 0)
+    {
+        return 0;
+    }
+    
+    off_t file_length = ftello(file);
+    fseeko(file, 0, SEEK_SET);
+    
+    return (file_length < 0) ? 0 : (u64)file_length;
+}
@@ -1,11 +1,12 @@
 #ifndef LINUX_PLATFORM_H
 #define LINUX_PLATFORM_H
 
-internal f32 GetTime();
+internal f64 GetTime();
 
-// TODO(winston): write the linux memory functions
-internal void *RequestMem(u32 size);
+internal void *RequestMem(u64 size);
 
-internal void FreeMem(void *mem, u32 size);
+internal void FreeMem(void *mem, u64 size);
+
+internal u64 GetFileLength(FILE *file);
 
 #endif
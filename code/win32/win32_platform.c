@@ -28,7 +28,7 @@ f64 GetTime()
 }
 
 internal 
-void *RequestMem(u32 size) 
+void *RequestMem(u64 size) 
 {
     return VirtualAlloc(0,
                         size,
@@ -37,9 +37,27 @@ void *RequestMem(u32 size)
 }
 
 internal void 
-FreeMem(void *mem, u32 size)
+FreeMem(void *mem, u64 size)
 {
     VirtualFree(mem,
                 0,
                 MEM_RELEASE);
 }
+
+/*
+ Gets the length of a seekable file using 64-bit offsets.
+ Returns 0 if the file cannot be seeked (pipes).
+ */
+internal u64
+GetFileLength(FILE *file)
+{
+    if (_fseeki64(file, 0, SEEK_END) != 0)
+    {
+        return 0;
+    }
+    
+    s64 file_length = _ftelli64(file);
+    _fseeki64(file, 0, SEEK_SET);
+    
+    return (file_length < 0) ? 0 : (u64)file_length;
+}
@@ -3,8 +3,10 @@
 
 internal f64 GetTime();
 
-internal void *RequestMem(u32 size);
+internal void *RequestMem(u64 size);
 
-internal void FreeMem(void *mem, u32 size);
+internal void FreeMem(void *mem, u64 size);
+
+internal u64 GetFileLength(FILE *file);
 
 #endif 
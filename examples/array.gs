@@ -0,0 +1,245 @@
+~output_ext .h
+
+@template_start Dynamic_Array <- T, INLINE:0
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* points at inline_items until the array outgrows them */
+    T *items;
+    u64 count;
+    u64 capacity;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+@if INLINE > 0
+
+    T inline_items[INLINE];
+@endif
+};
+@template_end
+
+@template_fn Dynamic_Array <- T, INLINE:0
+#include <stdlib.h>
+#include <string.h>
+
+/* heap growth, counted when GEN_INSTRUMENT is defined */
+@instrument grows, allocated_bytes, copied_bytes, peak_capacity
+
+/*
+ Growable array of T. Elements are reached as array->items[i], so
+ access is plain indexing. With an inline buffer the first elements
+ live in the struct itself and the heap is only used past that; such
+ an array points into itself and must not be copied by value.
+ */
+static inline b32
+@template_name_is_inline(@template_name *array)
+{
+@if INLINE > 0
+    return array->items == array->inline_items;
+@else
+    (void)array;
+    return 0;
+@endif
+}
+
+static inline void
+@template_name_release_items(@template_name *array)
+{
+    if (!array->items || @template_name_is_inline(array))
+    {
+        return;
+    }
+    
+    if (!array->alloc)
+    {
+        free(array->items);
+    }
+    else if (array->release)
+    {
+        array->release(array->context, array->items,
+                       array->capacity * sizeof(T));
+    }
+}
+
+/* grows to at least capacity elements, at least doubling each time */
+static inline b32
+@template_name_reserve(@template_name *array, u64 capacity)
+{
+    if (capacity <= array->capacity)
+    {
+        return 1;
+    }
+
+@if INLINE > 0
+    if (array->capacity == 0 && capacity <= INLINE)
+    {
+        array->items = array->inline_items;
+        array->capacity = INLINE;
+        return 1;
+    }
+
+@endif
+    u64 grown = (array->capacity > 0) ? 2 * array->capacity : 8;
+    if (grown < capacity)
+    {
+        grown = capacity;
+    }
+    
+    u64 size = grown * sizeof(T);
+    T *items = array->alloc ? array->alloc(array->context, size) : malloc(size);
+    if (!items)
+    {
+        return 0;
+    }
+    @template_name_COUNT(grows, 1);
+    @template_name_COUNT(allocated_bytes, size);
+    @template_name_COUNT(copied_bytes, array->count * sizeof(T));
+    @template_name_COUNT_MAX(peak_capacity, grown);
+    
+    if (array->count > 0)
+    {
+        memcpy(items, array->items, array->count * sizeof(T));
+    }
+    @template_name_release_items(array);
+    
+    array->items = items;
+    array->capacity = grown;
+    return 1;
+}
+
+static inline b32
+@template_name_push(@template_name *array, T value)
+{
+    if (array->count == array->capacity &&
+        @template_name_reserve(array, array->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    array->items[array->count++] = value;
+    return 1;
+}
+
+static inline T
+@template_name_pop(@template_name *array)
+{
+    return array->items[--array->count];
+}
+
+static inline T *
+@template_name_at(@template_name *array, u64 index)
+{
+    return &array->items[index];
+}
+
+/*
+ index of values in the array's own elements, or -1 if they live
+ elsewhere. reserve can move the elements, so it is taken before.
+ */
+static inline u64
+@template_name_alias_index(@template_name *array, T *values)
+{
+    u64 offset = (u64)values - (u64)array->items;
+    
+    return (offset < array->count * sizeof(T)) ? offset / sizeof(T) : (u64)-1;
+}
+
+/* appends count elements with one copy, values may point into the array */
+static inline b32
+@template_name_append(@template_name *array, T *values, u64 count)
+{
+    u64 alias = @template_name_alias_index(array, values);
+    
+    if (@template_name_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (alias != (u64)-1)
+    {
+        values = array->items + alias;
+    }
+    if (count > 0)
+    {
+        memcpy(array->items + array->count, values, count * sizeof(T));
+    }
+    array->count += count;
+    return 1;
+}
+
+/*
+ inserts count elements before index, moving the tail once.
+ values may point into the array; the part of them at or after
+ index has moved by count when it is copied.
+ */
+static inline b32
+@template_name_insert(@template_name *array, u64 index, T *values, u64 count)
+{
+    u64 alias = @template_name_alias_index(array, values);
+    
+    if (@template_name_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memmove(array->items + index + count, array->items + index,
+                (array->count - index) * sizeof(T));
+        
+        if (alias == (u64)-1)
+        {
+            memcpy(array->items + index, values, count * sizeof(T));
+        }
+        else
+        {
+            u64 before = (alias < index) ? index - alias : 0;
+            if (before > count)
+            {
+                before = count;
+            }
+            
+            memcpy(array->items + index, array->items + alias,
+                   before * sizeof(T));
+            memcpy(array->items + index + before,
+                   array->items + alias + before + count,
+                   (count - before) * sizeof(T));
+        }
+    }
+    array->count += count;
+    return 1;
+}
+
+/* removes count elements starting at index, keeping the order */
+static inline void
+@template_name_remove(@template_name *array, u64 index, u64 count)
+{
+    memmove(array->items + index, array->items + index + count,
+            (array->count - index - count) * sizeof(T));
+    array->count -= count;
+}
+
+static inline void
+@template_name_clear(@template_name *array)
+{
+    array->count = 0;
+}
+
+static inline void
+@template_name_free(@template_name *array)
+{
+    @template_name_release_items(array);
+    array->items = 0;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+#define @template_name_for_each(value, array) \
+    for (T *value = (array)->items; value < (array)->items + (array)->count; ++value)
+@template_end
+
+@template Dynamic_Array -> u32 -> Array_U32
+@template Dynamic_Array -> u32, 8 -> Small_Array_U32
+@template Dynamic_Array -> f64, 4 -> Small_Array_F64
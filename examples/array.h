@@ -0,0 +1,796 @@
+typedef struct Array_U32 Array_U32;
+struct Array_U32
+{
+    /* points at inline_items until the array outgrows them */
+    u32 *items;
+    u64 count;
+    u64 capacity;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* heap growth, counted when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Array_U32 in the calling thread */
+typedef struct Array_U32_Counters
+{
+    u64 grows;
+    u64 allocated_bytes;
+    u64 copied_bytes;
+    u64 peak_capacity;
+} Array_U32_Counters;
+
+static _Thread_local Array_U32_Counters Array_U32_counters;
+
+#define Array_U32_COUNT(counter, n) (Array_U32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Array_U32_COUNT_MAX(counter, value) \
+    (Array_U32_counters.counter = ((u64)(value) > Array_U32_counters.counter) ? \
+        (u64)(value) : Array_U32_counters.counter)
+
+static inline void
+Array_U32_dump_counters(FILE *file)
+{
+    fprintf(file, "Array_U32:");
+    fprintf(file, " grows %llu", (unsigned long long)Array_U32_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Array_U32_counters.allocated_bytes);
+    fprintf(file, " copied_bytes %llu", (unsigned long long)Array_U32_counters.copied_bytes);
+    fprintf(file, " peak_capacity %llu", (unsigned long long)Array_U32_counters.peak_capacity);
+    fprintf(file, "\n");
+}
+
+static inline void
+Array_U32_reset_counters(void)
+{
+    Array_U32_counters = (Array_U32_Counters){0};
+}
+#else
+#define Array_U32_COUNT(counter, n) ((void)0)
+#define Array_U32_COUNT_MAX(counter, value) ((void)0)
+#define Array_U32_dump_counters(file) ((void)0)
+#define Array_U32_reset_counters() ((void)0)
+#endif
+
+/*
+ Growable array of T. Elements are reached as array->items[i], so
+ access is plain indexing. With an inline buffer the first elements
+ live in the struct itself and the heap is only used past that; such
+ an array points into itself and must not be copied by value.
+ */
+static inline b32
+Array_U32_is_inline(Array_U32 *array)
+{
+    (void)array;
+    return 0;
+}
+
+static inline void
+Array_U32_release_items(Array_U32 *array)
+{
+    if (!array->items || Array_U32_is_inline(array))
+    {
+        return;
+    }
+    
+    if (!array->alloc)
+    {
+        free(array->items);
+    }
+    else if (array->release)
+    {
+        array->release(array->context, array->items,
+                       array->capacity * sizeof(u32));
+    }
+}
+
+/* grows to at least capacity elements, at least doubling each time */
+static inline b32
+Array_U32_reserve(Array_U32 *array, u64 capacity)
+{
+    if (capacity <= array->capacity)
+    {
+        return 1;
+    }
+
+    u64 grown = (array->capacity > 0) ? 2 * array->capacity : 8;
+    if (grown < capacity)
+    {
+        grown = capacity;
+    }
+    
+    u64 size = grown * sizeof(u32);
+    u32 *items = array->alloc ? array->alloc(array->context, size) : malloc(size);
+    if (!items)
+    {
+        return 0;
+    }
+    Array_U32_COUNT(grows, 1);
+    Array_U32_COUNT(allocated_bytes, size);
+    Array_U32_COUNT(copied_bytes, array->count * sizeof(u32));
+    Array_U32_COUNT_MAX(peak_capacity, grown);
+    
+    if (array->count > 0)
+    {
+        memcpy(items, array->items, array->count * sizeof(u32));
+    }
+    Array_U32_release_items(array);
+    
+    array->items = items;
+    array->capacity = grown;
+    return 1;
+}
+
+static inline b32
+Array_U32_push(Array_U32 *array, u32 value)
+{
+    if (array->count == array->capacity &&
+        Array_U32_reserve(array, array->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    array->items[array->count++] = value;
+    return 1;
+}
+
+static inline u32
+Array_U32_pop(Array_U32 *array)
+{
+    return array->items[--array->count];
+}
+
+static inline u32 *
+Array_U32_at(Array_U32 *array, u64 index)
+{
+    return &array->items[index];
+}
+
+/*
+ index of values in the array's own elements, or -1 if they live
+ elsewhere. reserve can move the elements, so it is taken before.
+ */
+static inline u64
+Array_U32_alias_index(Array_U32 *array, u32 *values)
+{
+    u64 offset = (u64)values - (u64)array->items;
+    
+    return (offset < array->count * sizeof(u32)) ? offset / sizeof(u32) : (u64)-1;
+}
+
+/* appends count elements with one copy, values may point into the array */
+static inline b32
+Array_U32_append(Array_U32 *array, u32 *values, u64 count)
+{
+    u64 alias = Array_U32_alias_index(array, values);
+    
+    if (Array_U32_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (alias != (u64)-1)
+    {
+        values = array->items + alias;
+    }
+    if (count > 0)
+    {
+        memcpy(array->items + array->count, values, count * sizeof(u32));
+    }
+    array->count += count;
+    return 1;
+}
+
+/*
+ inserts count elements before index, moving the tail once.
+ values may point into the array; the part of them at or after
+ index has moved by count when it is copied.
+ */
+static inline b32
+Array_U32_insert(Array_U32 *array, u64 index, u32 *values, u64 count)
+{
+    u64 alias = Array_U32_alias_index(array, values);
+    
+    if (Array_U32_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memmove(array->items + index + count, array->items + index,
+                (array->count - index) * sizeof(u32));
+        
+        if (alias == (u64)-1)
+        {
+            memcpy(array->items + index, values, count * sizeof(u32));
+        }
+        else
+        {
+            u64 before = (alias < index) ? index - alias : 0;
+            if (before > count)
+            {
+                before = count;
+            }
+            
+            memcpy(array->items + index, array->items + alias,
+                   before * sizeof(u32));
+            memcpy(array->items + index + before,
+                   array->items + alias + before + count,
+                   (count - before) * sizeof(u32));
+        }
+    }
+    array->count += count;
+    return 1;
+}
+
+/* removes count elements starting at index, keeping the order */
+static inline void
+Array_U32_remove(Array_U32 *array, u64 index, u64 count)
+{
+    memmove(array->items + index, array->items + index + count,
+            (array->count - index - count) * sizeof(u32));
+    array->count -= count;
+}
+
+static inline void
+Array_U32_clear(Array_U32 *array)
+{
+    array->count = 0;
+}
+
+static inline void
+Array_U32_free(Array_U32 *array)
+{
+    Array_U32_release_items(array);
+    array->items = 0;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+#define Array_U32_for_each(value, array) \
+    for (u32 *value = (array)->items; value < (array)->items + (array)->count; ++value)
+
+typedef struct Small_Array_U32 Small_Array_U32;
+struct Small_Array_U32
+{
+    /* points at inline_items until the array outgrows them */
+    u32 *items;
+    u64 count;
+    u64 capacity;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+
+    u32 inline_items[8];
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* heap growth, counted when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Small_Array_U32 in the calling thread */
+typedef struct Small_Array_U32_Counters
+{
+    u64 grows;
+    u64 allocated_bytes;
+    u64 copied_bytes;
+    u64 peak_capacity;
+} Small_Array_U32_Counters;
+
+static _Thread_local Small_Array_U32_Counters Small_Array_U32_counters;
+
+#define Small_Array_U32_COUNT(counter, n) (Small_Array_U32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Small_Array_U32_COUNT_MAX(counter, value) \
+    (Small_Array_U32_counters.counter = ((u64)(value) > Small_Array_U32_counters.counter) ? \
+        (u64)(value) : Small_Array_U32_counters.counter)
+
+static inline void
+Small_Array_U32_dump_counters(FILE *file)
+{
+    fprintf(file, "Small_Array_U32:");
+    fprintf(file, " grows %llu", (unsigned long long)Small_Array_U32_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Small_Array_U32_counters.allocated_bytes);
+    fprintf(file, " copied_bytes %llu", (unsigned long long)Small_Array_U32_counters.copied_bytes);
+    fprintf(file, " peak_capacity %llu", (unsigned long long)Small_Array_U32_counters.peak_capacity);
+    fprintf(file, "\n");
+}
+
+static inline void
+Small_Array_U32_reset_counters(void)
+{
+    Small_Array_U32_counters = (Small_Array_U32_Counters){0};
+}
+#else
+#define Small_Array_U32_COUNT(counter, n) ((void)0)
+#define Small_Array_U32_COUNT_MAX(counter, value) ((void)0)
+#define Small_Array_U32_dump_counters(file) ((void)0)
+#define Small_Array_U32_reset_counters() ((void)0)
+#endif
+
+/*
+ Growable array of T. Elements are reached as array->items[i], so
+ access is plain indexing. With an inline buffer the first elements
+ live in the struct itself and the heap is only used past that; such
+ an array points into itself and must not be copied by value.
+ */
+static inline b32
+Small_Array_U32_is_inline(Small_Array_U32 *array)
+{
+    return array->items == array->inline_items;
+}
+
+static inline void
+Small_Array_U32_release_items(Small_Array_U32 *array)
+{
+    if (!array->items || Small_Array_U32_is_inline(array))
+    {
+        return;
+    }
+    
+    if (!array->alloc)
+    {
+        free(array->items);
+    }
+    else if (array->release)
+    {
+        array->release(array->context, array->items,
+                       array->capacity * sizeof(u32));
+    }
+}
+
+/* grows to at least capacity elements, at least doubling each time */
+static inline b32
+Small_Array_U32_reserve(Small_Array_U32 *array, u64 capacity)
+{
+    if (capacity <= array->capacity)
+    {
+        return 1;
+    }
+
+    if (array->capacity == 0 && capacity <= 8)
+    {
+        array->items = array->inline_items;
+        array->capacity = 8;
+        return 1;
+    }
+
+    u64 grown = (array->capacity > 0) ? 2 * array->capacity : 8;
+    if (grown < capacity)
+    {
+        grown = capacity;
+    }
+    
+    u64 size = grown * sizeof(u32);
+    u32 *items = array->alloc ? array->alloc(array->context, size) : malloc(size);
+    if (!items)
+    {
+        return 0;
+    }
+    Small_Array_U32_COUNT(grows, 1);
+    Small_Array_U32_COUNT(allocated_bytes, size);
+    Small_Array_U32_COUNT(copied_bytes, array->count * sizeof(u32));
+    Small_Array_U32_COUNT_MAX(peak_capacity, grown);
+    
+    if (array->count > 0)
+    {
+        memcpy(items, array->items, array->count * sizeof(u32));
+    }
+    Small_Array_U32_release_items(array);
+    
+    array->items = items;
+    array->capacity = grown;
+    return 1;
+}
+
+static inline b32
+Small_Array_U32_push(Small_Array_U32 *array, u32 value)
+{
+    if (array->count == array->capacity &&
+        Small_Array_U32_reserve(array, array->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    array->items[array->count++] = value;
+    return 1;
+}
+
+static inline u32
+Small_Array_U32_pop(Small_Array_U32 *array)
+{
+    return array->items[--array->count];
+}
+
+static inline u32 *
+Small_Array_U32_at(Small_Array_U32 *array, u64 index)
+{
+    return &array->items[index];
+}
+
+/*
+ index of values in the array's own elements, or -1 if they live
+ elsewhere. reserve can move the elements, so it is taken before.
+ */
+static inline u64
+Small_Array_U32_alias_index(Small_Array_U32 *array, u32 *values)
+{
+    u64 offset = (u64)values - (u64)array->items;
+    
+    return (offset < array->count * sizeof(u32)) ? offset / sizeof(u32) : (u64)-1;
+}
+
+/* appends count elements with one copy, values may point into the array */
+static inline b32
+Small_Array_U32_append(Small_Array_U32 *array, u32 *values, u64 count)
+{
+    u64 alias = Small_Array_U32_alias_index(array, values);
+    
+    if (Small_Array_U32_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (alias != (u64)-1)
+    {
+        values = array->items + alias;
+    }
+    if (count > 0)
+    {
+        memcpy(array->items + array->count, values, count * sizeof(u32));
+    }
+    array->count += count;
+    return 1;
+}
+
+/*
+ inserts count elements before index, moving the tail once.
+ values may point into the array; the part of them at or after
+ index has moved by count when it is copied.
+ */
+static inline b32
+Small_Array_U32_insert(Small_Array_U32 *array, u64 index, u32 *values, u64 count)
+{
+    u64 alias = Small_Array_U32_alias_index(array, values);
+    
+    if (Small_Array_U32_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memmove(array->items + index + count, array->items + index,
+                (array->count - index) * sizeof(u32));
+        
+        if (alias == (u64)-1)
+        {
+            memcpy(array->items + index, values, count * sizeof(u32));
+        }
+        else
+        {
+            u64 before = (alias < index) ? index - alias : 0;
+            if (before > count)
+            {
+                before = count;
+            }
+            
+            memcpy(array->items + index, array->items + alias,
+                   before * sizeof(u32));
+            memcpy(array->items + index + before,
+                   array->items + alias + before + count,
+                   (count - before) * sizeof(u32));
+        }
+    }
+    array->count += count;
+    return 1;
+}
+
+/* removes count elements starting at index, keeping the order */
+static inline void
+Small_Array_U32_remove(Small_Array_U32 *array, u64 index, u64 count)
+{
+    memmove(array->items + index, array->items + index + count,
+            (array->count - index - count) * sizeof(u32));
+    array->count -= count;
+}
+
+static inline void
+Small_Array_U32_clear(Small_Array_U32 *array)
+{
+    array->count = 0;
+}
+
+static inline void
+Small_Array_U32_free(Small_Array_U32 *array)
+{
+    Small_Array_U32_release_items(array);
+    array->items = 0;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+#define Small_Array_U32_for_each(value, array) \
+    for (u32 *value = (array)->items; value < (array)->items + (array)->count; ++value)
+
+typedef struct Small_Array_F64 Small_Array_F64;
+struct Small_Array_F64
+{
+    /* points at inline_items until the array outgrows them */
+    f64 *items;
+    u64 count;
+    u64 capacity;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+
+    f64 inline_items[4];
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* heap growth, counted when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Small_Array_F64 in the calling thread */
+typedef struct Small_Array_F64_Counters
+{
+    u64 grows;
+    u64 allocated_bytes;
+    u64 copied_bytes;
+    u64 peak_capacity;
+} Small_Array_F64_Counters;
+
+static _Thread_local Small_Array_F64_Counters Small_Array_F64_counters;
+
+#define Small_Array_F64_COUNT(counter, n) (Small_Array_F64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Small_Array_F64_COUNT_MAX(counter, value) \
+    (Small_Array_F64_counters.counter = ((u64)(value) > Small_Array_F64_counters.counter) ? \
+        (u64)(value) : Small_Array_F64_counters.counter)
+
+static inline void
+Small_Array_F64_dump_counters(FILE *file)
+{
+    fprintf(file, "Small_Array_F64:");
+    fprintf(file, " grows %llu", (unsigned long long)Small_Array_F64_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Small_Array_F64_counters.allocated_bytes);
+    fprintf(file, " copied_bytes %llu", (unsigned long long)Small_Array_F64_counters.copied_bytes);
+    fprintf(file, " peak_capacity %llu", (unsigned long long)Small_Array_F64_counters.peak_capacity);
+    fprintf(file, "\n");
+}
+
+static inline void
+Small_Array_F64_reset_counters(void)
+{
+    Small_Array_F64_counters = (Small_Array_F64_Counters){0};
+}
+#else
+#define Small_Array_F64_COUNT(counter, n) ((void)0)
+#define Small_Array_F64_COUNT_MAX(counter, value) ((void)0)
+#define Small_Array_F64_dump_counters(file) ((void)0)
+#define Small_Array_F64_reset_counters() ((void)0)
+#endif
+
+/*
+ Growable array of T. Elements are reached as array->items[i], so
+ access is plain indexing. With an inline buffer the first elements
+ live in the struct itself and the heap is only used past that; such
+ an array points into itself and must not be copied by value.
+ */
+static inline b32
+Small_Array_F64_is_inline(Small_Array_F64 *array)
+{
+    return array->items == array->inline_items;
+}
+
+static inline void
+Small_Array_F64_release_items(Small_Array_F64 *array)
+{
+    if (!array->items || Small_Array_F64_is_inline(array))
+    {
+        return;
+    }
+    
+    if (!array->alloc)
+    {
+        free(array->items);
+    }
+    else if (array->release)
+    {
+        array->release(array->context, array->items,
+                       array->capacity * sizeof(f64));
+    }
+}
+
+/* grows to at least capacity elements, at least doubling each time */
+static inline b32
+Small_Array_F64_reserve(Small_Array_F64 *array, u64 capacity)
+{
+    if (capacity <= array->capacity)
+    {
+        return 1;
+    }
+
+    if (array->capacity == 0 && capacity <= 4)
+    {
+        array->items = array->inline_items;
+        array->capacity = 4;
+        return 1;
+    }
+
+    u64 grown = (array->capacity > 0) ? 2 * array->capacity : 8;
+    if (grown < capacity)
+    {
+        grown = capacity;
+    }
+    
+    u64 size = grown * sizeof(f64);
+    f64 *items = array->alloc ? array->alloc(array->context, size) : malloc(size);
+    if (!items)
+    {
+        return 0;
+    }
+    Small_Array_F64_COUNT(grows, 1);
+    Small_Array_F64_COUNT(allocated_bytes, size);
+    Small_Array_F64_COUNT(copied_bytes, array->count * sizeof(f64));
+    Small_Array_F64_COUNT_MAX(peak_capacity, grown);
+    
+    if (array->count > 0)
+    {
+        memcpy(items, array->items, array->count * sizeof(f64));
+    }
+    Small_Array_F64_release_items(array);
+    
+    array->items = items;
+    array->capacity = grown;
+    return 1;
+}
+
+static inline b32
+Small_Array_F64_push(Small_Array_F64 *array, f64 value)
+{
+    if (array->count == array->capacity &&
+        Small_Array_F64_reserve(array, array->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    array->items[array->count++] = value;
+    return 1;
+}
+
+static inline f64
+Small_Array_F64_pop(Small_Array_F64 *array)
+{
+    return array->items[--array->count];
+}
+
+static inline f64 *
+Small_Array_F64_at(Small_Array_F64 *array, u64 index)
+{
+    return &array->items[index];
+}
+
+/*
+ index of values in the array's own elements, or -1 if they live
+ elsewhere. reserve can move the elements, so it is taken before.
+ */
+static inline u64
+Small_Array_F64_alias_index(Small_Array_F64 *array, f64 *values)
+{
+    u64 offset = (u64)values - (u64)array->items;
+    
+    return (offset < array->count * sizeof(f64)) ? offset / sizeof(f64) : (u64)-1;
+}
+
+/* appends count elements with one copy, values may point into the array */
+static inline b32
+Small_Array_F64_append(Small_Array_F64 *array, f64 *values, u64 count)
+{
+    u64 alias = Small_Array_F64_alias_index(array, values);
+    
+    if (Small_Array_F64_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (alias != (u64)-1)
+    {
+        values = array->items + alias;
+    }
+    if (count > 0)
+    {
+        memcpy(array->items + array->count, values, count * sizeof(f64));
+    }
+    array->count += count;
+    return 1;
+}
+
+/*
+ inserts count elements before index, moving the tail once.
+ values may point into the array; the part of them at or after
+ index has moved by count when it is copied.
+ */
+static inline b32
+Small_Array_F64_insert(Small_Array_F64 *array, u64 index, f64 *values, u64 count)
+{
+    u64 alias = Small_Array_F64_alias_index(array, values);
+    
+    if (Small_Array_F64_reserve(array, array->count + count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memmove(array->items + index + count, array->items + index,
+                (array->count - index) * sizeof(f64));
+        
+        if (alias == (u64)-1)
+        {
+            memcpy(array->items + index, values, count * sizeof(f64));
+        }
+        else
+        {
+            u64 before = (alias < index) ? index - alias : 0;
+            if (before > count)
+            {
+                before = count;
+            }
+            
+            memcpy(array->items + index, array->items + alias,
+                   before * sizeof(f64));
+            memcpy(array->items + index + before,
+                   array->items + alias + before + count,
+                   (count - before) * sizeof(f64));
+        }
+    }
+    array->count += count;
+    return 1;
+}
+
+/* removes count elements starting at index, keeping the order */
+static inline void
+Small_Array_F64_remove(Small_Array_F64 *array, u64 index, u64 count)
+{
+    memmove(array->items + index, array->items + index + count,
+            (array->count - index - count) * sizeof(f64));
+    array->count -= count;
+}
+
+static inline void
+Small_Array_F64_clear(Small_Array_F64 *array)
+{
+    array->count = 0;
+}
+
+static inline void
+Small_Array_F64_free(Small_Array_F64 *array)
+{
+    Small_Array_F64_release_items(array);
+    array->items = 0;
+    array->count = 0;
+    array->capacity = 0;
+}
+
+#define Small_Array_F64_for_each(value, array) \
+    for (f64 *value = (array)->items; value < (array)->items + (array)->count; ++value)
+
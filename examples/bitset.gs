@@ -0,0 +1,241 @@
+~output_ext .h
+
+@template_start Bitset <- BITS:256
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* bit i is bit i % 64 of words[i / 64]; bits past the end stay 0 */
+    u64 words[(BITS + 63) / 64];
+};
+@template_end
+
+@template_fn Bitset <- BITS:256
+#include <string.h>
+
+/*
+ Set of the numbers below a fixed size, one bit each. Whole-set
+ operations go over the words with AVX2 or SSE2 when the compiler
+ enables them and one word at a time otherwise.
+ */
+#ifndef GEN_BITSET
+#define GEN_BITSET
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static inline u32
+GenBitsetPopcount(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (u32)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* index of the lowest set bit, word must not be 0 */
+static inline u32
+GenBitsetFirstBit(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctzll(word);
+#else
+    u32 bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/*
+ out = a op b over count words, where op is one of & | ^ and andnot
+ (a & ~b). The vector paths handle whole vectors and the rest falls
+ through to the word loop.
+ */
+#define GEN_BITSET_AND 0
+#define GEN_BITSET_OR 1
+#define GEN_BITSET_XOR 2
+#define GEN_BITSET_ANDNOT 3
+
+static inline void
+GenBitsetCombine(u64 *out, u64 *a, u64 *b, u32 count, u32 op)
+{
+    u32 i = 0;
+    
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((__m256i *)(b + i));
+        __m256i z = (op == GEN_BITSET_AND) ? _mm256_and_si256(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm256_or_si256(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm256_xor_si256(x, y) :
+                    _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i *)(out + i), z);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((__m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((__m128i *)(b + i));
+        __m128i z = (op == GEN_BITSET_AND) ? _mm_and_si128(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm_or_si128(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm_xor_si128(x, y) :
+                    _mm_andnot_si128(y, x);
+        _mm_storeu_si128((__m128i *)(out + i), z);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = (op == GEN_BITSET_AND) ? (a[i] & b[i]) :
+                 (op == GEN_BITSET_OR) ? (a[i] | b[i]) :
+                 (op == GEN_BITSET_XOR) ? (a[i] ^ b[i]) :
+                 (a[i] & ~b[i]);
+    }
+}
+#endif
+
+static inline void
+@template_name_set(@template_name *set, u32 bit)
+{
+    set->words[bit / 64] |= (u64)1 << (bit % 64);
+}
+
+static inline void
+@template_name_clear(@template_name *set, u32 bit)
+{
+    set->words[bit / 64] &= ~((u64)1 << (bit % 64));
+}
+
+static inline void
+@template_name_flip(@template_name *set, u32 bit)
+{
+    set->words[bit / 64] ^= (u64)1 << (bit % 64);
+}
+
+static inline b32
+@template_name_test(@template_name *set, u32 bit)
+{
+    return (set->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void
+@template_name_clear_all(@template_name *set)
+{
+    memset(set->words, 0, sizeof(set->words));
+}
+
+static inline void
+@template_name_set_all(@template_name *set)
+{
+    memset(set->words, 0xFF, sizeof(set->words));
+@if BITS % 64 != 0
+    set->words[BITS / 64] = ((u64)1 << (BITS % 64)) - 1;
+@endif
+}
+
+static inline u32
+@template_name_count(@template_name *set)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        count += GenBitsetPopcount(set->words[i]);
+    }
+    return count;
+}
+
+static inline b32
+@template_name_any(@template_name *set)
+{
+    u64 any = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        any |= set->words[i];
+    }
+    return any != 0;
+}
+
+static inline b32
+@template_name_equal(@template_name *a, @template_name *b)
+{
+    return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+/* the first set bit at or after from, or the bit count if there is none */
+static inline u32
+@template_name_next(@template_name *set, u32 from)
+{
+    if (from >= BITS)
+    {
+        return BITS;
+    }
+    
+    u32 i = from / 64;
+    u64 word = set->words[i] & (~(u64)0 << (from % 64));
+    
+    while (word == 0)
+    {
+        if (++i == sizeof(set->words) / sizeof(u64))
+        {
+            return BITS;
+        }
+        word = set->words[i];
+    }
+    return 64 * i + GenBitsetFirstBit(word);
+}
+
+static inline u32
+@template_name_first(@template_name *set)
+{
+    return @template_name_next(set, 0);
+}
+
+static inline void
+@template_name_and(@template_name *out, @template_name *a, @template_name *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_AND);
+}
+
+static inline void
+@template_name_or(@template_name *out, @template_name *a, @template_name *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_OR);
+}
+
+static inline void
+@template_name_xor(@template_name *out, @template_name *a, @template_name *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_XOR);
+}
+
+/* the bits of a that are not in b */
+static inline void
+@template_name_andnot(@template_name *out, @template_name *a, @template_name *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_ANDNOT);
+}
+
+/* visits every set bit in increasing order, a word at a time */
+#define @template_name_for_each(bit, set) \
+    for (u32 bit##_word = 0; bit##_word < sizeof((set)->words) / sizeof(u64); ++bit##_word) \
+        for (u64 bit##_bits = (set)->words[bit##_word], bit = 0; \
+             bit##_bits && (bit = 64 * bit##_word + GenBitsetFirstBit(bit##_bits), 1); \
+             bit##_bits &= bit##_bits - 1)
+@template_end
+
+@template Bitset -> 64 -> Bitset_64
+@template Bitset -> 256 -> Bitset_256
+@template Bitset -> 1000 -> Bitset_1000
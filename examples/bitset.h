@@ -0,0 +1,688 @@
+typedef struct Bitset_64 Bitset_64;
+struct Bitset_64
+{
+    /* bit i is bit i % 64 of words[i / 64]; bits past the end stay 0 */
+    u64 words[(64 + 63) / 64];
+};
+
+#include <string.h>
+
+/*
+ Set of the numbers below a fixed size, one bit each. Whole-set
+ operations go over the words with AVX2 or SSE2 when the compiler
+ enables them and one word at a time otherwise.
+ */
+#ifndef GEN_BITSET
+#define GEN_BITSET
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static inline u32
+GenBitsetPopcount(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (u32)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* index of the lowest set bit, word must not be 0 */
+static inline u32
+GenBitsetFirstBit(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctzll(word);
+#else
+    u32 bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/*
+ out = a op b over count words, where op is one of & | ^ and andnot
+ (a & ~b). The vector paths handle whole vectors and the rest falls
+ through to the word loop.
+ */
+#define GEN_BITSET_AND 0
+#define GEN_BITSET_OR 1
+#define GEN_BITSET_XOR 2
+#define GEN_BITSET_ANDNOT 3
+
+static inline void
+GenBitsetCombine(u64 *out, u64 *a, u64 *b, u32 count, u32 op)
+{
+    u32 i = 0;
+    
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((__m256i *)(b + i));
+        __m256i z = (op == GEN_BITSET_AND) ? _mm256_and_si256(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm256_or_si256(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm256_xor_si256(x, y) :
+                    _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i *)(out + i), z);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((__m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((__m128i *)(b + i));
+        __m128i z = (op == GEN_BITSET_AND) ? _mm_and_si128(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm_or_si128(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm_xor_si128(x, y) :
+                    _mm_andnot_si128(y, x);
+        _mm_storeu_si128((__m128i *)(out + i), z);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = (op == GEN_BITSET_AND) ? (a[i] & b[i]) :
+                 (op == GEN_BITSET_OR) ? (a[i] | b[i]) :
+                 (op == GEN_BITSET_XOR) ? (a[i] ^ b[i]) :
+                 (a[i] & ~b[i]);
+    }
+}
+#endif
+
+static inline void
+Bitset_64_set(Bitset_64 *set, u32 bit)
+{
+    set->words[bit / 64] |= (u64)1 << (bit % 64);
+}
+
+static inline void
+Bitset_64_clear(Bitset_64 *set, u32 bit)
+{
+    set->words[bit / 64] &= ~((u64)1 << (bit % 64));
+}
+
+static inline void
+Bitset_64_flip(Bitset_64 *set, u32 bit)
+{
+    set->words[bit / 64] ^= (u64)1 << (bit % 64);
+}
+
+static inline b32
+Bitset_64_test(Bitset_64 *set, u32 bit)
+{
+    return (set->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void
+Bitset_64_clear_all(Bitset_64 *set)
+{
+    memset(set->words, 0, sizeof(set->words));
+}
+
+static inline void
+Bitset_64_set_all(Bitset_64 *set)
+{
+    memset(set->words, 0xFF, sizeof(set->words));
+}
+
+static inline u32
+Bitset_64_count(Bitset_64 *set)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        count += GenBitsetPopcount(set->words[i]);
+    }
+    return count;
+}
+
+static inline b32
+Bitset_64_any(Bitset_64 *set)
+{
+    u64 any = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        any |= set->words[i];
+    }
+    return any != 0;
+}
+
+static inline b32
+Bitset_64_equal(Bitset_64 *a, Bitset_64 *b)
+{
+    return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+/* the first set bit at or after from, or the bit count if there is none */
+static inline u32
+Bitset_64_next(Bitset_64 *set, u32 from)
+{
+    if (from >= 64)
+    {
+        return 64;
+    }
+    
+    u32 i = from / 64;
+    u64 word = set->words[i] & (~(u64)0 << (from % 64));
+    
+    while (word == 0)
+    {
+        if (++i == sizeof(set->words) / sizeof(u64))
+        {
+            return 64;
+        }
+        word = set->words[i];
+    }
+    return 64 * i + GenBitsetFirstBit(word);
+}
+
+static inline u32
+Bitset_64_first(Bitset_64 *set)
+{
+    return Bitset_64_next(set, 0);
+}
+
+static inline void
+Bitset_64_and(Bitset_64 *out, Bitset_64 *a, Bitset_64 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_AND);
+}
+
+static inline void
+Bitset_64_or(Bitset_64 *out, Bitset_64 *a, Bitset_64 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_OR);
+}
+
+static inline void
+Bitset_64_xor(Bitset_64 *out, Bitset_64 *a, Bitset_64 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_XOR);
+}
+
+/* the bits of a that are not in b */
+static inline void
+Bitset_64_andnot(Bitset_64 *out, Bitset_64 *a, Bitset_64 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_ANDNOT);
+}
+
+/* visits every set bit in increasing order, a word at a time */
+#define Bitset_64_for_each(bit, set) \
+    for (u32 bit##_word = 0; bit##_word < sizeof((set)->words) / sizeof(u64); ++bit##_word) \
+        for (u64 bit##_bits = (set)->words[bit##_word], bit = 0; \
+             bit##_bits && (bit = 64 * bit##_word + GenBitsetFirstBit(bit##_bits), 1); \
+             bit##_bits &= bit##_bits - 1)
+
+typedef struct Bitset_256 Bitset_256;
+struct Bitset_256
+{
+    /* bit i is bit i % 64 of words[i / 64]; bits past the end stay 0 */
+    u64 words[(256 + 63) / 64];
+};
+
+#include <string.h>
+
+/*
+ Set of the numbers below a fixed size, one bit each. Whole-set
+ operations go over the words with AVX2 or SSE2 when the compiler
+ enables them and one word at a time otherwise.
+ */
+#ifndef GEN_BITSET
+#define GEN_BITSET
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static inline u32
+GenBitsetPopcount(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (u32)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* index of the lowest set bit, word must not be 0 */
+static inline u32
+GenBitsetFirstBit(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctzll(word);
+#else
+    u32 bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/*
+ out = a op b over count words, where op is one of & | ^ and andnot
+ (a & ~b). The vector paths handle whole vectors and the rest falls
+ through to the word loop.
+ */
+#define GEN_BITSET_AND 0
+#define GEN_BITSET_OR 1
+#define GEN_BITSET_XOR 2
+#define GEN_BITSET_ANDNOT 3
+
+static inline void
+GenBitsetCombine(u64 *out, u64 *a, u64 *b, u32 count, u32 op)
+{
+    u32 i = 0;
+    
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((__m256i *)(b + i));
+        __m256i z = (op == GEN_BITSET_AND) ? _mm256_and_si256(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm256_or_si256(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm256_xor_si256(x, y) :
+                    _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i *)(out + i), z);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((__m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((__m128i *)(b + i));
+        __m128i z = (op == GEN_BITSET_AND) ? _mm_and_si128(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm_or_si128(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm_xor_si128(x, y) :
+                    _mm_andnot_si128(y, x);
+        _mm_storeu_si128((__m128i *)(out + i), z);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = (op == GEN_BITSET_AND) ? (a[i] & b[i]) :
+                 (op == GEN_BITSET_OR) ? (a[i] | b[i]) :
+                 (op == GEN_BITSET_XOR) ? (a[i] ^ b[i]) :
+                 (a[i] & ~b[i]);
+    }
+}
+#endif
+
+static inline void
+Bitset_256_set(Bitset_256 *set, u32 bit)
+{
+    set->words[bit / 64] |= (u64)1 << (bit % 64);
+}
+
+static inline void
+Bitset_256_clear(Bitset_256 *set, u32 bit)
+{
+    set->words[bit / 64] &= ~((u64)1 << (bit % 64));
+}
+
+static inline void
+Bitset_256_flip(Bitset_256 *set, u32 bit)
+{
+    set->words[bit / 64] ^= (u64)1 << (bit % 64);
+}
+
+static inline b32
+Bitset_256_test(Bitset_256 *set, u32 bit)
+{
+    return (set->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void
+Bitset_256_clear_all(Bitset_256 *set)
+{
+    memset(set->words, 0, sizeof(set->words));
+}
+
+static inline void
+Bitset_256_set_all(Bitset_256 *set)
+{
+    memset(set->words, 0xFF, sizeof(set->words));
+}
+
+static inline u32
+Bitset_256_count(Bitset_256 *set)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        count += GenBitsetPopcount(set->words[i]);
+    }
+    return count;
+}
+
+static inline b32
+Bitset_256_any(Bitset_256 *set)
+{
+    u64 any = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        any |= set->words[i];
+    }
+    return any != 0;
+}
+
+static inline b32
+Bitset_256_equal(Bitset_256 *a, Bitset_256 *b)
+{
+    return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+/* the first set bit at or after from, or the bit count if there is none */
+static inline u32
+Bitset_256_next(Bitset_256 *set, u32 from)
+{
+    if (from >= 256)
+    {
+        return 256;
+    }
+    
+    u32 i = from / 64;
+    u64 word = set->words[i] & (~(u64)0 << (from % 64));
+    
+    while (word == 0)
+    {
+        if (++i == sizeof(set->words) / sizeof(u64))
+        {
+            return 256;
+        }
+        word = set->words[i];
+    }
+    return 64 * i + GenBitsetFirstBit(word);
+}
+
+static inline u32
+Bitset_256_first(Bitset_256 *set)
+{
+    return Bitset_256_next(set, 0);
+}
+
+static inline void
+Bitset_256_and(Bitset_256 *out, Bitset_256 *a, Bitset_256 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_AND);
+}
+
+static inline void
+Bitset_256_or(Bitset_256 *out, Bitset_256 *a, Bitset_256 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_OR);
+}
+
+static inline void
+Bitset_256_xor(Bitset_256 *out, Bitset_256 *a, Bitset_256 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_XOR);
+}
+
+/* the bits of a that are not in b */
+static inline void
+Bitset_256_andnot(Bitset_256 *out, Bitset_256 *a, Bitset_256 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_ANDNOT);
+}
+
+/* visits every set bit in increasing order, a word at a time */
+#define Bitset_256_for_each(bit, set) \
+    for (u32 bit##_word = 0; bit##_word < sizeof((set)->words) / sizeof(u64); ++bit##_word) \
+        for (u64 bit##_bits = (set)->words[bit##_word], bit = 0; \
+             bit##_bits && (bit = 64 * bit##_word + GenBitsetFirstBit(bit##_bits), 1); \
+             bit##_bits &= bit##_bits - 1)
+
+typedef struct Bitset_1000 Bitset_1000;
+struct Bitset_1000
+{
+    /* bit i is bit i % 64 of words[i / 64]; bits past the end stay 0 */
+    u64 words[(1000 + 63) / 64];
+};
+
+#include <string.h>
+
+/*
+ Set of the numbers below a fixed size, one bit each. Whole-set
+ operations go over the words with AVX2 or SSE2 when the compiler
+ enables them and one word at a time otherwise.
+ */
+#ifndef GEN_BITSET
+#define GEN_BITSET
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static inline u32
+GenBitsetPopcount(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (u32)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* index of the lowest set bit, word must not be 0 */
+static inline u32
+GenBitsetFirstBit(u64 word)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctzll(word);
+#else
+    u32 bit = 0;
+    while (!(word & 1))
+    {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/*
+ out = a op b over count words, where op is one of & | ^ and andnot
+ (a & ~b). The vector paths handle whole vectors and the rest falls
+ through to the word loop.
+ */
+#define GEN_BITSET_AND 0
+#define GEN_BITSET_OR 1
+#define GEN_BITSET_XOR 2
+#define GEN_BITSET_ANDNOT 3
+
+static inline void
+GenBitsetCombine(u64 *out, u64 *a, u64 *b, u32 count, u32 op)
+{
+    u32 i = 0;
+    
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((__m256i *)(b + i));
+        __m256i z = (op == GEN_BITSET_AND) ? _mm256_and_si256(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm256_or_si256(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm256_xor_si256(x, y) :
+                    _mm256_andnot_si256(y, x);
+        _mm256_storeu_si256((__m256i *)(out + i), z);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i x = _mm_loadu_si128((__m128i *)(a + i));
+        __m128i y = _mm_loadu_si128((__m128i *)(b + i));
+        __m128i z = (op == GEN_BITSET_AND) ? _mm_and_si128(x, y) :
+                    (op == GEN_BITSET_OR) ? _mm_or_si128(x, y) :
+                    (op == GEN_BITSET_XOR) ? _mm_xor_si128(x, y) :
+                    _mm_andnot_si128(y, x);
+        _mm_storeu_si128((__m128i *)(out + i), z);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = (op == GEN_BITSET_AND) ? (a[i] & b[i]) :
+                 (op == GEN_BITSET_OR) ? (a[i] | b[i]) :
+                 (op == GEN_BITSET_XOR) ? (a[i] ^ b[i]) :
+                 (a[i] & ~b[i]);
+    }
+}
+#endif
+
+static inline void
+Bitset_1000_set(Bitset_1000 *set, u32 bit)
+{
+    set->words[bit / 64] |= (u64)1 << (bit % 64);
+}
+
+static inline void
+Bitset_1000_clear(Bitset_1000 *set, u32 bit)
+{
+    set->words[bit / 64] &= ~((u64)1 << (bit % 64));
+}
+
+static inline void
+Bitset_1000_flip(Bitset_1000 *set, u32 bit)
+{
+    set->words[bit / 64] ^= (u64)1 << (bit % 64);
+}
+
+static inline b32
+Bitset_1000_test(Bitset_1000 *set, u32 bit)
+{
+    return (set->words[bit / 64] >> (bit % 64)) & 1;
+}
+
+static inline void
+Bitset_1000_clear_all(Bitset_1000 *set)
+{
+    memset(set->words, 0, sizeof(set->words));
+}
+
+static inline void
+Bitset_1000_set_all(Bitset_1000 *set)
+{
+    memset(set->words, 0xFF, sizeof(set->words));
+    set->words[1000 / 64] = ((u64)1 << (1000 % 64)) - 1;
+}
+
+static inline u32
+Bitset_1000_count(Bitset_1000 *set)
+{
+    u32 count = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        count += GenBitsetPopcount(set->words[i]);
+    }
+    return count;
+}
+
+static inline b32
+Bitset_1000_any(Bitset_1000 *set)
+{
+    u64 any = 0;
+    for (u32 i = 0; i < sizeof(set->words) / sizeof(u64); ++i)
+    {
+        any |= set->words[i];
+    }
+    return any != 0;
+}
+
+static inline b32
+Bitset_1000_equal(Bitset_1000 *a, Bitset_1000 *b)
+{
+    return memcmp(a->words, b->words, sizeof(a->words)) == 0;
+}
+
+/* the first set bit at or after from, or the bit count if there is none */
+static inline u32
+Bitset_1000_next(Bitset_1000 *set, u32 from)
+{
+    if (from >= 1000)
+    {
+        return 1000;
+    }
+    
+    u32 i = from / 64;
+    u64 word = set->words[i] & (~(u64)0 << (from % 64));
+    
+    while (word == 0)
+    {
+        if (++i == sizeof(set->words) / sizeof(u64))
+        {
+            return 1000;
+        }
+        word = set->words[i];
+    }
+    return 64 * i + GenBitsetFirstBit(word);
+}
+
+static inline u32
+Bitset_1000_first(Bitset_1000 *set)
+{
+    return Bitset_1000_next(set, 0);
+}
+
+static inline void
+Bitset_1000_and(Bitset_1000 *out, Bitset_1000 *a, Bitset_1000 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_AND);
+}
+
+static inline void
+Bitset_1000_or(Bitset_1000 *out, Bitset_1000 *a, Bitset_1000 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_OR);
+}
+
+static inline void
+Bitset_1000_xor(Bitset_1000 *out, Bitset_1000 *a, Bitset_1000 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_XOR);
+}
+
+/* the bits of a that are not in b */
+static inline void
+Bitset_1000_andnot(Bitset_1000 *out, Bitset_1000 *a, Bitset_1000 *b)
+{
+    GenBitsetCombine(out->words, a->words, b->words,
+                     sizeof(out->words) / sizeof(u64), GEN_BITSET_ANDNOT);
+}
+
+/* visits every set bit in increasing order, a word at a time */
+#define Bitset_1000_for_each(bit, set) \
+    for (u32 bit##_word = 0; bit##_word < sizeof((set)->words) / sizeof(u64); ++bit##_word) \
+        for (u64 bit##_bits = (set)->words[bit##_word], bit = 0; \
+             bit##_bits && (bit = 64 * bit##_word + GenBitsetFirstBit(bit##_bits), 1); \
+             bit##_bits &= bit##_bits - 1)
+
@@ -0,0 +1,138 @@
+~output_ext .h
+
+@template_start Counter_Shard <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* one cache line per shard, so threads on different shards never share one */
+    _Alignas(64) _Atomic T value;
+};
+@template_end
+
+@template_start Sharded_Counter <- T, SHARDS:64
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Counter_Shard<T> shards[SHARDS];
+};
+@template_end
+
+@template_fn Sharded_Counter <- T, SHARDS:64
+#include <stdatomic.h>
+
+_Static_assert((SHARDS & (SHARDS - 1)) == 0, "shard count must be a power of two");
+
+/*
+ Counter for hot paths that many threads update and few read. Every
+ thread adds to its own shard, picked by a small per-thread number,
+ so increments do not bounce a cache line between cores. Shards are
+ still atomic: with more threads than shards two threads share one.
+ Readers add the shards up; the total is exact once writers stop and
+ otherwise includes some concurrent updates and not others.
+ */
+#ifndef GEN_COUNTER_THREAD_INDEX
+#define GEN_COUNTER_THREAD_INDEX
+
+/* numbers threads in the order they first touch a counter in this file */
+static inline u32
+GenCounterThreadIndex()
+{
+    static _Atomic u32 thread_num;
+    static _Thread_local u32 thread_index;
+    
+    if (thread_index == 0)
+    {
+        thread_index = atomic_fetch_add_explicit(&thread_num, 1, memory_order_relaxed) + 1;
+    }
+    return thread_index - 1;
+}
+#endif
+
+static inline void
+@template_name_init(@template_name *counter)
+{
+    for (u32 i = 0; i < SHARDS; ++i)
+    {
+        atomic_init(&counter->shards[i].value, 0);
+    }
+}
+
+static inline void
+@template_name_add(@template_name *counter, T amount)
+{
+    _Atomic T *value = &counter->shards[GenCounterThreadIndex() & (SHARDS - 1)].value;
+@if is_float(T)
+    
+    /* there is no atomic add for floating point */
+    T old = atomic_load_explicit(value, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(value, &old, old + amount,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+    }
+@else
+    atomic_fetch_add_explicit(value, amount, memory_order_relaxed);
+@endif
+}
+
+static inline void
+@template_name_increment(@template_name *counter)
+{
+    @template_name_add(counter, 1);
+}
+
+/* copies every shard to shards, which has room for all of them */
+static inline void
+@template_name_snapshot(@template_name *counter, T *shards)
+{
+    for (u32 i = 0; i < SHARDS; ++i)
+    {
+        shards[i] = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+}
+
+/* the sum of all shards */
+static inline T
+@template_name_total(@template_name *counter)
+{
+    T total = 0;
+    for (u32 i = 0; i < SHARDS; ++i)
+    {
+        total += atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+/* adds the shards of from into counter and clears them, for periodic reporting */
+static inline void
+@template_name_drain(@template_name *counter, @template_name *from)
+{
+    for (u32 i = 0; i < SHARDS; ++i)
+    {
+        T amount = atomic_exchange_explicit(&from->shards[i].value, 0, memory_order_relaxed);
+@if is_float(T)
+        T old = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&counter->shards[i].value, &old, old + amount,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+        {
+        }
+@else
+        atomic_fetch_add_explicit(&counter->shards[i].value, amount, memory_order_relaxed);
+@endif
+    }
+}
+
+static inline void
+@template_name_reset(@template_name *counter)
+{
+    for (u32 i = 0; i < SHARDS; ++i)
+    {
+        atomic_store_explicit(&counter->shards[i].value, 0, memory_order_relaxed);
+    }
+}
+@template_end
+
+@template Sharded_Counter -> u64 -> Counter_U64
+@template Sharded_Counter -> f64 -> Counter_F64
+@template Sharded_Counter -> u32, 8 -> Counter_U32_8
@@ -0,0 +1,333 @@
+typedef struct Counter_Shard_u64 Counter_Shard_u64;
+struct Counter_Shard_u64
+{
+    /* one cache line per shard, so threads on different shards never share one */
+    _Alignas(64) _Atomic u64 value;
+};
+
+typedef struct Counter_U64 Counter_U64;
+struct Counter_U64
+{
+    Counter_Shard_u64 shards[64];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((64 & (64 - 1)) == 0, "shard count must be a power of two");
+
+/*
+ Counter for hot paths that many threads update and few read. Every
+ thread adds to its own shard, picked by a small per-thread number,
+ so increments do not bounce a cache line between cores. Shards are
+ still atomic: with more threads than shards two threads share one.
+ Readers add the shards up; the total is exact once writers stop and
+ otherwise includes some concurrent updates and not others.
+ */
+#ifndef GEN_COUNTER_THREAD_INDEX
+#define GEN_COUNTER_THREAD_INDEX
+
+/* numbers threads in the order they first touch a counter in this file */
+static inline u32
+GenCounterThreadIndex()
+{
+    static _Atomic u32 thread_num;
+    static _Thread_local u32 thread_index;
+    
+    if (thread_index == 0)
+    {
+        thread_index = atomic_fetch_add_explicit(&thread_num, 1, memory_order_relaxed) + 1;
+    }
+    return thread_index - 1;
+}
+#endif
+
+static inline void
+Counter_U64_init(Counter_U64 *counter)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        atomic_init(&counter->shards[i].value, 0);
+    }
+}
+
+static inline void
+Counter_U64_add(Counter_U64 *counter, u64 amount)
+{
+    _Atomic u64 *value = &counter->shards[GenCounterThreadIndex() & (64 - 1)].value;
+    atomic_fetch_add_explicit(value, amount, memory_order_relaxed);
+}
+
+static inline void
+Counter_U64_increment(Counter_U64 *counter)
+{
+    Counter_U64_add(counter, 1);
+}
+
+/* copies every shard to shards, which has room for all of them */
+static inline void
+Counter_U64_snapshot(Counter_U64 *counter, u64 *shards)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        shards[i] = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+}
+
+/* the sum of all shards */
+static inline u64
+Counter_U64_total(Counter_U64 *counter)
+{
+    u64 total = 0;
+    for (u32 i = 0; i < 64; ++i)
+    {
+        total += atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+/* adds the shards of from into counter and clears them, for periodic reporting */
+static inline void
+Counter_U64_drain(Counter_U64 *counter, Counter_U64 *from)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        u64 amount = atomic_exchange_explicit(&from->shards[i].value, 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counter->shards[i].value, amount, memory_order_relaxed);
+    }
+}
+
+static inline void
+Counter_U64_reset(Counter_U64 *counter)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        atomic_store_explicit(&counter->shards[i].value, 0, memory_order_relaxed);
+    }
+}
+
+typedef struct Counter_Shard_f64 Counter_Shard_f64;
+struct Counter_Shard_f64
+{
+    /* one cache line per shard, so threads on different shards never share one */
+    _Alignas(64) _Atomic f64 value;
+};
+
+typedef struct Counter_F64 Counter_F64;
+struct Counter_F64
+{
+    Counter_Shard_f64 shards[64];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((64 & (64 - 1)) == 0, "shard count must be a power of two");
+
+/*
+ Counter for hot paths that many threads update and few read. Every
+ thread adds to its own shard, picked by a small per-thread number,
+ so increments do not bounce a cache line between cores. Shards are
+ still atomic: with more threads than shards two threads share one.
+ Readers add the shards up; the total is exact once writers stop and
+ otherwise includes some concurrent updates and not others.
+ */
+#ifndef GEN_COUNTER_THREAD_INDEX
+#define GEN_COUNTER_THREAD_INDEX
+
+/* numbers threads in the order they first touch a counter in this file */
+static inline u32
+GenCounterThreadIndex()
+{
+    static _Atomic u32 thread_num;
+    static _Thread_local u32 thread_index;
+    
+    if (thread_index == 0)
+    {
+        thread_index = atomic_fetch_add_explicit(&thread_num, 1, memory_order_relaxed) + 1;
+    }
+    return thread_index - 1;
+}
+#endif
+
+static inline void
+Counter_F64_init(Counter_F64 *counter)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        atomic_init(&counter->shards[i].value, 0);
+    }
+}
+
+static inline void
+Counter_F64_add(Counter_F64 *counter, f64 amount)
+{
+    _Atomic f64 *value = &counter->shards[GenCounterThreadIndex() & (64 - 1)].value;
+    
+    /* there is no atomic add for floating point */
+    f64 old = atomic_load_explicit(value, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(value, &old, old + amount,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+    }
+}
+
+static inline void
+Counter_F64_increment(Counter_F64 *counter)
+{
+    Counter_F64_add(counter, 1);
+}
+
+/* copies every shard to shards, which has room for all of them */
+static inline void
+Counter_F64_snapshot(Counter_F64 *counter, f64 *shards)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        shards[i] = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+}
+
+/* the sum of all shards */
+static inline f64
+Counter_F64_total(Counter_F64 *counter)
+{
+    f64 total = 0;
+    for (u32 i = 0; i < 64; ++i)
+    {
+        total += atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+/* adds the shards of from into counter and clears them, for periodic reporting */
+static inline void
+Counter_F64_drain(Counter_F64 *counter, Counter_F64 *from)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        f64 amount = atomic_exchange_explicit(&from->shards[i].value, 0, memory_order_relaxed);
+        f64 old = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&counter->shards[i].value, &old, old + amount,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+        {
+        }
+    }
+}
+
+static inline void
+Counter_F64_reset(Counter_F64 *counter)
+{
+    for (u32 i = 0; i < 64; ++i)
+    {
+        atomic_store_explicit(&counter->shards[i].value, 0, memory_order_relaxed);
+    }
+}
+
+typedef struct Counter_Shard_u32 Counter_Shard_u32;
+struct Counter_Shard_u32
+{
+    /* one cache line per shard, so threads on different shards never share one */
+    _Alignas(64) _Atomic u32 value;
+};
+
+typedef struct Counter_U32_8 Counter_U32_8;
+struct Counter_U32_8
+{
+    Counter_Shard_u32 shards[8];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((8 & (8 - 1)) == 0, "shard count must be a power of two");
+
+/*
+ Counter for hot paths that many threads update and few read. Every
+ thread adds to its own shard, picked by a small per-thread number,
+ so increments do not bounce a cache line between cores. Shards are
+ still atomic: with more threads than shards two threads share one.
+ Readers add the shards up; the total is exact once writers stop and
+ otherwise includes some concurrent updates and not others.
+ */
+#ifndef GEN_COUNTER_THREAD_INDEX
+#define GEN_COUNTER_THREAD_INDEX
+
+/* numbers threads in the order they first touch a counter in this file */
+static inline u32
+GenCounterThreadIndex()
+{
+    static _Atomic u32 thread_num;
+    static _Thread_local u32 thread_index;
+    
+    if (thread_index == 0)
+    {
+        thread_index = atomic_fetch_add_explicit(&thread_num, 1, memory_order_relaxed) + 1;
+    }
+    return thread_index - 1;
+}
+#endif
+
+static inline void
+Counter_U32_8_init(Counter_U32_8 *counter)
+{
+    for (u32 i = 0; i < 8; ++i)
+    {
+        atomic_init(&counter->shards[i].value, 0);
+    }
+}
+
+static inline void
+Counter_U32_8_add(Counter_U32_8 *counter, u32 amount)
+{
+    _Atomic u32 *value = &counter->shards[GenCounterThreadIndex() & (8 - 1)].value;
+    atomic_fetch_add_explicit(value, amount, memory_order_relaxed);
+}
+
+static inline void
+Counter_U32_8_increment(Counter_U32_8 *counter)
+{
+    Counter_U32_8_add(counter, 1);
+}
+
+/* copies every shard to shards, which has room for all of them */
+static inline void
+Counter_U32_8_snapshot(Counter_U32_8 *counter, u32 *shards)
+{
+    for (u32 i = 0; i < 8; ++i)
+    {
+        shards[i] = atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+}
+
+/* the sum of all shards */
+static inline u32
+Counter_U32_8_total(Counter_U32_8 *counter)
+{
+    u32 total = 0;
+    for (u32 i = 0; i < 8; ++i)
+    {
+        total += atomic_load_explicit(&counter->shards[i].value, memory_order_relaxed);
+    }
+    return total;
+}
+
+/* adds the shards of from into counter and clears them, for periodic reporting */
+static inline void
+Counter_U32_8_drain(Counter_U32_8 *counter, Counter_U32_8 *from)
+{
+    for (u32 i = 0; i < 8; ++i)
+    {
+        u32 amount = atomic_exchange_explicit(&from->shards[i].value, 0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counter->shards[i].value, amount, memory_order_relaxed);
+    }
+}
+
+static inline void
+Counter_U32_8_reset(Counter_U32_8 *counter)
+{
+    for (u32 i = 0; i < 8; ++i)
+    {
+        atomic_store_explicit(&counter->shards[i].value, 0, memory_order_relaxed);
+    }
+}
+
@@ -0,0 +1,34 @@
+~output_ext .h
+
+@template_start Fixed_Array <- T, N:16
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T items[N];
+};
+@template_end
+
+@template_start Small_Vector <- T, N:8
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	u32 count;
+	T items[N];
+};
+@template_end
+
+@template_start Vec_N <- T, N:4
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T e[N];
+};
+@template_end
+
+@template Fixed_Array -> f32, 64 -> Fixed_Array_F32_64
+@template Fixed_Array -> u8 -> Fixed_Array_U8_16
+
+@template Small_Vector -> u32, 4 -> Small_Vector_U32_4
+
+@template Vec_N -> f32 -> Vec4f_N
+@template Vec_N -> f64, 8 -> Vec8d_N
@@ -0,0 +1,31 @@
+typedef struct Fixed_Array_F32_64 Fixed_Array_F32_64;
+struct Fixed_Array_F32_64
+{
+	f32 items[64];
+};
+
+typedef struct Fixed_Array_U8_16 Fixed_Array_U8_16;
+struct Fixed_Array_U8_16
+{
+	u8 items[16];
+};
+
+typedef struct Small_Vector_U32_4 Small_Vector_U32_4;
+struct Small_Vector_U32_4
+{
+	u32 count;
+	u32 items[4];
+};
+
+typedef struct Vec4f_N Vec4f_N;
+struct Vec4f_N
+{
+	f32 e[4];
+};
+
+typedef struct Vec8d_N Vec8d_N;
+struct Vec8d_N
+{
+	f64 e[8];
+};
+
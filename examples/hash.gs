@@ -0,0 +1,37 @@
+~output_ext .h
+
+@template_start Vec3 <- T
+@hash
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y, z;
+};
+@template_end
+
+@template_start Cell_Key <- T
+@hash
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    u8 layer;
+    T x, y;
+    u16 flags;
+};
+@template_end
+
+@template_start Edge_Key <- T
+@hash
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Cell_Key<T> from;
+    Cell_Key<T> to;
+    Vec3<T> offset;
+    u32 cost;
+};
+@template_end
+
+@template Vec3 -> f32 -> Vec3f
+@template Cell_Key -> s32 -> Cell_Key_S32
+@template Edge_Key -> s32 -> Edge_Key_S32
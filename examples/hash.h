@@ -0,0 +1,169 @@
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+    f32 x, y, z;
+};
+
+#ifndef GEN_HASH_PRELUDE
+#define GEN_HASH_PRELUDE
+#include <stddef.h>
+#include <string.h>
+
+#ifndef GEN_HASH_SEED
+#define GEN_HASH_SEED 0x9e3779b97f4a7c15ull
+#endif
+
+/* Hash_<type> and Equal_<type> of a type parameter */
+#define GEN_HASH(type) Hash_##type
+#define GEN_EQUAL(type) Equal_##type
+
+/* one multiply per word, the finish step does the rest */
+static inline u64
+GenHashMix(u64 hash, u64 word)
+{
+    hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 31);
+}
+
+/* size is a constant in every call, so the loop unrolls */
+static inline u64
+GenHashBytes(u8 *data, u64 size, u64 hash)
+{
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        u64 word;
+        memcpy(&word, data, 8);
+        hash = GenHashMix(hash, word);
+    }
+    if (size > 0)
+    {
+        u64 word = 0;
+        memcpy(&word, data, size);
+        hash = GenHashMix(hash, word);
+    }
+    return hash;
+}
+
+static inline u64
+GenHashFinish(u64 hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+#endif
+
+/* Vec3f has no padding, so it is hashed and compared as memory */
+static inline u64
+Hash_Vec3f(Vec3f *value)
+{
+    return GenHashFinish(GenHashBytes((u8 *)value, sizeof(*value), GEN_HASH_SEED));
+}
+
+static inline b32
+Equal_Vec3f(Vec3f *a, Vec3f *b)
+{
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+typedef struct Cell_Key_S32 Cell_Key_S32;
+struct Cell_Key_S32
+{
+    u8 layer;
+    s32 x, y;
+    u16 flags;
+};
+
+/* Cell_Key_S32 has padding, which is skipped */
+static inline u64
+Hash_Cell_Key_S32(Cell_Key_S32 *value)
+{
+    u8 *memory = (u8 *)value;
+    u64 hash = GEN_HASH_SEED;
+    hash = GenHashBytes(memory + offsetof(Cell_Key_S32, layer), 1, hash);
+    hash = GenHashBytes(memory + offsetof(Cell_Key_S32, x), 10, hash);
+    return GenHashFinish(hash);
+}
+
+static inline b32
+Equal_Cell_Key_S32(Cell_Key_S32 *a, Cell_Key_S32 *b)
+{
+    u8 *memory_a = (u8 *)a;
+    u8 *memory_b = (u8 *)b;
+    if (memcmp(memory_a + offsetof(Cell_Key_S32, layer),
+               memory_b + offsetof(Cell_Key_S32, layer), 1) != 0)
+    {
+        return 0;
+    }
+    if (memcmp(memory_a + offsetof(Cell_Key_S32, x),
+               memory_b + offsetof(Cell_Key_S32, x), 10) != 0)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct Vec3_s32 Vec3_s32;
+struct Vec3_s32
+{
+    s32 x, y, z;
+};
+
+/* Vec3_s32 has no padding, so it is hashed and compared as memory */
+static inline u64
+Hash_Vec3_s32(Vec3_s32 *value)
+{
+    return GenHashFinish(GenHashBytes((u8 *)value, sizeof(*value), GEN_HASH_SEED));
+}
+
+static inline b32
+Equal_Vec3_s32(Vec3_s32 *a, Vec3_s32 *b)
+{
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+typedef struct Edge_Key_S32 Edge_Key_S32;
+struct Edge_Key_S32
+{
+    Cell_Key_S32 from;
+    Cell_Key_S32 to;
+    Vec3_s32 offset;
+    u32 cost;
+};
+
+/* Edge_Key_S32 has padding, which is skipped */
+static inline u64
+Hash_Edge_Key_S32(Edge_Key_S32 *value)
+{
+    u8 *memory = (u8 *)value;
+    u64 hash = GEN_HASH_SEED;
+    hash = GenHashMix(hash, Hash_Cell_Key_S32(&value->from));
+    hash = GenHashMix(hash, Hash_Cell_Key_S32(&value->to));
+    hash = GenHashBytes(memory + offsetof(Edge_Key_S32, offset), 16, hash);
+    return GenHashFinish(hash);
+}
+
+static inline b32
+Equal_Edge_Key_S32(Edge_Key_S32 *a, Edge_Key_S32 *b)
+{
+    u8 *memory_a = (u8 *)a;
+    u8 *memory_b = (u8 *)b;
+    if (Equal_Cell_Key_S32(&a->from, &b->from) == 0)
+    {
+        return 0;
+    }
+    if (Equal_Cell_Key_S32(&a->to, &b->to) == 0)
+    {
+        return 0;
+    }
+    if (memcmp(memory_a + offsetof(Edge_Key_S32, offset),
+               memory_b + offsetof(Edge_Key_S32, offset), 16) != 0)
+    {
+        return 0;
+    }
+    return 1;
+}
+
@@ -0,0 +1,419 @@
+~output_ext .h
+
+@template_start Grid_Key <- T
+@hash
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    u8 layer;
+    T x, y;
+};
+@template_end
+
+@template_start Hash_Map <- K, V
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* one control byte per slot: empty, deleted or 7 bits of the hash */
+    u8 *control;
+    K *keys;
+    V *values;
+    /* number of slots, a power of two and at least 16 */
+    u64 capacity;
+    u64 count;
+    u64 deleted;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+};
+@template_end
+
+@template_fn Hash_Map <- K, V
+#include <stdlib.h>
+#include <string.h>
+
+/* with GEN_INSTRUMENT, per-thread counts of what the map did */
+@instrument lookups, groups_probed, key_compares, longest_probe, rehashes, allocated_bytes, peak_count
+
+/*
+ Open addressing in groups of 16 slots. A lookup compares the 7 hash
+ bits stored in the control bytes of a whole group at once (one SSE2
+ compare) and only looks at the keys that match. Groups are probed
+ triangularly, so every group is visited once.
+ */
+#ifndef GEN_HASH_MAP_GROUP
+#define GEN_HASH_MAP_GROUP
+#define HASH_MAP_GROUP_SIZE 16
+#define HASH_MAP_EMPTY 0x80
+#define HASH_MAP_DELETED 0xFE
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* bit i is set if control[i] == byte */
+static inline u32
+GenHashMapMatch(u8 *control, u8 byte)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((__m128i *)control);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+/* bit i is set if control[i] is empty or deleted, which both have the top bit */
+static inline u32
+GenHashMapMatchFree(u8 *control)
+{
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((__m128i *)control));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32
+GenHashMapFirstBit(u32 mask)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctz(mask);
+#else
+    u32 bit = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+#endif
+
+static inline u64
+@template_name_hash(K key)
+{
+@if has_hash(K)
+    /* generated by @hash in the template of the key */
+    return GEN_HASH(K)(&key);
+@else
+@if is_integer(K) || is_pointer(K)
+    u64 x = (u64)key;
+@else
+@if is_float(K)
+    /* 0 and -0 compare equal, so they have to hash alike */
+    if (key == 0)
+    {
+        key = 0;
+    }
+    u64 x = 0;
+    memcpy(&x, &key, sizeof(key));
+@else
+    /* struct keys without @hash are hashed as bytes and must not contain padding */
+    u64 x = 0xcbf29ce484222325ull;
+    u8 *bytes = (u8 *)&key;
+    for (u64 i = 0; i < sizeof(key); ++i)
+    {
+        x = (x ^ bytes[i]) * 0x100000001b3ull;
+    }
+@endif
+@endif
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+@endif
+}
+
+static inline b32
+@template_name_equal(K a, K b)
+{
+@if has_hash(K)
+    return GEN_EQUAL(K)(&a, &b);
+@else
+@if is_integer(K) || is_pointer(K) || is_float(K)
+    return a == b;
+@else
+    return memcmp(&a, &b, sizeof(a)) == 0;
+@endif
+@endif
+}
+
+/* slot of key, or capacity if it is not in the map */
+static inline u64
+@template_name_slot(@template_name *map, K key, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    u8 tag = (u8)(hash & 0x7F);
+    @template_name_COUNT(lookups, 1);
+    
+    for (u64 step = 1;; ++step)
+    {
+        u8 *control = map->control + group * HASH_MAP_GROUP_SIZE;
+        @template_name_COUNT(groups_probed, 1);
+        @template_name_COUNT_MAX(longest_probe, step);
+        
+        for (u32 match = GenHashMapMatch(control, tag); match; match &= match - 1)
+        {
+            u64 index = group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+            @template_name_COUNT(key_compares, 1);
+            if (@template_name_equal(map->keys[index], key))
+            {
+                return index;
+            }
+        }
+        
+        if (GenHashMapMatch(control, HASH_MAP_EMPTY))
+        {
+            return map->capacity;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* first empty or deleted slot on the probe sequence of hash */
+static inline u64
+@template_name_free_slot(@template_name *map, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    
+    for (u64 step = 1;; ++step)
+    {
+        u32 match = GenHashMapMatchFree(map->control + group * HASH_MAP_GROUP_SIZE);
+        if (match)
+        {
+            return group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* control bytes, keys and values share one block */
+static inline u64
+@template_name_keys_offset(u64 capacity)
+{
+    return (capacity + _Alignof(K) - 1) & ~(u64)(_Alignof(K) - 1);
+}
+
+static inline u64
+@template_name_values_offset(u64 capacity)
+{
+    u64 offset = @template_name_keys_offset(capacity) + capacity * sizeof(K);
+    return (offset + _Alignof(V) - 1) & ~(u64)(_Alignof(V) - 1);
+}
+
+static inline u64
+@template_name_block_size(u64 capacity)
+{
+    return @template_name_values_offset(capacity) + capacity * sizeof(V);
+}
+
+static inline void
+@template_name_release_block(@template_name *map)
+{
+    if (!map->control)
+    {
+        return;
+    }
+    
+    if (!map->alloc)
+    {
+        free(map->control);
+    }
+    else if (map->release)
+    {
+        map->release(map->context, map->control,
+                     @template_name_block_size(map->capacity));
+    }
+}
+
+/*
+ Moves every entry into a new block of capacity slots, which also
+ drops the deleted markers. With an arena allocator and no release
+ the old block is simply left behind.
+ */
+static inline b32
+@template_name_rehash(@template_name *map, u64 capacity)
+{
+    u64 size = @template_name_block_size(capacity);
+    u8 *block = map->alloc ? map->alloc(map->context, size) : malloc(size);
+    if (!block)
+    {
+        return 0;
+    }
+    @template_name_COUNT(rehashes, 1);
+    @template_name_COUNT(allocated_bytes, size);
+    
+    @template_name grown = *map;
+    grown.control = block;
+    grown.keys = (K *)(block + @template_name_keys_offset(capacity));
+    grown.values = (V *)(block + @template_name_values_offset(capacity));
+    grown.capacity = capacity;
+    grown.deleted = 0;
+    memset(grown.control, HASH_MAP_EMPTY, capacity);
+    
+    for (u64 i = 0; i < map->capacity; ++i)
+    {
+        if (map->control[i] & 0x80)
+        {
+            continue;
+        }
+        
+        u64 index = @template_name_free_slot(&grown, @template_name_hash(map->keys[i]));
+        grown.control[index] = map->control[i];
+        grown.keys[index] = map->keys[i];
+        grown.values[index] = map->values[i];
+    }
+    
+    @template_name_release_block(map);
+    *map = grown;
+    return 1;
+}
+
+/* makes room for count entries without rehashing */
+static inline b32
+@template_name_reserve(@template_name *map, u64 count)
+{
+    u64 capacity = HASH_MAP_GROUP_SIZE;
+    while (count * 8 > capacity * 7)
+    {
+        capacity *= 2;
+    }
+    
+    return (capacity <= map->capacity) || @template_name_rehash(map, capacity);
+}
+
+static inline V *
+@template_name_find(@template_name *map, K key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = @template_name_slot(map, key, @template_name_hash(key));
+    return (index == map->capacity) ? 0 : &map->values[index];
+}
+
+/* inserts or overwrites, returns 0 if the map could not grow */
+static inline b32
+@template_name_insert(@template_name *map, K key, V value)
+{
+    u64 hash = @template_name_hash(key);
+    
+    if (map->capacity > 0)
+    {
+        u64 index = @template_name_slot(map, key, hash);
+        if (index != map->capacity)
+        {
+            map->values[index] = value;
+            return 1;
+        }
+    }
+    
+    /* keep 1/8 of the slots empty so every probe ends */
+    if ((map->count + map->deleted + 1) * 8 > map->capacity * 7)
+    {
+        u64 capacity = (map->capacity > 0) ? map->capacity : HASH_MAP_GROUP_SIZE;
+        if ((map->count + 1) * 16 > capacity * 7)
+        {
+            capacity *= 2;
+        }
+        
+        if (@template_name_rehash(map, capacity) == 0)
+        {
+            return 0;
+        }
+    }
+    
+    u64 index = @template_name_free_slot(map, hash);
+    if (map->control[index] == HASH_MAP_DELETED)
+    {
+        --map->deleted;
+    }
+    map->control[index] = (u8)(hash & 0x7F);
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    @template_name_COUNT_MAX(peak_count, map->count);
+    return 1;
+}
+
+static inline b32
+@template_name_remove(@template_name *map, K key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = @template_name_slot(map, key, @template_name_hash(key));
+    if (index == map->capacity)
+    {
+        return 0;
+    }
+    
+    /* no probe went past a group that still has an empty slot */
+    u8 *group = map->control + (index & ~(u64)(HASH_MAP_GROUP_SIZE - 1));
+    if (GenHashMapMatch(group, HASH_MAP_EMPTY))
+    {
+        map->control[index] = HASH_MAP_EMPTY;
+    }
+    else
+    {
+        map->control[index] = HASH_MAP_DELETED;
+        ++map->deleted;
+    }
+    --map->count;
+    return 1;
+}
+
+static inline void
+@template_name_clear(@template_name *map)
+{
+    if (map->control)
+    {
+        memset(map->control, HASH_MAP_EMPTY, map->capacity);
+    }
+    map->count = 0;
+    map->deleted = 0;
+}
+
+static inline void
+@template_name_free(@template_name *map)
+{
+    @template_name_release_block(map);
+    map->control = 0;
+    map->keys = 0;
+    map->values = 0;
+    map->capacity = 0;
+    map->count = 0;
+    map->deleted = 0;
+}
+
+/* visits the slot index of every entry */
+#define @template_name_for_each(map, index) \
+    for (u64 index = 0; index < (map)->capacity; ++index) \
+        if (!((map)->control[index] & 0x80))
+@template_end
+
+@template Hash_Map -> u64, u64 -> Map_U64
+@template Hash_Map -> f32, u32 -> Map_F32_U32
+@template Hash_Map -> Grid_Key<s32>, u32 -> Map_Grid
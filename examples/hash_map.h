@@ -0,0 +1,1331 @@
+typedef struct Map_U64 Map_U64;
+struct Map_U64
+{
+    /* one control byte per slot: empty, deleted or 7 bits of the hash */
+    u8 *control;
+    u64 *keys;
+    u64 *values;
+    /* number of slots, a power of two and at least 16 */
+    u64 capacity;
+    u64 count;
+    u64 deleted;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* with GEN_INSTRUMENT, per-thread counts of what the map did */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Map_U64 in the calling thread */
+typedef struct Map_U64_Counters
+{
+    u64 lookups;
+    u64 groups_probed;
+    u64 key_compares;
+    u64 longest_probe;
+    u64 rehashes;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Map_U64_Counters;
+
+static _Thread_local Map_U64_Counters Map_U64_counters;
+
+#define Map_U64_COUNT(counter, n) (Map_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Map_U64_COUNT_MAX(counter, value) \
+    (Map_U64_counters.counter = ((u64)(value) > Map_U64_counters.counter) ? \
+        (u64)(value) : Map_U64_counters.counter)
+
+static inline void
+Map_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "Map_U64:");
+    fprintf(file, " lookups %llu", (unsigned long long)Map_U64_counters.lookups);
+    fprintf(file, " groups_probed %llu", (unsigned long long)Map_U64_counters.groups_probed);
+    fprintf(file, " key_compares %llu", (unsigned long long)Map_U64_counters.key_compares);
+    fprintf(file, " longest_probe %llu", (unsigned long long)Map_U64_counters.longest_probe);
+    fprintf(file, " rehashes %llu", (unsigned long long)Map_U64_counters.rehashes);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Map_U64_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Map_U64_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Map_U64_reset_counters(void)
+{
+    Map_U64_counters = (Map_U64_Counters){0};
+}
+#else
+#define Map_U64_COUNT(counter, n) ((void)0)
+#define Map_U64_COUNT_MAX(counter, value) ((void)0)
+#define Map_U64_dump_counters(file) ((void)0)
+#define Map_U64_reset_counters() ((void)0)
+#endif
+
+/*
+ Open addressing in groups of 16 slots. A lookup compares the 7 hash
+ bits stored in the control bytes of a whole group at once (one SSE2
+ compare) and only looks at the keys that match. Groups are probed
+ triangularly, so every group is visited once.
+ */
+#ifndef GEN_HASH_MAP_GROUP
+#define GEN_HASH_MAP_GROUP
+#define HASH_MAP_GROUP_SIZE 16
+#define HASH_MAP_EMPTY 0x80
+#define HASH_MAP_DELETED 0xFE
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* bit i is set if control[i] == byte */
+static inline u32
+GenHashMapMatch(u8 *control, u8 byte)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((__m128i *)control);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+/* bit i is set if control[i] is empty or deleted, which both have the top bit */
+static inline u32
+GenHashMapMatchFree(u8 *control)
+{
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((__m128i *)control));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32
+GenHashMapFirstBit(u32 mask)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctz(mask);
+#else
+    u32 bit = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+#endif
+
+static inline u64
+Map_U64_hash(u64 key)
+{
+    u64 x = (u64)key;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline b32
+Map_U64_equal(u64 a, u64 b)
+{
+    return a == b;
+}
+
+/* slot of key, or capacity if it is not in the map */
+static inline u64
+Map_U64_slot(Map_U64 *map, u64 key, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    u8 tag = (u8)(hash & 0x7F);
+    Map_U64_COUNT(lookups, 1);
+    
+    for (u64 step = 1;; ++step)
+    {
+        u8 *control = map->control + group * HASH_MAP_GROUP_SIZE;
+        Map_U64_COUNT(groups_probed, 1);
+        Map_U64_COUNT_MAX(longest_probe, step);
+        
+        for (u32 match = GenHashMapMatch(control, tag); match; match &= match - 1)
+        {
+            u64 index = group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+            Map_U64_COUNT(key_compares, 1);
+            if (Map_U64_equal(map->keys[index], key))
+            {
+                return index;
+            }
+        }
+        
+        if (GenHashMapMatch(control, HASH_MAP_EMPTY))
+        {
+            return map->capacity;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* first empty or deleted slot on the probe sequence of hash */
+static inline u64
+Map_U64_free_slot(Map_U64 *map, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    
+    for (u64 step = 1;; ++step)
+    {
+        u32 match = GenHashMapMatchFree(map->control + group * HASH_MAP_GROUP_SIZE);
+        if (match)
+        {
+            return group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* control bytes, keys and values share one block */
+static inline u64
+Map_U64_keys_offset(u64 capacity)
+{
+    return (capacity + _Alignof(u64) - 1) & ~(u64)(_Alignof(u64) - 1);
+}
+
+static inline u64
+Map_U64_values_offset(u64 capacity)
+{
+    u64 offset = Map_U64_keys_offset(capacity) + capacity * sizeof(u64);
+    return (offset + _Alignof(u64) - 1) & ~(u64)(_Alignof(u64) - 1);
+}
+
+static inline u64
+Map_U64_block_size(u64 capacity)
+{
+    return Map_U64_values_offset(capacity) + capacity * sizeof(u64);
+}
+
+static inline void
+Map_U64_release_block(Map_U64 *map)
+{
+    if (!map->control)
+    {
+        return;
+    }
+    
+    if (!map->alloc)
+    {
+        free(map->control);
+    }
+    else if (map->release)
+    {
+        map->release(map->context, map->control,
+                     Map_U64_block_size(map->capacity));
+    }
+}
+
+/*
+ Moves every entry into a new block of capacity slots, which also
+ drops the deleted markers. With an arena allocator and no release
+ the old block is simply left behind.
+ */
+static inline b32
+Map_U64_rehash(Map_U64 *map, u64 capacity)
+{
+    u64 size = Map_U64_block_size(capacity);
+    u8 *block = map->alloc ? map->alloc(map->context, size) : malloc(size);
+    if (!block)
+    {
+        return 0;
+    }
+    Map_U64_COUNT(rehashes, 1);
+    Map_U64_COUNT(allocated_bytes, size);
+    
+    Map_U64 grown = *map;
+    grown.control = block;
+    grown.keys = (u64 *)(block + Map_U64_keys_offset(capacity));
+    grown.values = (u64 *)(block + Map_U64_values_offset(capacity));
+    grown.capacity = capacity;
+    grown.deleted = 0;
+    memset(grown.control, HASH_MAP_EMPTY, capacity);
+    
+    for (u64 i = 0; i < map->capacity; ++i)
+    {
+        if (map->control[i] & 0x80)
+        {
+            continue;
+        }
+        
+        u64 index = Map_U64_free_slot(&grown, Map_U64_hash(map->keys[i]));
+        grown.control[index] = map->control[i];
+        grown.keys[index] = map->keys[i];
+        grown.values[index] = map->values[i];
+    }
+    
+    Map_U64_release_block(map);
+    *map = grown;
+    return 1;
+}
+
+/* makes room for count entries without rehashing */
+static inline b32
+Map_U64_reserve(Map_U64 *map, u64 count)
+{
+    u64 capacity = HASH_MAP_GROUP_SIZE;
+    while (count * 8 > capacity * 7)
+    {
+        capacity *= 2;
+    }
+    
+    return (capacity <= map->capacity) || Map_U64_rehash(map, capacity);
+}
+
+static inline u64 *
+Map_U64_find(Map_U64 *map, u64 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_U64_slot(map, key, Map_U64_hash(key));
+    return (index == map->capacity) ? 0 : &map->values[index];
+}
+
+/* inserts or overwrites, returns 0 if the map could not grow */
+static inline b32
+Map_U64_insert(Map_U64 *map, u64 key, u64 value)
+{
+    u64 hash = Map_U64_hash(key);
+    
+    if (map->capacity > 0)
+    {
+        u64 index = Map_U64_slot(map, key, hash);
+        if (index != map->capacity)
+        {
+            map->values[index] = value;
+            return 1;
+        }
+    }
+    
+    /* keep 1/8 of the slots empty so every probe ends */
+    if ((map->count + map->deleted + 1) * 8 > map->capacity * 7)
+    {
+        u64 capacity = (map->capacity > 0) ? map->capacity : HASH_MAP_GROUP_SIZE;
+        if ((map->count + 1) * 16 > capacity * 7)
+        {
+            capacity *= 2;
+        }
+        
+        if (Map_U64_rehash(map, capacity) == 0)
+        {
+            return 0;
+        }
+    }
+    
+    u64 index = Map_U64_free_slot(map, hash);
+    if (map->control[index] == HASH_MAP_DELETED)
+    {
+        --map->deleted;
+    }
+    map->control[index] = (u8)(hash & 0x7F);
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    Map_U64_COUNT_MAX(peak_count, map->count);
+    return 1;
+}
+
+static inline b32
+Map_U64_remove(Map_U64 *map, u64 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_U64_slot(map, key, Map_U64_hash(key));
+    if (index == map->capacity)
+    {
+        return 0;
+    }
+    
+    /* no probe went past a group that still has an empty slot */
+    u8 *group = map->control + (index & ~(u64)(HASH_MAP_GROUP_SIZE - 1));
+    if (GenHashMapMatch(group, HASH_MAP_EMPTY))
+    {
+        map->control[index] = HASH_MAP_EMPTY;
+    }
+    else
+    {
+        map->control[index] = HASH_MAP_DELETED;
+        ++map->deleted;
+    }
+    --map->count;
+    return 1;
+}
+
+static inline void
+Map_U64_clear(Map_U64 *map)
+{
+    if (map->control)
+    {
+        memset(map->control, HASH_MAP_EMPTY, map->capacity);
+    }
+    map->count = 0;
+    map->deleted = 0;
+}
+
+static inline void
+Map_U64_free(Map_U64 *map)
+{
+    Map_U64_release_block(map);
+    map->control = 0;
+    map->keys = 0;
+    map->values = 0;
+    map->capacity = 0;
+    map->count = 0;
+    map->deleted = 0;
+}
+
+/* visits the slot index of every entry */
+#define Map_U64_for_each(map, index) \
+    for (u64 index = 0; index < (map)->capacity; ++index) \
+        if (!((map)->control[index] & 0x80))
+
+typedef struct Map_F32_U32 Map_F32_U32;
+struct Map_F32_U32
+{
+    /* one control byte per slot: empty, deleted or 7 bits of the hash */
+    u8 *control;
+    f32 *keys;
+    u32 *values;
+    /* number of slots, a power of two and at least 16 */
+    u64 capacity;
+    u64 count;
+    u64 deleted;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* with GEN_INSTRUMENT, per-thread counts of what the map did */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Map_F32_U32 in the calling thread */
+typedef struct Map_F32_U32_Counters
+{
+    u64 lookups;
+    u64 groups_probed;
+    u64 key_compares;
+    u64 longest_probe;
+    u64 rehashes;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Map_F32_U32_Counters;
+
+static _Thread_local Map_F32_U32_Counters Map_F32_U32_counters;
+
+#define Map_F32_U32_COUNT(counter, n) (Map_F32_U32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Map_F32_U32_COUNT_MAX(counter, value) \
+    (Map_F32_U32_counters.counter = ((u64)(value) > Map_F32_U32_counters.counter) ? \
+        (u64)(value) : Map_F32_U32_counters.counter)
+
+static inline void
+Map_F32_U32_dump_counters(FILE *file)
+{
+    fprintf(file, "Map_F32_U32:");
+    fprintf(file, " lookups %llu", (unsigned long long)Map_F32_U32_counters.lookups);
+    fprintf(file, " groups_probed %llu", (unsigned long long)Map_F32_U32_counters.groups_probed);
+    fprintf(file, " key_compares %llu", (unsigned long long)Map_F32_U32_counters.key_compares);
+    fprintf(file, " longest_probe %llu", (unsigned long long)Map_F32_U32_counters.longest_probe);
+    fprintf(file, " rehashes %llu", (unsigned long long)Map_F32_U32_counters.rehashes);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Map_F32_U32_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Map_F32_U32_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Map_F32_U32_reset_counters(void)
+{
+    Map_F32_U32_counters = (Map_F32_U32_Counters){0};
+}
+#else
+#define Map_F32_U32_COUNT(counter, n) ((void)0)
+#define Map_F32_U32_COUNT_MAX(counter, value) ((void)0)
+#define Map_F32_U32_dump_counters(file) ((void)0)
+#define Map_F32_U32_reset_counters() ((void)0)
+#endif
+
+/*
+ Open addressing in groups of 16 slots. A lookup compares the 7 hash
+ bits stored in the control bytes of a whole group at once (one SSE2
+ compare) and only looks at the keys that match. Groups are probed
+ triangularly, so every group is visited once.
+ */
+#ifndef GEN_HASH_MAP_GROUP
+#define GEN_HASH_MAP_GROUP
+#define HASH_MAP_GROUP_SIZE 16
+#define HASH_MAP_EMPTY 0x80
+#define HASH_MAP_DELETED 0xFE
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* bit i is set if control[i] == byte */
+static inline u32
+GenHashMapMatch(u8 *control, u8 byte)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((__m128i *)control);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+/* bit i is set if control[i] is empty or deleted, which both have the top bit */
+static inline u32
+GenHashMapMatchFree(u8 *control)
+{
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((__m128i *)control));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32
+GenHashMapFirstBit(u32 mask)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctz(mask);
+#else
+    u32 bit = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+#endif
+
+static inline u64
+Map_F32_U32_hash(f32 key)
+{
+    /* 0 and -0 compare equal, so they have to hash alike */
+    if (key == 0)
+    {
+        key = 0;
+    }
+    u64 x = 0;
+    memcpy(&x, &key, sizeof(key));
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline b32
+Map_F32_U32_equal(f32 a, f32 b)
+{
+    return a == b;
+}
+
+/* slot of key, or capacity if it is not in the map */
+static inline u64
+Map_F32_U32_slot(Map_F32_U32 *map, f32 key, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    u8 tag = (u8)(hash & 0x7F);
+    Map_F32_U32_COUNT(lookups, 1);
+    
+    for (u64 step = 1;; ++step)
+    {
+        u8 *control = map->control + group * HASH_MAP_GROUP_SIZE;
+        Map_F32_U32_COUNT(groups_probed, 1);
+        Map_F32_U32_COUNT_MAX(longest_probe, step);
+        
+        for (u32 match = GenHashMapMatch(control, tag); match; match &= match - 1)
+        {
+            u64 index = group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+            Map_F32_U32_COUNT(key_compares, 1);
+            if (Map_F32_U32_equal(map->keys[index], key))
+            {
+                return index;
+            }
+        }
+        
+        if (GenHashMapMatch(control, HASH_MAP_EMPTY))
+        {
+            return map->capacity;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* first empty or deleted slot on the probe sequence of hash */
+static inline u64
+Map_F32_U32_free_slot(Map_F32_U32 *map, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    
+    for (u64 step = 1;; ++step)
+    {
+        u32 match = GenHashMapMatchFree(map->control + group * HASH_MAP_GROUP_SIZE);
+        if (match)
+        {
+            return group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* control bytes, keys and values share one block */
+static inline u64
+Map_F32_U32_keys_offset(u64 capacity)
+{
+    return (capacity + _Alignof(f32) - 1) & ~(u64)(_Alignof(f32) - 1);
+}
+
+static inline u64
+Map_F32_U32_values_offset(u64 capacity)
+{
+    u64 offset = Map_F32_U32_keys_offset(capacity) + capacity * sizeof(f32);
+    return (offset + _Alignof(u32) - 1) & ~(u64)(_Alignof(u32) - 1);
+}
+
+static inline u64
+Map_F32_U32_block_size(u64 capacity)
+{
+    return Map_F32_U32_values_offset(capacity) + capacity * sizeof(u32);
+}
+
+static inline void
+Map_F32_U32_release_block(Map_F32_U32 *map)
+{
+    if (!map->control)
+    {
+        return;
+    }
+    
+    if (!map->alloc)
+    {
+        free(map->control);
+    }
+    else if (map->release)
+    {
+        map->release(map->context, map->control,
+                     Map_F32_U32_block_size(map->capacity));
+    }
+}
+
+/*
+ Moves every entry into a new block of capacity slots, which also
+ drops the deleted markers. With an arena allocator and no release
+ the old block is simply left behind.
+ */
+static inline b32
+Map_F32_U32_rehash(Map_F32_U32 *map, u64 capacity)
+{
+    u64 size = Map_F32_U32_block_size(capacity);
+    u8 *block = map->alloc ? map->alloc(map->context, size) : malloc(size);
+    if (!block)
+    {
+        return 0;
+    }
+    Map_F32_U32_COUNT(rehashes, 1);
+    Map_F32_U32_COUNT(allocated_bytes, size);
+    
+    Map_F32_U32 grown = *map;
+    grown.control = block;
+    grown.keys = (f32 *)(block + Map_F32_U32_keys_offset(capacity));
+    grown.values = (u32 *)(block + Map_F32_U32_values_offset(capacity));
+    grown.capacity = capacity;
+    grown.deleted = 0;
+    memset(grown.control, HASH_MAP_EMPTY, capacity);
+    
+    for (u64 i = 0; i < map->capacity; ++i)
+    {
+        if (map->control[i] & 0x80)
+        {
+            continue;
+        }
+        
+        u64 index = Map_F32_U32_free_slot(&grown, Map_F32_U32_hash(map->keys[i]));
+        grown.control[index] = map->control[i];
+        grown.keys[index] = map->keys[i];
+        grown.values[index] = map->values[i];
+    }
+    
+    Map_F32_U32_release_block(map);
+    *map = grown;
+    return 1;
+}
+
+/* makes room for count entries without rehashing */
+static inline b32
+Map_F32_U32_reserve(Map_F32_U32 *map, u64 count)
+{
+    u64 capacity = HASH_MAP_GROUP_SIZE;
+    while (count * 8 > capacity * 7)
+    {
+        capacity *= 2;
+    }
+    
+    return (capacity <= map->capacity) || Map_F32_U32_rehash(map, capacity);
+}
+
+static inline u32 *
+Map_F32_U32_find(Map_F32_U32 *map, f32 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_F32_U32_slot(map, key, Map_F32_U32_hash(key));
+    return (index == map->capacity) ? 0 : &map->values[index];
+}
+
+/* inserts or overwrites, returns 0 if the map could not grow */
+static inline b32
+Map_F32_U32_insert(Map_F32_U32 *map, f32 key, u32 value)
+{
+    u64 hash = Map_F32_U32_hash(key);
+    
+    if (map->capacity > 0)
+    {
+        u64 index = Map_F32_U32_slot(map, key, hash);
+        if (index != map->capacity)
+        {
+            map->values[index] = value;
+            return 1;
+        }
+    }
+    
+    /* keep 1/8 of the slots empty so every probe ends */
+    if ((map->count + map->deleted + 1) * 8 > map->capacity * 7)
+    {
+        u64 capacity = (map->capacity > 0) ? map->capacity : HASH_MAP_GROUP_SIZE;
+        if ((map->count + 1) * 16 > capacity * 7)
+        {
+            capacity *= 2;
+        }
+        
+        if (Map_F32_U32_rehash(map, capacity) == 0)
+        {
+            return 0;
+        }
+    }
+    
+    u64 index = Map_F32_U32_free_slot(map, hash);
+    if (map->control[index] == HASH_MAP_DELETED)
+    {
+        --map->deleted;
+    }
+    map->control[index] = (u8)(hash & 0x7F);
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    Map_F32_U32_COUNT_MAX(peak_count, map->count);
+    return 1;
+}
+
+static inline b32
+Map_F32_U32_remove(Map_F32_U32 *map, f32 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_F32_U32_slot(map, key, Map_F32_U32_hash(key));
+    if (index == map->capacity)
+    {
+        return 0;
+    }
+    
+    /* no probe went past a group that still has an empty slot */
+    u8 *group = map->control + (index & ~(u64)(HASH_MAP_GROUP_SIZE - 1));
+    if (GenHashMapMatch(group, HASH_MAP_EMPTY))
+    {
+        map->control[index] = HASH_MAP_EMPTY;
+    }
+    else
+    {
+        map->control[index] = HASH_MAP_DELETED;
+        ++map->deleted;
+    }
+    --map->count;
+    return 1;
+}
+
+static inline void
+Map_F32_U32_clear(Map_F32_U32 *map)
+{
+    if (map->control)
+    {
+        memset(map->control, HASH_MAP_EMPTY, map->capacity);
+    }
+    map->count = 0;
+    map->deleted = 0;
+}
+
+static inline void
+Map_F32_U32_free(Map_F32_U32 *map)
+{
+    Map_F32_U32_release_block(map);
+    map->control = 0;
+    map->keys = 0;
+    map->values = 0;
+    map->capacity = 0;
+    map->count = 0;
+    map->deleted = 0;
+}
+
+/* visits the slot index of every entry */
+#define Map_F32_U32_for_each(map, index) \
+    for (u64 index = 0; index < (map)->capacity; ++index) \
+        if (!((map)->control[index] & 0x80))
+
+typedef struct Grid_Key_s32 Grid_Key_s32;
+struct Grid_Key_s32
+{
+    u8 layer;
+    s32 x, y;
+};
+
+#ifndef GEN_HASH_PRELUDE
+#define GEN_HASH_PRELUDE
+#include <stddef.h>
+#include <string.h>
+
+#ifndef GEN_HASH_SEED
+#define GEN_HASH_SEED 0x9e3779b97f4a7c15ull
+#endif
+
+/* Hash_<type> and Equal_<type> of a type parameter */
+#define GEN_HASH(type) Hash_##type
+#define GEN_EQUAL(type) Equal_##type
+
+/* one multiply per word, the finish step does the rest */
+static inline u64
+GenHashMix(u64 hash, u64 word)
+{
+    hash = (hash ^ word) * 0xbf58476d1ce4e5b9ull;
+    return hash ^ (hash >> 31);
+}
+
+/* size is a constant in every call, so the loop unrolls */
+static inline u64
+GenHashBytes(u8 *data, u64 size, u64 hash)
+{
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        u64 word;
+        memcpy(&word, data, 8);
+        hash = GenHashMix(hash, word);
+    }
+    if (size > 0)
+    {
+        u64 word = 0;
+        memcpy(&word, data, size);
+        hash = GenHashMix(hash, word);
+    }
+    return hash;
+}
+
+static inline u64
+GenHashFinish(u64 hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+#endif
+
+/* Grid_Key_s32 has padding, which is skipped */
+static inline u64
+Hash_Grid_Key_s32(Grid_Key_s32 *value)
+{
+    u8 *memory = (u8 *)value;
+    u64 hash = GEN_HASH_SEED;
+    hash = GenHashBytes(memory + offsetof(Grid_Key_s32, layer), 1, hash);
+    hash = GenHashBytes(memory + offsetof(Grid_Key_s32, x), 8, hash);
+    return GenHashFinish(hash);
+}
+
+static inline b32
+Equal_Grid_Key_s32(Grid_Key_s32 *a, Grid_Key_s32 *b)
+{
+    u8 *memory_a = (u8 *)a;
+    u8 *memory_b = (u8 *)b;
+    if (memcmp(memory_a + offsetof(Grid_Key_s32, layer),
+               memory_b + offsetof(Grid_Key_s32, layer), 1) != 0)
+    {
+        return 0;
+    }
+    if (memcmp(memory_a + offsetof(Grid_Key_s32, x),
+               memory_b + offsetof(Grid_Key_s32, x), 8) != 0)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+typedef struct Map_Grid Map_Grid;
+struct Map_Grid
+{
+    /* one control byte per slot: empty, deleted or 7 bits of the hash */
+    u8 *control;
+    Grid_Key_s32 *keys;
+    u32 *values;
+    /* number of slots, a power of two and at least 16 */
+    u64 capacity;
+    u64 count;
+    u64 deleted;
+    
+    /* optional allocator, malloc and free when alloc is 0 */
+    void *(*alloc)(void *context, u64 size);
+    void (*release)(void *context, void *memory, u64 size);
+    void *context;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* with GEN_INSTRUMENT, per-thread counts of what the map did */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Map_Grid in the calling thread */
+typedef struct Map_Grid_Counters
+{
+    u64 lookups;
+    u64 groups_probed;
+    u64 key_compares;
+    u64 longest_probe;
+    u64 rehashes;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Map_Grid_Counters;
+
+static _Thread_local Map_Grid_Counters Map_Grid_counters;
+
+#define Map_Grid_COUNT(counter, n) (Map_Grid_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Map_Grid_COUNT_MAX(counter, value) \
+    (Map_Grid_counters.counter = ((u64)(value) > Map_Grid_counters.counter) ? \
+        (u64)(value) : Map_Grid_counters.counter)
+
+static inline void
+Map_Grid_dump_counters(FILE *file)
+{
+    fprintf(file, "Map_Grid:");
+    fprintf(file, " lookups %llu", (unsigned long long)Map_Grid_counters.lookups);
+    fprintf(file, " groups_probed %llu", (unsigned long long)Map_Grid_counters.groups_probed);
+    fprintf(file, " key_compares %llu", (unsigned long long)Map_Grid_counters.key_compares);
+    fprintf(file, " longest_probe %llu", (unsigned long long)Map_Grid_counters.longest_probe);
+    fprintf(file, " rehashes %llu", (unsigned long long)Map_Grid_counters.rehashes);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Map_Grid_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Map_Grid_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Map_Grid_reset_counters(void)
+{
+    Map_Grid_counters = (Map_Grid_Counters){0};
+}
+#else
+#define Map_Grid_COUNT(counter, n) ((void)0)
+#define Map_Grid_COUNT_MAX(counter, value) ((void)0)
+#define Map_Grid_dump_counters(file) ((void)0)
+#define Map_Grid_reset_counters() ((void)0)
+#endif
+
+/*
+ Open addressing in groups of 16 slots. A lookup compares the 7 hash
+ bits stored in the control bytes of a whole group at once (one SSE2
+ compare) and only looks at the keys that match. Groups are probed
+ triangularly, so every group is visited once.
+ */
+#ifndef GEN_HASH_MAP_GROUP
+#define GEN_HASH_MAP_GROUP
+#define HASH_MAP_GROUP_SIZE 16
+#define HASH_MAP_EMPTY 0x80
+#define HASH_MAP_DELETED 0xFE
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* bit i is set if control[i] == byte */
+static inline u32
+GenHashMapMatch(u8 *control, u8 byte)
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128((__m128i *)control);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+/* bit i is set if control[i] is empty or deleted, which both have the top bit */
+static inline u32
+GenHashMapMatchFree(u8 *control)
+{
+#if defined(__SSE2__)
+    return (u32)_mm_movemask_epi8(_mm_loadu_si128((__m128i *)control));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HASH_MAP_GROUP_SIZE; ++i)
+    {
+        mask |= (u32)(control[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u32
+GenHashMapFirstBit(u32 mask)
+{
+#if defined(__GNUC__)
+    return (u32)__builtin_ctz(mask);
+#else
+    u32 bit = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+#endif
+
+static inline u64
+Map_Grid_hash(Grid_Key_s32 key)
+{
+    /* generated by @hash in the template of the key */
+    return GEN_HASH(Grid_Key_s32)(&key);
+}
+
+static inline b32
+Map_Grid_equal(Grid_Key_s32 a, Grid_Key_s32 b)
+{
+    return GEN_EQUAL(Grid_Key_s32)(&a, &b);
+}
+
+/* slot of key, or capacity if it is not in the map */
+static inline u64
+Map_Grid_slot(Map_Grid *map, Grid_Key_s32 key, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    u8 tag = (u8)(hash & 0x7F);
+    Map_Grid_COUNT(lookups, 1);
+    
+    for (u64 step = 1;; ++step)
+    {
+        u8 *control = map->control + group * HASH_MAP_GROUP_SIZE;
+        Map_Grid_COUNT(groups_probed, 1);
+        Map_Grid_COUNT_MAX(longest_probe, step);
+        
+        for (u32 match = GenHashMapMatch(control, tag); match; match &= match - 1)
+        {
+            u64 index = group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+            Map_Grid_COUNT(key_compares, 1);
+            if (Map_Grid_equal(map->keys[index], key))
+            {
+                return index;
+            }
+        }
+        
+        if (GenHashMapMatch(control, HASH_MAP_EMPTY))
+        {
+            return map->capacity;
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* first empty or deleted slot on the probe sequence of hash */
+static inline u64
+Map_Grid_free_slot(Map_Grid *map, u64 hash)
+{
+    u64 group_mask = map->capacity / HASH_MAP_GROUP_SIZE - 1;
+    u64 group = (hash / 128) & group_mask;
+    
+    for (u64 step = 1;; ++step)
+    {
+        u32 match = GenHashMapMatchFree(map->control + group * HASH_MAP_GROUP_SIZE);
+        if (match)
+        {
+            return group * HASH_MAP_GROUP_SIZE + GenHashMapFirstBit(match);
+        }
+        group = (group + step) & group_mask;
+    }
+}
+
+/* control bytes, keys and values share one block */
+static inline u64
+Map_Grid_keys_offset(u64 capacity)
+{
+    return (capacity + _Alignof(Grid_Key_s32) - 1) & ~(u64)(_Alignof(Grid_Key_s32) - 1);
+}
+
+static inline u64
+Map_Grid_values_offset(u64 capacity)
+{
+    u64 offset = Map_Grid_keys_offset(capacity) + capacity * sizeof(Grid_Key_s32);
+    return (offset + _Alignof(u32) - 1) & ~(u64)(_Alignof(u32) - 1);
+}
+
+static inline u64
+Map_Grid_block_size(u64 capacity)
+{
+    return Map_Grid_values_offset(capacity) + capacity * sizeof(u32);
+}
+
+static inline void
+Map_Grid_release_block(Map_Grid *map)
+{
+    if (!map->control)
+    {
+        return;
+    }
+    
+    if (!map->alloc)
+    {
+        free(map->control);
+    }
+    else if (map->release)
+    {
+        map->release(map->context, map->control,
+                     Map_Grid_block_size(map->capacity));
+    }
+}
+
+/*
+ Moves every entry into a new block of capacity slots, which also
+ drops the deleted markers. With an arena allocator and no release
+ the old block is simply left behind.
+ */
+static inline b32
+Map_Grid_rehash(Map_Grid *map, u64 capacity)
+{
+    u64 size = Map_Grid_block_size(capacity);
+    u8 *block = map->alloc ? map->alloc(map->context, size) : malloc(size);
+    if (!block)
+    {
+        return 0;
+    }
+    Map_Grid_COUNT(rehashes, 1);
+    Map_Grid_COUNT(allocated_bytes, size);
+    
+    Map_Grid grown = *map;
+    grown.control = block;
+    grown.keys = (Grid_Key_s32 *)(block + Map_Grid_keys_offset(capacity));
+    grown.values = (u32 *)(block + Map_Grid_values_offset(capacity));
+    grown.capacity = capacity;
+    grown.deleted = 0;
+    memset(grown.control, HASH_MAP_EMPTY, capacity);
+    
+    for (u64 i = 0; i < map->capacity; ++i)
+    {
+        if (map->control[i] & 0x80)
+        {
+            continue;
+        }
+        
+        u64 index = Map_Grid_free_slot(&grown, Map_Grid_hash(map->keys[i]));
+        grown.control[index] = map->control[i];
+        grown.keys[index] = map->keys[i];
+        grown.values[index] = map->values[i];
+    }
+    
+    Map_Grid_release_block(map);
+    *map = grown;
+    return 1;
+}
+
+/* makes room for count entries without rehashing */
+static inline b32
+Map_Grid_reserve(Map_Grid *map, u64 count)
+{
+    u64 capacity = HASH_MAP_GROUP_SIZE;
+    while (count * 8 > capacity * 7)
+    {
+        capacity *= 2;
+    }
+    
+    return (capacity <= map->capacity) || Map_Grid_rehash(map, capacity);
+}
+
+static inline u32 *
+Map_Grid_find(Map_Grid *map, Grid_Key_s32 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_Grid_slot(map, key, Map_Grid_hash(key));
+    return (index == map->capacity) ? 0 : &map->values[index];
+}
+
+/* inserts or overwrites, returns 0 if the map could not grow */
+static inline b32
+Map_Grid_insert(Map_Grid *map, Grid_Key_s32 key, u32 value)
+{
+    u64 hash = Map_Grid_hash(key);
+    
+    if (map->capacity > 0)
+    {
+        u64 index = Map_Grid_slot(map, key, hash);
+        if (index != map->capacity)
+        {
+            map->values[index] = value;
+            return 1;
+        }
+    }
+    
+    /* keep 1/8 of the slots empty so every probe ends */
+    if ((map->count + map->deleted + 1) * 8 > map->capacity * 7)
+    {
+        u64 capacity = (map->capacity > 0) ? map->capacity : HASH_MAP_GROUP_SIZE;
+        if ((map->count + 1) * 16 > capacity * 7)
+        {
+            capacity *= 2;
+        }
+        
+        if (Map_Grid_rehash(map, capacity) == 0)
+        {
+            return 0;
+        }
+    }
+    
+    u64 index = Map_Grid_free_slot(map, hash);
+    if (map->control[index] == HASH_MAP_DELETED)
+    {
+        --map->deleted;
+    }
+    map->control[index] = (u8)(hash & 0x7F);
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    Map_Grid_COUNT_MAX(peak_count, map->count);
+    return 1;
+}
+
+static inline b32
+Map_Grid_remove(Map_Grid *map, Grid_Key_s32 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    u64 index = Map_Grid_slot(map, key, Map_Grid_hash(key));
+    if (index == map->capacity)
+    {
+        return 0;
+    }
+    
+    /* no probe went past a group that still has an empty slot */
+    u8 *group = map->control + (index & ~(u64)(HASH_MAP_GROUP_SIZE - 1));
+    if (GenHashMapMatch(group, HASH_MAP_EMPTY))
+    {
+        map->control[index] = HASH_MAP_EMPTY;
+    }
+    else
+    {
+        map->control[index] = HASH_MAP_DELETED;
+        ++map->deleted;
+    }
+    --map->count;
+    return 1;
+}
+
+static inline void
+Map_Grid_clear(Map_Grid *map)
+{
+    if (map->control)
+    {
+        memset(map->control, HASH_MAP_EMPTY, map->capacity);
+    }
+    map->count = 0;
+    map->deleted = 0;
+}
+
+static inline void
+Map_Grid_free(Map_Grid *map)
+{
+    Map_Grid_release_block(map);
+    map->control = 0;
+    map->keys = 0;
+    map->values = 0;
+    map->capacity = 0;
+    map->count = 0;
+    map->deleted = 0;
+}
+
+/* visits the slot index of every entry */
+#define Map_Grid_for_each(map, index) \
+    for (u64 index = 0; index < (map)->capacity; ++index) \
+        if (!((map)->control[index] & 0x80))
+
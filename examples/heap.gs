@@ -0,0 +1,371 @@
+~output_ext .h
+
+@template_start Event <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T time;
+    u32 id;
+};
+@template_end
+
+@template_start Heap <- T, K, KEY, D:4, HANDLES:0
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T *items;
+    u64 count;
+    u64 capacity;
+@if HANDLES > 0
+
+    /* handles[i] belongs to items[i], positions[handle] is its index */
+    u32 *handles;
+    u32 *positions;
+    /* 1 + first unused handle, 0 if there is none */
+    u32 free_handle;
+    u32 handle_num;
+@endif
+};
+@template_end
+
+@template_fn Heap <- T, K, KEY, D:4, HANDLES:0
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Implicit min-heap with D children per node, ordered by a key field
+ of the items (or the items themselves for plain numbers). A wider
+ node makes the heap shallower and puts the children compared
+ together in adjacent memory. Items move into a hole instead of being
+ swapped. With handles enabled push hands out a handle that stays
+ valid while the item moves, for update and remove.
+ */
+#ifndef HEAP_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define HEAP_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* GEN_INSTRUMENT counts; levels_moved is the work of the sifts */
+@instrument pushes, pops, levels_moved, grows, allocated_bytes, peak_count
+
+static inline K
+@template_name_key(T *item)
+{
+@if is_integer(T) || is_float(T) || is_pointer(T)
+    return *item;
+@else
+    return HEAP_FIELD(item, KEY);
+@endif
+}
+
+static inline void
+@template_name_place(@template_name *heap, u64 index, T *item, u32 handle)
+{
+    heap->items[index] = *item;
+@if HANDLES > 0
+    heap->handles[index] = handle;
+    heap->positions[handle] = (u32)index;
+@else
+    (void)handle;
+@endif
+}
+
+static inline void
+@template_name_sift_up(@template_name *heap, u64 index, T item, u32 handle)
+{
+    K key = @template_name_key(&item);
+    
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / D;
+        if (!(key < @template_name_key(&heap->items[parent])))
+        {
+            break;
+        }
+        @template_name_COUNT(levels_moved, 1);
+
+@if HANDLES > 0
+        @template_name_place(heap, index, &heap->items[parent], heap->handles[parent]);
+@else
+        @template_name_place(heap, index, &heap->items[parent], 0);
+@endif
+        index = parent;
+    }
+    
+    @template_name_place(heap, index, &item, handle);
+}
+
+static inline void
+@template_name_sift_down(@template_name *heap, u64 index, T item, u32 handle)
+{
+    K key = @template_name_key(&item);
+    
+    for (;;)
+    {
+        u64 first = D * index + 1;
+        if (first >= heap->count)
+        {
+            break;
+        }
+        
+        u64 last = (first + D < heap->count) ? first + D : heap->count;
+        u64 best = first;
+        K best_key = @template_name_key(&heap->items[first]);
+        
+        for (u64 child = first + 1; child < last; ++child)
+        {
+            K child_key = @template_name_key(&heap->items[child]);
+            if (child_key < best_key)
+            {
+                best = child;
+                best_key = child_key;
+            }
+        }
+        
+        if (!(best_key < key))
+        {
+            break;
+        }
+        @template_name_COUNT(levels_moved, 1);
+
+@if HANDLES > 0
+        @template_name_place(heap, index, &heap->items[best], heap->handles[best]);
+@else
+        @template_name_place(heap, index, &heap->items[best], 0);
+@endif
+        index = best;
+    }
+    
+    @template_name_place(heap, index, &item, handle);
+}
+
+static inline b32
+@template_name_reserve(@template_name *heap, u64 capacity)
+{
+    if (capacity <= heap->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * heap->capacity)
+    {
+        capacity = 2 * heap->capacity;
+    }
+    
+    T *items = realloc(heap->items, capacity * sizeof(T));
+    if (!items)
+    {
+        return 0;
+    }
+    heap->items = items;
+    @template_name_COUNT(grows, 1);
+    @template_name_COUNT(allocated_bytes, capacity * sizeof(T));
+@if HANDLES > 0
+
+    u32 *handles = realloc(heap->handles, capacity * sizeof(u32));
+    if (!handles)
+    {
+        return 0;
+    }
+    heap->handles = handles;
+    
+    u32 *positions = realloc(heap->positions, capacity * sizeof(u32));
+    if (!positions)
+    {
+        return 0;
+    }
+    heap->positions = positions;
+@endif
+
+    heap->capacity = capacity;
+    return 1;
+}
+
+static inline u32
+@template_name_new_handle(@template_name *heap)
+{
+@if HANDLES > 0
+    if (heap->free_handle)
+    {
+        u32 handle = heap->free_handle - 1;
+        heap->free_handle = heap->positions[handle];
+        return handle;
+    }
+    
+    return heap->handle_num++;
+@else
+    (void)heap;
+    return 0;
+@endif
+}
+
+static inline void
+@template_name_free_handle(@template_name *heap, u32 handle)
+{
+@if HANDLES > 0
+    heap->positions[handle] = heap->free_handle;
+    heap->free_handle = handle + 1;
+@else
+    (void)heap;
+    (void)handle;
+@endif
+}
+
+/* adds item and stores its handle, which is only meaningful with handles */
+static inline b32
+@template_name_push_handle(@template_name *heap, T item, u32 *handle)
+{
+    if (@template_name_reserve(heap, heap->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    *handle = @template_name_new_handle(heap);
+    @template_name_sift_up(heap, heap->count++, item, *handle);
+    @template_name_COUNT(pushes, 1);
+    @template_name_COUNT_MAX(peak_count, heap->count);
+    return 1;
+}
+
+static inline b32
+@template_name_push(@template_name *heap, T item)
+{
+    u32 handle;
+    return @template_name_push_handle(heap, item, &handle);
+}
+
+/* the smallest item, or 0 if the heap is empty */
+static inline T *
+@template_name_top(@template_name *heap)
+{
+    return (heap->count > 0) ? &heap->items[0] : 0;
+}
+
+static inline b32
+@template_name_pop(@template_name *heap, T *item)
+{
+    if (heap->count == 0)
+    {
+        return 0;
+    }
+    
+    *item = heap->items[0];
+    --heap->count;
+    @template_name_COUNT(pops, 1);
+
+@if HANDLES > 0
+    @template_name_free_handle(heap, heap->handles[0]);
+    if (heap->count > 0)
+    {
+        @template_name_sift_down(heap, 0, heap->items[heap->count],
+                                 heap->handles[heap->count]);
+    }
+@else
+    if (heap->count > 0)
+    {
+        @template_name_sift_down(heap, 0, heap->items[heap->count], 0);
+    }
+@endif
+    return 1;
+}
+
+/*
+ Replaces the contents with count items and orders them bottom up in
+ linear time. With handles item i gets handle i.
+ */
+static inline b32
+@template_name_heapify(@template_name *heap, T *items, u64 count)
+{
+    if (@template_name_reserve(heap, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(heap->items, items, count * sizeof(T));
+    }
+    heap->count = count;
+@if HANDLES > 0
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        heap->handles[i] = i;
+        heap->positions[i] = i;
+    }
+    heap->handle_num = (u32)count;
+    heap->free_handle = 0;
+@endif
+
+    for (u64 i = (count > 1) ? (count - 2) / D + 1 : 0; i > 0; --i)
+    {
+@if HANDLES > 0
+        @template_name_sift_down(heap, i - 1, heap->items[i - 1], heap->handles[i - 1]);
+@else
+        @template_name_sift_down(heap, i - 1, heap->items[i - 1], 0);
+@endif
+    }
+    
+    return 1;
+}
+@if HANDLES > 0
+
+/* replaces the item of handle, for example with a smaller key */
+static inline void
+@template_name_update(@template_name *heap, u32 handle, T item)
+{
+    u64 index = heap->positions[handle];
+    
+    if (@template_name_key(&item) < @template_name_key(&heap->items[index]))
+    {
+        @template_name_sift_up(heap, index, item, handle);
+    }
+    else
+    {
+        @template_name_sift_down(heap, index, item, handle);
+    }
+}
+
+static inline void
+@template_name_remove(@template_name *heap, u32 handle)
+{
+    u64 index = heap->positions[handle];
+    @template_name_free_handle(heap, handle);
+    
+    if (index == --heap->count)
+    {
+        return;
+    }
+    
+    /* the last item fills the hole and moves whichever way it has to */
+    T last = heap->items[heap->count];
+    u32 last_handle = heap->handles[heap->count];
+    
+    if (@template_name_key(&last) < @template_name_key(&heap->items[index]))
+    {
+        @template_name_sift_up(heap, index, last, last_handle);
+    }
+    else
+    {
+        @template_name_sift_down(heap, index, last, last_handle);
+    }
+}
+@endif
+
+static inline void
+@template_name_free(@template_name *heap)
+{
+    free(heap->items);
+@if HANDLES > 0
+    free(heap->handles);
+    free(heap->positions);
+@endif
+    memset(heap, 0, sizeof(*heap));
+}
+@template_end
+
+@template Event -> f64 -> Event_F64
+
+@template Heap -> Event_F64, f64, time -> Event_Queue
+@template Heap -> Event_F64, f64, time, 2 -> Event_Queue_Binary
+@template Heap -> u64, u64, _, 4, 1 -> Heap_U64_Handles
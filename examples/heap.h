@@ -0,0 +1,892 @@
+typedef struct Event_F64 Event_F64;
+struct Event_F64
+{
+    f64 time;
+    u32 id;
+};
+
+typedef struct Event_Queue Event_Queue;
+struct Event_Queue
+{
+    Event_F64 *items;
+    u64 count;
+    u64 capacity;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Implicit min-heap with 4 children per node, ordered by a key field
+ of the items (or the items themselves for plain numbers). A wider
+ node makes the heap shallower and puts the children compared
+ together in adjacent memory. Items move into a hole instead of being
+ swapped. With handles enabled push hands out a handle that stays
+ valid while the item moves, for update and remove.
+ */
+#ifndef HEAP_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define HEAP_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* GEN_INSTRUMENT counts; levels_moved is the work of the sifts */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Event_Queue in the calling thread */
+typedef struct Event_Queue_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 levels_moved;
+    u64 grows;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Event_Queue_Counters;
+
+static _Thread_local Event_Queue_Counters Event_Queue_counters;
+
+#define Event_Queue_COUNT(counter, n) (Event_Queue_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Event_Queue_COUNT_MAX(counter, value) \
+    (Event_Queue_counters.counter = ((u64)(value) > Event_Queue_counters.counter) ? \
+        (u64)(value) : Event_Queue_counters.counter)
+
+static inline void
+Event_Queue_dump_counters(FILE *file)
+{
+    fprintf(file, "Event_Queue:");
+    fprintf(file, " pushes %llu", (unsigned long long)Event_Queue_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Event_Queue_counters.pops);
+    fprintf(file, " levels_moved %llu", (unsigned long long)Event_Queue_counters.levels_moved);
+    fprintf(file, " grows %llu", (unsigned long long)Event_Queue_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Event_Queue_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Event_Queue_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Event_Queue_reset_counters(void)
+{
+    Event_Queue_counters = (Event_Queue_Counters){0};
+}
+#else
+#define Event_Queue_COUNT(counter, n) ((void)0)
+#define Event_Queue_COUNT_MAX(counter, value) ((void)0)
+#define Event_Queue_dump_counters(file) ((void)0)
+#define Event_Queue_reset_counters() ((void)0)
+#endif
+
+static inline f64
+Event_Queue_key(Event_F64 *item)
+{
+    return HEAP_FIELD(item, time);
+}
+
+static inline void
+Event_Queue_place(Event_Queue *heap, u64 index, Event_F64 *item, u32 handle)
+{
+    heap->items[index] = *item;
+    (void)handle;
+}
+
+static inline void
+Event_Queue_sift_up(Event_Queue *heap, u64 index, Event_F64 item, u32 handle)
+{
+    f64 key = Event_Queue_key(&item);
+    
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / 4;
+        if (!(key < Event_Queue_key(&heap->items[parent])))
+        {
+            break;
+        }
+        Event_Queue_COUNT(levels_moved, 1);
+
+        Event_Queue_place(heap, index, &heap->items[parent], 0);
+        index = parent;
+    }
+    
+    Event_Queue_place(heap, index, &item, handle);
+}
+
+static inline void
+Event_Queue_sift_down(Event_Queue *heap, u64 index, Event_F64 item, u32 handle)
+{
+    f64 key = Event_Queue_key(&item);
+    
+    for (;;)
+    {
+        u64 first = 4 * index + 1;
+        if (first >= heap->count)
+        {
+            break;
+        }
+        
+        u64 last = (first + 4 < heap->count) ? first + 4 : heap->count;
+        u64 best = first;
+        f64 best_key = Event_Queue_key(&heap->items[first]);
+        
+        for (u64 child = first + 1; child < last; ++child)
+        {
+            f64 child_key = Event_Queue_key(&heap->items[child]);
+            if (child_key < best_key)
+            {
+                best = child;
+                best_key = child_key;
+            }
+        }
+        
+        if (!(best_key < key))
+        {
+            break;
+        }
+        Event_Queue_COUNT(levels_moved, 1);
+
+        Event_Queue_place(heap, index, &heap->items[best], 0);
+        index = best;
+    }
+    
+    Event_Queue_place(heap, index, &item, handle);
+}
+
+static inline b32
+Event_Queue_reserve(Event_Queue *heap, u64 capacity)
+{
+    if (capacity <= heap->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * heap->capacity)
+    {
+        capacity = 2 * heap->capacity;
+    }
+    
+    Event_F64 *items = realloc(heap->items, capacity * sizeof(Event_F64));
+    if (!items)
+    {
+        return 0;
+    }
+    heap->items = items;
+    Event_Queue_COUNT(grows, 1);
+    Event_Queue_COUNT(allocated_bytes, capacity * sizeof(Event_F64));
+
+    heap->capacity = capacity;
+    return 1;
+}
+
+static inline u32
+Event_Queue_new_handle(Event_Queue *heap)
+{
+    (void)heap;
+    return 0;
+}
+
+static inline void
+Event_Queue_free_handle(Event_Queue *heap, u32 handle)
+{
+    (void)heap;
+    (void)handle;
+}
+
+/* adds item and stores its handle, which is only meaningful with handles */
+static inline b32
+Event_Queue_push_handle(Event_Queue *heap, Event_F64 item, u32 *handle)
+{
+    if (Event_Queue_reserve(heap, heap->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    *handle = Event_Queue_new_handle(heap);
+    Event_Queue_sift_up(heap, heap->count++, item, *handle);
+    Event_Queue_COUNT(pushes, 1);
+    Event_Queue_COUNT_MAX(peak_count, heap->count);
+    return 1;
+}
+
+static inline b32
+Event_Queue_push(Event_Queue *heap, Event_F64 item)
+{
+    u32 handle;
+    return Event_Queue_push_handle(heap, item, &handle);
+}
+
+/* the smallest item, or 0 if the heap is empty */
+static inline Event_F64 *
+Event_Queue_top(Event_Queue *heap)
+{
+    return (heap->count > 0) ? &heap->items[0] : 0;
+}
+
+static inline b32
+Event_Queue_pop(Event_Queue *heap, Event_F64 *item)
+{
+    if (heap->count == 0)
+    {
+        return 0;
+    }
+    
+    *item = heap->items[0];
+    --heap->count;
+    Event_Queue_COUNT(pops, 1);
+
+    if (heap->count > 0)
+    {
+        Event_Queue_sift_down(heap, 0, heap->items[heap->count], 0);
+    }
+    return 1;
+}
+
+/*
+ Replaces the contents with count items and orders them bottom up in
+ linear time. With handles item i gets handle i.
+ */
+static inline b32
+Event_Queue_heapify(Event_Queue *heap, Event_F64 *items, u64 count)
+{
+    if (Event_Queue_reserve(heap, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(heap->items, items, count * sizeof(Event_F64));
+    }
+    heap->count = count;
+
+    for (u64 i = (count > 1) ? (count - 2) / 4 + 1 : 0; i > 0; --i)
+    {
+        Event_Queue_sift_down(heap, i - 1, heap->items[i - 1], 0);
+    }
+    
+    return 1;
+}
+
+static inline void
+Event_Queue_free(Event_Queue *heap)
+{
+    free(heap->items);
+    memset(heap, 0, sizeof(*heap));
+}
+
+typedef struct Event_Queue_Binary Event_Queue_Binary;
+struct Event_Queue_Binary
+{
+    Event_F64 *items;
+    u64 count;
+    u64 capacity;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Implicit min-heap with 2 children per node, ordered by a key field
+ of the items (or the items themselves for plain numbers). A wider
+ node makes the heap shallower and puts the children compared
+ together in adjacent memory. Items move into a hole instead of being
+ swapped. With handles enabled push hands out a handle that stays
+ valid while the item moves, for update and remove.
+ */
+#ifndef HEAP_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define HEAP_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* GEN_INSTRUMENT counts; levels_moved is the work of the sifts */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Event_Queue_Binary in the calling thread */
+typedef struct Event_Queue_Binary_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 levels_moved;
+    u64 grows;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Event_Queue_Binary_Counters;
+
+static _Thread_local Event_Queue_Binary_Counters Event_Queue_Binary_counters;
+
+#define Event_Queue_Binary_COUNT(counter, n) (Event_Queue_Binary_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Event_Queue_Binary_COUNT_MAX(counter, value) \
+    (Event_Queue_Binary_counters.counter = ((u64)(value) > Event_Queue_Binary_counters.counter) ? \
+        (u64)(value) : Event_Queue_Binary_counters.counter)
+
+static inline void
+Event_Queue_Binary_dump_counters(FILE *file)
+{
+    fprintf(file, "Event_Queue_Binary:");
+    fprintf(file, " pushes %llu", (unsigned long long)Event_Queue_Binary_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Event_Queue_Binary_counters.pops);
+    fprintf(file, " levels_moved %llu", (unsigned long long)Event_Queue_Binary_counters.levels_moved);
+    fprintf(file, " grows %llu", (unsigned long long)Event_Queue_Binary_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Event_Queue_Binary_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Event_Queue_Binary_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Event_Queue_Binary_reset_counters(void)
+{
+    Event_Queue_Binary_counters = (Event_Queue_Binary_Counters){0};
+}
+#else
+#define Event_Queue_Binary_COUNT(counter, n) ((void)0)
+#define Event_Queue_Binary_COUNT_MAX(counter, value) ((void)0)
+#define Event_Queue_Binary_dump_counters(file) ((void)0)
+#define Event_Queue_Binary_reset_counters() ((void)0)
+#endif
+
+static inline f64
+Event_Queue_Binary_key(Event_F64 *item)
+{
+    return HEAP_FIELD(item, time);
+}
+
+static inline void
+Event_Queue_Binary_place(Event_Queue_Binary *heap, u64 index, Event_F64 *item, u32 handle)
+{
+    heap->items[index] = *item;
+    (void)handle;
+}
+
+static inline void
+Event_Queue_Binary_sift_up(Event_Queue_Binary *heap, u64 index, Event_F64 item, u32 handle)
+{
+    f64 key = Event_Queue_Binary_key(&item);
+    
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / 2;
+        if (!(key < Event_Queue_Binary_key(&heap->items[parent])))
+        {
+            break;
+        }
+        Event_Queue_Binary_COUNT(levels_moved, 1);
+
+        Event_Queue_Binary_place(heap, index, &heap->items[parent], 0);
+        index = parent;
+    }
+    
+    Event_Queue_Binary_place(heap, index, &item, handle);
+}
+
+static inline void
+Event_Queue_Binary_sift_down(Event_Queue_Binary *heap, u64 index, Event_F64 item, u32 handle)
+{
+    f64 key = Event_Queue_Binary_key(&item);
+    
+    for (;;)
+    {
+        u64 first = 2 * index + 1;
+        if (first >= heap->count)
+        {
+            break;
+        }
+        
+        u64 last = (first + 2 < heap->count) ? first + 2 : heap->count;
+        u64 best = first;
+        f64 best_key = Event_Queue_Binary_key(&heap->items[first]);
+        
+        for (u64 child = first + 1; child < last; ++child)
+        {
+            f64 child_key = Event_Queue_Binary_key(&heap->items[child]);
+            if (child_key < best_key)
+            {
+                best = child;
+                best_key = child_key;
+            }
+        }
+        
+        if (!(best_key < key))
+        {
+            break;
+        }
+        Event_Queue_Binary_COUNT(levels_moved, 1);
+
+        Event_Queue_Binary_place(heap, index, &heap->items[best], 0);
+        index = best;
+    }
+    
+    Event_Queue_Binary_place(heap, index, &item, handle);
+}
+
+static inline b32
+Event_Queue_Binary_reserve(Event_Queue_Binary *heap, u64 capacity)
+{
+    if (capacity <= heap->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * heap->capacity)
+    {
+        capacity = 2 * heap->capacity;
+    }
+    
+    Event_F64 *items = realloc(heap->items, capacity * sizeof(Event_F64));
+    if (!items)
+    {
+        return 0;
+    }
+    heap->items = items;
+    Event_Queue_Binary_COUNT(grows, 1);
+    Event_Queue_Binary_COUNT(allocated_bytes, capacity * sizeof(Event_F64));
+
+    heap->capacity = capacity;
+    return 1;
+}
+
+static inline u32
+Event_Queue_Binary_new_handle(Event_Queue_Binary *heap)
+{
+    (void)heap;
+    return 0;
+}
+
+static inline void
+Event_Queue_Binary_free_handle(Event_Queue_Binary *heap, u32 handle)
+{
+    (void)heap;
+    (void)handle;
+}
+
+/* adds item and stores its handle, which is only meaningful with handles */
+static inline b32
+Event_Queue_Binary_push_handle(Event_Queue_Binary *heap, Event_F64 item, u32 *handle)
+{
+    if (Event_Queue_Binary_reserve(heap, heap->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    *handle = Event_Queue_Binary_new_handle(heap);
+    Event_Queue_Binary_sift_up(heap, heap->count++, item, *handle);
+    Event_Queue_Binary_COUNT(pushes, 1);
+    Event_Queue_Binary_COUNT_MAX(peak_count, heap->count);
+    return 1;
+}
+
+static inline b32
+Event_Queue_Binary_push(Event_Queue_Binary *heap, Event_F64 item)
+{
+    u32 handle;
+    return Event_Queue_Binary_push_handle(heap, item, &handle);
+}
+
+/* the smallest item, or 0 if the heap is empty */
+static inline Event_F64 *
+Event_Queue_Binary_top(Event_Queue_Binary *heap)
+{
+    return (heap->count > 0) ? &heap->items[0] : 0;
+}
+
+static inline b32
+Event_Queue_Binary_pop(Event_Queue_Binary *heap, Event_F64 *item)
+{
+    if (heap->count == 0)
+    {
+        return 0;
+    }
+    
+    *item = heap->items[0];
+    --heap->count;
+    Event_Queue_Binary_COUNT(pops, 1);
+
+    if (heap->count > 0)
+    {
+        Event_Queue_Binary_sift_down(heap, 0, heap->items[heap->count], 0);
+    }
+    return 1;
+}
+
+/*
+ Replaces the contents with count items and orders them bottom up in
+ linear time. With handles item i gets handle i.
+ */
+static inline b32
+Event_Queue_Binary_heapify(Event_Queue_Binary *heap, Event_F64 *items, u64 count)
+{
+    if (Event_Queue_Binary_reserve(heap, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(heap->items, items, count * sizeof(Event_F64));
+    }
+    heap->count = count;
+
+    for (u64 i = (count > 1) ? (count - 2) / 2 + 1 : 0; i > 0; --i)
+    {
+        Event_Queue_Binary_sift_down(heap, i - 1, heap->items[i - 1], 0);
+    }
+    
+    return 1;
+}
+
+static inline void
+Event_Queue_Binary_free(Event_Queue_Binary *heap)
+{
+    free(heap->items);
+    memset(heap, 0, sizeof(*heap));
+}
+
+typedef struct Heap_U64_Handles Heap_U64_Handles;
+struct Heap_U64_Handles
+{
+    u64 *items;
+    u64 count;
+    u64 capacity;
+
+    /* handles[i] belongs to items[i], positions[handle] is its index */
+    u32 *handles;
+    u32 *positions;
+    /* 1 + first unused handle, 0 if there is none */
+    u32 free_handle;
+    u32 handle_num;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Implicit min-heap with 4 children per node, ordered by a key field
+ of the items (or the items themselves for plain numbers). A wider
+ node makes the heap shallower and puts the children compared
+ together in adjacent memory. Items move into a hole instead of being
+ swapped. With handles enabled push hands out a handle that stays
+ valid while the item moves, for update and remove.
+ */
+#ifndef HEAP_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define HEAP_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* GEN_INSTRUMENT counts; levels_moved is the work of the sifts */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Heap_U64_Handles in the calling thread */
+typedef struct Heap_U64_Handles_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 levels_moved;
+    u64 grows;
+    u64 allocated_bytes;
+    u64 peak_count;
+} Heap_U64_Handles_Counters;
+
+static _Thread_local Heap_U64_Handles_Counters Heap_U64_Handles_counters;
+
+#define Heap_U64_Handles_COUNT(counter, n) (Heap_U64_Handles_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Heap_U64_Handles_COUNT_MAX(counter, value) \
+    (Heap_U64_Handles_counters.counter = ((u64)(value) > Heap_U64_Handles_counters.counter) ? \
+        (u64)(value) : Heap_U64_Handles_counters.counter)
+
+static inline void
+Heap_U64_Handles_dump_counters(FILE *file)
+{
+    fprintf(file, "Heap_U64_Handles:");
+    fprintf(file, " pushes %llu", (unsigned long long)Heap_U64_Handles_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Heap_U64_Handles_counters.pops);
+    fprintf(file, " levels_moved %llu", (unsigned long long)Heap_U64_Handles_counters.levels_moved);
+    fprintf(file, " grows %llu", (unsigned long long)Heap_U64_Handles_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Heap_U64_Handles_counters.allocated_bytes);
+    fprintf(file, " peak_count %llu", (unsigned long long)Heap_U64_Handles_counters.peak_count);
+    fprintf(file, "\n");
+}
+
+static inline void
+Heap_U64_Handles_reset_counters(void)
+{
+    Heap_U64_Handles_counters = (Heap_U64_Handles_Counters){0};
+}
+#else
+#define Heap_U64_Handles_COUNT(counter, n) ((void)0)
+#define Heap_U64_Handles_COUNT_MAX(counter, value) ((void)0)
+#define Heap_U64_Handles_dump_counters(file) ((void)0)
+#define Heap_U64_Handles_reset_counters() ((void)0)
+#endif
+
+static inline u64
+Heap_U64_Handles_key(u64 *item)
+{
+    return *item;
+}
+
+static inline void
+Heap_U64_Handles_place(Heap_U64_Handles *heap, u64 index, u64 *item, u32 handle)
+{
+    heap->items[index] = *item;
+    heap->handles[index] = handle;
+    heap->positions[handle] = (u32)index;
+}
+
+static inline void
+Heap_U64_Handles_sift_up(Heap_U64_Handles *heap, u64 index, u64 item, u32 handle)
+{
+    u64 key = Heap_U64_Handles_key(&item);
+    
+    while (index > 0)
+    {
+        u64 parent = (index - 1) / 4;
+        if (!(key < Heap_U64_Handles_key(&heap->items[parent])))
+        {
+            break;
+        }
+        Heap_U64_Handles_COUNT(levels_moved, 1);
+
+        Heap_U64_Handles_place(heap, index, &heap->items[parent], heap->handles[parent]);
+        index = parent;
+    }
+    
+    Heap_U64_Handles_place(heap, index, &item, handle);
+}
+
+static inline void
+Heap_U64_Handles_sift_down(Heap_U64_Handles *heap, u64 index, u64 item, u32 handle)
+{
+    u64 key = Heap_U64_Handles_key(&item);
+    
+    for (;;)
+    {
+        u64 first = 4 * index + 1;
+        if (first >= heap->count)
+        {
+            break;
+        }
+        
+        u64 last = (first + 4 < heap->count) ? first + 4 : heap->count;
+        u64 best = first;
+        u64 best_key = Heap_U64_Handles_key(&heap->items[first]);
+        
+        for (u64 child = first + 1; child < last; ++child)
+        {
+            u64 child_key = Heap_U64_Handles_key(&heap->items[child]);
+            if (child_key < best_key)
+            {
+                best = child;
+                best_key = child_key;
+            }
+        }
+        
+        if (!(best_key < key))
+        {
+            break;
+        }
+        Heap_U64_Handles_COUNT(levels_moved, 1);
+
+        Heap_U64_Handles_place(heap, index, &heap->items[best], heap->handles[best]);
+        index = best;
+    }
+    
+    Heap_U64_Handles_place(heap, index, &item, handle);
+}
+
+static inline b32
+Heap_U64_Handles_reserve(Heap_U64_Handles *heap, u64 capacity)
+{
+    if (capacity <= heap->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * heap->capacity)
+    {
+        capacity = 2 * heap->capacity;
+    }
+    
+    u64 *items = realloc(heap->items, capacity * sizeof(u64));
+    if (!items)
+    {
+        return 0;
+    }
+    heap->items = items;
+    Heap_U64_Handles_COUNT(grows, 1);
+    Heap_U64_Handles_COUNT(allocated_bytes, capacity * sizeof(u64));
+
+    u32 *handles = realloc(heap->handles, capacity * sizeof(u32));
+    if (!handles)
+    {
+        return 0;
+    }
+    heap->handles = handles;
+    
+    u32 *positions = realloc(heap->positions, capacity * sizeof(u32));
+    if (!positions)
+    {
+        return 0;
+    }
+    heap->positions = positions;
+
+    heap->capacity = capacity;
+    return 1;
+}
+
+static inline u32
+Heap_U64_Handles_new_handle(Heap_U64_Handles *heap)
+{
+    if (heap->free_handle)
+    {
+        u32 handle = heap->free_handle - 1;
+        heap->free_handle = heap->positions[handle];
+        return handle;
+    }
+    
+    return heap->handle_num++;
+}
+
+static inline void
+Heap_U64_Handles_free_handle(Heap_U64_Handles *heap, u32 handle)
+{
+    heap->positions[handle] = heap->free_handle;
+    heap->free_handle = handle + 1;
+}
+
+/* adds item and stores its handle, which is only meaningful with handles */
+static inline b32
+Heap_U64_Handles_push_handle(Heap_U64_Handles *heap, u64 item, u32 *handle)
+{
+    if (Heap_U64_Handles_reserve(heap, heap->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    *handle = Heap_U64_Handles_new_handle(heap);
+    Heap_U64_Handles_sift_up(heap, heap->count++, item, *handle);
+    Heap_U64_Handles_COUNT(pushes, 1);
+    Heap_U64_Handles_COUNT_MAX(peak_count, heap->count);
+    return 1;
+}
+
+static inline b32
+Heap_U64_Handles_push(Heap_U64_Handles *heap, u64 item)
+{
+    u32 handle;
+    return Heap_U64_Handles_push_handle(heap, item, &handle);
+}
+
+/* the smallest item, or 0 if the heap is empty */
+static inline u64 *
+Heap_U64_Handles_top(Heap_U64_Handles *heap)
+{
+    return (heap->count > 0) ? &heap->items[0] : 0;
+}
+
+static inline b32
+Heap_U64_Handles_pop(Heap_U64_Handles *heap, u64 *item)
+{
+    if (heap->count == 0)
+    {
+        return 0;
+    }
+    
+    *item = heap->items[0];
+    --heap->count;
+    Heap_U64_Handles_COUNT(pops, 1);
+
+    Heap_U64_Handles_free_handle(heap, heap->handles[0]);
+    if (heap->count > 0)
+    {
+        Heap_U64_Handles_sift_down(heap, 0, heap->items[heap->count],
+                                 heap->handles[heap->count]);
+    }
+    return 1;
+}
+
+/*
+ Replaces the contents with count items and orders them bottom up in
+ linear time. With handles item i gets handle i.
+ */
+static inline b32
+Heap_U64_Handles_heapify(Heap_U64_Handles *heap, u64 *items, u64 count)
+{
+    if (Heap_U64_Handles_reserve(heap, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(heap->items, items, count * sizeof(u64));
+    }
+    heap->count = count;
+
+    for (u32 i = 0; i < count; ++i)
+    {
+        heap->handles[i] = i;
+        heap->positions[i] = i;
+    }
+    heap->handle_num = (u32)count;
+    heap->free_handle = 0;
+
+    for (u64 i = (count > 1) ? (count - 2) / 4 + 1 : 0; i > 0; --i)
+    {
+        Heap_U64_Handles_sift_down(heap, i - 1, heap->items[i - 1], heap->handles[i - 1]);
+    }
+    
+    return 1;
+}
+
+/* replaces the item of handle, for example with a smaller key */
+static inline void
+Heap_U64_Handles_update(Heap_U64_Handles *heap, u32 handle, u64 item)
+{
+    u64 index = heap->positions[handle];
+    
+    if (Heap_U64_Handles_key(&item) < Heap_U64_Handles_key(&heap->items[index]))
+    {
+        Heap_U64_Handles_sift_up(heap, index, item, handle);
+    }
+    else
+    {
+        Heap_U64_Handles_sift_down(heap, index, item, handle);
+    }
+}
+
+static inline void
+Heap_U64_Handles_remove(Heap_U64_Handles *heap, u32 handle)
+{
+    u64 index = heap->positions[handle];
+    Heap_U64_Handles_free_handle(heap, handle);
+    
+    if (index == --heap->count)
+    {
+        return;
+    }
+    
+    /* the last item fills the hole and moves whichever way it has to */
+    u64 last = heap->items[heap->count];
+    u32 last_handle = heap->handles[heap->count];
+    
+    if (Heap_U64_Handles_key(&last) < Heap_U64_Handles_key(&heap->items[index]))
+    {
+        Heap_U64_Handles_sift_up(heap, index, last, last_handle);
+    }
+    else
+    {
+        Heap_U64_Handles_sift_down(heap, index, last, last_handle);
+    }
+}
+
+static inline void
+Heap_U64_Handles_free(Heap_U64_Handles *heap)
+{
+    free(heap->items);
+    free(heap->handles);
+    free(heap->positions);
+    memset(heap, 0, sizeof(*heap));
+}
+
@@ -0,0 +1,382 @@
+~output_ext .h
+
+@template_start Lru_Node <- K, V
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    K key;
+    V value;
+    /* neighbours in recency order, LRU_NONE at the ends */
+    u32 newer;
+    u32 older;
+};
+@template_end
+
+@template_start Lru_Cache <- K, V
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Lru_Node<K, V> *nodes;
+    /* node + 1 in the low half, low hash bits in the high half, 0 if empty */
+    u64 *index;
+    u64 index_mask;
+    u32 capacity;
+    u32 count;
+    /* most and least recently used node */
+    u32 newest;
+    u32 oldest;
+    /* nodes past count that were never used are handed out in order */
+    u32 free_node;
+    u32 used;
+    
+    u64 hits;
+    u64 misses;
+};
+@template_end
+
+@template_fn Lru_Cache <- K, V
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Least recently used cache with a fixed number of entries. Entries
+ live in one node array allocated by init and are linked in recency
+ order by 32 bit indices. A linear probing index maps keys to nodes;
+ removals shift later entries back instead of leaving markers, so
+ lookups stay short however long the cache runs. get, put and the
+ eviction they cause are O(1) and never allocate.
+ */
+#ifndef LRU_NONE
+#define LRU_NONE 0xFFFFFFFFu
+#endif
+
+/* index traffic with GEN_INSTRUMENT; hits and misses are always counted */
+@instrument lookups, probed_slots, longest_probe, evictions, shifted_entries
+
+static inline u64
+@template_name_hash(K key)
+{
+@if has_hash(K)
+    /* generated by @hash in the template of the key */
+    return GEN_HASH(K)(&key);
+@else
+@if is_integer(K) || is_pointer(K)
+    u64 x = (u64)key;
+@else
+@if is_float(K)
+    /* 0 and -0 compare equal, so they have to hash alike */
+    if (key == 0)
+    {
+        key = 0;
+    }
+    u64 x = 0;
+    memcpy(&x, &key, sizeof(key));
+@else
+    /* struct keys without @hash are hashed as bytes and must not contain padding */
+    u64 x = 0xcbf29ce484222325ull;
+    u8 *bytes = (u8 *)&key;
+    for (u64 i = 0; i < sizeof(key); ++i)
+    {
+        x = (x ^ bytes[i]) * 0x100000001b3ull;
+    }
+@endif
+@endif
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+@endif
+}
+
+static inline b32
+@template_name_equal(K a, K b)
+{
+@if has_hash(K)
+    return GEN_EQUAL(K)(&a, &b);
+@else
+@if is_integer(K) || is_pointer(K) || is_float(K)
+    return a == b;
+@else
+    return memcmp(&a, &b, sizeof(a)) == 0;
+@endif
+@endif
+}
+
+/*
+ Allocates room for capacity entries and an index at most a quarter
+ full; probes then rarely go past the first slot, which matters more
+ than the memory for misses. Returns 0 if capacity is 0 or too large,
+ or allocation fails.
+ */
+static inline b32
+@template_name_init(@template_name *cache, u32 capacity)
+{
+    memset(cache, 0, sizeof(*cache));
+    if (capacity == 0 || capacity > 0x3FFFFFFFu)
+    {
+        return 0;
+    }
+    
+    u64 index_size = 16;
+    while (index_size < 4 * (u64)capacity)
+    {
+        index_size *= 2;
+    }
+    
+    cache->nodes = malloc(capacity * sizeof(*cache->nodes));
+    cache->index = calloc(index_size, sizeof(u64));
+    if (!cache->nodes || !cache->index)
+    {
+        free(cache->nodes);
+        free(cache->index);
+        memset(cache, 0, sizeof(*cache));
+        return 0;
+    }
+    
+    cache->index_mask = index_size - 1;
+    cache->capacity = capacity;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    return 1;
+}
+
+/* index slot of key, or the empty slot where it would go */
+static inline u64
+@template_name_slot(@template_name *cache, K key, u64 hash)
+{
+    u64 tag = hash << 32;
+    @template_name_COUNT(lookups, 1);
+    
+    for (u64 slot = hash & cache->index_mask;; slot = (slot + 1) & cache->index_mask)
+    {
+        u64 entry = cache->index[slot];
+        @template_name_COUNT(probed_slots, 1);
+        if (entry == 0 ||
+            ((entry & 0xFFFFFFFF00000000ull) == tag &&
+             @template_name_equal(cache->nodes[(u32)entry - 1].key, key)))
+        {
+            @template_name_COUNT_MAX(longest_probe, ((slot - hash) & cache->index_mask) + 1);
+            return slot;
+        }
+    }
+}
+
+/* empties slot and moves back entries whose probe ran past it */
+static inline void
+@template_name_clear_slot(@template_name *cache, u64 slot)
+{
+    u64 mask = cache->index_mask;
+    
+    for (u64 next = (slot + 1) & mask;; next = (next + 1) & mask)
+    {
+        u64 entry = cache->index[next];
+        if (entry == 0)
+        {
+            break;
+        }
+        
+        u64 home = (entry >> 32) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            cache->index[slot] = entry;
+            slot = next;
+            @template_name_COUNT(shifted_entries, 1);
+        }
+    }
+    
+    cache->index[slot] = 0;
+}
+
+static inline void
+@template_name_unlink(@template_name *cache, u32 node)
+{
+    Lru_Node<K, V> *n = &cache->nodes[node];
+    
+    if (n->newer != LRU_NONE)
+    {
+        cache->nodes[n->newer].older = n->older;
+    }
+    else
+    {
+        cache->newest = n->older;
+    }
+    
+    if (n->older != LRU_NONE)
+    {
+        cache->nodes[n->older].newer = n->newer;
+    }
+    else
+    {
+        cache->oldest = n->newer;
+    }
+}
+
+static inline void
+@template_name_link_newest(@template_name *cache, u32 node)
+{
+    Lru_Node<K, V> *n = &cache->nodes[node];
+    
+    n->newer = LRU_NONE;
+    n->older = cache->newest;
+    if (cache->newest != LRU_NONE)
+    {
+        cache->nodes[cache->newest].newer = node;
+    }
+    else
+    {
+        cache->oldest = node;
+    }
+    cache->newest = node;
+}
+
+/* the value of key without changing its recency or the statistics, or 0 */
+static inline V *
+@template_name_peek(@template_name *cache, K key)
+{
+    u64 entry = cache->index[@template_name_slot(cache, key, @template_name_hash(key))];
+    
+    return entry ? &cache->nodes[(u32)entry - 1].value : 0;
+}
+
+/* the value of key, which becomes the most recently used, or 0 */
+static inline V *
+@template_name_get(@template_name *cache, K key)
+{
+    u64 entry = cache->index[@template_name_slot(cache, key, @template_name_hash(key))];
+    if (entry == 0)
+    {
+        ++cache->misses;
+        return 0;
+    }
+    
+    ++cache->hits;
+    u32 node = (u32)entry - 1;
+    if (node != cache->newest)
+    {
+        @template_name_unlink(cache, node);
+        @template_name_link_newest(cache, node);
+    }
+    return &cache->nodes[node].value;
+}
+
+/*
+ Inserts or overwrites key as the most recently used entry. A full
+ cache first drops its least recently used entry, which is copied to
+ evicted_key and evicted_value when they are not 0. Returns 1 if an
+ entry was evicted.
+ */
+static inline b32
+@template_name_put(@template_name *cache, K key, V value,
+                   K *evicted_key, V *evicted_value)
+{
+    u64 hash = @template_name_hash(key);
+    u64 slot = @template_name_slot(cache, key, hash);
+    
+    if (cache->index[slot])
+    {
+        u32 node = (u32)cache->index[slot] - 1;
+        cache->nodes[node].value = value;
+        if (node != cache->newest)
+        {
+            @template_name_unlink(cache, node);
+            @template_name_link_newest(cache, node);
+        }
+        return 0;
+    }
+    
+    b32 evicted = 0;
+    u32 node;
+    
+    if (cache->count == cache->capacity)
+    {
+        node = cache->oldest;
+        Lru_Node<K, V> *old = &cache->nodes[node];
+        if (evicted_key)
+        {
+            *evicted_key = old->key;
+        }
+        if (evicted_value)
+        {
+            *evicted_value = old->value;
+        }
+        
+        @template_name_clear_slot(cache, @template_name_slot(cache, old->key,
+                                                             @template_name_hash(old->key)));
+        @template_name_unlink(cache, node);
+        --cache->count;
+        evicted = 1;
+        @template_name_COUNT(evictions, 1);
+        
+        /* the shift may have moved the empty slot for key */
+        slot = @template_name_slot(cache, key, hash);
+    }
+    else if (cache->free_node != LRU_NONE)
+    {
+        node = cache->free_node;
+        cache->free_node = cache->nodes[node].older;
+    }
+    else
+    {
+        node = cache->used++;
+    }
+    
+    cache->nodes[node].key = key;
+    cache->nodes[node].value = value;
+    cache->index[slot] = ((hash << 32) | (node + 1));
+    @template_name_link_newest(cache, node);
+    ++cache->count;
+    return evicted;
+}
+
+static inline b32
+@template_name_remove(@template_name *cache, K key)
+{
+    u64 slot = @template_name_slot(cache, key, @template_name_hash(key));
+    if (cache->index[slot] == 0)
+    {
+        return 0;
+    }
+    
+    u32 node = (u32)cache->index[slot] - 1;
+    @template_name_clear_slot(cache, slot);
+    @template_name_unlink(cache, node);
+    
+    cache->nodes[node].older = cache->free_node;
+    cache->free_node = node;
+    --cache->count;
+    return 1;
+}
+
+/* drops every entry and resets the statistics, keeping the memory */
+static inline void
+@template_name_clear(@template_name *cache)
+{
+    memset(cache->index, 0, (cache->index_mask + 1) * sizeof(u64));
+    cache->count = 0;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    cache->used = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+static inline void
+@template_name_free(@template_name *cache)
+{
+    free(cache->nodes);
+    free(cache->index);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/* visits entries from the most to the least recently used */
+#define @template_name_for_each(node, cache) \
+    for (Lru_Node<K, V> *node = ((cache)->newest != LRU_NONE) ? &(cache)->nodes[(cache)->newest] : 0; \
+         node; node = (node->older != LRU_NONE) ? &(cache)->nodes[node->older] : 0)
+@template_end
+
+@template Lru_Cache -> u64, u64 -> Lru_U64
+@template Lru_Cache -> u32, f64 -> Lru_U32_F64
@@ -0,0 +1,764 @@
+typedef struct Lru_Node_u64_u64 Lru_Node_u64_u64;
+struct Lru_Node_u64_u64
+{
+    u64 key;
+    u64 value;
+    /* neighbours in recency order, LRU_NONE at the ends */
+    u32 newer;
+    u32 older;
+};
+
+typedef struct Lru_U64 Lru_U64;
+struct Lru_U64
+{
+    Lru_Node_u64_u64 *nodes;
+    /* node + 1 in the low half, low hash bits in the high half, 0 if empty */
+    u64 *index;
+    u64 index_mask;
+    u32 capacity;
+    u32 count;
+    /* most and least recently used node */
+    u32 newest;
+    u32 oldest;
+    /* nodes past count that were never used are handed out in order */
+    u32 free_node;
+    u32 used;
+    
+    u64 hits;
+    u64 misses;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Least recently used cache with a fixed number of entries. Entries
+ live in one node array allocated by init and are linked in recency
+ order by 32 bit indices. A linear probing index maps keys to nodes;
+ removals shift later entries back instead of leaving markers, so
+ lookups stay short however long the cache runs. get, put and the
+ eviction they cause are O(1) and never allocate.
+ */
+#ifndef LRU_NONE
+#define LRU_NONE 0xFFFFFFFFu
+#endif
+
+/* index traffic with GEN_INSTRUMENT; hits and misses are always counted */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Lru_U64 in the calling thread */
+typedef struct Lru_U64_Counters
+{
+    u64 lookups;
+    u64 probed_slots;
+    u64 longest_probe;
+    u64 evictions;
+    u64 shifted_entries;
+} Lru_U64_Counters;
+
+static _Thread_local Lru_U64_Counters Lru_U64_counters;
+
+#define Lru_U64_COUNT(counter, n) (Lru_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Lru_U64_COUNT_MAX(counter, value) \
+    (Lru_U64_counters.counter = ((u64)(value) > Lru_U64_counters.counter) ? \
+        (u64)(value) : Lru_U64_counters.counter)
+
+static inline void
+Lru_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "Lru_U64:");
+    fprintf(file, " lookups %llu", (unsigned long long)Lru_U64_counters.lookups);
+    fprintf(file, " probed_slots %llu", (unsigned long long)Lru_U64_counters.probed_slots);
+    fprintf(file, " longest_probe %llu", (unsigned long long)Lru_U64_counters.longest_probe);
+    fprintf(file, " evictions %llu", (unsigned long long)Lru_U64_counters.evictions);
+    fprintf(file, " shifted_entries %llu", (unsigned long long)Lru_U64_counters.shifted_entries);
+    fprintf(file, "\n");
+}
+
+static inline void
+Lru_U64_reset_counters(void)
+{
+    Lru_U64_counters = (Lru_U64_Counters){0};
+}
+#else
+#define Lru_U64_COUNT(counter, n) ((void)0)
+#define Lru_U64_COUNT_MAX(counter, value) ((void)0)
+#define Lru_U64_dump_counters(file) ((void)0)
+#define Lru_U64_reset_counters() ((void)0)
+#endif
+
+static inline u64
+Lru_U64_hash(u64 key)
+{
+    u64 x = (u64)key;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline b32
+Lru_U64_equal(u64 a, u64 b)
+{
+    return a == b;
+}
+
+/*
+ Allocates room for capacity entries and an index at most a quarter
+ full; probes then rarely go past the first slot, which matters more
+ than the memory for misses. Returns 0 if capacity is 0 or too large,
+ or allocation fails.
+ */
+static inline b32
+Lru_U64_init(Lru_U64 *cache, u32 capacity)
+{
+    memset(cache, 0, sizeof(*cache));
+    if (capacity == 0 || capacity > 0x3FFFFFFFu)
+    {
+        return 0;
+    }
+    
+    u64 index_size = 16;
+    while (index_size < 4 * (u64)capacity)
+    {
+        index_size *= 2;
+    }
+    
+    cache->nodes = malloc(capacity * sizeof(*cache->nodes));
+    cache->index = calloc(index_size, sizeof(u64));
+    if (!cache->nodes || !cache->index)
+    {
+        free(cache->nodes);
+        free(cache->index);
+        memset(cache, 0, sizeof(*cache));
+        return 0;
+    }
+    
+    cache->index_mask = index_size - 1;
+    cache->capacity = capacity;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    return 1;
+}
+
+/* index slot of key, or the empty slot where it would go */
+static inline u64
+Lru_U64_slot(Lru_U64 *cache, u64 key, u64 hash)
+{
+    u64 tag = hash << 32;
+    Lru_U64_COUNT(lookups, 1);
+    
+    for (u64 slot = hash & cache->index_mask;; slot = (slot + 1) & cache->index_mask)
+    {
+        u64 entry = cache->index[slot];
+        Lru_U64_COUNT(probed_slots, 1);
+        if (entry == 0 ||
+            ((entry & 0xFFFFFFFF00000000ull) == tag &&
+             Lru_U64_equal(cache->nodes[(u32)entry - 1].key, key)))
+        {
+            Lru_U64_COUNT_MAX(longest_probe, ((slot - hash) & cache->index_mask) + 1);
+            return slot;
+        }
+    }
+}
+
+/* empties slot and moves back entries whose probe ran past it */
+static inline void
+Lru_U64_clear_slot(Lru_U64 *cache, u64 slot)
+{
+    u64 mask = cache->index_mask;
+    
+    for (u64 next = (slot + 1) & mask;; next = (next + 1) & mask)
+    {
+        u64 entry = cache->index[next];
+        if (entry == 0)
+        {
+            break;
+        }
+        
+        u64 home = (entry >> 32) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            cache->index[slot] = entry;
+            slot = next;
+            Lru_U64_COUNT(shifted_entries, 1);
+        }
+    }
+    
+    cache->index[slot] = 0;
+}
+
+static inline void
+Lru_U64_unlink(Lru_U64 *cache, u32 node)
+{
+    Lru_Node_u64_u64 *n = &cache->nodes[node];
+    
+    if (n->newer != LRU_NONE)
+    {
+        cache->nodes[n->newer].older = n->older;
+    }
+    else
+    {
+        cache->newest = n->older;
+    }
+    
+    if (n->older != LRU_NONE)
+    {
+        cache->nodes[n->older].newer = n->newer;
+    }
+    else
+    {
+        cache->oldest = n->newer;
+    }
+}
+
+static inline void
+Lru_U64_link_newest(Lru_U64 *cache, u32 node)
+{
+    Lru_Node_u64_u64 *n = &cache->nodes[node];
+    
+    n->newer = LRU_NONE;
+    n->older = cache->newest;
+    if (cache->newest != LRU_NONE)
+    {
+        cache->nodes[cache->newest].newer = node;
+    }
+    else
+    {
+        cache->oldest = node;
+    }
+    cache->newest = node;
+}
+
+/* the value of key without changing its recency or the statistics, or 0 */
+static inline u64 *
+Lru_U64_peek(Lru_U64 *cache, u64 key)
+{
+    u64 entry = cache->index[Lru_U64_slot(cache, key, Lru_U64_hash(key))];
+    
+    return entry ? &cache->nodes[(u32)entry - 1].value : 0;
+}
+
+/* the value of key, which becomes the most recently used, or 0 */
+static inline u64 *
+Lru_U64_get(Lru_U64 *cache, u64 key)
+{
+    u64 entry = cache->index[Lru_U64_slot(cache, key, Lru_U64_hash(key))];
+    if (entry == 0)
+    {
+        ++cache->misses;
+        return 0;
+    }
+    
+    ++cache->hits;
+    u32 node = (u32)entry - 1;
+    if (node != cache->newest)
+    {
+        Lru_U64_unlink(cache, node);
+        Lru_U64_link_newest(cache, node);
+    }
+    return &cache->nodes[node].value;
+}
+
+/*
+ Inserts or overwrites key as the most recently used entry. A full
+ cache first drops its least recently used entry, which is copied to
+ evicted_key and evicted_value when they are not 0. Returns 1 if an
+ entry was evicted.
+ */
+static inline b32
+Lru_U64_put(Lru_U64 *cache, u64 key, u64 value,
+                   u64 *evicted_key, u64 *evicted_value)
+{
+    u64 hash = Lru_U64_hash(key);
+    u64 slot = Lru_U64_slot(cache, key, hash);
+    
+    if (cache->index[slot])
+    {
+        u32 node = (u32)cache->index[slot] - 1;
+        cache->nodes[node].value = value;
+        if (node != cache->newest)
+        {
+            Lru_U64_unlink(cache, node);
+            Lru_U64_link_newest(cache, node);
+        }
+        return 0;
+    }
+    
+    b32 evicted = 0;
+    u32 node;
+    
+    if (cache->count == cache->capacity)
+    {
+        node = cache->oldest;
+        Lru_Node_u64_u64 *old = &cache->nodes[node];
+        if (evicted_key)
+        {
+            *evicted_key = old->key;
+        }
+        if (evicted_value)
+        {
+            *evicted_value = old->value;
+        }
+        
+        Lru_U64_clear_slot(cache, Lru_U64_slot(cache, old->key,
+                                                             Lru_U64_hash(old->key)));
+        Lru_U64_unlink(cache, node);
+        --cache->count;
+        evicted = 1;
+        Lru_U64_COUNT(evictions, 1);
+        
+        /* the shift may have moved the empty slot for key */
+        slot = Lru_U64_slot(cache, key, hash);
+    }
+    else if (cache->free_node != LRU_NONE)
+    {
+        node = cache->free_node;
+        cache->free_node = cache->nodes[node].older;
+    }
+    else
+    {
+        node = cache->used++;
+    }
+    
+    cache->nodes[node].key = key;
+    cache->nodes[node].value = value;
+    cache->index[slot] = ((hash << 32) | (node + 1));
+    Lru_U64_link_newest(cache, node);
+    ++cache->count;
+    return evicted;
+}
+
+static inline b32
+Lru_U64_remove(Lru_U64 *cache, u64 key)
+{
+    u64 slot = Lru_U64_slot(cache, key, Lru_U64_hash(key));
+    if (cache->index[slot] == 0)
+    {
+        return 0;
+    }
+    
+    u32 node = (u32)cache->index[slot] - 1;
+    Lru_U64_clear_slot(cache, slot);
+    Lru_U64_unlink(cache, node);
+    
+    cache->nodes[node].older = cache->free_node;
+    cache->free_node = node;
+    --cache->count;
+    return 1;
+}
+
+/* drops every entry and resets the statistics, keeping the memory */
+static inline void
+Lru_U64_clear(Lru_U64 *cache)
+{
+    memset(cache->index, 0, (cache->index_mask + 1) * sizeof(u64));
+    cache->count = 0;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    cache->used = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+static inline void
+Lru_U64_free(Lru_U64 *cache)
+{
+    free(cache->nodes);
+    free(cache->index);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/* visits entries from the most to the least recently used */
+#define Lru_U64_for_each(node, cache) \
+    for (Lru_Node_u64_u64 *node = ((cache)->newest != LRU_NONE) ? &(cache)->nodes[(cache)->newest] : 0; \
+         node; node = (node->older != LRU_NONE) ? &(cache)->nodes[node->older] : 0)
+
+typedef struct Lru_Node_u32_f64 Lru_Node_u32_f64;
+struct Lru_Node_u32_f64
+{
+    u32 key;
+    f64 value;
+    /* neighbours in recency order, LRU_NONE at the ends */
+    u32 newer;
+    u32 older;
+};
+
+typedef struct Lru_U32_F64 Lru_U32_F64;
+struct Lru_U32_F64
+{
+    Lru_Node_u32_f64 *nodes;
+    /* node + 1 in the low half, low hash bits in the high half, 0 if empty */
+    u64 *index;
+    u64 index_mask;
+    u32 capacity;
+    u32 count;
+    /* most and least recently used node */
+    u32 newest;
+    u32 oldest;
+    /* nodes past count that were never used are handed out in order */
+    u32 free_node;
+    u32 used;
+    
+    u64 hits;
+    u64 misses;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ Least recently used cache with a fixed number of entries. Entries
+ live in one node array allocated by init and are linked in recency
+ order by 32 bit indices. A linear probing index maps keys to nodes;
+ removals shift later entries back instead of leaving markers, so
+ lookups stay short however long the cache runs. get, put and the
+ eviction they cause are O(1) and never allocate.
+ */
+#ifndef LRU_NONE
+#define LRU_NONE 0xFFFFFFFFu
+#endif
+
+/* index traffic with GEN_INSTRUMENT; hits and misses are always counted */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Lru_U32_F64 in the calling thread */
+typedef struct Lru_U32_F64_Counters
+{
+    u64 lookups;
+    u64 probed_slots;
+    u64 longest_probe;
+    u64 evictions;
+    u64 shifted_entries;
+} Lru_U32_F64_Counters;
+
+static _Thread_local Lru_U32_F64_Counters Lru_U32_F64_counters;
+
+#define Lru_U32_F64_COUNT(counter, n) (Lru_U32_F64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Lru_U32_F64_COUNT_MAX(counter, value) \
+    (Lru_U32_F64_counters.counter = ((u64)(value) > Lru_U32_F64_counters.counter) ? \
+        (u64)(value) : Lru_U32_F64_counters.counter)
+
+static inline void
+Lru_U32_F64_dump_counters(FILE *file)
+{
+    fprintf(file, "Lru_U32_F64:");
+    fprintf(file, " lookups %llu", (unsigned long long)Lru_U32_F64_counters.lookups);
+    fprintf(file, " probed_slots %llu", (unsigned long long)Lru_U32_F64_counters.probed_slots);
+    fprintf(file, " longest_probe %llu", (unsigned long long)Lru_U32_F64_counters.longest_probe);
+    fprintf(file, " evictions %llu", (unsigned long long)Lru_U32_F64_counters.evictions);
+    fprintf(file, " shifted_entries %llu", (unsigned long long)Lru_U32_F64_counters.shifted_entries);
+    fprintf(file, "\n");
+}
+
+static inline void
+Lru_U32_F64_reset_counters(void)
+{
+    Lru_U32_F64_counters = (Lru_U32_F64_Counters){0};
+}
+#else
+#define Lru_U32_F64_COUNT(counter, n) ((void)0)
+#define Lru_U32_F64_COUNT_MAX(counter, value) ((void)0)
+#define Lru_U32_F64_dump_counters(file) ((void)0)
+#define Lru_U32_F64_reset_counters() ((void)0)
+#endif
+
+static inline u64
+Lru_U32_F64_hash(u32 key)
+{
+    u64 x = (u64)key;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline b32
+Lru_U32_F64_equal(u32 a, u32 b)
+{
+    return a == b;
+}
+
+/*
+ Allocates room for capacity entries and an index at most a quarter
+ full; probes then rarely go past the first slot, which matters more
+ than the memory for misses. Returns 0 if capacity is 0 or too large,
+ or allocation fails.
+ */
+static inline b32
+Lru_U32_F64_init(Lru_U32_F64 *cache, u32 capacity)
+{
+    memset(cache, 0, sizeof(*cache));
+    if (capacity == 0 || capacity > 0x3FFFFFFFu)
+    {
+        return 0;
+    }
+    
+    u64 index_size = 16;
+    while (index_size < 4 * (u64)capacity)
+    {
+        index_size *= 2;
+    }
+    
+    cache->nodes = malloc(capacity * sizeof(*cache->nodes));
+    cache->index = calloc(index_size, sizeof(u64));
+    if (!cache->nodes || !cache->index)
+    {
+        free(cache->nodes);
+        free(cache->index);
+        memset(cache, 0, sizeof(*cache));
+        return 0;
+    }
+    
+    cache->index_mask = index_size - 1;
+    cache->capacity = capacity;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    return 1;
+}
+
+/* index slot of key, or the empty slot where it would go */
+static inline u64
+Lru_U32_F64_slot(Lru_U32_F64 *cache, u32 key, u64 hash)
+{
+    u64 tag = hash << 32;
+    Lru_U32_F64_COUNT(lookups, 1);
+    
+    for (u64 slot = hash & cache->index_mask;; slot = (slot + 1) & cache->index_mask)
+    {
+        u64 entry = cache->index[slot];
+        Lru_U32_F64_COUNT(probed_slots, 1);
+        if (entry == 0 ||
+            ((entry & 0xFFFFFFFF00000000ull) == tag &&
+             Lru_U32_F64_equal(cache->nodes[(u32)entry - 1].key, key)))
+        {
+            Lru_U32_F64_COUNT_MAX(longest_probe, ((slot - hash) & cache->index_mask) + 1);
+            return slot;
+        }
+    }
+}
+
+/* empties slot and moves back entries whose probe ran past it */
+static inline void
+Lru_U32_F64_clear_slot(Lru_U32_F64 *cache, u64 slot)
+{
+    u64 mask = cache->index_mask;
+    
+    for (u64 next = (slot + 1) & mask;; next = (next + 1) & mask)
+    {
+        u64 entry = cache->index[next];
+        if (entry == 0)
+        {
+            break;
+        }
+        
+        u64 home = (entry >> 32) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            cache->index[slot] = entry;
+            slot = next;
+            Lru_U32_F64_COUNT(shifted_entries, 1);
+        }
+    }
+    
+    cache->index[slot] = 0;
+}
+
+static inline void
+Lru_U32_F64_unlink(Lru_U32_F64 *cache, u32 node)
+{
+    Lru_Node_u32_f64 *n = &cache->nodes[node];
+    
+    if (n->newer != LRU_NONE)
+    {
+        cache->nodes[n->newer].older = n->older;
+    }
+    else
+    {
+        cache->newest = n->older;
+    }
+    
+    if (n->older != LRU_NONE)
+    {
+        cache->nodes[n->older].newer = n->newer;
+    }
+    else
+    {
+        cache->oldest = n->newer;
+    }
+}
+
+static inline void
+Lru_U32_F64_link_newest(Lru_U32_F64 *cache, u32 node)
+{
+    Lru_Node_u32_f64 *n = &cache->nodes[node];
+    
+    n->newer = LRU_NONE;
+    n->older = cache->newest;
+    if (cache->newest != LRU_NONE)
+    {
+        cache->nodes[cache->newest].newer = node;
+    }
+    else
+    {
+        cache->oldest = node;
+    }
+    cache->newest = node;
+}
+
+/* the value of key without changing its recency or the statistics, or 0 */
+static inline f64 *
+Lru_U32_F64_peek(Lru_U32_F64 *cache, u32 key)
+{
+    u64 entry = cache->index[Lru_U32_F64_slot(cache, key, Lru_U32_F64_hash(key))];
+    
+    return entry ? &cache->nodes[(u32)entry - 1].value : 0;
+}
+
+/* the value of key, which becomes the most recently used, or 0 */
+static inline f64 *
+Lru_U32_F64_get(Lru_U32_F64 *cache, u32 key)
+{
+    u64 entry = cache->index[Lru_U32_F64_slot(cache, key, Lru_U32_F64_hash(key))];
+    if (entry == 0)
+    {
+        ++cache->misses;
+        return 0;
+    }
+    
+    ++cache->hits;
+    u32 node = (u32)entry - 1;
+    if (node != cache->newest)
+    {
+        Lru_U32_F64_unlink(cache, node);
+        Lru_U32_F64_link_newest(cache, node);
+    }
+    return &cache->nodes[node].value;
+}
+
+/*
+ Inserts or overwrites key as the most recently used entry. A full
+ cache first drops its least recently used entry, which is copied to
+ evicted_key and evicted_value when they are not 0. Returns 1 if an
+ entry was evicted.
+ */
+static inline b32
+Lru_U32_F64_put(Lru_U32_F64 *cache, u32 key, f64 value,
+                   u32 *evicted_key, f64 *evicted_value)
+{
+    u64 hash = Lru_U32_F64_hash(key);
+    u64 slot = Lru_U32_F64_slot(cache, key, hash);
+    
+    if (cache->index[slot])
+    {
+        u32 node = (u32)cache->index[slot] - 1;
+        cache->nodes[node].value = value;
+        if (node != cache->newest)
+        {
+            Lru_U32_F64_unlink(cache, node);
+            Lru_U32_F64_link_newest(cache, node);
+        }
+        return 0;
+    }
+    
+    b32 evicted = 0;
+    u32 node;
+    
+    if (cache->count == cache->capacity)
+    {
+        node = cache->oldest;
+        Lru_Node_u32_f64 *old = &cache->nodes[node];
+        if (evicted_key)
+        {
+            *evicted_key = old->key;
+        }
+        if (evicted_value)
+        {
+            *evicted_value = old->value;
+        }
+        
+        Lru_U32_F64_clear_slot(cache, Lru_U32_F64_slot(cache, old->key,
+                                                             Lru_U32_F64_hash(old->key)));
+        Lru_U32_F64_unlink(cache, node);
+        --cache->count;
+        evicted = 1;
+        Lru_U32_F64_COUNT(evictions, 1);
+        
+        /* the shift may have moved the empty slot for key */
+        slot = Lru_U32_F64_slot(cache, key, hash);
+    }
+    else if (cache->free_node != LRU_NONE)
+    {
+        node = cache->free_node;
+        cache->free_node = cache->nodes[node].older;
+    }
+    else
+    {
+        node = cache->used++;
+    }
+    
+    cache->nodes[node].key = key;
+    cache->nodes[node].value = value;
+    cache->index[slot] = ((hash << 32) | (node + 1));
+    Lru_U32_F64_link_newest(cache, node);
+    ++cache->count;
+    return evicted;
+}
+
+static inline b32
+Lru_U32_F64_remove(Lru_U32_F64 *cache, u32 key)
+{
+    u64 slot = Lru_U32_F64_slot(cache, key, Lru_U32_F64_hash(key));
+    if (cache->index[slot] == 0)
+    {
+        return 0;
+    }
+    
+    u32 node = (u32)cache->index[slot] - 1;
+    Lru_U32_F64_clear_slot(cache, slot);
+    Lru_U32_F64_unlink(cache, node);
+    
+    cache->nodes[node].older = cache->free_node;
+    cache->free_node = node;
+    --cache->count;
+    return 1;
+}
+
+/* drops every entry and resets the statistics, keeping the memory */
+static inline void
+Lru_U32_F64_clear(Lru_U32_F64 *cache)
+{
+    memset(cache->index, 0, (cache->index_mask + 1) * sizeof(u64));
+    cache->count = 0;
+    cache->newest = LRU_NONE;
+    cache->oldest = LRU_NONE;
+    cache->free_node = LRU_NONE;
+    cache->used = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+static inline void
+Lru_U32_F64_free(Lru_U32_F64 *cache)
+{
+    free(cache->nodes);
+    free(cache->index);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/* visits entries from the most to the least recently used */
+#define Lru_U32_F64_for_each(node, cache) \
+    for (Lru_Node_u32_f64 *node = ((cache)->newest != LRU_NONE) ? &(cache)->nodes[(cache)->newest] : 0; \
+         node; node = (node->older != LRU_NONE) ? &(cache)->nodes[node->older] : 0)
+
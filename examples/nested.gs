@@ -0,0 +1,42 @@
+~output_ext .h
+
+@template_start Vec3 <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T x, y, z;
+};
+@template_end
+
+@template_start Pair <- A, B
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	A first;
+	B second;
+};
+@template_end
+
+@template_start Linked_List <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T data;
+	@template_name *next;
+};
+@template_end
+
+@template_start Mesh <- T, N:4
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	Vec3<T> positions[N];
+	Pair<T, Vec3<T>> tagged;
+};
+@template_end
+
+@template Vec3 -> f32 -> Vec3f
+@template Linked_List -> Vec3<f32> -> List_Vec3f
+@template Linked_List -> Pair<u32, Vec3<f64>> -> List_Pair
+@template Mesh -> f32 -> Mesh_F32
+@template Mesh -> f64, 4 -> Mesh_F64
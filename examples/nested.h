@@ -0,0 +1,61 @@
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+	f32 x, y, z;
+};
+
+typedef struct List_Vec3f List_Vec3f;
+struct List_Vec3f
+{
+	Vec3f data;
+	List_Vec3f *next;
+};
+
+typedef struct Vec3_f64 Vec3_f64;
+struct Vec3_f64
+{
+	f64 x, y, z;
+};
+
+typedef struct Pair_u32_Vec3_f64 Pair_u32_Vec3_f64;
+struct Pair_u32_Vec3_f64
+{
+	u32 first;
+	Vec3_f64 second;
+};
+
+typedef struct List_Pair List_Pair;
+struct List_Pair
+{
+	Pair_u32_Vec3_f64 data;
+	List_Pair *next;
+};
+
+typedef struct Pair_f32_Vec3f Pair_f32_Vec3f;
+struct Pair_f32_Vec3f
+{
+	f32 first;
+	Vec3f second;
+};
+
+typedef struct Mesh_F32 Mesh_F32;
+struct Mesh_F32
+{
+	Vec3f positions[4];
+	Pair_f32_Vec3f tagged;
+};
+
+typedef struct Pair_f64_Vec3_f64 Pair_f64_Vec3_f64;
+struct Pair_f64_Vec3_f64
+{
+	f64 first;
+	Vec3_f64 second;
+};
+
+typedef struct Mesh_F64 Mesh_F64;
+struct Mesh_F64
+{
+	Vec3_f64 positions[4];
+	Pair_f64_Vec3_f64 tagged;
+};
+
@@ -0,0 +1,665 @@
+~output_ext .h
+
+@template_start Flat_Map <- K, V
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* sorted, keys apart from values so a search only reads keys */
+    K *keys;
+    V *values;
+    u64 count;
+    u64 capacity;
+};
+@template_end
+
+@template_fn Flat_Map <- K, V
+#include <stdlib.h>
+#include <string.h>
+
+/* GEN_INSTRUMENT counts; moved_entries is what inserts and removes cost */
+@instrument lookups, grows, allocated_bytes, moved_entries
+
+/*
+ Ordered map in two sorted arrays, for data that is read much more
+ often than it changes. Lookups are branchless binary searches over
+ contiguous keys; inserts and removes move the tail of the arrays.
+ */
+static inline u64
+@template_name_lower_bound(@template_name *map, K key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    @template_name_COUNT(lookups, 1);
+    K *base = map->keys;
+    u64 count = map->count;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (base[half - 1] < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - map->keys) + (*base < key);
+}
+
+static inline V *
+@template_name_find(@template_name *map, K key)
+{
+    u64 index = @template_name_lower_bound(map, key);
+    
+    return (index < map->count && map->keys[index] == key) ? &map->values[index] : 0;
+}
+
+static inline b32
+@template_name_reserve(@template_name *map, u64 capacity)
+{
+    if (capacity <= map->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * map->capacity)
+    {
+        capacity = 2 * map->capacity;
+    }
+    
+    K *keys = realloc(map->keys, capacity * sizeof(K));
+    if (!keys)
+    {
+        return 0;
+    }
+    map->keys = keys;
+    
+    V *values = realloc(map->values, capacity * sizeof(V));
+    if (!values)
+    {
+        return 0;
+    }
+    map->values = values;
+    @template_name_COUNT(grows, 1);
+    @template_name_COUNT(allocated_bytes, capacity * (sizeof(K) + sizeof(V)));
+    
+    map->capacity = capacity;
+    return 1;
+}
+
+/* inserts or overwrites */
+static inline b32
+@template_name_insert(@template_name *map, K key, V value)
+{
+    u64 index = @template_name_lower_bound(map, key);
+    
+    if (index < map->count && map->keys[index] == key)
+    {
+        map->values[index] = value;
+        return 1;
+    }
+    
+    if (@template_name_reserve(map, map->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    u64 tail = map->count - index;
+    @template_name_COUNT(moved_entries, tail);
+    memmove(map->keys + index + 1, map->keys + index, tail * sizeof(K));
+    memmove(map->values + index + 1, map->values + index, tail * sizeof(V));
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    return 1;
+}
+
+static inline b32
+@template_name_remove(@template_name *map, K key)
+{
+    u64 index = @template_name_lower_bound(map, key);
+    
+    if (index == map->count || map->keys[index] != key)
+    {
+        return 0;
+    }
+    
+    u64 tail = map->count - index - 1;
+    @template_name_COUNT(moved_entries, tail);
+    memmove(map->keys + index, map->keys + index + 1, tail * sizeof(K));
+    memmove(map->values + index, map->values + index + 1, tail * sizeof(V));
+    --map->count;
+    return 1;
+}
+
+/* replaces the contents with count entries whose keys are sorted and unique */
+static inline b32
+@template_name_load_sorted(@template_name *map, K *keys, V *values, u64 count)
+{
+    if (@template_name_reserve(map, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(map->keys, keys, count * sizeof(K));
+        memcpy(map->values, values, count * sizeof(V));
+    }
+    map->count = count;
+    return 1;
+}
+
+static inline void
+@template_name_free(@template_name *map)
+{
+    free(map->keys);
+    free(map->values);
+    map->keys = 0;
+    map->values = 0;
+    map->count = 0;
+    map->capacity = 0;
+}
+
+/* visits the index of every entry with first <= key < last, in order */
+#define @template_name_for_range(map, index, first, last) \
+    for (u64 index = @template_name_lower_bound((map), (first)); \
+         index < (map)->count && (map)->keys[index] < (last); \
+         ++index)
+@template_end
+
+@template_start B_Tree_Leaf <- K, V, N:16
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    _Alignas(64) K keys[N];
+    V values[N];
+    u32 count;
+    @template_name *next;
+};
+@template_end
+
+@template_start B_Tree_Inner <- K, N:16
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* keys[i] is the smallest key under children[i], keys[0] is unused */
+    _Alignas(64) K keys[N];
+    void *children[N];
+    u32 count;
+};
+@template_end
+
+@template_start B_Tree <- K, V, N:16
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* a leaf when height is 0, an inner node otherwise */
+    void *root;
+    u32 height;
+    u64 count;
+    B_Tree_Leaf<K, V, N> *first;
+};
+@template_end
+
+@template_fn B_Tree <- K, V, N:16
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ B+ tree with N keys per node. Keys of a node are contiguous and
+ start on a cache line, and a node is searched by counting the keys
+ below the one looked for, which has no branches and vectorizes.
+ Entries live in the leaves, which are linked in key order for range
+ iteration. There is no remove.
+ */
+#ifndef B_TREE_MAX_HEIGHT
+#define B_TREE_MAX_HEIGHT 32
+#endif
+
+/* per-thread B_Tree events when GEN_INSTRUMENT is defined */
+@instrument lookups, inner_nodes_visited, leaf_splits, inner_splits, allocated_bytes
+
+typedef struct @template_name_Cursor
+{
+    B_Tree_Leaf<K, V, N> *leaf;
+    u32 index;
+} @template_name_Cursor;
+
+/* child of an inner node that can contain key */
+static inline u32
+@template_name_child_index(B_Tree_Inner<K, N> *inner, K key)
+{
+    u32 index = 0;
+    for (u32 i = 1; i < inner->count; ++i)
+    {
+        index += (inner->keys[i] <= key);
+    }
+    return index;
+}
+
+/* number of keys in a leaf that are less than key */
+static inline u32
+@template_name_leaf_index(B_Tree_Leaf<K, V, N> *leaf, K key)
+{
+    u32 index = 0;
+    for (u32 i = 0; i < leaf->count; ++i)
+    {
+        index += (leaf->keys[i] < key);
+    }
+    return index;
+}
+
+static inline B_Tree_Leaf<K, V, N> *
+@template_name_find_leaf(@template_name *tree, K key)
+{
+    void *node = tree->root;
+    @template_name_COUNT(lookups, 1);
+    @template_name_COUNT(inner_nodes_visited, tree->height);
+    
+    for (u32 level = tree->height; level > 0; --level)
+    {
+        B_Tree_Inner<K, N> *inner = node;
+        node = inner->children[@template_name_child_index(inner, key)];
+    }
+    
+    return node;
+}
+
+static inline V *
+@template_name_find(@template_name *tree, K key)
+{
+    if (!tree->root)
+    {
+        return 0;
+    }
+    
+    B_Tree_Leaf<K, V, N> *leaf = @template_name_find_leaf(tree, key);
+    u32 index = @template_name_leaf_index(leaf, key);
+    
+    return (index < leaf->count && leaf->keys[index] == key) ? &leaf->values[index] : 0;
+}
+
+static inline void *
+@template_name_alloc_node(u64 size)
+{
+    void *node = aligned_alloc(64, (size + 63) & ~(u64)63);
+    if (node)
+    {
+        memset(node, 0, size);
+        @template_name_COUNT(allocated_bytes, (size + 63) & ~(u64)63);
+    }
+    return node;
+}
+
+/* inserts or overwrites, returns 0 if a node could not be allocated */
+static inline b32
+@template_name_insert(@template_name *tree, K key, V value)
+{
+    if (!tree->root)
+    {
+        tree->root = @template_name_alloc_node(sizeof(B_Tree_Leaf<K, V, N>));
+        if (!tree->root)
+        {
+            return 0;
+        }
+        tree->first = tree->root;
+    }
+    
+    B_Tree_Inner<K, N> *path[B_TREE_MAX_HEIGHT];
+    u32 path_index[B_TREE_MAX_HEIGHT];
+    void *node = tree->root;
+    
+    for (u32 level = 0; level < tree->height; ++level)
+    {
+        B_Tree_Inner<K, N> *inner = node;
+        path[level] = inner;
+        path_index[level] = @template_name_child_index(inner, key);
+        node = inner->children[path_index[level]];
+    }
+    
+    B_Tree_Leaf<K, V, N> *leaf = node;
+    u32 index = @template_name_leaf_index(leaf, key);
+    
+    if (index < leaf->count && leaf->keys[index] == key)
+    {
+        leaf->values[index] = value;
+        return 1;
+    }
+    
+    /*
+     every node a split needs is allocated before anything changes, so a
+     failed allocation leaves the tree as it was: a leaf, one inner node
+     per full parent above it, and a root if all of them are full
+     */
+    void *spare[B_TREE_MAX_HEIGHT + 2];
+    u32 spare_num = 0;
+    u32 spare_used = 0;
+    
+    if (leaf->count == N)
+    {
+        u32 level = tree->height;
+        while (level > 0 && path[level - 1]->count == N)
+        {
+            --level;
+        }
+        
+        u32 needed = 1 + (tree->height - level) + (level == 0);
+        for (; spare_num < needed; ++spare_num)
+        {
+            spare[spare_num] = @template_name_alloc_node((spare_num == 0) ?
+                sizeof(B_Tree_Leaf<K, V, N>) : sizeof(B_Tree_Inner<K, N>));
+            if (!spare[spare_num])
+            {
+                while (spare_num > 0)
+                {
+                    free(spare[--spare_num]);
+                }
+                return 0;
+            }
+        }
+    }
+    
+    /* a full leaf gives its upper half to a new leaf on its right */
+    B_Tree_Leaf<K, V, N> *target = leaf;
+    void *split = 0;
+    K split_key = key;
+    
+    if (leaf->count == N)
+    {
+        B_Tree_Leaf<K, V, N> *right = spare[spare_used++];
+        
+        @template_name_COUNT(leaf_splits, 1);
+        u32 half = N / 2;
+        right->count = N - half;
+        memcpy(right->keys, leaf->keys + half, right->count * sizeof(K));
+        memcpy(right->values, leaf->values + half, right->count * sizeof(V));
+        leaf->count = half;
+        right->next = leaf->next;
+        leaf->next = right;
+        
+        if (index > half)
+        {
+            target = right;
+            index -= half;
+        }
+        split = right;
+        split_key = right->keys[0];
+    }
+    
+    memmove(target->keys + index + 1, target->keys + index,
+            (target->count - index) * sizeof(K));
+    memmove(target->values + index + 1, target->values + index,
+            (target->count - index) * sizeof(V));
+    target->keys[index] = key;
+    target->values[index] = value;
+    ++target->count;
+    ++tree->count;
+    
+    /* hand the new node to the parent, splitting full parents on the way up */
+    for (u32 level = tree->height; split && level > 0; --level)
+    {
+        B_Tree_Inner<K, N> *inner = path[level - 1];
+        u32 position = path_index[level - 1] + 1;
+        B_Tree_Inner<K, N> *parent = inner;
+        
+        void *new_split = 0;
+        K new_split_key = split_key;
+        
+        if (inner->count == N)
+        {
+            B_Tree_Inner<K, N> *right = spare[spare_used++];
+            
+            @template_name_COUNT(inner_splits, 1);
+            u32 half = N / 2;
+            right->count = N - half;
+            memcpy(right->keys, inner->keys + half, right->count * sizeof(K));
+            memcpy(right->children, inner->children + half,
+                   right->count * sizeof(void *));
+            inner->count = half;
+            
+            if (position > half)
+            {
+                parent = right;
+                position -= half;
+            }
+            new_split = right;
+            new_split_key = right->keys[0];
+        }
+        
+        memmove(parent->keys + position + 1, parent->keys + position,
+                (parent->count - position) * sizeof(K));
+        memmove(parent->children + position + 1, parent->children + position,
+                (parent->count - position) * sizeof(void *));
+        parent->keys[position] = split_key;
+        parent->children[position] = split;
+        ++parent->count;
+        
+        split = new_split;
+        split_key = new_split_key;
+    }
+    
+    /* the root split, the tree grows by one level */
+    if (split)
+    {
+        B_Tree_Inner<K, N> *root = spare[spare_used++];
+        root->count = 2;
+        root->children[0] = tree->root;
+        root->children[1] = split;
+        root->keys[1] = split_key;
+        tree->root = root;
+        ++tree->height;
+    }
+    
+    return 1;
+}
+
+static inline void
+@template_name_free_node(void *node, u32 height)
+{
+    if (height > 0)
+    {
+        B_Tree_Inner<K, N> *inner = node;
+        for (u32 i = 0; i < inner->count; ++i)
+        {
+            @template_name_free_node(inner->children[i], height - 1);
+        }
+    }
+    free(node);
+}
+
+static inline void
+@template_name_free(@template_name *tree)
+{
+    if (tree->root)
+    {
+        @template_name_free_node(tree->root, tree->height);
+    }
+    tree->root = 0;
+    tree->height = 0;
+    tree->count = 0;
+    tree->first = 0;
+}
+
+/* frees the inner nodes of a subtree, its leaves are freed through the leaf chain */
+static inline void
+@template_name_free_inner(void *node, u32 height)
+{
+    if (height == 0)
+    {
+        return;
+    }
+    
+    B_Tree_Inner<K, N> *inner = node;
+    for (u32 i = 0; i < inner->count; ++i)
+    {
+        @template_name_free_inner(inner->children[i], height - 1);
+    }
+    free(inner);
+}
+
+/*
+ Replaces the contents with count entries whose keys are sorted and
+ unique. Leaves and inner nodes are filled completely, bottom up.
+ */
+static inline b32
+@template_name_load_sorted(@template_name *tree, K *keys, V *values, u64 count)
+{
+    @template_name_free(tree);
+    if (count == 0)
+    {
+        return 1;
+    }
+    
+    u64 node_num = (count + N - 1) / N;
+    void **nodes = malloc(node_num * sizeof(void *));
+    K *first_keys = malloc(node_num * sizeof(K));
+    if (!nodes || !first_keys)
+    {
+        free(nodes);
+        free(first_keys);
+        return 0;
+    }
+    
+    B_Tree_Leaf<K, V, N> *previous = 0;
+    for (u64 i = 0; i < node_num; ++i)
+    {
+        B_Tree_Leaf<K, V, N> *leaf = @template_name_alloc_node(sizeof(*leaf));
+        if (!leaf)
+        {
+            /* the leaves made so far are linked and freed below */
+            break;
+        }
+        
+        u64 start = i * N;
+        leaf->count = (u32)((count - start < N) ? count - start : N);
+        memcpy(leaf->keys, keys + start, leaf->count * sizeof(K));
+        memcpy(leaf->values, values + start, leaf->count * sizeof(V));
+        
+        if (previous)
+        {
+            previous->next = leaf;
+        }
+        else
+        {
+            tree->first = leaf;
+        }
+        previous = leaf;
+        nodes[i] = leaf;
+        first_keys[i] = leaf->keys[0];
+        tree->count += leaf->count;
+    }
+    
+    b32 complete = (tree->count == count);
+    u32 height = 0;
+    
+    while (node_num > 1 && complete)
+    {
+        u64 parent_num = (node_num + N - 1) / N;
+        
+        for (u64 i = 0; i < parent_num; ++i)
+        {
+            B_Tree_Inner<K, N> *inner = @template_name_alloc_node(sizeof(*inner));
+            if (!inner)
+            {
+                /*
+                 nodes[0, i) are the new parents, nodes[i * N, node_num)
+                 the children they did not take yet
+                 */
+                for (u64 j = 0; j < i; ++j)
+                {
+                    @template_name_free_inner(nodes[j], height + 1);
+                }
+                for (u64 j = i * N; j < node_num; ++j)
+                {
+                    @template_name_free_inner(nodes[j], height);
+                }
+                complete = 0;
+                break;
+            }
+            
+            u64 start = i * N;
+            inner->count = (u32)((node_num - start < N) ? node_num - start : N);
+            memcpy(inner->keys, first_keys + start, inner->count * sizeof(K));
+            memcpy(inner->children, nodes + start, inner->count * sizeof(void *));
+            
+            nodes[i] = inner;
+            first_keys[i] = inner->keys[0];
+        }
+        
+        if (!complete)
+        {
+            break;
+        }
+        node_num = parent_num;
+        ++height;
+    }
+    
+    if (complete)
+    {
+        tree->root = nodes[0];
+        tree->height = height;
+    }
+    
+    free(nodes);
+    free(first_keys);
+    
+    if (!complete)
+    {
+        /* the inner nodes are freed above, the leaves are all on the chain */
+        for (B_Tree_Leaf<K, V, N> *leaf = tree->first; leaf;)
+        {
+            B_Tree_Leaf<K, V, N> *next = leaf->next;
+            free(leaf);
+            leaf = next;
+        }
+        tree->root = 0;
+        tree->height = 0;
+        tree->count = 0;
+        tree->first = 0;
+        return 0;
+    }
+    
+    return 1;
+}
+
+/* cursor at the first entry whose key is not less than key */
+static inline @template_name_Cursor
+@template_name_lower_bound(@template_name *tree, K key)
+{
+    @template_name_Cursor cursor = {0};
+    
+    if (tree->root)
+    {
+        cursor.leaf = @template_name_find_leaf(tree, key);
+        cursor.index = @template_name_leaf_index(cursor.leaf, key);
+        
+        if (cursor.index == cursor.leaf->count)
+        {
+            cursor.leaf = cursor.leaf->next;
+            cursor.index = 0;
+        }
+    }
+    
+    return cursor;
+}
+
+static inline void
+@template_name_cursor_next(@template_name_Cursor *cursor)
+{
+    if (++cursor->index == cursor->leaf->count)
+    {
+        cursor->leaf = cursor->leaf->next;
+        cursor->index = 0;
+    }
+}
+
+/* visits every entry with first <= key < last, in order */
+#define @template_name_for_range(tree, cursor, first, last) \
+    for (@template_name_Cursor cursor = @template_name_lower_bound((tree), (first)); \
+         cursor.leaf && cursor.leaf->keys[cursor.index] < (last); \
+         @template_name_cursor_next(&cursor))
+@template_end
+
+@template Flat_Map -> u64, u64 -> Flat_Map_U64
+@template B_Tree -> u64, u64 -> B_Tree_U64
+@template B_Tree -> f32, u32, 32 -> B_Tree_F32_32
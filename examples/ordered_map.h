@@ -0,0 +1,1260 @@
+typedef struct Flat_Map_U64 Flat_Map_U64;
+struct Flat_Map_U64
+{
+    /* sorted, keys apart from values so a search only reads keys */
+    u64 *keys;
+    u64 *values;
+    u64 count;
+    u64 capacity;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/* GEN_INSTRUMENT counts; moved_entries is what inserts and removes cost */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Flat_Map_U64 in the calling thread */
+typedef struct Flat_Map_U64_Counters
+{
+    u64 lookups;
+    u64 grows;
+    u64 allocated_bytes;
+    u64 moved_entries;
+} Flat_Map_U64_Counters;
+
+static _Thread_local Flat_Map_U64_Counters Flat_Map_U64_counters;
+
+#define Flat_Map_U64_COUNT(counter, n) (Flat_Map_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Flat_Map_U64_COUNT_MAX(counter, value) \
+    (Flat_Map_U64_counters.counter = ((u64)(value) > Flat_Map_U64_counters.counter) ? \
+        (u64)(value) : Flat_Map_U64_counters.counter)
+
+static inline void
+Flat_Map_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "Flat_Map_U64:");
+    fprintf(file, " lookups %llu", (unsigned long long)Flat_Map_U64_counters.lookups);
+    fprintf(file, " grows %llu", (unsigned long long)Flat_Map_U64_counters.grows);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Flat_Map_U64_counters.allocated_bytes);
+    fprintf(file, " moved_entries %llu", (unsigned long long)Flat_Map_U64_counters.moved_entries);
+    fprintf(file, "\n");
+}
+
+static inline void
+Flat_Map_U64_reset_counters(void)
+{
+    Flat_Map_U64_counters = (Flat_Map_U64_Counters){0};
+}
+#else
+#define Flat_Map_U64_COUNT(counter, n) ((void)0)
+#define Flat_Map_U64_COUNT_MAX(counter, value) ((void)0)
+#define Flat_Map_U64_dump_counters(file) ((void)0)
+#define Flat_Map_U64_reset_counters() ((void)0)
+#endif
+
+/*
+ Ordered map in two sorted arrays, for data that is read much more
+ often than it changes. Lookups are branchless binary searches over
+ contiguous keys; inserts and removes move the tail of the arrays.
+ */
+static inline u64
+Flat_Map_U64_lower_bound(Flat_Map_U64 *map, u64 key)
+{
+    if (map->count == 0)
+    {
+        return 0;
+    }
+    
+    Flat_Map_U64_COUNT(lookups, 1);
+    u64 *base = map->keys;
+    u64 count = map->count;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (base[half - 1] < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - map->keys) + (*base < key);
+}
+
+static inline u64 *
+Flat_Map_U64_find(Flat_Map_U64 *map, u64 key)
+{
+    u64 index = Flat_Map_U64_lower_bound(map, key);
+    
+    return (index < map->count && map->keys[index] == key) ? &map->values[index] : 0;
+}
+
+static inline b32
+Flat_Map_U64_reserve(Flat_Map_U64 *map, u64 capacity)
+{
+    if (capacity <= map->capacity)
+    {
+        return 1;
+    }
+    
+    if (capacity < 2 * map->capacity)
+    {
+        capacity = 2 * map->capacity;
+    }
+    
+    u64 *keys = realloc(map->keys, capacity * sizeof(u64));
+    if (!keys)
+    {
+        return 0;
+    }
+    map->keys = keys;
+    
+    u64 *values = realloc(map->values, capacity * sizeof(u64));
+    if (!values)
+    {
+        return 0;
+    }
+    map->values = values;
+    Flat_Map_U64_COUNT(grows, 1);
+    Flat_Map_U64_COUNT(allocated_bytes, capacity * (sizeof(u64) + sizeof(u64)));
+    
+    map->capacity = capacity;
+    return 1;
+}
+
+/* inserts or overwrites */
+static inline b32
+Flat_Map_U64_insert(Flat_Map_U64 *map, u64 key, u64 value)
+{
+    u64 index = Flat_Map_U64_lower_bound(map, key);
+    
+    if (index < map->count && map->keys[index] == key)
+    {
+        map->values[index] = value;
+        return 1;
+    }
+    
+    if (Flat_Map_U64_reserve(map, map->count + 1) == 0)
+    {
+        return 0;
+    }
+    
+    u64 tail = map->count - index;
+    Flat_Map_U64_COUNT(moved_entries, tail);
+    memmove(map->keys + index + 1, map->keys + index, tail * sizeof(u64));
+    memmove(map->values + index + 1, map->values + index, tail * sizeof(u64));
+    map->keys[index] = key;
+    map->values[index] = value;
+    ++map->count;
+    return 1;
+}
+
+static inline b32
+Flat_Map_U64_remove(Flat_Map_U64 *map, u64 key)
+{
+    u64 index = Flat_Map_U64_lower_bound(map, key);
+    
+    if (index == map->count || map->keys[index] != key)
+    {
+        return 0;
+    }
+    
+    u64 tail = map->count - index - 1;
+    Flat_Map_U64_COUNT(moved_entries, tail);
+    memmove(map->keys + index, map->keys + index + 1, tail * sizeof(u64));
+    memmove(map->values + index, map->values + index + 1, tail * sizeof(u64));
+    --map->count;
+    return 1;
+}
+
+/* replaces the contents with count entries whose keys are sorted and unique */
+static inline b32
+Flat_Map_U64_load_sorted(Flat_Map_U64 *map, u64 *keys, u64 *values, u64 count)
+{
+    if (Flat_Map_U64_reserve(map, count) == 0)
+    {
+        return 0;
+    }
+    
+    if (count > 0)
+    {
+        memcpy(map->keys, keys, count * sizeof(u64));
+        memcpy(map->values, values, count * sizeof(u64));
+    }
+    map->count = count;
+    return 1;
+}
+
+static inline void
+Flat_Map_U64_free(Flat_Map_U64 *map)
+{
+    free(map->keys);
+    free(map->values);
+    map->keys = 0;
+    map->values = 0;
+    map->count = 0;
+    map->capacity = 0;
+}
+
+/* visits the index of every entry with first <= key < last, in order */
+#define Flat_Map_U64_for_range(map, index, first, last) \
+    for (u64 index = Flat_Map_U64_lower_bound((map), (first)); \
+         index < (map)->count && (map)->keys[index] < (last); \
+         ++index)
+
+typedef struct B_Tree_Leaf_u64_u64_16 B_Tree_Leaf_u64_u64_16;
+struct B_Tree_Leaf_u64_u64_16
+{
+    _Alignas(64) u64 keys[16];
+    u64 values[16];
+    u32 count;
+    B_Tree_Leaf_u64_u64_16 *next;
+};
+
+typedef struct B_Tree_Inner_u64_16 B_Tree_Inner_u64_16;
+struct B_Tree_Inner_u64_16
+{
+    /* keys[i] is the smallest key under children[i], keys[0] is unused */
+    _Alignas(64) u64 keys[16];
+    void *children[16];
+    u32 count;
+};
+
+typedef struct B_Tree_U64 B_Tree_U64;
+struct B_Tree_U64
+{
+    /* a leaf when height is 0, an inner node otherwise */
+    void *root;
+    u32 height;
+    u64 count;
+    B_Tree_Leaf_u64_u64_16 *first;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ B+ tree with 16 keys per node. Keys of a node are contiguous and
+ start on a cache line, and a node is searched by counting the keys
+ below the one looked for, which has no branches and vectorizes.
+ Entries live in the leaves, which are linked in key order for range
+ iteration. There is no remove.
+ */
+#ifndef B_TREE_MAX_HEIGHT
+#define B_TREE_MAX_HEIGHT 32
+#endif
+
+/* per-thread B_Tree events when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of B_Tree_U64 in the calling thread */
+typedef struct B_Tree_U64_Counters
+{
+    u64 lookups;
+    u64 inner_nodes_visited;
+    u64 leaf_splits;
+    u64 inner_splits;
+    u64 allocated_bytes;
+} B_Tree_U64_Counters;
+
+static _Thread_local B_Tree_U64_Counters B_Tree_U64_counters;
+
+#define B_Tree_U64_COUNT(counter, n) (B_Tree_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define B_Tree_U64_COUNT_MAX(counter, value) \
+    (B_Tree_U64_counters.counter = ((u64)(value) > B_Tree_U64_counters.counter) ? \
+        (u64)(value) : B_Tree_U64_counters.counter)
+
+static inline void
+B_Tree_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "B_Tree_U64:");
+    fprintf(file, " lookups %llu", (unsigned long long)B_Tree_U64_counters.lookups);
+    fprintf(file, " inner_nodes_visited %llu", (unsigned long long)B_Tree_U64_counters.inner_nodes_visited);
+    fprintf(file, " leaf_splits %llu", (unsigned long long)B_Tree_U64_counters.leaf_splits);
+    fprintf(file, " inner_splits %llu", (unsigned long long)B_Tree_U64_counters.inner_splits);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)B_Tree_U64_counters.allocated_bytes);
+    fprintf(file, "\n");
+}
+
+static inline void
+B_Tree_U64_reset_counters(void)
+{
+    B_Tree_U64_counters = (B_Tree_U64_Counters){0};
+}
+#else
+#define B_Tree_U64_COUNT(counter, n) ((void)0)
+#define B_Tree_U64_COUNT_MAX(counter, value) ((void)0)
+#define B_Tree_U64_dump_counters(file) ((void)0)
+#define B_Tree_U64_reset_counters() ((void)0)
+#endif
+
+typedef struct B_Tree_U64_Cursor
+{
+    B_Tree_Leaf_u64_u64_16 *leaf;
+    u32 index;
+} B_Tree_U64_Cursor;
+
+/* child of an inner node that can contain key */
+static inline u32
+B_Tree_U64_child_index(B_Tree_Inner_u64_16 *inner, u64 key)
+{
+    u32 index = 0;
+    for (u32 i = 1; i < inner->count; ++i)
+    {
+        index += (inner->keys[i] <= key);
+    }
+    return index;
+}
+
+/* number of keys in a leaf that are less than key */
+static inline u32
+B_Tree_U64_leaf_index(B_Tree_Leaf_u64_u64_16 *leaf, u64 key)
+{
+    u32 index = 0;
+    for (u32 i = 0; i < leaf->count; ++i)
+    {
+        index += (leaf->keys[i] < key);
+    }
+    return index;
+}
+
+static inline B_Tree_Leaf_u64_u64_16 *
+B_Tree_U64_find_leaf(B_Tree_U64 *tree, u64 key)
+{
+    void *node = tree->root;
+    B_Tree_U64_COUNT(lookups, 1);
+    B_Tree_U64_COUNT(inner_nodes_visited, tree->height);
+    
+    for (u32 level = tree->height; level > 0; --level)
+    {
+        B_Tree_Inner_u64_16 *inner = node;
+        node = inner->children[B_Tree_U64_child_index(inner, key)];
+    }
+    
+    return node;
+}
+
+static inline u64 *
+B_Tree_U64_find(B_Tree_U64 *tree, u64 key)
+{
+    if (!tree->root)
+    {
+        return 0;
+    }
+    
+    B_Tree_Leaf_u64_u64_16 *leaf = B_Tree_U64_find_leaf(tree, key);
+    u32 index = B_Tree_U64_leaf_index(leaf, key);
+    
+    return (index < leaf->count && leaf->keys[index] == key) ? &leaf->values[index] : 0;
+}
+
+static inline void *
+B_Tree_U64_alloc_node(u64 size)
+{
+    void *node = aligned_alloc(64, (size + 63) & ~(u64)63);
+    if (node)
+    {
+        memset(node, 0, size);
+        B_Tree_U64_COUNT(allocated_bytes, (size + 63) & ~(u64)63);
+    }
+    return node;
+}
+
+/* inserts or overwrites, returns 0 if a node could not be allocated */
+static inline b32
+B_Tree_U64_insert(B_Tree_U64 *tree, u64 key, u64 value)
+{
+    if (!tree->root)
+    {
+        tree->root = B_Tree_U64_alloc_node(sizeof(B_Tree_Leaf_u64_u64_16));
+        if (!tree->root)
+        {
+            return 0;
+        }
+        tree->first = tree->root;
+    }
+    
+    B_Tree_Inner_u64_16 *path[B_TREE_MAX_HEIGHT];
+    u32 path_index[B_TREE_MAX_HEIGHT];
+    void *node = tree->root;
+    
+    for (u32 level = 0; level < tree->height; ++level)
+    {
+        B_Tree_Inner_u64_16 *inner = node;
+        path[level] = inner;
+        path_index[level] = B_Tree_U64_child_index(inner, key);
+        node = inner->children[path_index[level]];
+    }
+    
+    B_Tree_Leaf_u64_u64_16 *leaf = node;
+    u32 index = B_Tree_U64_leaf_index(leaf, key);
+    
+    if (index < leaf->count && leaf->keys[index] == key)
+    {
+        leaf->values[index] = value;
+        return 1;
+    }
+    
+    /*
+     every node a split needs is allocated before anything changes, so a
+     failed allocation leaves the tree as it was: a leaf, one inner node
+     per full parent above it, and a root if all of them are full
+     */
+    void *spare[B_TREE_MAX_HEIGHT + 2];
+    u32 spare_num = 0;
+    u32 spare_used = 0;
+    
+    if (leaf->count == 16)
+    {
+        u32 level = tree->height;
+        while (level > 0 && path[level - 1]->count == 16)
+        {
+            --level;
+        }
+        
+        u32 needed = 1 + (tree->height - level) + (level == 0);
+        for (; spare_num < needed; ++spare_num)
+        {
+            spare[spare_num] = B_Tree_U64_alloc_node((spare_num == 0) ?
+                sizeof(B_Tree_Leaf_u64_u64_16) : sizeof(B_Tree_Inner_u64_16));
+            if (!spare[spare_num])
+            {
+                while (spare_num > 0)
+                {
+                    free(spare[--spare_num]);
+                }
+                return 0;
+            }
+        }
+    }
+    
+    /* a full leaf gives its upper half to a new leaf on its right */
+    B_Tree_Leaf_u64_u64_16 *target = leaf;
+    void *split = 0;
+    u64 split_key = key;
+    
+    if (leaf->count == 16)
+    {
+        B_Tree_Leaf_u64_u64_16 *right = spare[spare_used++];
+        
+        B_Tree_U64_COUNT(leaf_splits, 1);
+        u32 half = 16 / 2;
+        right->count = 16 - half;
+        memcpy(right->keys, leaf->keys + half, right->count * sizeof(u64));
+        memcpy(right->values, leaf->values + half, right->count * sizeof(u64));
+        leaf->count = half;
+        right->next = leaf->next;
+        leaf->next = right;
+        
+        if (index > half)
+        {
+            target = right;
+            index -= half;
+        }
+        split = right;
+        split_key = right->keys[0];
+    }
+    
+    memmove(target->keys + index + 1, target->keys + index,
+            (target->count - index) * sizeof(u64));
+    memmove(target->values + index + 1, target->values + index,
+            (target->count - index) * sizeof(u64));
+    target->keys[index] = key;
+    target->values[index] = value;
+    ++target->count;
+    ++tree->count;
+    
+    /* hand the new node to the parent, splitting full parents on the way up */
+    for (u32 level = tree->height; split && level > 0; --level)
+    {
+        B_Tree_Inner_u64_16 *inner = path[level - 1];
+        u32 position = path_index[level - 1] + 1;
+        B_Tree_Inner_u64_16 *parent = inner;
+        
+        void *new_split = 0;
+        u64 new_split_key = split_key;
+        
+        if (inner->count == 16)
+        {
+            B_Tree_Inner_u64_16 *right = spare[spare_used++];
+            
+            B_Tree_U64_COUNT(inner_splits, 1);
+            u32 half = 16 / 2;
+            right->count = 16 - half;
+            memcpy(right->keys, inner->keys + half, right->count * sizeof(u64));
+            memcpy(right->children, inner->children + half,
+                   right->count * sizeof(void *));
+            inner->count = half;
+            
+            if (position > half)
+            {
+                parent = right;
+                position -= half;
+            }
+            new_split = right;
+            new_split_key = right->keys[0];
+        }
+        
+        memmove(parent->keys + position + 1, parent->keys + position,
+                (parent->count - position) * sizeof(u64));
+        memmove(parent->children + position + 1, parent->children + position,
+                (parent->count - position) * sizeof(void *));
+        parent->keys[position] = split_key;
+        parent->children[position] = split;
+        ++parent->count;
+        
+        split = new_split;
+        split_key = new_split_key;
+    }
+    
+    /* the root split, the tree grows by one level */
+    if (split)
+    {
+        B_Tree_Inner_u64_16 *root = spare[spare_used++];
+        root->count = 2;
+        root->children[0] = tree->root;
+        root->children[1] = split;
+        root->keys[1] = split_key;
+        tree->root = root;
+        ++tree->height;
+    }
+    
+    return 1;
+}
+
+static inline void
+B_Tree_U64_free_node(void *node, u32 height)
+{
+    if (height > 0)
+    {
+        B_Tree_Inner_u64_16 *inner = node;
+        for (u32 i = 0; i < inner->count; ++i)
+        {
+            B_Tree_U64_free_node(inner->children[i], height - 1);
+        }
+    }
+    free(node);
+}
+
+static inline void
+B_Tree_U64_free(B_Tree_U64 *tree)
+{
+    if (tree->root)
+    {
+        B_Tree_U64_free_node(tree->root, tree->height);
+    }
+    tree->root = 0;
+    tree->height = 0;
+    tree->count = 0;
+    tree->first = 0;
+}
+
+/* frees the inner nodes of a subtree, its leaves are freed through the leaf chain */
+static inline void
+B_Tree_U64_free_inner(void *node, u32 height)
+{
+    if (height == 0)
+    {
+        return;
+    }
+    
+    B_Tree_Inner_u64_16 *inner = node;
+    for (u32 i = 0; i < inner->count; ++i)
+    {
+        B_Tree_U64_free_inner(inner->children[i], height - 1);
+    }
+    free(inner);
+}
+
+/*
+ Replaces the contents with count entries whose keys are sorted and
+ unique. Leaves and inner nodes are filled completely, bottom up.
+ */
+static inline b32
+B_Tree_U64_load_sorted(B_Tree_U64 *tree, u64 *keys, u64 *values, u64 count)
+{
+    B_Tree_U64_free(tree);
+    if (count == 0)
+    {
+        return 1;
+    }
+    
+    u64 node_num = (count + 16 - 1) / 16;
+    void **nodes = malloc(node_num * sizeof(void *));
+    u64 *first_keys = malloc(node_num * sizeof(u64));
+    if (!nodes || !first_keys)
+    {
+        free(nodes);
+        free(first_keys);
+        return 0;
+    }
+    
+    B_Tree_Leaf_u64_u64_16 *previous = 0;
+    for (u64 i = 0; i < node_num; ++i)
+    {
+        B_Tree_Leaf_u64_u64_16 *leaf = B_Tree_U64_alloc_node(sizeof(*leaf));
+        if (!leaf)
+        {
+            /* the leaves made so far are linked and freed below */
+            break;
+        }
+        
+        u64 start = i * 16;
+        leaf->count = (u32)((count - start < 16) ? count - start : 16);
+        memcpy(leaf->keys, keys + start, leaf->count * sizeof(u64));
+        memcpy(leaf->values, values + start, leaf->count * sizeof(u64));
+        
+        if (previous)
+        {
+            previous->next = leaf;
+        }
+        else
+        {
+            tree->first = leaf;
+        }
+        previous = leaf;
+        nodes[i] = leaf;
+        first_keys[i] = leaf->keys[0];
+        tree->count += leaf->count;
+    }
+    
+    b32 complete = (tree->count == count);
+    u32 height = 0;
+    
+    while (node_num > 1 && complete)
+    {
+        u64 parent_num = (node_num + 16 - 1) / 16;
+        
+        for (u64 i = 0; i < parent_num; ++i)
+        {
+            B_Tree_Inner_u64_16 *inner = B_Tree_U64_alloc_node(sizeof(*inner));
+            if (!inner)
+            {
+                /*
+                 nodes[0, i) are the new parents, nodes[i * 16, node_num)
+                 the children they did not take yet
+                 */
+                for (u64 j = 0; j < i; ++j)
+                {
+                    B_Tree_U64_free_inner(nodes[j], height + 1);
+                }
+                for (u64 j = i * 16; j < node_num; ++j)
+                {
+                    B_Tree_U64_free_inner(nodes[j], height);
+                }
+                complete = 0;
+                break;
+            }
+            
+            u64 start = i * 16;
+            inner->count = (u32)((node_num - start < 16) ? node_num - start : 16);
+            memcpy(inner->keys, first_keys + start, inner->count * sizeof(u64));
+            memcpy(inner->children, nodes + start, inner->count * sizeof(void *));
+            
+            nodes[i] = inner;
+            first_keys[i] = inner->keys[0];
+        }
+        
+        if (!complete)
+        {
+            break;
+        }
+        node_num = parent_num;
+        ++height;
+    }
+    
+    if (complete)
+    {
+        tree->root = nodes[0];
+        tree->height = height;
+    }
+    
+    free(nodes);
+    free(first_keys);
+    
+    if (!complete)
+    {
+        /* the inner nodes are freed above, the leaves are all on the chain */
+        for (B_Tree_Leaf_u64_u64_16 *leaf = tree->first; leaf;)
+        {
+            B_Tree_Leaf_u64_u64_16 *next = leaf->next;
+            free(leaf);
+            leaf = next;
+        }
+        tree->root = 0;
+        tree->height = 0;
+        tree->count = 0;
+        tree->first = 0;
+        return 0;
+    }
+    
+    return 1;
+}
+
+/* cursor at the first entry whose key is not less than key */
+static inline B_Tree_U64_Cursor
+B_Tree_U64_lower_bound(B_Tree_U64 *tree, u64 key)
+{
+    B_Tree_U64_Cursor cursor = {0};
+    
+    if (tree->root)
+    {
+        cursor.leaf = B_Tree_U64_find_leaf(tree, key);
+        cursor.index = B_Tree_U64_leaf_index(cursor.leaf, key);
+        
+        if (cursor.index == cursor.leaf->count)
+        {
+            cursor.leaf = cursor.leaf->next;
+            cursor.index = 0;
+        }
+    }
+    
+    return cursor;
+}
+
+static inline void
+B_Tree_U64_cursor_next(B_Tree_U64_Cursor *cursor)
+{
+    if (++cursor->index == cursor->leaf->count)
+    {
+        cursor->leaf = cursor->leaf->next;
+        cursor->index = 0;
+    }
+}
+
+/* visits every entry with first <= key < last, in order */
+#define B_Tree_U64_for_range(tree, cursor, first, last) \
+    for (B_Tree_U64_Cursor cursor = B_Tree_U64_lower_bound((tree), (first)); \
+         cursor.leaf && cursor.leaf->keys[cursor.index] < (last); \
+         B_Tree_U64_cursor_next(&cursor))
+
+typedef struct B_Tree_Leaf_f32_u32_32 B_Tree_Leaf_f32_u32_32;
+struct B_Tree_Leaf_f32_u32_32
+{
+    _Alignas(64) f32 keys[32];
+    u32 values[32];
+    u32 count;
+    B_Tree_Leaf_f32_u32_32 *next;
+};
+
+typedef struct B_Tree_Inner_f32_32 B_Tree_Inner_f32_32;
+struct B_Tree_Inner_f32_32
+{
+    /* keys[i] is the smallest key under children[i], keys[0] is unused */
+    _Alignas(64) f32 keys[32];
+    void *children[32];
+    u32 count;
+};
+
+typedef struct B_Tree_F32_32 B_Tree_F32_32;
+struct B_Tree_F32_32
+{
+    /* a leaf when height is 0, an inner node otherwise */
+    void *root;
+    u32 height;
+    u64 count;
+    B_Tree_Leaf_f32_u32_32 *first;
+};
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ B+ tree with 32 keys per node. Keys of a node are contiguous and
+ start on a cache line, and a node is searched by counting the keys
+ below the one looked for, which has no branches and vectorizes.
+ Entries live in the leaves, which are linked in key order for range
+ iteration. There is no remove.
+ */
+#ifndef B_TREE_MAX_HEIGHT
+#define B_TREE_MAX_HEIGHT 32
+#endif
+
+/* per-thread B_Tree events when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of B_Tree_F32_32 in the calling thread */
+typedef struct B_Tree_F32_32_Counters
+{
+    u64 lookups;
+    u64 inner_nodes_visited;
+    u64 leaf_splits;
+    u64 inner_splits;
+    u64 allocated_bytes;
+} B_Tree_F32_32_Counters;
+
+static _Thread_local B_Tree_F32_32_Counters B_Tree_F32_32_counters;
+
+#define B_Tree_F32_32_COUNT(counter, n) (B_Tree_F32_32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define B_Tree_F32_32_COUNT_MAX(counter, value) \
+    (B_Tree_F32_32_counters.counter = ((u64)(value) > B_Tree_F32_32_counters.counter) ? \
+        (u64)(value) : B_Tree_F32_32_counters.counter)
+
+static inline void
+B_Tree_F32_32_dump_counters(FILE *file)
+{
+    fprintf(file, "B_Tree_F32_32:");
+    fprintf(file, " lookups %llu", (unsigned long long)B_Tree_F32_32_counters.lookups);
+    fprintf(file, " inner_nodes_visited %llu", (unsigned long long)B_Tree_F32_32_counters.inner_nodes_visited);
+    fprintf(file, " leaf_splits %llu", (unsigned long long)B_Tree_F32_32_counters.leaf_splits);
+    fprintf(file, " inner_splits %llu", (unsigned long long)B_Tree_F32_32_counters.inner_splits);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)B_Tree_F32_32_counters.allocated_bytes);
+    fprintf(file, "\n");
+}
+
+static inline void
+B_Tree_F32_32_reset_counters(void)
+{
+    B_Tree_F32_32_counters = (B_Tree_F32_32_Counters){0};
+}
+#else
+#define B_Tree_F32_32_COUNT(counter, n) ((void)0)
+#define B_Tree_F32_32_COUNT_MAX(counter, value) ((void)0)
+#define B_Tree_F32_32_dump_counters(file) ((void)0)
+#define B_Tree_F32_32_reset_counters() ((void)0)
+#endif
+
+typedef struct B_Tree_F32_32_Cursor
+{
+    B_Tree_Leaf_f32_u32_32 *leaf;
+    u32 index;
+} B_Tree_F32_32_Cursor;
+
+/* child of an inner node that can contain key */
+static inline u32
+B_Tree_F32_32_child_index(B_Tree_Inner_f32_32 *inner, f32 key)
+{
+    u32 index = 0;
+    for (u32 i = 1; i < inner->count; ++i)
+    {
+        index += (inner->keys[i] <= key);
+    }
+    return index;
+}
+
+/* number of keys in a leaf that are less than key */
+static inline u32
+B_Tree_F32_32_leaf_index(B_Tree_Leaf_f32_u32_32 *leaf, f32 key)
+{
+    u32 index = 0;
+    for (u32 i = 0; i < leaf->count; ++i)
+    {
+        index += (leaf->keys[i] < key);
+    }
+    return index;
+}
+
+static inline B_Tree_Leaf_f32_u32_32 *
+B_Tree_F32_32_find_leaf(B_Tree_F32_32 *tree, f32 key)
+{
+    void *node = tree->root;
+    B_Tree_F32_32_COUNT(lookups, 1);
+    B_Tree_F32_32_COUNT(inner_nodes_visited, tree->height);
+    
+    for (u32 level = tree->height; level > 0; --level)
+    {
+        B_Tree_Inner_f32_32 *inner = node;
+        node = inner->children[B_Tree_F32_32_child_index(inner, key)];
+    }
+    
+    return node;
+}
+
+static inline u32 *
+B_Tree_F32_32_find(B_Tree_F32_32 *tree, f32 key)
+{
+    if (!tree->root)
+    {
+        return 0;
+    }
+    
+    B_Tree_Leaf_f32_u32_32 *leaf = B_Tree_F32_32_find_leaf(tree, key);
+    u32 index = B_Tree_F32_32_leaf_index(leaf, key);
+    
+    return (index < leaf->count && leaf->keys[index] == key) ? &leaf->values[index] : 0;
+}
+
+static inline void *
+B_Tree_F32_32_alloc_node(u64 size)
+{
+    void *node = aligned_alloc(64, (size + 63) & ~(u64)63);
+    if (node)
+    {
+        memset(node, 0, size);
+        B_Tree_F32_32_COUNT(allocated_bytes, (size + 63) & ~(u64)63);
+    }
+    return node;
+}
+
+/* inserts or overwrites, returns 0 if a node could not be allocated */
+static inline b32
+B_Tree_F32_32_insert(B_Tree_F32_32 *tree, f32 key, u32 value)
+{
+    if (!tree->root)
+    {
+        tree->root = B_Tree_F32_32_alloc_node(sizeof(B_Tree_Leaf_f32_u32_32));
+        if (!tree->root)
+        {
+            return 0;
+        }
+        tree->first = tree->root;
+    }
+    
+    B_Tree_Inner_f32_32 *path[B_TREE_MAX_HEIGHT];
+    u32 path_index[B_TREE_MAX_HEIGHT];
+    void *node = tree->root;
+    
+    for (u32 level = 0; level < tree->height; ++level)
+    {
+        B_Tree_Inner_f32_32 *inner = node;
+        path[level] = inner;
+        path_index[level] = B_Tree_F32_32_child_index(inner, key);
+        node = inner->children[path_index[level]];
+    }
+    
+    B_Tree_Leaf_f32_u32_32 *leaf = node;
+    u32 index = B_Tree_F32_32_leaf_index(leaf, key);
+    
+    if (index < leaf->count && leaf->keys[index] == key)
+    {
+        leaf->values[index] = value;
+        return 1;
+    }
+    
+    /*
+     every node a split needs is allocated before anything changes, so a
+     failed allocation leaves the tree as it was: a leaf, one inner node
+     per full parent above it, and a root if all of them are full
+     */
+    void *spare[B_TREE_MAX_HEIGHT + 2];
+    u32 spare_num = 0;
+    u32 spare_used = 0;
+    
+    if (leaf->count == 32)
+    {
+        u32 level = tree->height;
+        while (level > 0 && path[level - 1]->count == 32)
+        {
+            --level;
+        }
+        
+        u32 needed = 1 + (tree->height - level) + (level == 0);
+        for (; spare_num < needed; ++spare_num)
+        {
+            spare[spare_num] = B_Tree_F32_32_alloc_node((spare_num == 0) ?
+                sizeof(B_Tree_Leaf_f32_u32_32) : sizeof(B_Tree_Inner_f32_32));
+            if (!spare[spare_num])
+            {
+                while (spare_num > 0)
+                {
+                    free(spare[--spare_num]);
+                }
+                return 0;
+            }
+        }
+    }
+    
+    /* a full leaf gives its upper half to a new leaf on its right */
+    B_Tree_Leaf_f32_u32_32 *target = leaf;
+    void *split = 0;
+    f32 split_key = key;
+    
+    if (leaf->count == 32)
+    {
+        B_Tree_Leaf_f32_u32_32 *right = spare[spare_used++];
+        
+        B_Tree_F32_32_COUNT(leaf_splits, 1);
+        u32 half = 32 / 2;
+        right->count = 32 - half;
+        memcpy(right->keys, leaf->keys + half, right->count * sizeof(f32));
+        memcpy(right->values, leaf->values + half, right->count * sizeof(u32));
+        leaf->count = half;
+        right->next = leaf->next;
+        leaf->next = right;
+        
+        if (index > half)
+        {
+            target = right;
+            index -= half;
+        }
+        split = right;
+        split_key = right->keys[0];
+    }
+    
+    memmove(target->keys + index + 1, target->keys + index,
+            (target->count - index) * sizeof(f32));
+    memmove(target->values + index + 1, target->values + index,
+            (target->count - index) * sizeof(u32));
+    target->keys[index] = key;
+    target->values[index] = value;
+    ++target->count;
+    ++tree->count;
+    
+    /* hand the new node to the parent, splitting full parents on the way up */
+    for (u32 level = tree->height; split && level > 0; --level)
+    {
+        B_Tree_Inner_f32_32 *inner = path[level - 1];
+        u32 position = path_index[level - 1] + 1;
+        B_Tree_Inner_f32_32 *parent = inner;
+        
+        void *new_split = 0;
+        f32 new_split_key = split_key;
+        
+        if (inner->count == 32)
+        {
+            B_Tree_Inner_f32_32 *right = spare[spare_used++];
+            
+            B_Tree_F32_32_COUNT(inner_splits, 1);
+            u32 half = 32 / 2;
+            right->count = 32 - half;
+            memcpy(right->keys, inner->keys + half, right->count * sizeof(f32));
+            memcpy(right->children, inner->children + half,
+                   right->count * sizeof(void *));
+            inner->count = half;
+            
+            if (position > half)
+            {
+                parent = right;
+                position -= half;
+            }
+            new_split = right;
+            new_split_key = right->keys[0];
+        }
+        
+        memmove(parent->keys + position + 1, parent->keys + position,
+                (parent->count - position) * sizeof(f32));
+        memmove(parent->children + position + 1, parent->children + position,
+                (parent->count - position) * sizeof(void *));
+        parent->keys[position] = split_key;
+        parent->children[position] = split;
+        ++parent->count;
+        
+        split = new_split;
+        split_key = new_split_key;
+    }
+    
+    /* the root split, the tree grows by one level */
+    if (split)
+    {
+        B_Tree_Inner_f32_32 *root = spare[spare_used++];
+        root->count = 2;
+        root->children[0] = tree->root;
+        root->children[1] = split;
+        root->keys[1] = split_key;
+        tree->root = root;
+        ++tree->height;
+    }
+    
+    return 1;
+}
+
+static inline void
+B_Tree_F32_32_free_node(void *node, u32 height)
+{
+    if (height > 0)
+    {
+        B_Tree_Inner_f32_32 *inner = node;
+        for (u32 i = 0; i < inner->count; ++i)
+        {
+            B_Tree_F32_32_free_node(inner->children[i], height - 1);
+        }
+    }
+    free(node);
+}
+
+static inline void
+B_Tree_F32_32_free(B_Tree_F32_32 *tree)
+{
+    if (tree->root)
+    {
+        B_Tree_F32_32_free_node(tree->root, tree->height);
+    }
+    tree->root = 0;
+    tree->height = 0;
+    tree->count = 0;
+    tree->first = 0;
+}
+
+/* frees the inner nodes of a subtree, its leaves are freed through the leaf chain */
+static inline void
+B_Tree_F32_32_free_inner(void *node, u32 height)
+{
+    if (height == 0)
+    {
+        return;
+    }
+    
+    B_Tree_Inner_f32_32 *inner = node;
+    for (u32 i = 0; i < inner->count; ++i)
+    {
+        B_Tree_F32_32_free_inner(inner->children[i], height - 1);
+    }
+    free(inner);
+}
+
+/*
+ Replaces the contents with count entries whose keys are sorted and
+ unique. Leaves and inner nodes are filled completely, bottom up.
+ */
+static inline b32
+B_Tree_F32_32_load_sorted(B_Tree_F32_32 *tree, f32 *keys, u32 *values, u64 count)
+{
+    B_Tree_F32_32_free(tree);
+    if (count == 0)
+    {
+        return 1;
+    }
+    
+    u64 node_num = (count + 32 - 1) / 32;
+    void **nodes = malloc(node_num * sizeof(void *));
+    f32 *first_keys = malloc(node_num * sizeof(f32));
+    if (!nodes || !first_keys)
+    {
+        free(nodes);
+        free(first_keys);
+        return 0;
+    }
+    
+    B_Tree_Leaf_f32_u32_32 *previous = 0;
+    for (u64 i = 0; i < node_num; ++i)
+    {
+        B_Tree_Leaf_f32_u32_32 *leaf = B_Tree_F32_32_alloc_node(sizeof(*leaf));
+        if (!leaf)
+        {
+            /* the leaves made so far are linked and freed below */
+            break;
+        }
+        
+        u64 start = i * 32;
+        leaf->count = (u32)((count - start < 32) ? count - start : 32);
+        memcpy(leaf->keys, keys + start, leaf->count * sizeof(f32));
+        memcpy(leaf->values, values + start, leaf->count * sizeof(u32));
+        
+        if (previous)
+        {
+            previous->next = leaf;
+        }
+        else
+        {
+            tree->first = leaf;
+        }
+        previous = leaf;
+        nodes[i] = leaf;
+        first_keys[i] = leaf->keys[0];
+        tree->count += leaf->count;
+    }
+    
+    b32 complete = (tree->count == count);
+    u32 height = 0;
+    
+    while (node_num > 1 && complete)
+    {
+        u64 parent_num = (node_num + 32 - 1) / 32;
+        
+        for (u64 i = 0; i < parent_num; ++i)
+        {
+            B_Tree_Inner_f32_32 *inner = B_Tree_F32_32_alloc_node(sizeof(*inner));
+            if (!inner)
+            {
+                /*
+                 nodes[0, i) are the new parents, nodes[i * 32, node_num)
+                 the children they did not take yet
+                 */
+                for (u64 j = 0; j < i; ++j)
+                {
+                    B_Tree_F32_32_free_inner(nodes[j], height + 1);
+                }
+                for (u64 j = i * 32; j < node_num; ++j)
+                {
+                    B_Tree_F32_32_free_inner(nodes[j], height);
+                }
+                complete = 0;
+                break;
+            }
+            
+            u64 start = i * 32;
+            inner->count = (u32)((node_num - start < 32) ? node_num - start : 32);
+            memcpy(inner->keys, first_keys + start, inner->count * sizeof(f32));
+            memcpy(inner->children, nodes + start, inner->count * sizeof(void *));
+            
+            nodes[i] = inner;
+            first_keys[i] = inner->keys[0];
+        }
+        
+        if (!complete)
+        {
+            break;
+        }
+        node_num = parent_num;
+        ++height;
+    }
+    
+    if (complete)
+    {
+        tree->root = nodes[0];
+        tree->height = height;
+    }
+    
+    free(nodes);
+    free(first_keys);
+    
+    if (!complete)
+    {
+        /* the inner nodes are freed above, the leaves are all on the chain */
+        for (B_Tree_Leaf_f32_u32_32 *leaf = tree->first; leaf;)
+        {
+            B_Tree_Leaf_f32_u32_32 *next = leaf->next;
+            free(leaf);
+            leaf = next;
+        }
+        tree->root = 0;
+        tree->height = 0;
+        tree->count = 0;
+        tree->first = 0;
+        return 0;
+    }
+    
+    return 1;
+}
+
+/* cursor at the first entry whose key is not less than key */
+static inline B_Tree_F32_32_Cursor
+B_Tree_F32_32_lower_bound(B_Tree_F32_32 *tree, f32 key)
+{
+    B_Tree_F32_32_Cursor cursor = {0};
+    
+    if (tree->root)
+    {
+        cursor.leaf = B_Tree_F32_32_find_leaf(tree, key);
+        cursor.index = B_Tree_F32_32_leaf_index(cursor.leaf, key);
+        
+        if (cursor.index == cursor.leaf->count)
+        {
+            cursor.leaf = cursor.leaf->next;
+            cursor.index = 0;
+        }
+    }
+    
+    return cursor;
+}
+
+static inline void
+B_Tree_F32_32_cursor_next(B_Tree_F32_32_Cursor *cursor)
+{
+    if (++cursor->index == cursor->leaf->count)
+    {
+        cursor->leaf = cursor->leaf->next;
+        cursor->index = 0;
+    }
+}
+
+/* visits every entry with first <= key < last, in order */
+#define B_Tree_F32_32_for_range(tree, cursor, first, last) \
+    for (B_Tree_F32_32_Cursor cursor = B_Tree_F32_32_lower_bound((tree), (first)); \
+         cursor.leaf && cursor.leaf->keys[cursor.index] < (last); \
+         B_Tree_F32_32_cursor_next(&cursor))
+
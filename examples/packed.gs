@@ -0,0 +1,16 @@
+~output_ext .h
+
+@template_start Record <- T
+@packed_order
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	u8 flag; // set once the record is valid
+	T value;
+	u16 id, other;
+	@template_name *next;
+};
+@template_end
+
+@template Record -> f64 -> Record_F64
+@template Record -> u8 -> Record_U8
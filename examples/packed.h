@@ -0,0 +1,20 @@
+typedef struct Record_F64 Record_F64;
+struct Record_F64
+{
+	f64 value;
+	Record_F64 *next;
+	u16 id, other;
+	u8 flag; // set once the record is valid
+};
+_Static_assert(sizeof(Record_F64) == 24, "unexpected size of Record_F64");
+
+typedef struct Record_U8 Record_U8;
+struct Record_U8
+{
+	Record_U8 *next;
+	u16 id, other;
+	u8 flag; // set once the record is valid
+	u8 value;
+};
+_Static_assert(sizeof(Record_U8) == 16, "unexpected size of Record_U8");
+
@@ -0,0 +1,34 @@
+~output_ext .h
+
+@template_start Pair <- A, B
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	A first;
+	B second;
+};
+@template_end
+
+@template_start Vec3 <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	T x, y, z;
+};
+@template_end
+
+@template_start Tagged_Record <- Tag, Key, Value
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	Tag tag;
+	Key key;
+	Value value;
+};
+@template_end
+
+@template Vec3 -> f32 -> Vec3f
+@template Pair -> u32, f32 -> Pair_U32_F32
+@template Pair -> u64, Vec3f -> Pair_U64_Vec3f
+
+@template Tagged_Record -> u8, u32, f64 -> Record_U32_F64
@@ -0,0 +1,28 @@
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+	f32 x, y, z;
+};
+
+typedef struct Pair_U32_F32 Pair_U32_F32;
+struct Pair_U32_F32
+{
+	u32 first;
+	f32 second;
+};
+
+typedef struct Pair_U64_Vec3f Pair_U64_Vec3f;
+struct Pair_U64_Vec3f
+{
+	u64 first;
+	Vec3f second;
+};
+
+typedef struct Record_U32_F64 Record_U32_F64;
+struct Record_U32_F64
+{
+	u8 tag;
+	u32 key;
+	f64 value;
+};
+
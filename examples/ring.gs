@@ -0,0 +1,216 @@
+~output_ext .h
+
+@template_start Ring_Slot <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* which lap of the ring may use the slot next */
+    _Atomic u64 sequence;
+    T value;
+};
+@template_end
+
+@template_start Spsc_Ring <- T, N:1024
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    /* producer side: next slot to write and the last head it saw */
+    _Alignas(64) _Atomic u64 tail;
+    u64 cached_head;
+    
+    /* consumer side: next slot to read and the last tail it saw */
+    _Alignas(64) _Atomic u64 head;
+    u64 cached_tail;
+    
+    _Alignas(64) T slots[N];
+};
+@template_end
+
+@template_fn Spsc_Ring <- T, N:1024
+#include <stdatomic.h>
+
+_Static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+/* with GEN_INSTRUMENT; the producer and consumer count in their own threads */
+@instrument pushes, pops, full, empty, index_reloads
+
+/*
+ Bounded queue for one producer and one consumer thread. Each side
+ keeps a copy of the other side's index and only reloads it when the
+ ring looks full or empty, so the shared cache lines move rarely.
+ */
+static inline void
+@template_name_init(@template_name *ring)
+{
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+}
+
+/* producer only, returns 0 if the ring is full */
+static inline b32
+@template_name_push(@template_name *ring, T value)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    
+    if (tail - ring->cached_head == N)
+    {
+        @template_name_COUNT(index_reloads, 1);
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head == N)
+        {
+            @template_name_COUNT(full, 1);
+            return 0;
+        }
+    }
+    
+    ring->slots[tail & (N - 1)] = value;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    @template_name_COUNT(pushes, 1);
+    return 1;
+}
+
+/* consumer only, returns 0 if the ring is empty */
+static inline b32
+@template_name_pop(@template_name *ring, T *value)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    
+    if (head == ring->cached_tail)
+    {
+        @template_name_COUNT(index_reloads, 1);
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail)
+        {
+            @template_name_COUNT(empty, 1);
+            return 0;
+        }
+    }
+    
+    *value = ring->slots[head & (N - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    @template_name_COUNT(pops, 1);
+    return 1;
+}
+@template_end
+
+@template_start Mpmc_Ring <- T, N:1024
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    _Alignas(64) _Atomic u64 tail;
+    _Alignas(64) _Atomic u64 head;
+    _Alignas(64) Ring_Slot<T> slots[N];
+};
+@template_end
+
+@template_fn Mpmc_Ring <- T, N:1024
+#include <stdatomic.h>
+
+_Static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+/* with GEN_INSTRUMENT; retries show contention on head and tail */
+@instrument pushes, pops, full, empty, retries
+
+/*
+ Bounded queue for any number of producers and consumers. Every slot
+ has a sequence number that says whether it is free for the producer
+ of the current lap or filled for its consumer, so threads only
+ contend on the index they advance and on the slot they use.
+ */
+static inline void
+@template_name_init(@template_name *ring)
+{
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    for (u64 i = 0; i < N; ++i)
+    {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+}
+
+/* returns 0 if the ring is full */
+static inline b32
+@template_name_push(@template_name *ring, T value)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    Ring_Slot<T> *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[tail & (N - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - tail);
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            @template_name_COUNT(full, 1);
+            return 0;
+        }
+        else
+        {
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+        @template_name_COUNT(retries, 1);
+    }
+    
+    slot->value = value;
+    atomic_store_explicit(&slot->sequence, tail + 1, memory_order_release);
+    @template_name_COUNT(pushes, 1);
+    return 1;
+}
+
+/* returns 0 if the ring is empty */
+static inline b32
+@template_name_pop(@template_name *ring, T *value)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    Ring_Slot<T> *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[head & (N - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - (head + 1));
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &head, head + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            @template_name_COUNT(empty, 1);
+            return 0;
+        }
+        else
+        {
+            head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+        @template_name_COUNT(retries, 1);
+    }
+    
+    *value = slot->value;
+    atomic_store_explicit(&slot->sequence, head + N, memory_order_release);
+    @template_name_COUNT(pops, 1);
+    return 1;
+}
+@template_end
+
+@template Spsc_Ring -> u64 -> Spsc_Ring_U64
+@template Mpmc_Ring -> u64 -> Mpmc_Ring_U64
+@template Mpmc_Ring -> u32, 256 -> Mpmc_Ring_U32_256
@@ -0,0 +1,450 @@
+typedef struct Spsc_Ring_U64 Spsc_Ring_U64;
+struct Spsc_Ring_U64
+{
+    /* producer side: next slot to write and the last head it saw */
+    _Alignas(64) _Atomic u64 tail;
+    u64 cached_head;
+    
+    /* consumer side: next slot to read and the last tail it saw */
+    _Alignas(64) _Atomic u64 head;
+    u64 cached_tail;
+    
+    _Alignas(64) u64 slots[1024];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((1024 & (1024 - 1)) == 0, "ring size must be a power of two");
+
+/* with GEN_INSTRUMENT; the producer and consumer count in their own threads */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Spsc_Ring_U64 in the calling thread */
+typedef struct Spsc_Ring_U64_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 full;
+    u64 empty;
+    u64 index_reloads;
+} Spsc_Ring_U64_Counters;
+
+static _Thread_local Spsc_Ring_U64_Counters Spsc_Ring_U64_counters;
+
+#define Spsc_Ring_U64_COUNT(counter, n) (Spsc_Ring_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Spsc_Ring_U64_COUNT_MAX(counter, value) \
+    (Spsc_Ring_U64_counters.counter = ((u64)(value) > Spsc_Ring_U64_counters.counter) ? \
+        (u64)(value) : Spsc_Ring_U64_counters.counter)
+
+static inline void
+Spsc_Ring_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "Spsc_Ring_U64:");
+    fprintf(file, " pushes %llu", (unsigned long long)Spsc_Ring_U64_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Spsc_Ring_U64_counters.pops);
+    fprintf(file, " full %llu", (unsigned long long)Spsc_Ring_U64_counters.full);
+    fprintf(file, " empty %llu", (unsigned long long)Spsc_Ring_U64_counters.empty);
+    fprintf(file, " index_reloads %llu", (unsigned long long)Spsc_Ring_U64_counters.index_reloads);
+    fprintf(file, "\n");
+}
+
+static inline void
+Spsc_Ring_U64_reset_counters(void)
+{
+    Spsc_Ring_U64_counters = (Spsc_Ring_U64_Counters){0};
+}
+#else
+#define Spsc_Ring_U64_COUNT(counter, n) ((void)0)
+#define Spsc_Ring_U64_COUNT_MAX(counter, value) ((void)0)
+#define Spsc_Ring_U64_dump_counters(file) ((void)0)
+#define Spsc_Ring_U64_reset_counters() ((void)0)
+#endif
+
+/*
+ Bounded queue for one producer and one consumer thread. Each side
+ keeps a copy of the other side's index and only reloads it when the
+ ring looks full or empty, so the shared cache lines move rarely.
+ */
+static inline void
+Spsc_Ring_U64_init(Spsc_Ring_U64 *ring)
+{
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+}
+
+/* producer only, returns 0 if the ring is full */
+static inline b32
+Spsc_Ring_U64_push(Spsc_Ring_U64 *ring, u64 value)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    
+    if (tail - ring->cached_head == 1024)
+    {
+        Spsc_Ring_U64_COUNT(index_reloads, 1);
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head == 1024)
+        {
+            Spsc_Ring_U64_COUNT(full, 1);
+            return 0;
+        }
+    }
+    
+    ring->slots[tail & (1024 - 1)] = value;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    Spsc_Ring_U64_COUNT(pushes, 1);
+    return 1;
+}
+
+/* consumer only, returns 0 if the ring is empty */
+static inline b32
+Spsc_Ring_U64_pop(Spsc_Ring_U64 *ring, u64 *value)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    
+    if (head == ring->cached_tail)
+    {
+        Spsc_Ring_U64_COUNT(index_reloads, 1);
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail)
+        {
+            Spsc_Ring_U64_COUNT(empty, 1);
+            return 0;
+        }
+    }
+    
+    *value = ring->slots[head & (1024 - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    Spsc_Ring_U64_COUNT(pops, 1);
+    return 1;
+}
+
+typedef struct Ring_Slot_u64 Ring_Slot_u64;
+struct Ring_Slot_u64
+{
+    /* which lap of the ring may use the slot next */
+    _Atomic u64 sequence;
+    u64 value;
+};
+
+typedef struct Mpmc_Ring_U64 Mpmc_Ring_U64;
+struct Mpmc_Ring_U64
+{
+    _Alignas(64) _Atomic u64 tail;
+    _Alignas(64) _Atomic u64 head;
+    _Alignas(64) Ring_Slot_u64 slots[1024];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((1024 & (1024 - 1)) == 0, "ring size must be a power of two");
+
+/* with GEN_INSTRUMENT; retries show contention on head and tail */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Mpmc_Ring_U64 in the calling thread */
+typedef struct Mpmc_Ring_U64_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 full;
+    u64 empty;
+    u64 retries;
+} Mpmc_Ring_U64_Counters;
+
+static _Thread_local Mpmc_Ring_U64_Counters Mpmc_Ring_U64_counters;
+
+#define Mpmc_Ring_U64_COUNT(counter, n) (Mpmc_Ring_U64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Mpmc_Ring_U64_COUNT_MAX(counter, value) \
+    (Mpmc_Ring_U64_counters.counter = ((u64)(value) > Mpmc_Ring_U64_counters.counter) ? \
+        (u64)(value) : Mpmc_Ring_U64_counters.counter)
+
+static inline void
+Mpmc_Ring_U64_dump_counters(FILE *file)
+{
+    fprintf(file, "Mpmc_Ring_U64:");
+    fprintf(file, " pushes %llu", (unsigned long long)Mpmc_Ring_U64_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Mpmc_Ring_U64_counters.pops);
+    fprintf(file, " full %llu", (unsigned long long)Mpmc_Ring_U64_counters.full);
+    fprintf(file, " empty %llu", (unsigned long long)Mpmc_Ring_U64_counters.empty);
+    fprintf(file, " retries %llu", (unsigned long long)Mpmc_Ring_U64_counters.retries);
+    fprintf(file, "\n");
+}
+
+static inline void
+Mpmc_Ring_U64_reset_counters(void)
+{
+    Mpmc_Ring_U64_counters = (Mpmc_Ring_U64_Counters){0};
+}
+#else
+#define Mpmc_Ring_U64_COUNT(counter, n) ((void)0)
+#define Mpmc_Ring_U64_COUNT_MAX(counter, value) ((void)0)
+#define Mpmc_Ring_U64_dump_counters(file) ((void)0)
+#define Mpmc_Ring_U64_reset_counters() ((void)0)
+#endif
+
+/*
+ Bounded queue for any number of producers and consumers. Every slot
+ has a sequence number that says whether it is free for the producer
+ of the current lap or filled for its consumer, so threads only
+ contend on the index they advance and on the slot they use.
+ */
+static inline void
+Mpmc_Ring_U64_init(Mpmc_Ring_U64 *ring)
+{
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    for (u64 i = 0; i < 1024; ++i)
+    {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+}
+
+/* returns 0 if the ring is full */
+static inline b32
+Mpmc_Ring_U64_push(Mpmc_Ring_U64 *ring, u64 value)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    Ring_Slot_u64 *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[tail & (1024 - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - tail);
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            Mpmc_Ring_U64_COUNT(full, 1);
+            return 0;
+        }
+        else
+        {
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+        Mpmc_Ring_U64_COUNT(retries, 1);
+    }
+    
+    slot->value = value;
+    atomic_store_explicit(&slot->sequence, tail + 1, memory_order_release);
+    Mpmc_Ring_U64_COUNT(pushes, 1);
+    return 1;
+}
+
+/* returns 0 if the ring is empty */
+static inline b32
+Mpmc_Ring_U64_pop(Mpmc_Ring_U64 *ring, u64 *value)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    Ring_Slot_u64 *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[head & (1024 - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - (head + 1));
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &head, head + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            Mpmc_Ring_U64_COUNT(empty, 1);
+            return 0;
+        }
+        else
+        {
+            head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+        Mpmc_Ring_U64_COUNT(retries, 1);
+    }
+    
+    *value = slot->value;
+    atomic_store_explicit(&slot->sequence, head + 1024, memory_order_release);
+    Mpmc_Ring_U64_COUNT(pops, 1);
+    return 1;
+}
+
+typedef struct Ring_Slot_u32 Ring_Slot_u32;
+struct Ring_Slot_u32
+{
+    /* which lap of the ring may use the slot next */
+    _Atomic u64 sequence;
+    u32 value;
+};
+
+typedef struct Mpmc_Ring_U32_256 Mpmc_Ring_U32_256;
+struct Mpmc_Ring_U32_256
+{
+    _Alignas(64) _Atomic u64 tail;
+    _Alignas(64) _Atomic u64 head;
+    _Alignas(64) Ring_Slot_u32 slots[256];
+};
+
+#include <stdatomic.h>
+
+_Static_assert((256 & (256 - 1)) == 0, "ring size must be a power of two");
+
+/* with GEN_INSTRUMENT; retries show contention on head and tail */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Mpmc_Ring_U32_256 in the calling thread */
+typedef struct Mpmc_Ring_U32_256_Counters
+{
+    u64 pushes;
+    u64 pops;
+    u64 full;
+    u64 empty;
+    u64 retries;
+} Mpmc_Ring_U32_256_Counters;
+
+static _Thread_local Mpmc_Ring_U32_256_Counters Mpmc_Ring_U32_256_counters;
+
+#define Mpmc_Ring_U32_256_COUNT(counter, n) (Mpmc_Ring_U32_256_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Mpmc_Ring_U32_256_COUNT_MAX(counter, value) \
+    (Mpmc_Ring_U32_256_counters.counter = ((u64)(value) > Mpmc_Ring_U32_256_counters.counter) ? \
+        (u64)(value) : Mpmc_Ring_U32_256_counters.counter)
+
+static inline void
+Mpmc_Ring_U32_256_dump_counters(FILE *file)
+{
+    fprintf(file, "Mpmc_Ring_U32_256:");
+    fprintf(file, " pushes %llu", (unsigned long long)Mpmc_Ring_U32_256_counters.pushes);
+    fprintf(file, " pops %llu", (unsigned long long)Mpmc_Ring_U32_256_counters.pops);
+    fprintf(file, " full %llu", (unsigned long long)Mpmc_Ring_U32_256_counters.full);
+    fprintf(file, " empty %llu", (unsigned long long)Mpmc_Ring_U32_256_counters.empty);
+    fprintf(file, " retries %llu", (unsigned long long)Mpmc_Ring_U32_256_counters.retries);
+    fprintf(file, "\n");
+}
+
+static inline void
+Mpmc_Ring_U32_256_reset_counters(void)
+{
+    Mpmc_Ring_U32_256_counters = (Mpmc_Ring_U32_256_Counters){0};
+}
+#else
+#define Mpmc_Ring_U32_256_COUNT(counter, n) ((void)0)
+#define Mpmc_Ring_U32_256_COUNT_MAX(counter, value) ((void)0)
+#define Mpmc_Ring_U32_256_dump_counters(file) ((void)0)
+#define Mpmc_Ring_U32_256_reset_counters() ((void)0)
+#endif
+
+/*
+ Bounded queue for any number of producers and consumers. Every slot
+ has a sequence number that says whether it is free for the producer
+ of the current lap or filled for its consumer, so threads only
+ contend on the index they advance and on the slot they use.
+ */
+static inline void
+Mpmc_Ring_U32_256_init(Mpmc_Ring_U32_256 *ring)
+{
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    for (u64 i = 0; i < 256; ++i)
+    {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+}
+
+/* returns 0 if the ring is full */
+static inline b32
+Mpmc_Ring_U32_256_push(Mpmc_Ring_U32_256 *ring, u32 value)
+{
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    Ring_Slot_u32 *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[tail & (256 - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - tail);
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            Mpmc_Ring_U32_256_COUNT(full, 1);
+            return 0;
+        }
+        else
+        {
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+        Mpmc_Ring_U32_256_COUNT(retries, 1);
+    }
+    
+    slot->value = value;
+    atomic_store_explicit(&slot->sequence, tail + 1, memory_order_release);
+    Mpmc_Ring_U32_256_COUNT(pushes, 1);
+    return 1;
+}
+
+/* returns 0 if the ring is empty */
+static inline b32
+Mpmc_Ring_U32_256_pop(Mpmc_Ring_U32_256 *ring, u32 *value)
+{
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    Ring_Slot_u32 *slot;
+    
+    for (;;)
+    {
+        slot = &ring->slots[head & (256 - 1)];
+        u64 sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        s64 difference = (s64)(sequence - (head + 1));
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &head, head + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            Mpmc_Ring_U32_256_COUNT(empty, 1);
+            return 0;
+        }
+        else
+        {
+            head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+        Mpmc_Ring_U32_256_COUNT(retries, 1);
+    }
+    
+    *value = slot->value;
+    atomic_store_explicit(&slot->sequence, head + 256, memory_order_release);
+    Mpmc_Ring_U32_256_COUNT(pops, 1);
+    return 1;
+}
+
@@ -0,0 +1,36 @@
+~output_ext .h
+
+@template_start Vec3 <- T
+@serialize
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y, z;
+};
+@template_end
+
+@template_start Vec4 <- T
+@serialize
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y, z, w;
+};
+@template_end
+
+@template_start Particle <- T
+@serialize
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Vec3<T> position;
+    Vec3<T> velocity;
+    u8 kind;
+    u32 id;
+    u16 flags[2];
+};
+@template_end
+
+@template Vec3 -> f32 -> Vec3f
+@template Vec4 -> u8 -> Vec4c
+@template Particle -> f32 -> Particle_F32
@@ -0,0 +1,291 @@
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+    f32 x, y, z;
+};
+
+#ifndef GEN_SERIALIZE_PRELUDE
+#define GEN_SERIALIZE_PRELUDE
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define GEN_LITTLE_ENDIAN 1
+#elif defined(_WIN32)
+#define GEN_LITTLE_ENDIAN 1
+#else
+#define GEN_LITTLE_ENDIAN 0
+#endif
+
+/* one field of a serializable struct */
+typedef struct GenFieldInfo
+{
+    char *name;
+    char *type_name;
+    /* where the field starts in the struct and in the bytes */
+    u64 offset;
+    u64 wire_offset;
+    /* size of one element and number of elements */
+    u64 size;
+    u64 count;
+} GenFieldInfo;
+
+/*
+ Copies count numbers of size bytes between memory and their
+ little-endian form. The byte loops compile to plain loads and
+ stores on little-endian machines and to byte swaps elsewhere.
+ */
+static inline void
+GenStoreLittleEndian(u8 *to, u8 *from, u64 size, u64 count)
+{
+    for (u64 i = 0; i < count; ++i, to += size, from += size)
+    {
+        u64 bits = 0;
+        switch (size)
+        {
+            case 1: { u8 x; memcpy(&x, from, 1); bits = x; } break;
+            case 2: { u16 x; memcpy(&x, from, 2); bits = x; } break;
+            case 4: { u32 x; memcpy(&x, from, 4); bits = x; } break;
+            default: { memcpy(&bits, from, 8); } break;
+        }
+        for (u64 byte = 0; byte < size; ++byte)
+        {
+            to[byte] = (u8)(bits >> (8 * byte));
+        }
+    }
+}
+
+static inline void
+GenLoadLittleEndian(u8 *to, u8 *from, u64 size, u64 count)
+{
+    for (u64 i = 0; i < count; ++i, to += size, from += size)
+    {
+        u64 bits = 0;
+        for (u64 byte = 0; byte < size; ++byte)
+        {
+            bits |= (u64)from[byte] << (8 * byte);
+        }
+        switch (size)
+        {
+            case 1: { u8 x = (u8)bits; memcpy(to, &x, 1); } break;
+            case 2: { u16 x = (u16)bits; memcpy(to, &x, 2); } break;
+            case 4: { u32 x = (u32)bits; memcpy(to, &x, 4); } break;
+            default: { memcpy(to, &bits, 8); } break;
+        }
+    }
+}
+#endif
+
+#define Vec3f_WIRE_SIZE 12
+
+static inline GenFieldInfo *
+Vec3f_fields(u32 *field_num)
+{
+    static GenFieldInfo fields[] =
+    {
+        {"x", "f32", offsetof(Vec3f, x), 0, 4, 1},
+        {"y", "f32", offsetof(Vec3f, y), 4, 4, 1},
+        {"z", "f32", offsetof(Vec3f, z), 8, 4, 1},
+    };
+    *field_num = 3;
+    return fields;
+}
+
+/* writes Vec3f_WIRE_SIZE bytes */
+static inline void
+Vec3f_serialize(Vec3f *value, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(buffer, value, sizeof(*value));
+#else
+    u8 *memory = (u8 *)value;
+    GenStoreLittleEndian(buffer + 0, memory + offsetof(Vec3f, x), 4, 1);
+    GenStoreLittleEndian(buffer + 4, memory + offsetof(Vec3f, y), 4, 1);
+    GenStoreLittleEndian(buffer + 8, memory + offsetof(Vec3f, z), 4, 1);
+#endif
+}
+
+static inline void
+Vec3f_deserialize(Vec3f *value, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(value, buffer, sizeof(*value));
+#else
+    u8 *memory = (u8 *)value;
+    GenLoadLittleEndian(memory + offsetof(Vec3f, x), buffer + 0, 4, 1);
+    GenLoadLittleEndian(memory + offsetof(Vec3f, y), buffer + 4, 4, 1);
+    GenLoadLittleEndian(memory + offsetof(Vec3f, z), buffer + 8, 4, 1);
+#endif
+}
+
+static inline void
+Vec3f_serialize_array(Vec3f *values, u64 count, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(buffer, values, count * sizeof(*values));
+#else
+    for (u64 i = 0; i < count; ++i)
+    {
+        Vec3f_serialize(&values[i], buffer + i * 12);
+    }
+#endif
+}
+
+static inline void
+Vec3f_deserialize_array(Vec3f *values, u64 count, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(values, buffer, count * sizeof(*values));
+#else
+    for (u64 i = 0; i < count; ++i)
+    {
+        Vec3f_deserialize(&values[i], buffer + i * 12);
+    }
+#endif
+}
+
+typedef struct Vec4c Vec4c;
+struct Vec4c
+{
+    u8 x, y, z, w;
+};
+
+#define Vec4c_WIRE_SIZE 4
+
+static inline GenFieldInfo *
+Vec4c_fields(u32 *field_num)
+{
+    static GenFieldInfo fields[] =
+    {
+        {"x", "u8", offsetof(Vec4c, x), 0, 1, 1},
+        {"y", "u8", offsetof(Vec4c, y), 1, 1, 1},
+        {"z", "u8", offsetof(Vec4c, z), 2, 1, 1},
+        {"w", "u8", offsetof(Vec4c, w), 3, 1, 1},
+    };
+    *field_num = 4;
+    return fields;
+}
+
+/* writes Vec4c_WIRE_SIZE bytes */
+static inline void
+Vec4c_serialize(Vec4c *value, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(buffer, value, sizeof(*value));
+#else
+    u8 *memory = (u8 *)value;
+    GenStoreLittleEndian(buffer + 0, memory + offsetof(Vec4c, x), 1, 1);
+    GenStoreLittleEndian(buffer + 1, memory + offsetof(Vec4c, y), 1, 1);
+    GenStoreLittleEndian(buffer + 2, memory + offsetof(Vec4c, z), 1, 1);
+    GenStoreLittleEndian(buffer + 3, memory + offsetof(Vec4c, w), 1, 1);
+#endif
+}
+
+static inline void
+Vec4c_deserialize(Vec4c *value, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(value, buffer, sizeof(*value));
+#else
+    u8 *memory = (u8 *)value;
+    GenLoadLittleEndian(memory + offsetof(Vec4c, x), buffer + 0, 1, 1);
+    GenLoadLittleEndian(memory + offsetof(Vec4c, y), buffer + 1, 1, 1);
+    GenLoadLittleEndian(memory + offsetof(Vec4c, z), buffer + 2, 1, 1);
+    GenLoadLittleEndian(memory + offsetof(Vec4c, w), buffer + 3, 1, 1);
+#endif
+}
+
+static inline void
+Vec4c_serialize_array(Vec4c *values, u64 count, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(buffer, values, count * sizeof(*values));
+#else
+    for (u64 i = 0; i < count; ++i)
+    {
+        Vec4c_serialize(&values[i], buffer + i * 4);
+    }
+#endif
+}
+
+static inline void
+Vec4c_deserialize_array(Vec4c *values, u64 count, u8 *buffer)
+{
+#if GEN_LITTLE_ENDIAN
+    memcpy(values, buffer, count * sizeof(*values));
+#else
+    for (u64 i = 0; i < count; ++i)
+    {
+        Vec4c_deserialize(&values[i], buffer + i * 4);
+    }
+#endif
+}
+
+typedef struct Particle_F32 Particle_F32;
+struct Particle_F32
+{
+    Vec3f position;
+    Vec3f velocity;
+    u8 kind;
+    u32 id;
+    u16 flags[2];
+};
+
+#define Particle_F32_WIRE_SIZE 33
+
+static inline GenFieldInfo *
+Particle_F32_fields(u32 *field_num)
+{
+    static GenFieldInfo fields[] =
+    {
+        {"position", "Vec3f", offsetof(Particle_F32, position), 0, 12, 1},
+        {"velocity", "Vec3f", offsetof(Particle_F32, velocity), 12, 12, 1},
+        {"kind", "u8", offsetof(Particle_F32, kind), 24, 1, 1},
+        {"id", "u32", offsetof(Particle_F32, id), 25, 4, 1},
+        {"flags", "u16", offsetof(Particle_F32, flags), 29, 2, 2},
+    };
+    *field_num = 5;
+    return fields;
+}
+
+/* writes Particle_F32_WIRE_SIZE bytes */
+static inline void
+Particle_F32_serialize(Particle_F32 *value, u8 *buffer)
+{
+    u8 *memory = (u8 *)value;
+    Vec3f_serialize((Vec3f *)(memory + offsetof(Particle_F32, position)), buffer + 0);
+    Vec3f_serialize((Vec3f *)(memory + offsetof(Particle_F32, velocity)), buffer + 12);
+    GenStoreLittleEndian(buffer + 24, memory + offsetof(Particle_F32, kind), 1, 1);
+    GenStoreLittleEndian(buffer + 25, memory + offsetof(Particle_F32, id), 4, 1);
+    GenStoreLittleEndian(buffer + 29, memory + offsetof(Particle_F32, flags), 2, 2);
+}
+
+static inline void
+Particle_F32_deserialize(Particle_F32 *value, u8 *buffer)
+{
+    u8 *memory = (u8 *)value;
+    Vec3f_deserialize((Vec3f *)(memory + offsetof(Particle_F32, position)), buffer + 0);
+    Vec3f_deserialize((Vec3f *)(memory + offsetof(Particle_F32, velocity)), buffer + 12);
+    GenLoadLittleEndian(memory + offsetof(Particle_F32, kind), buffer + 24, 1, 1);
+    GenLoadLittleEndian(memory + offsetof(Particle_F32, id), buffer + 25, 4, 1);
+    GenLoadLittleEndian(memory + offsetof(Particle_F32, flags), buffer + 29, 2, 2);
+}
+
+static inline void
+Particle_F32_serialize_array(Particle_F32 *values, u64 count, u8 *buffer)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        Particle_F32_serialize(&values[i], buffer + i * 33);
+    }
+}
+
+static inline void
+Particle_F32_deserialize_array(Particle_F32 *values, u64 count, u8 *buffer)
+{
+    for (u64 i = 0; i < count; ++i)
+    {
+        Particle_F32_deserialize(&values[i], buffer + i * 33);
+    }
+}
+
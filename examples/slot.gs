@@ -0,0 +1,21 @@
+~output_ext .h
+
+@template_start Slot <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+@if size(T) <= 8
+	T value;
+@else
+	T *value;
+@endif
+	u32 generation;
+@if is_float(T) || is_pointer(T)
+	b32 is_set;
+@endif
+};
+@template_end
+
+@template Slot -> u64 -> Slot_U64
+@template Slot -> f32 -> Slot_F32
+@template Slot -> Slot_U64 -> Slot_Slot_U64
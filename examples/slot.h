@@ -0,0 +1,22 @@
+typedef struct Slot_U64 Slot_U64;
+struct Slot_U64
+{
+	u64 value;
+	u32 generation;
+};
+
+typedef struct Slot_F32 Slot_F32;
+struct Slot_F32
+{
+	f32 value;
+	u32 generation;
+	b32 is_set;
+};
+
+typedef struct Slot_Slot_U64 Slot_Slot_U64;
+struct Slot_Slot_U64
+{
+	Slot_U64 *value;
+	u32 generation;
+};
+
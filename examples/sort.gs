@@ -0,0 +1,348 @@
+~output_ext .h
+
+@template_start Vec3 <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y, z;
+};
+@template_end
+
+@template_fn Sort <- T, K, KEY
+#include <string.h>
+
+/*
+ Sorting and searching for arrays ordered by a key field of the
+ elements, or by the elements themselves for plain numbers.
+ Comparisons are inlined instead of going through a comparator
+ pointer as with qsort.
+ */
+#ifndef SORT_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define SORT_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* with GEN_INSTRUMENT, how often each algorithm ran in this thread */
+@instrument sorts, sorted_elements, insertion_sorts, heap_sort_fallbacks, radix_passes, radix_passes_skipped, searches
+
+static inline K
+@template_name_key(T *element)
+{
+@if is_integer(T) || is_float(T) || is_pointer(T)
+    return *element;
+@else
+    return SORT_FIELD(element, KEY);
+@endif
+}
+
+/*
+ Insertion sort for short runs. The position of each element is
+ counted without branches, then the larger ones move up at once.
+ */
+static inline void
+@template_name_insertion_sort(T *array, u64 count)
+{
+    @template_name_COUNT(insertion_sorts, 1);
+    for (u64 i = 1; i < count; ++i)
+    {
+        T value = array[i];
+        K key = @template_name_key(&value);
+        
+        u64 position = 0;
+        for (u64 j = 0; j < i; ++j)
+        {
+            position += (@template_name_key(&array[j]) <= key);
+        }
+        
+        memmove(array + position + 1, array + position, (i - position) * sizeof(T));
+        array[position] = value;
+    }
+}
+
+static inline void
+@template_name_swap(T *a, T *b)
+{
+    T temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void
+@template_name_sift_down(T *array, u64 root, u64 count)
+{
+    for (;;)
+    {
+        u64 child = 2 * root + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        
+        if (child + 1 < count &&
+            @template_name_key(&array[child]) < @template_name_key(&array[child + 1]))
+        {
+            ++child;
+        }
+        
+        if (!(@template_name_key(&array[root]) < @template_name_key(&array[child])))
+        {
+            return;
+        }
+        
+        @template_name_swap(&array[root], &array[child]);
+        root = child;
+    }
+}
+
+static inline void
+@template_name_heap_sort(T *array, u64 count)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        @template_name_sift_down(array, i - 1, count);
+    }
+    
+    for (u64 end = count; end > 1; --end)
+    {
+        @template_name_swap(&array[0], &array[end - 1]);
+        @template_name_sift_down(array, 0, end - 1);
+    }
+}
+
+/* runs at most this long are finished with insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* quicksort that falls back to heap sort when it recurses too deep */
+static inline void
+@template_name_introsort(T *array, u64 count, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit-- == 0)
+        {
+            @template_name_COUNT(heap_sort_fallbacks, 1);
+            @template_name_heap_sort(array, count);
+            return;
+        }
+        
+        /* median of three ends up at the front as the pivot */
+        u64 middle = count / 2;
+        if (@template_name_key(&array[middle]) < @template_name_key(&array[0]))
+        {
+            @template_name_swap(&array[middle], &array[0]);
+        }
+        if (@template_name_key(&array[count - 1]) < @template_name_key(&array[middle]))
+        {
+            @template_name_swap(&array[count - 1], &array[middle]);
+            if (@template_name_key(&array[middle]) < @template_name_key(&array[0]))
+            {
+                @template_name_swap(&array[middle], &array[0]);
+            }
+        }
+        @template_name_swap(&array[0], &array[middle]);
+        K pivot = @template_name_key(&array[0]);
+        
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            while (@template_name_key(&array[++i]) < pivot)
+            {
+            }
+            while (pivot < @template_name_key(&array[--j]))
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            @template_name_swap(&array[i], &array[j]);
+        }
+        @template_name_swap(&array[0], &array[j]);
+        
+        /* recurse into the smaller side, loop on the larger one */
+        if (j < count - j - 1)
+        {
+            @template_name_introsort(array, j, depth_limit);
+            array += j + 1;
+            count -= j + 1;
+        }
+        else
+        {
+            @template_name_introsort(array + j + 1, count - j - 1, depth_limit);
+            count = j;
+        }
+    }
+    
+    @template_name_insertion_sort(array, count);
+}
+
+static inline void
+@template_name_sort(T *array, u64 count)
+{
+    @template_name_COUNT(sorts, 1);
+    @template_name_COUNT(sorted_elements, count);
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n /= 2)
+    {
+        depth_limit += 2;
+    }
+    
+    @template_name_introsort(array, count, depth_limit);
+}
+@if is_integer(K) || is_float(K)
+
+/* key bits in an order where unsigned comparison sorts like K */
+static inline u64
+@template_name_radix_key(T *element)
+{
+    K key = @template_name_key(element);
+@if is_float(K)
+@if size(K) == 4
+    u32 bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x80000000u) ? (u32)~bits : (bits | 0x80000000u);
+@else
+    u64 bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+@endif
+@else
+    u64 bits = (u64)key & (~(u64)0 >> (64 - 8 * sizeof(K)));
+@if is_signed(K)
+    bits ^= (u64)1 << (8 * sizeof(K) - 1);
+@endif
+    return bits;
+@endif
+}
+
+/*
+ Stable LSD radix sort, one byte of the key per pass. scratch has
+ room for count elements. Passes where every key has the same byte
+ are skipped.
+ */
+static inline void
+@template_name_radix_sort(T *array, T *scratch, u64 count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    @template_name_COUNT(sorts, 1);
+    @template_name_COUNT(sorted_elements, count);
+    
+    u64 histograms[sizeof(K)][256];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        u64 bits = @template_name_radix_key(&array[i]);
+        for (u32 digit = 0; digit < sizeof(K); ++digit)
+        {
+            ++histograms[digit][(bits >> (8 * digit)) & 0xFF];
+        }
+    }
+    
+    T *from = array;
+    T *to = scratch;
+    
+    for (u32 digit = 0; digit < sizeof(K); ++digit)
+    {
+        u64 *histogram = histograms[digit];
+        u32 shift = 8 * digit;
+        
+        u64 first = (@template_name_radix_key(&from[0]) >> shift) & 0xFF;
+        if (histogram[first] == count)
+        {
+            @template_name_COUNT(radix_passes_skipped, 1);
+            continue;
+        }
+        @template_name_COUNT(radix_passes, 1);
+        
+        u64 offset = 0;
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u64 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 byte = (@template_name_radix_key(&from[i]) >> shift) & 0xFF;
+            to[histogram[byte]++] = from[i];
+        }
+        
+        T *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != array)
+    {
+        memcpy(array, from, count * sizeof(T));
+    }
+}
+@endif
+
+/* index of the first element whose key is not less than key */
+static inline u64
+@template_name_lower_bound(T *array, u64 count, K key)
+{
+    @template_name_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    T *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (@template_name_key(&base[half - 1]) < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - array) + (@template_name_key(base) < key);
+}
+
+/* index of the first element whose key is greater than key */
+static inline u64
+@template_name_upper_bound(T *array, u64 count, K key)
+{
+    @template_name_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    T *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (key < @template_name_key(&base[half - 1])) ? base : base + half;
+        count -= half;
+    }
+    
+    return (base - array) + !(key < @template_name_key(base));
+}
+
+/* an element with the key, or 0 */
+static inline T *
+@template_name_search(T *array, u64 count, K key)
+{
+    u64 index = @template_name_lower_bound(array, count, key);
+    
+    return (index < count && !(key < @template_name_key(&array[index]))) ?
+        &array[index] : 0;
+}
+@template_end
+
+@template Vec3 -> f32 -> Vec3f
+
+@template Sort -> u32, u32, _ -> Sort_U32
+@template Sort -> s64, s64, _ -> Sort_S64
+@template Sort -> f64, f64, _ -> Sort_F64
+@template Sort -> Vec3f, f32, x -> Sort_Vec3f_X
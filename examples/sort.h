@@ -0,0 +1,1433 @@
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+    f32 x, y, z;
+};
+
+#include <string.h>
+
+/*
+ Sorting and searching for arrays ordered by a key field of the
+ elements, or by the elements themselves for plain numbers.
+ Comparisons are inlined instead of going through a comparator
+ pointer as with qsort.
+ */
+#ifndef SORT_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define SORT_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* with GEN_INSTRUMENT, how often each algorithm ran in this thread */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Sort_U32 in the calling thread */
+typedef struct Sort_U32_Counters
+{
+    u64 sorts;
+    u64 sorted_elements;
+    u64 insertion_sorts;
+    u64 heap_sort_fallbacks;
+    u64 radix_passes;
+    u64 radix_passes_skipped;
+    u64 searches;
+} Sort_U32_Counters;
+
+static _Thread_local Sort_U32_Counters Sort_U32_counters;
+
+#define Sort_U32_COUNT(counter, n) (Sort_U32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Sort_U32_COUNT_MAX(counter, value) \
+    (Sort_U32_counters.counter = ((u64)(value) > Sort_U32_counters.counter) ? \
+        (u64)(value) : Sort_U32_counters.counter)
+
+static inline void
+Sort_U32_dump_counters(FILE *file)
+{
+    fprintf(file, "Sort_U32:");
+    fprintf(file, " sorts %llu", (unsigned long long)Sort_U32_counters.sorts);
+    fprintf(file, " sorted_elements %llu", (unsigned long long)Sort_U32_counters.sorted_elements);
+    fprintf(file, " insertion_sorts %llu", (unsigned long long)Sort_U32_counters.insertion_sorts);
+    fprintf(file, " heap_sort_fallbacks %llu", (unsigned long long)Sort_U32_counters.heap_sort_fallbacks);
+    fprintf(file, " radix_passes %llu", (unsigned long long)Sort_U32_counters.radix_passes);
+    fprintf(file, " radix_passes_skipped %llu", (unsigned long long)Sort_U32_counters.radix_passes_skipped);
+    fprintf(file, " searches %llu", (unsigned long long)Sort_U32_counters.searches);
+    fprintf(file, "\n");
+}
+
+static inline void
+Sort_U32_reset_counters(void)
+{
+    Sort_U32_counters = (Sort_U32_Counters){0};
+}
+#else
+#define Sort_U32_COUNT(counter, n) ((void)0)
+#define Sort_U32_COUNT_MAX(counter, value) ((void)0)
+#define Sort_U32_dump_counters(file) ((void)0)
+#define Sort_U32_reset_counters() ((void)0)
+#endif
+
+static inline u32
+Sort_U32_key(u32 *element)
+{
+    return *element;
+}
+
+/*
+ Insertion sort for short runs. The position of each element is
+ counted without branches, then the larger ones move up at once.
+ */
+static inline void
+Sort_U32_insertion_sort(u32 *array, u64 count)
+{
+    Sort_U32_COUNT(insertion_sorts, 1);
+    for (u64 i = 1; i < count; ++i)
+    {
+        u32 value = array[i];
+        u32 key = Sort_U32_key(&value);
+        
+        u64 position = 0;
+        for (u64 j = 0; j < i; ++j)
+        {
+            position += (Sort_U32_key(&array[j]) <= key);
+        }
+        
+        memmove(array + position + 1, array + position, (i - position) * sizeof(u32));
+        array[position] = value;
+    }
+}
+
+static inline void
+Sort_U32_swap(u32 *a, u32 *b)
+{
+    u32 temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void
+Sort_U32_sift_down(u32 *array, u64 root, u64 count)
+{
+    for (;;)
+    {
+        u64 child = 2 * root + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        
+        if (child + 1 < count &&
+            Sort_U32_key(&array[child]) < Sort_U32_key(&array[child + 1]))
+        {
+            ++child;
+        }
+        
+        if (!(Sort_U32_key(&array[root]) < Sort_U32_key(&array[child])))
+        {
+            return;
+        }
+        
+        Sort_U32_swap(&array[root], &array[child]);
+        root = child;
+    }
+}
+
+static inline void
+Sort_U32_heap_sort(u32 *array, u64 count)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        Sort_U32_sift_down(array, i - 1, count);
+    }
+    
+    for (u64 end = count; end > 1; --end)
+    {
+        Sort_U32_swap(&array[0], &array[end - 1]);
+        Sort_U32_sift_down(array, 0, end - 1);
+    }
+}
+
+/* runs at most this long are finished with insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* quicksort that falls back to heap sort when it recurses too deep */
+static inline void
+Sort_U32_introsort(u32 *array, u64 count, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit-- == 0)
+        {
+            Sort_U32_COUNT(heap_sort_fallbacks, 1);
+            Sort_U32_heap_sort(array, count);
+            return;
+        }
+        
+        /* median of three ends up at the front as the pivot */
+        u64 middle = count / 2;
+        if (Sort_U32_key(&array[middle]) < Sort_U32_key(&array[0]))
+        {
+            Sort_U32_swap(&array[middle], &array[0]);
+        }
+        if (Sort_U32_key(&array[count - 1]) < Sort_U32_key(&array[middle]))
+        {
+            Sort_U32_swap(&array[count - 1], &array[middle]);
+            if (Sort_U32_key(&array[middle]) < Sort_U32_key(&array[0]))
+            {
+                Sort_U32_swap(&array[middle], &array[0]);
+            }
+        }
+        Sort_U32_swap(&array[0], &array[middle]);
+        u32 pivot = Sort_U32_key(&array[0]);
+        
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            while (Sort_U32_key(&array[++i]) < pivot)
+            {
+            }
+            while (pivot < Sort_U32_key(&array[--j]))
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            Sort_U32_swap(&array[i], &array[j]);
+        }
+        Sort_U32_swap(&array[0], &array[j]);
+        
+        /* recurse into the smaller side, loop on the larger one */
+        if (j < count - j - 1)
+        {
+            Sort_U32_introsort(array, j, depth_limit);
+            array += j + 1;
+            count -= j + 1;
+        }
+        else
+        {
+            Sort_U32_introsort(array + j + 1, count - j - 1, depth_limit);
+            count = j;
+        }
+    }
+    
+    Sort_U32_insertion_sort(array, count);
+}
+
+static inline void
+Sort_U32_sort(u32 *array, u64 count)
+{
+    Sort_U32_COUNT(sorts, 1);
+    Sort_U32_COUNT(sorted_elements, count);
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n /= 2)
+    {
+        depth_limit += 2;
+    }
+    
+    Sort_U32_introsort(array, count, depth_limit);
+}
+
+/* key bits in an order where unsigned comparison sorts like u32 */
+static inline u64
+Sort_U32_radix_key(u32 *element)
+{
+    u32 key = Sort_U32_key(element);
+    u64 bits = (u64)key & (~(u64)0 >> (64 - 8 * sizeof(u32)));
+    return bits;
+}
+
+/*
+ Stable LSD radix sort, one byte of the key per pass. scratch has
+ room for count elements. Passes where every key has the same byte
+ are skipped.
+ */
+static inline void
+Sort_U32_radix_sort(u32 *array, u32 *scratch, u64 count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    Sort_U32_COUNT(sorts, 1);
+    Sort_U32_COUNT(sorted_elements, count);
+    
+    u64 histograms[sizeof(u32)][256];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        u64 bits = Sort_U32_radix_key(&array[i]);
+        for (u32 digit = 0; digit < sizeof(u32); ++digit)
+        {
+            ++histograms[digit][(bits >> (8 * digit)) & 0xFF];
+        }
+    }
+    
+    u32 *from = array;
+    u32 *to = scratch;
+    
+    for (u32 digit = 0; digit < sizeof(u32); ++digit)
+    {
+        u64 *histogram = histograms[digit];
+        u32 shift = 8 * digit;
+        
+        u64 first = (Sort_U32_radix_key(&from[0]) >> shift) & 0xFF;
+        if (histogram[first] == count)
+        {
+            Sort_U32_COUNT(radix_passes_skipped, 1);
+            continue;
+        }
+        Sort_U32_COUNT(radix_passes, 1);
+        
+        u64 offset = 0;
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u64 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 byte = (Sort_U32_radix_key(&from[i]) >> shift) & 0xFF;
+            to[histogram[byte]++] = from[i];
+        }
+        
+        u32 *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != array)
+    {
+        memcpy(array, from, count * sizeof(u32));
+    }
+}
+
+/* index of the first element whose key is not less than key */
+static inline u64
+Sort_U32_lower_bound(u32 *array, u64 count, u32 key)
+{
+    Sort_U32_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    u32 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (Sort_U32_key(&base[half - 1]) < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - array) + (Sort_U32_key(base) < key);
+}
+
+/* index of the first element whose key is greater than key */
+static inline u64
+Sort_U32_upper_bound(u32 *array, u64 count, u32 key)
+{
+    Sort_U32_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    u32 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (key < Sort_U32_key(&base[half - 1])) ? base : base + half;
+        count -= half;
+    }
+    
+    return (base - array) + !(key < Sort_U32_key(base));
+}
+
+/* an element with the key, or 0 */
+static inline u32 *
+Sort_U32_search(u32 *array, u64 count, u32 key)
+{
+    u64 index = Sort_U32_lower_bound(array, count, key);
+    
+    return (index < count && !(key < Sort_U32_key(&array[index]))) ?
+        &array[index] : 0;
+}
+
+#include <string.h>
+
+/*
+ Sorting and searching for arrays ordered by a key field of the
+ elements, or by the elements themselves for plain numbers.
+ Comparisons are inlined instead of going through a comparator
+ pointer as with qsort.
+ */
+#ifndef SORT_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define SORT_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* with GEN_INSTRUMENT, how often each algorithm ran in this thread */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Sort_S64 in the calling thread */
+typedef struct Sort_S64_Counters
+{
+    u64 sorts;
+    u64 sorted_elements;
+    u64 insertion_sorts;
+    u64 heap_sort_fallbacks;
+    u64 radix_passes;
+    u64 radix_passes_skipped;
+    u64 searches;
+} Sort_S64_Counters;
+
+static _Thread_local Sort_S64_Counters Sort_S64_counters;
+
+#define Sort_S64_COUNT(counter, n) (Sort_S64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Sort_S64_COUNT_MAX(counter, value) \
+    (Sort_S64_counters.counter = ((u64)(value) > Sort_S64_counters.counter) ? \
+        (u64)(value) : Sort_S64_counters.counter)
+
+static inline void
+Sort_S64_dump_counters(FILE *file)
+{
+    fprintf(file, "Sort_S64:");
+    fprintf(file, " sorts %llu", (unsigned long long)Sort_S64_counters.sorts);
+    fprintf(file, " sorted_elements %llu", (unsigned long long)Sort_S64_counters.sorted_elements);
+    fprintf(file, " insertion_sorts %llu", (unsigned long long)Sort_S64_counters.insertion_sorts);
+    fprintf(file, " heap_sort_fallbacks %llu", (unsigned long long)Sort_S64_counters.heap_sort_fallbacks);
+    fprintf(file, " radix_passes %llu", (unsigned long long)Sort_S64_counters.radix_passes);
+    fprintf(file, " radix_passes_skipped %llu", (unsigned long long)Sort_S64_counters.radix_passes_skipped);
+    fprintf(file, " searches %llu", (unsigned long long)Sort_S64_counters.searches);
+    fprintf(file, "\n");
+}
+
+static inline void
+Sort_S64_reset_counters(void)
+{
+    Sort_S64_counters = (Sort_S64_Counters){0};
+}
+#else
+#define Sort_S64_COUNT(counter, n) ((void)0)
+#define Sort_S64_COUNT_MAX(counter, value) ((void)0)
+#define Sort_S64_dump_counters(file) ((void)0)
+#define Sort_S64_reset_counters() ((void)0)
+#endif
+
+static inline s64
+Sort_S64_key(s64 *element)
+{
+    return *element;
+}
+
+/*
+ Insertion sort for short runs. The position of each element is
+ counted without branches, then the larger ones move up at once.
+ */
+static inline void
+Sort_S64_insertion_sort(s64 *array, u64 count)
+{
+    Sort_S64_COUNT(insertion_sorts, 1);
+    for (u64 i = 1; i < count; ++i)
+    {
+        s64 value = array[i];
+        s64 key = Sort_S64_key(&value);
+        
+        u64 position = 0;
+        for (u64 j = 0; j < i; ++j)
+        {
+            position += (Sort_S64_key(&array[j]) <= key);
+        }
+        
+        memmove(array + position + 1, array + position, (i - position) * sizeof(s64));
+        array[position] = value;
+    }
+}
+
+static inline void
+Sort_S64_swap(s64 *a, s64 *b)
+{
+    s64 temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void
+Sort_S64_sift_down(s64 *array, u64 root, u64 count)
+{
+    for (;;)
+    {
+        u64 child = 2 * root + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        
+        if (child + 1 < count &&
+            Sort_S64_key(&array[child]) < Sort_S64_key(&array[child + 1]))
+        {
+            ++child;
+        }
+        
+        if (!(Sort_S64_key(&array[root]) < Sort_S64_key(&array[child])))
+        {
+            return;
+        }
+        
+        Sort_S64_swap(&array[root], &array[child]);
+        root = child;
+    }
+}
+
+static inline void
+Sort_S64_heap_sort(s64 *array, u64 count)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        Sort_S64_sift_down(array, i - 1, count);
+    }
+    
+    for (u64 end = count; end > 1; --end)
+    {
+        Sort_S64_swap(&array[0], &array[end - 1]);
+        Sort_S64_sift_down(array, 0, end - 1);
+    }
+}
+
+/* runs at most this long are finished with insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* quicksort that falls back to heap sort when it recurses too deep */
+static inline void
+Sort_S64_introsort(s64 *array, u64 count, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit-- == 0)
+        {
+            Sort_S64_COUNT(heap_sort_fallbacks, 1);
+            Sort_S64_heap_sort(array, count);
+            return;
+        }
+        
+        /* median of three ends up at the front as the pivot */
+        u64 middle = count / 2;
+        if (Sort_S64_key(&array[middle]) < Sort_S64_key(&array[0]))
+        {
+            Sort_S64_swap(&array[middle], &array[0]);
+        }
+        if (Sort_S64_key(&array[count - 1]) < Sort_S64_key(&array[middle]))
+        {
+            Sort_S64_swap(&array[count - 1], &array[middle]);
+            if (Sort_S64_key(&array[middle]) < Sort_S64_key(&array[0]))
+            {
+                Sort_S64_swap(&array[middle], &array[0]);
+            }
+        }
+        Sort_S64_swap(&array[0], &array[middle]);
+        s64 pivot = Sort_S64_key(&array[0]);
+        
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            while (Sort_S64_key(&array[++i]) < pivot)
+            {
+            }
+            while (pivot < Sort_S64_key(&array[--j]))
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            Sort_S64_swap(&array[i], &array[j]);
+        }
+        Sort_S64_swap(&array[0], &array[j]);
+        
+        /* recurse into the smaller side, loop on the larger one */
+        if (j < count - j - 1)
+        {
+            Sort_S64_introsort(array, j, depth_limit);
+            array += j + 1;
+            count -= j + 1;
+        }
+        else
+        {
+            Sort_S64_introsort(array + j + 1, count - j - 1, depth_limit);
+            count = j;
+        }
+    }
+    
+    Sort_S64_insertion_sort(array, count);
+}
+
+static inline void
+Sort_S64_sort(s64 *array, u64 count)
+{
+    Sort_S64_COUNT(sorts, 1);
+    Sort_S64_COUNT(sorted_elements, count);
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n /= 2)
+    {
+        depth_limit += 2;
+    }
+    
+    Sort_S64_introsort(array, count, depth_limit);
+}
+
+/* key bits in an order where unsigned comparison sorts like s64 */
+static inline u64
+Sort_S64_radix_key(s64 *element)
+{
+    s64 key = Sort_S64_key(element);
+    u64 bits = (u64)key & (~(u64)0 >> (64 - 8 * sizeof(s64)));
+    bits ^= (u64)1 << (8 * sizeof(s64) - 1);
+    return bits;
+}
+
+/*
+ Stable LSD radix sort, one byte of the key per pass. scratch has
+ room for count elements. Passes where every key has the same byte
+ are skipped.
+ */
+static inline void
+Sort_S64_radix_sort(s64 *array, s64 *scratch, u64 count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    Sort_S64_COUNT(sorts, 1);
+    Sort_S64_COUNT(sorted_elements, count);
+    
+    u64 histograms[sizeof(s64)][256];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        u64 bits = Sort_S64_radix_key(&array[i]);
+        for (u32 digit = 0; digit < sizeof(s64); ++digit)
+        {
+            ++histograms[digit][(bits >> (8 * digit)) & 0xFF];
+        }
+    }
+    
+    s64 *from = array;
+    s64 *to = scratch;
+    
+    for (u32 digit = 0; digit < sizeof(s64); ++digit)
+    {
+        u64 *histogram = histograms[digit];
+        u32 shift = 8 * digit;
+        
+        u64 first = (Sort_S64_radix_key(&from[0]) >> shift) & 0xFF;
+        if (histogram[first] == count)
+        {
+            Sort_S64_COUNT(radix_passes_skipped, 1);
+            continue;
+        }
+        Sort_S64_COUNT(radix_passes, 1);
+        
+        u64 offset = 0;
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u64 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 byte = (Sort_S64_radix_key(&from[i]) >> shift) & 0xFF;
+            to[histogram[byte]++] = from[i];
+        }
+        
+        s64 *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != array)
+    {
+        memcpy(array, from, count * sizeof(s64));
+    }
+}
+
+/* index of the first element whose key is not less than key */
+static inline u64
+Sort_S64_lower_bound(s64 *array, u64 count, s64 key)
+{
+    Sort_S64_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    s64 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (Sort_S64_key(&base[half - 1]) < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - array) + (Sort_S64_key(base) < key);
+}
+
+/* index of the first element whose key is greater than key */
+static inline u64
+Sort_S64_upper_bound(s64 *array, u64 count, s64 key)
+{
+    Sort_S64_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    s64 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (key < Sort_S64_key(&base[half - 1])) ? base : base + half;
+        count -= half;
+    }
+    
+    return (base - array) + !(key < Sort_S64_key(base));
+}
+
+/* an element with the key, or 0 */
+static inline s64 *
+Sort_S64_search(s64 *array, u64 count, s64 key)
+{
+    u64 index = Sort_S64_lower_bound(array, count, key);
+    
+    return (index < count && !(key < Sort_S64_key(&array[index]))) ?
+        &array[index] : 0;
+}
+
+#include <string.h>
+
+/*
+ Sorting and searching for arrays ordered by a key field of the
+ elements, or by the elements themselves for plain numbers.
+ Comparisons are inlined instead of going through a comparator
+ pointer as with qsort.
+ */
+#ifndef SORT_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define SORT_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* with GEN_INSTRUMENT, how often each algorithm ran in this thread */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Sort_F64 in the calling thread */
+typedef struct Sort_F64_Counters
+{
+    u64 sorts;
+    u64 sorted_elements;
+    u64 insertion_sorts;
+    u64 heap_sort_fallbacks;
+    u64 radix_passes;
+    u64 radix_passes_skipped;
+    u64 searches;
+} Sort_F64_Counters;
+
+static _Thread_local Sort_F64_Counters Sort_F64_counters;
+
+#define Sort_F64_COUNT(counter, n) (Sort_F64_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Sort_F64_COUNT_MAX(counter, value) \
+    (Sort_F64_counters.counter = ((u64)(value) > Sort_F64_counters.counter) ? \
+        (u64)(value) : Sort_F64_counters.counter)
+
+static inline void
+Sort_F64_dump_counters(FILE *file)
+{
+    fprintf(file, "Sort_F64:");
+    fprintf(file, " sorts %llu", (unsigned long long)Sort_F64_counters.sorts);
+    fprintf(file, " sorted_elements %llu", (unsigned long long)Sort_F64_counters.sorted_elements);
+    fprintf(file, " insertion_sorts %llu", (unsigned long long)Sort_F64_counters.insertion_sorts);
+    fprintf(file, " heap_sort_fallbacks %llu", (unsigned long long)Sort_F64_counters.heap_sort_fallbacks);
+    fprintf(file, " radix_passes %llu", (unsigned long long)Sort_F64_counters.radix_passes);
+    fprintf(file, " radix_passes_skipped %llu", (unsigned long long)Sort_F64_counters.radix_passes_skipped);
+    fprintf(file, " searches %llu", (unsigned long long)Sort_F64_counters.searches);
+    fprintf(file, "\n");
+}
+
+static inline void
+Sort_F64_reset_counters(void)
+{
+    Sort_F64_counters = (Sort_F64_Counters){0};
+}
+#else
+#define Sort_F64_COUNT(counter, n) ((void)0)
+#define Sort_F64_COUNT_MAX(counter, value) ((void)0)
+#define Sort_F64_dump_counters(file) ((void)0)
+#define Sort_F64_reset_counters() ((void)0)
+#endif
+
+static inline f64
+Sort_F64_key(f64 *element)
+{
+    return *element;
+}
+
+/*
+ Insertion sort for short runs. The position of each element is
+ counted without branches, then the larger ones move up at once.
+ */
+static inline void
+Sort_F64_insertion_sort(f64 *array, u64 count)
+{
+    Sort_F64_COUNT(insertion_sorts, 1);
+    for (u64 i = 1; i < count; ++i)
+    {
+        f64 value = array[i];
+        f64 key = Sort_F64_key(&value);
+        
+        u64 position = 0;
+        for (u64 j = 0; j < i; ++j)
+        {
+            position += (Sort_F64_key(&array[j]) <= key);
+        }
+        
+        memmove(array + position + 1, array + position, (i - position) * sizeof(f64));
+        array[position] = value;
+    }
+}
+
+static inline void
+Sort_F64_swap(f64 *a, f64 *b)
+{
+    f64 temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void
+Sort_F64_sift_down(f64 *array, u64 root, u64 count)
+{
+    for (;;)
+    {
+        u64 child = 2 * root + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        
+        if (child + 1 < count &&
+            Sort_F64_key(&array[child]) < Sort_F64_key(&array[child + 1]))
+        {
+            ++child;
+        }
+        
+        if (!(Sort_F64_key(&array[root]) < Sort_F64_key(&array[child])))
+        {
+            return;
+        }
+        
+        Sort_F64_swap(&array[root], &array[child]);
+        root = child;
+    }
+}
+
+static inline void
+Sort_F64_heap_sort(f64 *array, u64 count)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        Sort_F64_sift_down(array, i - 1, count);
+    }
+    
+    for (u64 end = count; end > 1; --end)
+    {
+        Sort_F64_swap(&array[0], &array[end - 1]);
+        Sort_F64_sift_down(array, 0, end - 1);
+    }
+}
+
+/* runs at most this long are finished with insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* quicksort that falls back to heap sort when it recurses too deep */
+static inline void
+Sort_F64_introsort(f64 *array, u64 count, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit-- == 0)
+        {
+            Sort_F64_COUNT(heap_sort_fallbacks, 1);
+            Sort_F64_heap_sort(array, count);
+            return;
+        }
+        
+        /* median of three ends up at the front as the pivot */
+        u64 middle = count / 2;
+        if (Sort_F64_key(&array[middle]) < Sort_F64_key(&array[0]))
+        {
+            Sort_F64_swap(&array[middle], &array[0]);
+        }
+        if (Sort_F64_key(&array[count - 1]) < Sort_F64_key(&array[middle]))
+        {
+            Sort_F64_swap(&array[count - 1], &array[middle]);
+            if (Sort_F64_key(&array[middle]) < Sort_F64_key(&array[0]))
+            {
+                Sort_F64_swap(&array[middle], &array[0]);
+            }
+        }
+        Sort_F64_swap(&array[0], &array[middle]);
+        f64 pivot = Sort_F64_key(&array[0]);
+        
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            while (Sort_F64_key(&array[++i]) < pivot)
+            {
+            }
+            while (pivot < Sort_F64_key(&array[--j]))
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            Sort_F64_swap(&array[i], &array[j]);
+        }
+        Sort_F64_swap(&array[0], &array[j]);
+        
+        /* recurse into the smaller side, loop on the larger one */
+        if (j < count - j - 1)
+        {
+            Sort_F64_introsort(array, j, depth_limit);
+            array += j + 1;
+            count -= j + 1;
+        }
+        else
+        {
+            Sort_F64_introsort(array + j + 1, count - j - 1, depth_limit);
+            count = j;
+        }
+    }
+    
+    Sort_F64_insertion_sort(array, count);
+}
+
+static inline void
+Sort_F64_sort(f64 *array, u64 count)
+{
+    Sort_F64_COUNT(sorts, 1);
+    Sort_F64_COUNT(sorted_elements, count);
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n /= 2)
+    {
+        depth_limit += 2;
+    }
+    
+    Sort_F64_introsort(array, count, depth_limit);
+}
+
+/* key bits in an order where unsigned comparison sorts like f64 */
+static inline u64
+Sort_F64_radix_key(f64 *element)
+{
+    f64 key = Sort_F64_key(element);
+    u64 bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+}
+
+/*
+ Stable LSD radix sort, one byte of the key per pass. scratch has
+ room for count elements. Passes where every key has the same byte
+ are skipped.
+ */
+static inline void
+Sort_F64_radix_sort(f64 *array, f64 *scratch, u64 count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    Sort_F64_COUNT(sorts, 1);
+    Sort_F64_COUNT(sorted_elements, count);
+    
+    u64 histograms[sizeof(f64)][256];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        u64 bits = Sort_F64_radix_key(&array[i]);
+        for (u32 digit = 0; digit < sizeof(f64); ++digit)
+        {
+            ++histograms[digit][(bits >> (8 * digit)) & 0xFF];
+        }
+    }
+    
+    f64 *from = array;
+    f64 *to = scratch;
+    
+    for (u32 digit = 0; digit < sizeof(f64); ++digit)
+    {
+        u64 *histogram = histograms[digit];
+        u32 shift = 8 * digit;
+        
+        u64 first = (Sort_F64_radix_key(&from[0]) >> shift) & 0xFF;
+        if (histogram[first] == count)
+        {
+            Sort_F64_COUNT(radix_passes_skipped, 1);
+            continue;
+        }
+        Sort_F64_COUNT(radix_passes, 1);
+        
+        u64 offset = 0;
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u64 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 byte = (Sort_F64_radix_key(&from[i]) >> shift) & 0xFF;
+            to[histogram[byte]++] = from[i];
+        }
+        
+        f64 *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != array)
+    {
+        memcpy(array, from, count * sizeof(f64));
+    }
+}
+
+/* index of the first element whose key is not less than key */
+static inline u64
+Sort_F64_lower_bound(f64 *array, u64 count, f64 key)
+{
+    Sort_F64_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    f64 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (Sort_F64_key(&base[half - 1]) < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - array) + (Sort_F64_key(base) < key);
+}
+
+/* index of the first element whose key is greater than key */
+static inline u64
+Sort_F64_upper_bound(f64 *array, u64 count, f64 key)
+{
+    Sort_F64_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    f64 *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (key < Sort_F64_key(&base[half - 1])) ? base : base + half;
+        count -= half;
+    }
+    
+    return (base - array) + !(key < Sort_F64_key(base));
+}
+
+/* an element with the key, or 0 */
+static inline f64 *
+Sort_F64_search(f64 *array, u64 count, f64 key)
+{
+    u64 index = Sort_F64_lower_bound(array, count, key);
+    
+    return (index < count && !(key < Sort_F64_key(&array[index]))) ?
+        &array[index] : 0;
+}
+
+#include <string.h>
+
+/*
+ Sorting and searching for arrays ordered by a key field of the
+ elements, or by the elements themselves for plain numbers.
+ Comparisons are inlined instead of going through a comparator
+ pointer as with qsort.
+ */
+#ifndef SORT_FIELD
+/* member access with the field name as its own token, so it is substituted */
+#define SORT_FIELD(pointer, field) ((pointer)->field)
+#endif
+
+/* with GEN_INSTRUMENT, how often each algorithm ran in this thread */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Sort_Vec3f_X in the calling thread */
+typedef struct Sort_Vec3f_X_Counters
+{
+    u64 sorts;
+    u64 sorted_elements;
+    u64 insertion_sorts;
+    u64 heap_sort_fallbacks;
+    u64 radix_passes;
+    u64 radix_passes_skipped;
+    u64 searches;
+} Sort_Vec3f_X_Counters;
+
+static _Thread_local Sort_Vec3f_X_Counters Sort_Vec3f_X_counters;
+
+#define Sort_Vec3f_X_COUNT(counter, n) (Sort_Vec3f_X_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Sort_Vec3f_X_COUNT_MAX(counter, value) \
+    (Sort_Vec3f_X_counters.counter = ((u64)(value) > Sort_Vec3f_X_counters.counter) ? \
+        (u64)(value) : Sort_Vec3f_X_counters.counter)
+
+static inline void
+Sort_Vec3f_X_dump_counters(FILE *file)
+{
+    fprintf(file, "Sort_Vec3f_X:");
+    fprintf(file, " sorts %llu", (unsigned long long)Sort_Vec3f_X_counters.sorts);
+    fprintf(file, " sorted_elements %llu", (unsigned long long)Sort_Vec3f_X_counters.sorted_elements);
+    fprintf(file, " insertion_sorts %llu", (unsigned long long)Sort_Vec3f_X_counters.insertion_sorts);
+    fprintf(file, " heap_sort_fallbacks %llu", (unsigned long long)Sort_Vec3f_X_counters.heap_sort_fallbacks);
+    fprintf(file, " radix_passes %llu", (unsigned long long)Sort_Vec3f_X_counters.radix_passes);
+    fprintf(file, " radix_passes_skipped %llu", (unsigned long long)Sort_Vec3f_X_counters.radix_passes_skipped);
+    fprintf(file, " searches %llu", (unsigned long long)Sort_Vec3f_X_counters.searches);
+    fprintf(file, "\n");
+}
+
+static inline void
+Sort_Vec3f_X_reset_counters(void)
+{
+    Sort_Vec3f_X_counters = (Sort_Vec3f_X_Counters){0};
+}
+#else
+#define Sort_Vec3f_X_COUNT(counter, n) ((void)0)
+#define Sort_Vec3f_X_COUNT_MAX(counter, value) ((void)0)
+#define Sort_Vec3f_X_dump_counters(file) ((void)0)
+#define Sort_Vec3f_X_reset_counters() ((void)0)
+#endif
+
+static inline f32
+Sort_Vec3f_X_key(Vec3f *element)
+{
+    return SORT_FIELD(element, x);
+}
+
+/*
+ Insertion sort for short runs. The position of each element is
+ counted without branches, then the larger ones move up at once.
+ */
+static inline void
+Sort_Vec3f_X_insertion_sort(Vec3f *array, u64 count)
+{
+    Sort_Vec3f_X_COUNT(insertion_sorts, 1);
+    for (u64 i = 1; i < count; ++i)
+    {
+        Vec3f value = array[i];
+        f32 key = Sort_Vec3f_X_key(&value);
+        
+        u64 position = 0;
+        for (u64 j = 0; j < i; ++j)
+        {
+            position += (Sort_Vec3f_X_key(&array[j]) <= key);
+        }
+        
+        memmove(array + position + 1, array + position, (i - position) * sizeof(Vec3f));
+        array[position] = value;
+    }
+}
+
+static inline void
+Sort_Vec3f_X_swap(Vec3f *a, Vec3f *b)
+{
+    Vec3f temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static inline void
+Sort_Vec3f_X_sift_down(Vec3f *array, u64 root, u64 count)
+{
+    for (;;)
+    {
+        u64 child = 2 * root + 1;
+        if (child >= count)
+        {
+            return;
+        }
+        
+        if (child + 1 < count &&
+            Sort_Vec3f_X_key(&array[child]) < Sort_Vec3f_X_key(&array[child + 1]))
+        {
+            ++child;
+        }
+        
+        if (!(Sort_Vec3f_X_key(&array[root]) < Sort_Vec3f_X_key(&array[child])))
+        {
+            return;
+        }
+        
+        Sort_Vec3f_X_swap(&array[root], &array[child]);
+        root = child;
+    }
+}
+
+static inline void
+Sort_Vec3f_X_heap_sort(Vec3f *array, u64 count)
+{
+    for (u64 i = count / 2; i > 0; --i)
+    {
+        Sort_Vec3f_X_sift_down(array, i - 1, count);
+    }
+    
+    for (u64 end = count; end > 1; --end)
+    {
+        Sort_Vec3f_X_swap(&array[0], &array[end - 1]);
+        Sort_Vec3f_X_sift_down(array, 0, end - 1);
+    }
+}
+
+/* runs at most this long are finished with insertion sort */
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 16
+#endif
+
+/* quicksort that falls back to heap sort when it recurses too deep */
+static inline void
+Sort_Vec3f_X_introsort(Vec3f *array, u64 count, u32 depth_limit)
+{
+    while (count > SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit-- == 0)
+        {
+            Sort_Vec3f_X_COUNT(heap_sort_fallbacks, 1);
+            Sort_Vec3f_X_heap_sort(array, count);
+            return;
+        }
+        
+        /* median of three ends up at the front as the pivot */
+        u64 middle = count / 2;
+        if (Sort_Vec3f_X_key(&array[middle]) < Sort_Vec3f_X_key(&array[0]))
+        {
+            Sort_Vec3f_X_swap(&array[middle], &array[0]);
+        }
+        if (Sort_Vec3f_X_key(&array[count - 1]) < Sort_Vec3f_X_key(&array[middle]))
+        {
+            Sort_Vec3f_X_swap(&array[count - 1], &array[middle]);
+            if (Sort_Vec3f_X_key(&array[middle]) < Sort_Vec3f_X_key(&array[0]))
+            {
+                Sort_Vec3f_X_swap(&array[middle], &array[0]);
+            }
+        }
+        Sort_Vec3f_X_swap(&array[0], &array[middle]);
+        f32 pivot = Sort_Vec3f_X_key(&array[0]);
+        
+        u64 i = 0;
+        u64 j = count;
+        for (;;)
+        {
+            while (Sort_Vec3f_X_key(&array[++i]) < pivot)
+            {
+            }
+            while (pivot < Sort_Vec3f_X_key(&array[--j]))
+            {
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            Sort_Vec3f_X_swap(&array[i], &array[j]);
+        }
+        Sort_Vec3f_X_swap(&array[0], &array[j]);
+        
+        /* recurse into the smaller side, loop on the larger one */
+        if (j < count - j - 1)
+        {
+            Sort_Vec3f_X_introsort(array, j, depth_limit);
+            array += j + 1;
+            count -= j + 1;
+        }
+        else
+        {
+            Sort_Vec3f_X_introsort(array + j + 1, count - j - 1, depth_limit);
+            count = j;
+        }
+    }
+    
+    Sort_Vec3f_X_insertion_sort(array, count);
+}
+
+static inline void
+Sort_Vec3f_X_sort(Vec3f *array, u64 count)
+{
+    Sort_Vec3f_X_COUNT(sorts, 1);
+    Sort_Vec3f_X_COUNT(sorted_elements, count);
+    u32 depth_limit = 0;
+    for (u64 n = count; n > 1; n /= 2)
+    {
+        depth_limit += 2;
+    }
+    
+    Sort_Vec3f_X_introsort(array, count, depth_limit);
+}
+
+/* key bits in an order where unsigned comparison sorts like f32 */
+static inline u64
+Sort_Vec3f_X_radix_key(Vec3f *element)
+{
+    f32 key = Sort_Vec3f_X_key(element);
+    u32 bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return (bits & 0x80000000u) ? (u32)~bits : (bits | 0x80000000u);
+}
+
+/*
+ Stable LSD radix sort, one byte of the key per pass. scratch has
+ room for count elements. Passes where every key has the same byte
+ are skipped.
+ */
+static inline void
+Sort_Vec3f_X_radix_sort(Vec3f *array, Vec3f *scratch, u64 count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+    Sort_Vec3f_X_COUNT(sorts, 1);
+    Sort_Vec3f_X_COUNT(sorted_elements, count);
+    
+    u64 histograms[sizeof(f32)][256];
+    memset(histograms, 0, sizeof(histograms));
+    
+    for (u64 i = 0; i < count; ++i)
+    {
+        u64 bits = Sort_Vec3f_X_radix_key(&array[i]);
+        for (u32 digit = 0; digit < sizeof(f32); ++digit)
+        {
+            ++histograms[digit][(bits >> (8 * digit)) & 0xFF];
+        }
+    }
+    
+    Vec3f *from = array;
+    Vec3f *to = scratch;
+    
+    for (u32 digit = 0; digit < sizeof(f32); ++digit)
+    {
+        u64 *histogram = histograms[digit];
+        u32 shift = 8 * digit;
+        
+        u64 first = (Sort_Vec3f_X_radix_key(&from[0]) >> shift) & 0xFF;
+        if (histogram[first] == count)
+        {
+            Sort_Vec3f_X_COUNT(radix_passes_skipped, 1);
+            continue;
+        }
+        Sort_Vec3f_X_COUNT(radix_passes, 1);
+        
+        u64 offset = 0;
+        for (u32 i = 0; i < 256; ++i)
+        {
+            u64 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+        
+        for (u64 i = 0; i < count; ++i)
+        {
+            u64 byte = (Sort_Vec3f_X_radix_key(&from[i]) >> shift) & 0xFF;
+            to[histogram[byte]++] = from[i];
+        }
+        
+        Vec3f *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != array)
+    {
+        memcpy(array, from, count * sizeof(Vec3f));
+    }
+}
+
+/* index of the first element whose key is not less than key */
+static inline u64
+Sort_Vec3f_X_lower_bound(Vec3f *array, u64 count, f32 key)
+{
+    Sort_Vec3f_X_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    Vec3f *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (Sort_Vec3f_X_key(&base[half - 1]) < key) ? base + half : base;
+        count -= half;
+    }
+    
+    return (base - array) + (Sort_Vec3f_X_key(base) < key);
+}
+
+/* index of the first element whose key is greater than key */
+static inline u64
+Sort_Vec3f_X_upper_bound(Vec3f *array, u64 count, f32 key)
+{
+    Sort_Vec3f_X_COUNT(searches, 1);
+    if (count == 0)
+    {
+        return 0;
+    }
+    
+    Vec3f *base = array;
+    while (count > 1)
+    {
+        u64 half = count / 2;
+        base = (key < Sort_Vec3f_X_key(&base[half - 1])) ? base : base + half;
+        count -= half;
+    }
+    
+    return (base - array) + !(key < Sort_Vec3f_X_key(base));
+}
+
+/* an element with the key, or 0 */
+static inline Vec3f *
+Sort_Vec3f_X_search(Vec3f *array, u64 count, f32 key)
+{
+    u64 index = Sort_Vec3f_X_lower_bound(array, count, key);
+    
+    return (index < count && !(key < Sort_Vec3f_X_key(&array[index]))) ?
+        &array[index] : 0;
+}
+
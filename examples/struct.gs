@@ -11,6 +11,17 @@ struct @template_name
 };
 @template_end
 
+@template_specialize Vec4 -> f32
+typedef struct @template_name @template_name;
+struct @template_name
+{
+	_Alignas(16) f32 x;
+	f32 y;
+	f32 z;
+	f32 w;
+};
+@template_end
+
 @template_start Vec3 <- T
 typedef struct @template_name @template_name;
 struct @template_name
@@ -35,6 +46,7 @@ struct @template_name
 
 @template Vec3 -> f32 -> Vec3f
 @template Vec3 -> u8 -> Vec3c
+@template_soa Vec3 -> f32 -> Vec3fSoA
 
 @template Vec2 -> f32 -> Vec2f
 @template Vec2 -> u16 -> Vec2Coords
\ No newline at end of file
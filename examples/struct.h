@@ -1,7 +1,7 @@
 typedef struct Vec4f Vec4f;
 struct Vec4f
 {
-	f32 x;
+	_Alignas(16) f32 x;
 	f32 y;
 	f32 z;
 	f32 w;
@@ -32,6 +32,129 @@ struct Vec3c
 	u8 z;
 };
 
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Vec3fSoA Vec3fSoA;
+struct Vec3fSoA
+{
+    f32 *x;
+    f32 *y;
+    f32 *z;
+    u64 count;
+    u64 capacity;
+};
+
+static inline void
+Vec3fSoA_free(Vec3fSoA *soa)
+{
+    free(soa->x);
+    free(soa->y);
+    free(soa->z);
+    *soa = (Vec3fSoA){0};
+}
+
+/* capacity is rounded up to whole cache lines per array */
+static inline b32
+Vec3fSoA_reserve(Vec3fSoA *soa, u64 capacity)
+{
+    if (capacity <= soa->capacity)
+    {
+        return 1;
+    }
+    capacity = (capacity + 63) & ~(u64)63;
+
+    Vec3fSoA grown = {0};
+    grown.count = soa->count;
+    grown.capacity = capacity;
+    grown.x = aligned_alloc(64, capacity * sizeof(*grown.x));
+    grown.y = aligned_alloc(64, capacity * sizeof(*grown.y));
+    grown.z = aligned_alloc(64, capacity * sizeof(*grown.z));
+
+    if (!grown.x || !grown.y || !grown.z)
+    {
+        Vec3fSoA_free(&grown);
+        return 0;
+    }
+
+    if (soa->count > 0)
+    {
+        memcpy(grown.x, soa->x, soa->count * sizeof(*soa->x));
+        memcpy(grown.y, soa->y, soa->count * sizeof(*soa->y));
+        memcpy(grown.z, soa->z, soa->count * sizeof(*soa->z));
+    }
+    Vec3fSoA_free(soa);
+    *soa = grown;
+    return 1;
+}
+
+static inline b32
+Vec3fSoA_push(Vec3fSoA *soa, Vec3f value)
+{
+    if (soa->count == soa->capacity &&
+        !Vec3fSoA_reserve(soa, 2 * soa->capacity + 1))
+    {
+        return 0;
+    }
+
+    soa->x[soa->count] = value.x;
+    soa->y[soa->count] = value.y;
+    soa->z[soa->count] = value.z;
+    ++soa->count;
+    return 1;
+}
+
+static inline Vec3f
+Vec3fSoA_get(Vec3fSoA *soa, u64 index)
+{
+    Vec3f value;
+    value.x = soa->x[index];
+    value.y = soa->y[index];
+    value.z = soa->z[index];
+    return value;
+}
+
+static inline b32
+Vec3fSoA_from_aos(Vec3fSoA *soa, Vec3f *aos, u64 count)
+{
+    if (!Vec3fSoA_reserve(soa, count))
+    {
+        return 0;
+    }
+
+    for (u64 i = 0; i < count; ++i)
+    {
+        soa->x[i] = aos[i].x;
+    }
+    for (u64 i = 0; i < count; ++i)
+    {
+        soa->y[i] = aos[i].y;
+    }
+    for (u64 i = 0; i < count; ++i)
+    {
+        soa->z[i] = aos[i].z;
+    }
+    soa->count = count;
+    return 1;
+}
+
+static inline void
+Vec3fSoA_to_aos(Vec3fSoA *soa, Vec3f *aos)
+{
+    for (u64 i = 0; i < soa->count; ++i)
+    {
+        aos[i].x = soa->x[i];
+    }
+    for (u64 i = 0; i < soa->count; ++i)
+    {
+        aos[i].y = soa->y[i];
+    }
+    for (u64 i = 0; i < soa->count; ++i)
+    {
+        aos[i].z = soa->z[i];
+    }
+}
+
 typedef struct Vec2f Vec2f;
 struct Vec2f
 {
@@ -1,12 +1,207 @@
 ~output_ext .h
 
-@template_start Linked_List <- T
-typedef struct @template_name
+@template_start Vec3 <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y, z;
+};
+@template_end
+
+@template_start Linked_List <- T, SLAB_NODES:256
+typedef struct @template_name @template_name;
+struct @template_name
 {
     T data;
     
     @template_name *next;
-} @template_name;
+};
+@template_end
+
+@template_fn Linked_List <- T, SLAB_NODES:256
+#include <string.h>
+
+static inline @template_name *
+@template_name_push(@template_name *head, @template_name *node, T data)
+{
+    node->data = data;
+    node->next = head;
+    return node;
+}
+
+static inline @template_name *
+@template_name_find(@template_name *head, T data)
+{
+    for (; head; head = head->next)
+    {
+@if is_integer(T) || is_float(T) || is_pointer(T)
+        if (head->data == data)
+@else
+@if has_hash(T)
+        if (GEN_EQUAL(T)(&head->data, &data))
+@else
+        /* struct elements without @hash are compared as bytes, so no padding */
+        if (memcmp(&head->data, &data, sizeof(T)) == 0)
+@endif
+@endif
+        {
+            return head;
+        }
+    }
+    return 0;
+}
+
+#define @template_name_for_each(node, head) \
+    for (@template_name *node = (head); node; node = node->next)
+
+/*
+ Node pool: nodes are carved out of slabs of SLAB_NODES in order, so a
+ list pushed from a fresh pool is contiguous. Popped nodes go on a free
+ list and are reused first. Reset keeps the slabs for the next round.
+ */
+#include <stdlib.h>
+
+/* pool events, counted when GEN_INSTRUMENT is defined */
+@instrument slab_allocs, allocated_bytes, reused_nodes
+
+typedef struct @template_name_Slab @template_name_Slab;
+struct @template_name_Slab
+{
+    @template_name_Slab *next;
+    @template_name nodes[SLAB_NODES];
+};
+
+typedef struct @template_name_Pool
+{
+    @template_name_Slab *slabs;
+    @template_name_Slab *current;
+    u32 slab_used;
+    @template_name *free_list;
+} @template_name_Pool;
+
+static inline @template_name *
+@template_name_alloc(@template_name_Pool *pool)
+{
+    @template_name *node = pool->free_list;
+    if (node)
+    {
+        pool->free_list = node->next;
+        @template_name_COUNT(reused_nodes, 1);
+        return node;
+    }
+    
+    if (!pool->current || pool->slab_used == SLAB_NODES)
+    {
+        @template_name_Slab *slab = pool->current ? pool->current->next : pool->slabs;
+        if (!slab)
+        {
+            slab = malloc(sizeof(@template_name_Slab));
+            if (!slab)
+            {
+                return 0;
+            }
+            slab->next = 0;
+            @template_name_COUNT(slab_allocs, 1);
+            @template_name_COUNT(allocated_bytes, sizeof(@template_name_Slab));
+            
+            if (pool->current)
+            {
+                pool->current->next = slab;
+            }
+            else
+            {
+                pool->slabs = slab;
+            }
+        }
+        pool->current = slab;
+        pool->slab_used = 0;
+    }
+    
+    return &pool->current->nodes[pool->slab_used++];
+}
+
+static inline void
+@template_name_release(@template_name_Pool *pool, @template_name *node)
+{
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+/* drops every node at once, the slabs are reused */
+static inline void
+@template_name_reset(@template_name_Pool *pool)
+{
+    pool->current = 0;
+    pool->slab_used = 0;
+    pool->free_list = 0;
+}
+
+static inline void
+@template_name_pool_free(@template_name_Pool *pool)
+{
+    for (@template_name_Slab *slab = pool->slabs; slab;)
+    {
+        @template_name_Slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    *pool = (@template_name_Pool){0};
+}
+
+static inline b32
+@template_name_pool_push(@template_name_Pool *pool, @template_name **head, T data)
+{
+    @template_name *node = @template_name_alloc(pool);
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *head = @template_name_push(*head, node, data);
+    return 1;
+}
+
+static inline b32
+@template_name_pool_pop(@template_name_Pool *pool, @template_name **head, T *data)
+{
+    @template_name *node = *head;
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *data = node->data;
+    *head = node->next;
+    @template_name_release(pool, node);
+    return 1;
+}
+
+/* like for_each, but starts loading the next node while the body runs */
+#ifndef GEN_PREFETCH
+#if defined(__GNUC__)
+#define GEN_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define GEN_PREFETCH(address) ((void)(address))
+#endif
+#endif
+
+#define @template_name_for_each_prefetch(node, head) \
+    for (@template_name *node = (head); \
+         node && (GEN_PREFETCH(node->next), 1); \
+         node = node->next)
+@template_end
+
+@template_fn Swap <- T
+static inline void
+@template_name(T *a, T *b)
+{
+    T temp = *a;
+    *a = *b;
+    *b = temp;
+}
 @template_end
 
 @template Linked_List -> f32 -> Linked_List_F32
+@template Vec3 -> f32 -> Vec3f
+@template Linked_List -> Vec3f -> List_Vec3f
+@template Swap -> f32 -> Swap_F32
@@ -1,7 +1,433 @@
-typedef struct Linked_List_F32
+typedef struct Linked_List_F32 Linked_List_F32;
+struct Linked_List_F32
 {
     f32 data;
     
     Linked_List_F32 *next;
-} Linked_List_F32;
+};
+
+#include <string.h>
+
+static inline Linked_List_F32 *
+Linked_List_F32_push(Linked_List_F32 *head, Linked_List_F32 *node, f32 data)
+{
+    node->data = data;
+    node->next = head;
+    return node;
+}
+
+static inline Linked_List_F32 *
+Linked_List_F32_find(Linked_List_F32 *head, f32 data)
+{
+    for (; head; head = head->next)
+    {
+        if (head->data == data)
+        {
+            return head;
+        }
+    }
+    return 0;
+}
+
+#define Linked_List_F32_for_each(node, head) \
+    for (Linked_List_F32 *node = (head); node; node = node->next)
+
+/*
+ Node pool: nodes are carved out of slabs of 256 in order, so a
+ list pushed from a fresh pool is contiguous. Popped nodes go on a free
+ list and are reused first. Reset keeps the slabs for the next round.
+ */
+#include <stdlib.h>
+
+/* pool events, counted when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of Linked_List_F32 in the calling thread */
+typedef struct Linked_List_F32_Counters
+{
+    u64 slab_allocs;
+    u64 allocated_bytes;
+    u64 reused_nodes;
+} Linked_List_F32_Counters;
+
+static _Thread_local Linked_List_F32_Counters Linked_List_F32_counters;
+
+#define Linked_List_F32_COUNT(counter, n) (Linked_List_F32_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define Linked_List_F32_COUNT_MAX(counter, value) \
+    (Linked_List_F32_counters.counter = ((u64)(value) > Linked_List_F32_counters.counter) ? \
+        (u64)(value) : Linked_List_F32_counters.counter)
+
+static inline void
+Linked_List_F32_dump_counters(FILE *file)
+{
+    fprintf(file, "Linked_List_F32:");
+    fprintf(file, " slab_allocs %llu", (unsigned long long)Linked_List_F32_counters.slab_allocs);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)Linked_List_F32_counters.allocated_bytes);
+    fprintf(file, " reused_nodes %llu", (unsigned long long)Linked_List_F32_counters.reused_nodes);
+    fprintf(file, "\n");
+}
+
+static inline void
+Linked_List_F32_reset_counters(void)
+{
+    Linked_List_F32_counters = (Linked_List_F32_Counters){0};
+}
+#else
+#define Linked_List_F32_COUNT(counter, n) ((void)0)
+#define Linked_List_F32_COUNT_MAX(counter, value) ((void)0)
+#define Linked_List_F32_dump_counters(file) ((void)0)
+#define Linked_List_F32_reset_counters() ((void)0)
+#endif
+
+typedef struct Linked_List_F32_Slab Linked_List_F32_Slab;
+struct Linked_List_F32_Slab
+{
+    Linked_List_F32_Slab *next;
+    Linked_List_F32 nodes[256];
+};
+
+typedef struct Linked_List_F32_Pool
+{
+    Linked_List_F32_Slab *slabs;
+    Linked_List_F32_Slab *current;
+    u32 slab_used;
+    Linked_List_F32 *free_list;
+} Linked_List_F32_Pool;
+
+static inline Linked_List_F32 *
+Linked_List_F32_alloc(Linked_List_F32_Pool *pool)
+{
+    Linked_List_F32 *node = pool->free_list;
+    if (node)
+    {
+        pool->free_list = node->next;
+        Linked_List_F32_COUNT(reused_nodes, 1);
+        return node;
+    }
+    
+    if (!pool->current || pool->slab_used == 256)
+    {
+        Linked_List_F32_Slab *slab = pool->current ? pool->current->next : pool->slabs;
+        if (!slab)
+        {
+            slab = malloc(sizeof(Linked_List_F32_Slab));
+            if (!slab)
+            {
+                return 0;
+            }
+            slab->next = 0;
+            Linked_List_F32_COUNT(slab_allocs, 1);
+            Linked_List_F32_COUNT(allocated_bytes, sizeof(Linked_List_F32_Slab));
+            
+            if (pool->current)
+            {
+                pool->current->next = slab;
+            }
+            else
+            {
+                pool->slabs = slab;
+            }
+        }
+        pool->current = slab;
+        pool->slab_used = 0;
+    }
+    
+    return &pool->current->nodes[pool->slab_used++];
+}
+
+static inline void
+Linked_List_F32_release(Linked_List_F32_Pool *pool, Linked_List_F32 *node)
+{
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+/* drops every node at once, the slabs are reused */
+static inline void
+Linked_List_F32_reset(Linked_List_F32_Pool *pool)
+{
+    pool->current = 0;
+    pool->slab_used = 0;
+    pool->free_list = 0;
+}
+
+static inline void
+Linked_List_F32_pool_free(Linked_List_F32_Pool *pool)
+{
+    for (Linked_List_F32_Slab *slab = pool->slabs; slab;)
+    {
+        Linked_List_F32_Slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    *pool = (Linked_List_F32_Pool){0};
+}
+
+static inline b32
+Linked_List_F32_pool_push(Linked_List_F32_Pool *pool, Linked_List_F32 **head, f32 data)
+{
+    Linked_List_F32 *node = Linked_List_F32_alloc(pool);
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *head = Linked_List_F32_push(*head, node, data);
+    return 1;
+}
+
+static inline b32
+Linked_List_F32_pool_pop(Linked_List_F32_Pool *pool, Linked_List_F32 **head, f32 *data)
+{
+    Linked_List_F32 *node = *head;
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *data = node->data;
+    *head = node->next;
+    Linked_List_F32_release(pool, node);
+    return 1;
+}
+
+/* like for_each, but starts loading the next node while the body runs */
+#ifndef GEN_PREFETCH
+#if defined(__GNUC__)
+#define GEN_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define GEN_PREFETCH(address) ((void)(address))
+#endif
+#endif
+
+#define Linked_List_F32_for_each_prefetch(node, head) \
+    for (Linked_List_F32 *node = (head); \
+         node && (GEN_PREFETCH(node->next), 1); \
+         node = node->next)
+
+typedef struct Vec3f Vec3f;
+struct Vec3f
+{
+    f32 x, y, z;
+};
+
+typedef struct List_Vec3f List_Vec3f;
+struct List_Vec3f
+{
+    Vec3f data;
+    
+    List_Vec3f *next;
+};
+
+#include <string.h>
+
+static inline List_Vec3f *
+List_Vec3f_push(List_Vec3f *head, List_Vec3f *node, Vec3f data)
+{
+    node->data = data;
+    node->next = head;
+    return node;
+}
+
+static inline List_Vec3f *
+List_Vec3f_find(List_Vec3f *head, Vec3f data)
+{
+    for (; head; head = head->next)
+    {
+        /* struct elements without @hash are compared as bytes, so no padding */
+        if (memcmp(&head->data, &data, sizeof(Vec3f)) == 0)
+        {
+            return head;
+        }
+    }
+    return 0;
+}
+
+#define List_Vec3f_for_each(node, head) \
+    for (List_Vec3f *node = (head); node; node = node->next)
+
+/*
+ Node pool: nodes are carved out of slabs of 256 in order, so a
+ list pushed from a fresh pool is contiguous. Popped nodes go on a free
+ list and are reused first. Reset keeps the slabs for the next round.
+ */
+#include <stdlib.h>
+
+/* pool events, counted when GEN_INSTRUMENT is defined */
+#ifdef GEN_INSTRUMENT
+#include <stdio.h>
+
+/* events of List_Vec3f in the calling thread */
+typedef struct List_Vec3f_Counters
+{
+    u64 slab_allocs;
+    u64 allocated_bytes;
+    u64 reused_nodes;
+} List_Vec3f_Counters;
+
+static _Thread_local List_Vec3f_Counters List_Vec3f_counters;
+
+#define List_Vec3f_COUNT(counter, n) (List_Vec3f_counters.counter += (u64)(n))
+/* value is evaluated twice */
+#define List_Vec3f_COUNT_MAX(counter, value) \
+    (List_Vec3f_counters.counter = ((u64)(value) > List_Vec3f_counters.counter) ? \
+        (u64)(value) : List_Vec3f_counters.counter)
+
+static inline void
+List_Vec3f_dump_counters(FILE *file)
+{
+    fprintf(file, "List_Vec3f:");
+    fprintf(file, " slab_allocs %llu", (unsigned long long)List_Vec3f_counters.slab_allocs);
+    fprintf(file, " allocated_bytes %llu", (unsigned long long)List_Vec3f_counters.allocated_bytes);
+    fprintf(file, " reused_nodes %llu", (unsigned long long)List_Vec3f_counters.reused_nodes);
+    fprintf(file, "\n");
+}
+
+static inline void
+List_Vec3f_reset_counters(void)
+{
+    List_Vec3f_counters = (List_Vec3f_Counters){0};
+}
+#else
+#define List_Vec3f_COUNT(counter, n) ((void)0)
+#define List_Vec3f_COUNT_MAX(counter, value) ((void)0)
+#define List_Vec3f_dump_counters(file) ((void)0)
+#define List_Vec3f_reset_counters() ((void)0)
+#endif
+
+typedef struct List_Vec3f_Slab List_Vec3f_Slab;
+struct List_Vec3f_Slab
+{
+    List_Vec3f_Slab *next;
+    List_Vec3f nodes[256];
+};
+
+typedef struct List_Vec3f_Pool
+{
+    List_Vec3f_Slab *slabs;
+    List_Vec3f_Slab *current;
+    u32 slab_used;
+    List_Vec3f *free_list;
+} List_Vec3f_Pool;
+
+static inline List_Vec3f *
+List_Vec3f_alloc(List_Vec3f_Pool *pool)
+{
+    List_Vec3f *node = pool->free_list;
+    if (node)
+    {
+        pool->free_list = node->next;
+        List_Vec3f_COUNT(reused_nodes, 1);
+        return node;
+    }
+    
+    if (!pool->current || pool->slab_used == 256)
+    {
+        List_Vec3f_Slab *slab = pool->current ? pool->current->next : pool->slabs;
+        if (!slab)
+        {
+            slab = malloc(sizeof(List_Vec3f_Slab));
+            if (!slab)
+            {
+                return 0;
+            }
+            slab->next = 0;
+            List_Vec3f_COUNT(slab_allocs, 1);
+            List_Vec3f_COUNT(allocated_bytes, sizeof(List_Vec3f_Slab));
+            
+            if (pool->current)
+            {
+                pool->current->next = slab;
+            }
+            else
+            {
+                pool->slabs = slab;
+            }
+        }
+        pool->current = slab;
+        pool->slab_used = 0;
+    }
+    
+    return &pool->current->nodes[pool->slab_used++];
+}
+
+static inline void
+List_Vec3f_release(List_Vec3f_Pool *pool, List_Vec3f *node)
+{
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+/* drops every node at once, the slabs are reused */
+static inline void
+List_Vec3f_reset(List_Vec3f_Pool *pool)
+{
+    pool->current = 0;
+    pool->slab_used = 0;
+    pool->free_list = 0;
+}
+
+static inline void
+List_Vec3f_pool_free(List_Vec3f_Pool *pool)
+{
+    for (List_Vec3f_Slab *slab = pool->slabs; slab;)
+    {
+        List_Vec3f_Slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    *pool = (List_Vec3f_Pool){0};
+}
+
+static inline b32
+List_Vec3f_pool_push(List_Vec3f_Pool *pool, List_Vec3f **head, Vec3f data)
+{
+    List_Vec3f *node = List_Vec3f_alloc(pool);
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *head = List_Vec3f_push(*head, node, data);
+    return 1;
+}
+
+static inline b32
+List_Vec3f_pool_pop(List_Vec3f_Pool *pool, List_Vec3f **head, Vec3f *data)
+{
+    List_Vec3f *node = *head;
+    if (!node)
+    {
+        return 0;
+    }
+    
+    *data = node->data;
+    *head = node->next;
+    List_Vec3f_release(pool, node);
+    return 1;
+}
+
+/* like for_each, but starts loading the next node while the body runs */
+#ifndef GEN_PREFETCH
+#if defined(__GNUC__)
+#define GEN_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define GEN_PREFETCH(address) ((void)(address))
+#endif
+#endif
+
+#define List_Vec3f_for_each_prefetch(node, head) \
+    for (List_Vec3f *node = (head); \
+         node && (GEN_PREFETCH(node->next), 1); \
+         node = node->next)
+
+static inline void
+Swap_F32(f32 *a, f32 *b)
+{
+    f32 temp = *a;
+    *a = *b;
+    *b = temp;
+}
 
@@ -0,0 +1,33 @@
+~output_ext .h
+
+@template_start Vec2 <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    T x, y;
+};
+@template_end
+
+@template_start Circle <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Vec2<T> center;
+    T radius;
+};
+@template_end
+
+@template_start Rect <- T
+typedef struct @template_name @template_name;
+struct @template_name
+{
+    Vec2<T> min;
+    Vec2<T> max;
+};
+@template_end
+
+@template Circle -> f32 -> Circle_F32
+@template Rect -> f32 -> Rect_F32
+
+@variant Circle_F32, Rect_F32, Vec2<f32> -> Shape
+@variant u32, f64, Vec2<f64> -> Value
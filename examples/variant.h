@@ -0,0 +1,234 @@
+typedef struct Vec2_f32 Vec2_f32;
+struct Vec2_f32
+{
+    f32 x, y;
+};
+
+typedef struct Circle_F32 Circle_F32;
+struct Circle_F32
+{
+    Vec2_f32 center;
+    f32 radius;
+};
+
+typedef struct Rect_F32 Rect_F32;
+struct Rect_F32
+{
+    Vec2_f32 min;
+    Vec2_f32 max;
+};
+
+/*
+ Shape: size 20, align 4, u8 tag at offset 16
+ Circle_F32: size 12, align 4
+ Rect_F32: size 16, align 4
+ Vec2_f32: size 8, align 4
+ */
+typedef enum Shape_Tag
+{
+    Shape_Tag_Circle_F32,
+    Shape_Tag_Rect_F32,
+    Shape_Tag_Vec2_f32,
+    Shape_Tag_Count
+} Shape_Tag;
+
+typedef struct Shape Shape;
+struct Shape
+{
+    union
+    {
+        Circle_F32 circle_f32;
+        Rect_F32 rect_f32;
+        Vec2_f32 vec2_f32;
+    };
+    u8 tag;
+};
+
+_Static_assert(sizeof(Shape) == 20, "unexpected size of Shape");
+
+static inline Shape
+Shape_from_circle_f32(Circle_F32 value)
+{
+    Shape variant;
+    variant.circle_f32 = value;
+    variant.tag = Shape_Tag_Circle_F32;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline Circle_F32 *
+Shape_as_circle_f32(Shape *variant)
+{
+    return (variant->tag == Shape_Tag_Circle_F32) ? &variant->circle_f32 : 0;
+}
+
+static inline Shape
+Shape_from_rect_f32(Rect_F32 value)
+{
+    Shape variant;
+    variant.rect_f32 = value;
+    variant.tag = Shape_Tag_Rect_F32;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline Rect_F32 *
+Shape_as_rect_f32(Shape *variant)
+{
+    return (variant->tag == Shape_Tag_Rect_F32) ? &variant->rect_f32 : 0;
+}
+
+static inline Shape
+Shape_from_vec2_f32(Vec2_f32 value)
+{
+    Shape variant;
+    variant.vec2_f32 = value;
+    variant.tag = Shape_Tag_Vec2_f32;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline Vec2_f32 *
+Shape_as_vec2_f32(Shape *variant)
+{
+    return (variant->tag == Shape_Tag_Vec2_f32) ? &variant->vec2_f32 : 0;
+}
+
+static inline char *
+Shape_tag_name(u32 tag)
+{
+    switch (tag)
+    {
+        case Shape_Tag_Circle_F32: return "Circle_F32";
+        case Shape_Tag_Rect_F32: return "Rect_F32";
+        case Shape_Tag_Vec2_f32: return "Vec2_f32";
+        default: return "";
+    }
+}
+
+/*
+ calls prefix_member(&variant->member, context) for the member in use,
+ for example prefix_circle_f32; variant is evaluated more than once
+ */
+#define Shape_visit(variant, prefix, context) \
+    do \
+    { \
+        switch ((variant)->tag) \
+        { \
+            case Shape_Tag_Circle_F32: prefix##_circle_f32(&(variant)->circle_f32, context); break; \
+            case Shape_Tag_Rect_F32: prefix##_rect_f32(&(variant)->rect_f32, context); break; \
+            case Shape_Tag_Vec2_f32: prefix##_vec2_f32(&(variant)->vec2_f32, context); break; \
+            default: break; \
+        } \
+    } while (0)
+
+typedef struct Vec2_f64 Vec2_f64;
+struct Vec2_f64
+{
+    f64 x, y;
+};
+
+/*
+ Value: size 24, align 8, u8 tag at offset 16
+ u32: size 4, align 4
+ f64: size 8, align 8
+ Vec2_f64: size 16, align 8
+ */
+typedef enum Value_Tag
+{
+    Value_Tag_u32,
+    Value_Tag_f64,
+    Value_Tag_Vec2_f64,
+    Value_Tag_Count
+} Value_Tag;
+
+typedef struct Value Value;
+struct Value
+{
+    union
+    {
+        u32 u32;
+        f64 f64;
+        Vec2_f64 vec2_f64;
+    };
+    u8 tag;
+};
+
+_Static_assert(sizeof(Value) == 24, "unexpected size of Value");
+
+static inline Value
+Value_from_u32(u32 value)
+{
+    Value variant;
+    variant.u32 = value;
+    variant.tag = Value_Tag_u32;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline u32 *
+Value_as_u32(Value *variant)
+{
+    return (variant->tag == Value_Tag_u32) ? &variant->u32 : 0;
+}
+
+static inline Value
+Value_from_f64(f64 value)
+{
+    Value variant;
+    variant.f64 = value;
+    variant.tag = Value_Tag_f64;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline f64 *
+Value_as_f64(Value *variant)
+{
+    return (variant->tag == Value_Tag_f64) ? &variant->f64 : 0;
+}
+
+static inline Value
+Value_from_vec2_f64(Vec2_f64 value)
+{
+    Value variant;
+    variant.vec2_f64 = value;
+    variant.tag = Value_Tag_Vec2_f64;
+    return variant;
+}
+
+/* the member if it is the one in use, or 0 */
+static inline Vec2_f64 *
+Value_as_vec2_f64(Value *variant)
+{
+    return (variant->tag == Value_Tag_Vec2_f64) ? &variant->vec2_f64 : 0;
+}
+
+static inline char *
+Value_tag_name(u32 tag)
+{
+    switch (tag)
+    {
+        case Value_Tag_u32: return "u32";
+        case Value_Tag_f64: return "f64";
+        case Value_Tag_Vec2_f64: return "Vec2_f64";
+        default: return "";
+    }
+}
+
+/*
+ calls prefix_member(&variant->member, context) for the member in use,
+ for example prefix_u32; variant is evaluated more than once
+ */
+#define Value_visit(variant, prefix, context) \
+    do \
+    { \
+        switch ((variant)->tag) \
+        { \
+            case Value_Tag_u32: prefix##_u32(&(variant)->u32, context); break; \
+            case Value_Tag_f64: prefix##_f64(&(variant)->f64, context); break; \
+            case Value_Tag_Vec2_f64: prefix##_vec2_f64(&(variant)->vec2_f64, context); break; \
+            default: break; \
+        } \
+    } while (0)
+